@@ -16,10 +16,24 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "client.h"
 
+/* Sequence number of the last sample shown (default of the wait command) */
+static uint64_t lastSampleSeq = 0;
+
+/* Live view state: subscribed channels and pushed frames not parsed yet (see subscribeSamples) */
+static uint8_t liveViewChannels = 0;
+static uint8_t liveRecvBuf[LIVE_VIEW_RECV_BUF_SIZE];
+static size_t liveRecvLen = 0;
+
+/* Multicast listener state: stream of the server and last sample received per sensor */
+static uint32_t mcastStreamId = 0;
+static uint64_t mcastLastSeq[SENSOR_ARRAY_SIZE];
+
 /* Function definitions */
 
 /*
@@ -48,43 +62,73 @@ int initMeasDataFilePath(char filePathBuf[]) {
 }
 
 /*
- * Function 'connectServer': connects to remote server.
+ * Function 'openServerSocket': opens a socket connected to the server.
+ * 
+ * Note:    An address containing '/' without port number is the path of the Unix
+ *          socket of a local server. Returns the socket or INVALID_FD on failure.
  */
-int connectServer(const char *ipAddress, const char *portNumber, struct pollfd pollArray[]) {
+int openServerSocket(const char *address, const char *portNumber) {
     
-    uint8_t response;
     int error;
-    int len;
-    int keepAliveState = 1;
-    char username[USR_NAME_MAX_LENGTH];
-    char password[USR_PWD_MAX_LENGTH];
+    int serverFd;
     
     struct addrinfo hints;
     struct addrinfo *res;
+    struct sockaddr_un unixAddress;
     
-    /* Initialize user data */
-    memset(username, 0, sizeof(username));
-    memset(password, 0, sizeof(password));
-    
-    /* Check if there is no active connection yet */
-    if(INVALID_FD != pollArray[POLL_ARRAY_SOCKET].fd) {
+    if((NULL == portNumber) && (NULL != strchr(address, '/'))) {
         
-        fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL_EXIST);
-        fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
-        fflush(stdout);
+        /* Local server */
+        if(strlen(address) >= sizeof(unixAddress.sun_path)) {
+            
+            fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL_ADDR);
+            fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
+            fflush(stdout);
+            
+            return INVALID_FD;
+        }
         
-        return -1;
+        memset(&unixAddress, 0, sizeof(unixAddress));
+        unixAddress.sun_family = AF_UNIX;
+        strcpy(unixAddress.sun_path, address);
+        
+        serverFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(serverFd < 0) {
+            
+            /* Failed to open client socket */
+            
+            perror("socket");
+            fflush(stderr);
+            fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL_SOCK);
+            fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
+            fflush(stdout);
+            
+            return INVALID_FD;
+        }
+        
+        if(connect(serverFd, (struct sockaddr*)&unixAddress, sizeof(unixAddress)) < 0) {
+            
+            /* Failed to connect to server socket */
+            
+            perror("connect");
+            fflush(stderr);
+            fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
+            fflush(stdout);
+            
+            close(serverFd);
+            return INVALID_FD;
+        }
+        
+        return serverFd;
     }
     
-    /* Check if function arguments are valid */
-    if((NULL == ipAddress) || (NULL == portNumber)) {
+    if(NULL == portNumber) {
         
         fprintf(stdout, MSG_USER_WARN_INVALID_ARG);
         fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
         fflush(stdout);
         
-        pollArray[POLL_ARRAY_SOCKET].fd = INVALID_FD;
-        return -1;
+        return INVALID_FD;
     }
     
     /* Initialize hints structure with TCP and either IPv4 or IPv6 address */
@@ -93,7 +137,7 @@ int connectServer(const char *ipAddress, const char *portNumber, struct pollfd p
     hints.ai_socktype = SOCK_STREAM;
     
     /* Resolve server address */
-    error = getaddrinfo(ipAddress, portNumber, &hints, &res);
+    error = getaddrinfo(address, portNumber, &hints, &res);
     if(0 != error) {
         
         /* Failed to resolve server address */
@@ -103,8 +147,7 @@ int connectServer(const char *ipAddress, const char *portNumber, struct pollfd p
         fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
         fflush(stdout);
         
-        pollArray[POLL_ARRAY_SOCKET].fd = INVALID_FD;
-        return -1;
+        return INVALID_FD;
     }
     else if(NULL == res) {
         
@@ -114,13 +157,12 @@ int connectServer(const char *ipAddress, const char *portNumber, struct pollfd p
         fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
         fflush(stdout);
         
-        pollArray[POLL_ARRAY_SOCKET].fd = INVALID_FD;
-        return -1;
+        return INVALID_FD;
     }
     
     /* Create client socket based on res settings */
-    pollArray[POLL_ARRAY_SOCKET].fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
-    if(pollArray[POLL_ARRAY_SOCKET].fd < 0) {
+    serverFd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if(serverFd < 0) {
         
         /* Failed to open client socket */
         
@@ -133,12 +175,11 @@ int connectServer(const char *ipAddress, const char *portNumber, struct pollfd p
         /* Free address-info list pointed by res */
         freeaddrinfo(res);
         
-        pollArray[POLL_ARRAY_SOCKET].fd = INVALID_FD;
-        return -1;
+        return INVALID_FD;
     }
     
     /* Connect client socket to server socket referenced to by ai_addr */
-    if(connect(pollArray[POLL_ARRAY_SOCKET].fd, res->ai_addr, res->ai_addrlen) < 0) {
+    if(connect(serverFd, res->ai_addr, res->ai_addrlen) < 0) {
         
         /* Failed to connect to server socket */
         
@@ -150,10 +191,62 @@ int connectServer(const char *ipAddress, const char *portNumber, struct pollfd p
         /* Free address-info list pointed by res */
         freeaddrinfo(res);
         
+        close(serverFd);
+        return INVALID_FD;
+    }
+    
+    /* Free address-info list pointed by res */
+    freeaddrinfo(res);
+    
+    return serverFd;
+}
+
+/*
+ * Function 'connectServer': connects to remote server.
+ * 
+ * Note:    Port number NULL and a path as address connect to the Unix socket of a
+ *          local server (see openServerSocket).
+ */
+int connectServer(const char *ipAddress, const char *portNumber, struct pollfd pollArray[]) {
+    
+    uint8_t response;
+    int len;
+    int keepAliveState = 1;
+    char username[USR_NAME_MAX_LENGTH];
+    char password[USR_PWD_MAX_LENGTH];
+    
+    /* Initialize user data */
+    memset(username, 0, sizeof(username));
+    memset(password, 0, sizeof(password));
+    
+    /* Check if there is no active connection yet */
+    if(INVALID_FD != pollArray[POLL_ARRAY_SOCKET].fd) {
+        
+        fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL_EXIST);
+        fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
+        fflush(stdout);
+        
+        return -1;
+    }
+    
+    /* Check if function arguments are valid */
+    if(NULL == ipAddress) {
+        
+        fprintf(stdout, MSG_USER_WARN_INVALID_ARG);
+        fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
+        fflush(stdout);
+        
         pollArray[POLL_ARRAY_SOCKET].fd = INVALID_FD;
         return -1;
     }
     
+    /* Connect to the server */
+    pollArray[POLL_ARRAY_SOCKET].fd = openServerSocket(ipAddress, portNumber);
+    if(INVALID_FD == pollArray[POLL_ARRAY_SOCKET].fd) {
+        
+        return -1;
+    }
+    
     /* Authenticate client */
     
     /* Read username */
@@ -204,9 +297,6 @@ int connectServer(const char *ipAddress, const char *portNumber, struct pollfd p
         fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
         fflush(stdout);
         
-        /* Free address-info list pointed by res */
-        freeaddrinfo(res);
-        
         close(pollArray[POLL_ARRAY_SOCKET].fd);
         pollArray[POLL_ARRAY_SOCKET].fd = INVALID_FD;
         return -1;
@@ -222,9 +312,6 @@ int connectServer(const char *ipAddress, const char *portNumber, struct pollfd p
         fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
         fflush(stdout);
         
-        /* Free address-info list pointed by res */
-        freeaddrinfo(res);
-        
         close(pollArray[POLL_ARRAY_SOCKET].fd);
         pollArray[POLL_ARRAY_SOCKET].fd = INVALID_FD;
         return -1;
@@ -240,9 +327,6 @@ int connectServer(const char *ipAddress, const char *portNumber, struct pollfd p
         fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
         fflush(stdout);
         
-        /* Free address-info list pointed by res */
-        freeaddrinfo(res);
-        
         close(pollArray[POLL_ARRAY_SOCKET].fd);
         pollArray[POLL_ARRAY_SOCKET].fd = INVALID_FD;
         return -1;
@@ -255,9 +339,6 @@ int connectServer(const char *ipAddress, const char *portNumber, struct pollfd p
         fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
         fflush(stdout);
         
-        /* Free address-info list pointed by res */
-        freeaddrinfo(res);
-        
         close(pollArray[POLL_ARRAY_SOCKET].fd);
         pollArray[POLL_ARRAY_SOCKET].fd = INVALID_FD;
         return -1;
@@ -273,17 +354,11 @@ int connectServer(const char *ipAddress, const char *portNumber, struct pollfd p
         fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL);
         fflush(stdout);
         
-        /* Free address-info list pointed by res */
-        freeaddrinfo(res);
-        
         close(pollArray[POLL_ARRAY_SOCKET].fd);
         pollArray[POLL_ARRAY_SOCKET].fd = INVALID_FD;
         return -1;
     }
     
-    /* Free address-info list pointed by res */
-    freeaddrinfo(res);
-    
     /* Connection was successfully estabilished */
     fprintf(stdout, MSG_USER_INFO_CONNECT_SUCCESS);
     fflush(stdout);
@@ -371,40 +446,23 @@ int exitProgram(struct pollfd pollArray[]) {
 }
 
 /*
- * Function 'setSensorConfig': requests server to set sensor configuration.
+ * Function 'parseConfigArgs': parses a config field of the sconf and mconf commands.
  * 
- * Protocol:    Client --> Server: set configuration request code <1 byte>
- *              Client <-- Server: result of request code validation <1 byte>
- * 
- *              ++ In case of successful request validation ++
- * 
- *              Client --> Server: configuration parameters <1 byte>
- *              Client --> Server: period value <4 bytes> (only for period config)
- *              Client <-- Server: result of request processing <1 byte>
+ * Note:    args[0] is the config type followed by its status and value arguments.
+ *          Returns the number of arguments the field consists of, -1 if invalid.
  */
-int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
+int parseConfigArgs(const char* args[], uint8_t *configSel, uint32_t *confValue) {
     
-    uint8_t request = 0x00;        // Request code (from client to server)
-    uint8_t configSel = 0x00;      // Configuration selector
-    uint8_t response = 0x00;       // Response code (from server to client)
-    int period = 0;
+    unsigned long long value = 0;  // Parsed period value
+    char *unit = NULL;             // Unit suffix of period value
     int error = 0;
-    int len;
+    int argCount = 2;              // Arguments of the field (type and status or period)
     
-    /* Check if there is an active connection */
-    if(INVALID_FD == pollArray[POLL_ARRAY_SOCKET].fd) {
-        
-        /* No active connection */
-        fprintf(stdout, MSG_USER_WARN_NO_CONN);
-        fprintf(stdout, MSG_USER_WARN_REQ_FAIL);
-        fflush(stdout);
-        
-        error = -1;
-        return error;
-    }
+    *configSel = 0x00;
+    *confValue = 0;
     
     /* Check NULL of config type argument */
-    if(NULL == args[1]) {
+    if(NULL == args[0]) {
         
         /* Invalid config type argument */
         fprintf(stdout, MSG_USER_WARN_INVALID_CONF_TYPE_ARG);
@@ -416,14 +474,25 @@ int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
     }
     
     /* Interpret user command */
-    if(0 == strcmp(args[1], STR_CMD_SCONF_PERIOD)) {
+    if(0 == strcmp(args[0], STR_CMD_SCONF_PERIOD)) {
         
         /* Request period config */
         
-        configSel |= REQ_CONF_PRD;
-        
         /* Check NULL of config period argument */
-        if(NULL == args[2]) {
+        if(NULL == args[1]) {
+            
+            fprintf(stdout, MSG_USER_WARN_INVALID_CONF_PRD_ARG);
+            fprintf(stdout, MSG_USER_INFO_HINT_CONF);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
+        
+        /* Convert period from string to integer and interpret unit suffix */
+        errno = 0;
+        value = strtoull(args[1], &unit, 10);
+        if((0 != errno) || (unit == args[1]) || ('-' == args[1][0])) {
             
             fprintf(stdout, MSG_USER_WARN_INVALID_CONF_PRD_ARG);
             fprintf(stdout, MSG_USER_INFO_HINT_CONF);
@@ -433,17 +502,66 @@ int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
             return error;
         }
         
-        /* Convert period from string to integer */
-        period = atoi(args[2]);
+        if(('\0' == *unit) || (0 == strcmp(unit, STR_CMD_SCONF_PERIOD_UNIT_SEC))) {
+            
+            /* Period in seconds */
+            *configSel |= REQ_CONF_PRD;
+            *confValue = (uint32_t)value;
+            
+            if(value > INT_MAX) {
+                
+                /* Period value out of range */
+                unit = NULL;
+            }
+        }
+        else if(0 == strcmp(unit, STR_CMD_SCONF_PERIOD_UNIT_MS)) {
+            
+            /* Period in milliseconds */
+            *configSel |= REQ_CONF_PRD_US;
+            *confValue = (uint32_t)(value * USEC_PER_MSEC);
+            
+            if(value > (UINT32_MAX / USEC_PER_MSEC)) {
+                
+                /* Period value out of range */
+                unit = NULL;
+            }
+        }
+        else if(0 == strcmp(unit, STR_CMD_SCONF_PERIOD_UNIT_US)) {
+            
+            /* Period in microseconds */
+            *configSel |= REQ_CONF_PRD_US;
+            *confValue = (uint32_t)value;
+            
+            if(value > UINT32_MAX) {
+                
+                /* Period value out of range */
+                unit = NULL;
+            }
+        }
+        else {
+            
+            /* Invalid period unit */
+            unit = NULL;
+        }
+        
+        if(NULL == unit) {
+            
+            fprintf(stdout, MSG_USER_WARN_INVALID_CONF_PRD_ARG);
+            fprintf(stdout, MSG_USER_INFO_HINT_CONF);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
     }
-    else if(0 == strcmp(args[1], STR_CMD_SCONF_IIR_FILTER)) {
+    else if(0 == strcmp(args[0], STR_CMD_SCONF_IIR_FILTER)) {
         
         /* Request IIR filter config */
         
-        configSel |= REQ_CONF_IIR;
+        *configSel |= REQ_CONF_IIR;
         
         /* Check NULL of config status argument */
-        if(NULL == args[2]) {
+        if(NULL == args[1]) {
             
             fprintf(stdout, MSG_USER_WARN_INVALID_CONF_STAT_ARG);
             fprintf(stdout, MSG_USER_INFO_HINT_CONF);
@@ -454,13 +572,14 @@ int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
         }
         
         /* Identify config status */
-        if(0 == strcmp(args[2], STR_CMD_SCONF_ON)) {
+        if(0 == strcmp(args[1], STR_CMD_SCONF_ON)) {
             
             /* Config status on */
-            configSel |= REQ_CONF_ON;
+            *configSel |= REQ_CONF_ON;
+            argCount = 3;
             
             /* Check NULL of config value argument */
-            if(NULL == args[3]) {
+            if(NULL == args[2]) {
             
                 fprintf(stdout, MSG_USER_WARN_INVALID_CONF_VAL_ARG);
                 fprintf(stdout, MSG_USER_INFO_HINT_CONF);
@@ -471,30 +590,30 @@ int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
             }
             
             /* Identify config value */
-            if(0 == strcmp(args[3], STR_CMD_SCONF_IIR_COEFF_OFF)) {
+            if(0 == strcmp(args[2], STR_CMD_SCONF_IIR_COEFF_OFF)) {
                 
                 /* Filter coefficient off */
-                configSel |= REQ_CONF_COEFF_OFF;
+                *configSel |= REQ_CONF_COEFF_OFF;
             }
-            else if(0 == strcmp(args[3], STR_CMD_SCONF_IIR_COEFF_2)) {
+            else if(0 == strcmp(args[2], STR_CMD_SCONF_IIR_COEFF_2)) {
                 
                 /* Filter coefficient 2 */
-                configSel |= REQ_CONF_COEFF_2;
+                *configSel |= REQ_CONF_COEFF_2;
             }
-            else if(0 == strcmp(args[3], STR_CMD_SCONF_IIR_COEFF_4)) {
+            else if(0 == strcmp(args[2], STR_CMD_SCONF_IIR_COEFF_4)) {
                 
                 /* Filter coefficient 4 */
-                configSel |= REQ_CONF_COEFF_4;
+                *configSel |= REQ_CONF_COEFF_4;
             }
-            else if(0 == strcmp(args[3], STR_CMD_SCONF_IIR_COEFF_8)) {
+            else if(0 == strcmp(args[2], STR_CMD_SCONF_IIR_COEFF_8)) {
                 
                 /* Filter coefficient 8 */
-                configSel |= REQ_CONF_COEFF_8;
+                *configSel |= REQ_CONF_COEFF_8;
             }
-            else if(0 == strcmp(args[3], STR_CMD_SCONF_IIR_COEFF_16)) {
+            else if(0 == strcmp(args[2], STR_CMD_SCONF_IIR_COEFF_16)) {
                 
                 /* Filter coefficient 16 */
-                configSel |= REQ_CONF_COEFF_16;
+                *configSel |= REQ_CONF_COEFF_16;
             }
             else {
                 
@@ -507,10 +626,38 @@ int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
                 return error;
             }
         }
-        else if(0 == strcmp(args[2], STR_CMD_SCONF_OFF)) {
+        else if(0 == strcmp(args[1], STR_CMD_SCONF_OFF)) {
             
             /* Config status off */
-            configSel |= REQ_CONF_OFF;
+            *configSel |= REQ_CONF_OFF;
+        }
+        else {
+            
+            /* Invalid config status argument */
+            fprintf(stdout, MSG_USER_WARN_INVALID_CONF_STAT_ARG);
+            fprintf(stdout, MSG_USER_INFO_HINT_CONF);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
+    }
+    else if(0 == strcmp(args[0], STR_CMD_SCONF_MODE)) {
+        
+        /* Request acquisition mode config */
+        
+        *configSel |= REQ_CONF_MODE;
+        
+        /* Identify config status */
+        if((NULL != args[1]) && (0 == strcmp(args[1], STR_CMD_SCONF_ON))) {
+            
+            /* Normal (continuous) mode */
+            *configSel |= REQ_CONF_ON;
+        }
+        else if((NULL != args[1]) && (0 == strcmp(args[1], STR_CMD_SCONF_OFF))) {
+            
+            /* Forced mode */
+            *configSel |= REQ_CONF_OFF;
         }
         else {
             
@@ -525,33 +672,33 @@ int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
     }
     else if(
         
-        (0 == strcmp(args[1], STR_CMD_SCONF_HUMIDITY)) ||
-        (0 == strcmp(args[1], STR_CMD_SCONF_PRESSURE)) ||
-        (0 == strcmp(args[1], STR_CMD_SCONF_TEMPERATURE))
+        (0 == strcmp(args[0], STR_CMD_SCONF_HUMIDITY)) ||
+        (0 == strcmp(args[0], STR_CMD_SCONF_PRESSURE)) ||
+        (0 == strcmp(args[0], STR_CMD_SCONF_TEMPERATURE))
     ) {
         
         /* Request humidity/pressure/temperature config */
         /* The interpretation of these configs are identical */
         
         /* Identify config type */
-        if(0 == strcmp(args[1], STR_CMD_SCONF_HUMIDITY)) {
+        if(0 == strcmp(args[0], STR_CMD_SCONF_HUMIDITY)) {
             
             /* Request humidity config */
-            configSel |= REQ_CONF_HUM;
+            *configSel |= REQ_CONF_HUM;
         }
-        else if(0 == strcmp(args[1], STR_CMD_SCONF_PRESSURE)) {
+        else if(0 == strcmp(args[0], STR_CMD_SCONF_PRESSURE)) {
             
             /* Request pressure config */
-            configSel |= REQ_CONF_PRS;
+            *configSel |= REQ_CONF_PRS;
         }
         else{
          
             /* Request temperature config */
-            configSel |= REQ_CONF_TMP;
+            *configSel |= REQ_CONF_TMP;
         }
         
         /* Check NULL of config status argument */
-        if(NULL == args[2]) {
+        if(NULL == args[1]) {
             
             fprintf(stdout, MSG_USER_WARN_INVALID_CONF_STAT_ARG);
             fprintf(stdout, MSG_USER_INFO_HINT_CONF);
@@ -562,13 +709,14 @@ int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
         }
         
         /* Identify config status */
-        if(0 == strcmp(args[2], STR_CMD_SCONF_ON)){
+        if(0 == strcmp(args[1], STR_CMD_SCONF_ON)){
             
             /* Config status on */
-            configSel |= REQ_CONF_ON;
+            *configSel |= REQ_CONF_ON;
+            argCount = 3;
             
             /* Check NULL of config value argument */
-            if(NULL == args[3]) {
+            if(NULL == args[2]) {
             
                 fprintf(stdout, MSG_USER_WARN_INVALID_CONF_VAL_ARG);
                 fprintf(stdout, MSG_USER_INFO_HINT_CONF);
@@ -579,35 +727,35 @@ int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
             }
             
             /* Identify config value */
-            if(0 == strcmp(args[3], STR_CMD_SCONF_OVERSAMPLING_OFF)) {
+            if(0 == strcmp(args[2], STR_CMD_SCONF_OVERSAMPLING_OFF)) {
             
                 /* Oversmapling off */
-                configSel |= REQ_CONF_OS_OFF;
+                *configSel |= REQ_CONF_OS_OFF;
             }
-            else if(0 == strcmp(args[3], STR_CMD_SCONF_OVERSAMPLING_1X)) {
+            else if(0 == strcmp(args[2], STR_CMD_SCONF_OVERSAMPLING_1X)) {
             
                 /* Oversampling 1X */
-                configSel |= REQ_CONF_OS_1X;
+                *configSel |= REQ_CONF_OS_1X;
             }
-            else if(0 == strcmp(args[3], STR_CMD_SCONF_OVERSAMPLING_2X)) {
+            else if(0 == strcmp(args[2], STR_CMD_SCONF_OVERSAMPLING_2X)) {
             
                 /* Oversampling 2X */
-                configSel |= REQ_CONF_OS_2X;
+                *configSel |= REQ_CONF_OS_2X;
             }
-            else if(0 == strcmp(args[3], STR_CMD_SCONF_OVERSAMPLING_4X)) {
+            else if(0 == strcmp(args[2], STR_CMD_SCONF_OVERSAMPLING_4X)) {
             
                 /* Oversampling 4X */
-                configSel |= REQ_CONF_OS_4X;
+                *configSel |= REQ_CONF_OS_4X;
             }
-            else if(0 == strcmp(args[3], STR_CMD_SCONF_OVERSAMPLING_8X)) {
+            else if(0 == strcmp(args[2], STR_CMD_SCONF_OVERSAMPLING_8X)) {
             
                 /* Oversampling 8X */
-                configSel |= REQ_CONF_OS_8X;
+                *configSel |= REQ_CONF_OS_8X;
             }
-            else if(0 == strcmp(args[3], STR_CMD_SCONF_OVERSAMPLING_16X)) {
+            else if(0 == strcmp(args[2], STR_CMD_SCONF_OVERSAMPLING_16X)) {
             
                 /* Oversampling 16X */
-                configSel |= REQ_CONF_OS_16X;
+                *configSel |= REQ_CONF_OS_16X;
             }
             else {
             
@@ -621,10 +769,10 @@ int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
             }
             
         }
-        else if(0 == strcmp(args[2], STR_CMD_SCONF_OFF)) {
+        else if(0 == strcmp(args[1], STR_CMD_SCONF_OFF)) {
             
             /* Config status off */
-            configSel |= REQ_CONF_OFF;
+            *configSel |= REQ_CONF_OFF;
         }
         else {
             
@@ -648,6 +796,62 @@ int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
         return error;
     }
     
+    return argCount;
+}
+
+/*
+ * Function 'setSensorConfig': requests server to set sensor configuration.
+ * 
+ * Protocol:    Client --> Server: set configuration request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: configuration parameters <1 byte>
+ *              Client --> Server: period value <4 bytes> (only for period config, seconds)
+ *              Client --> Server: period value <4 bytes> (only for microsecond period config)
+ *              Client <-- Server: result of request processing <1 byte>
+ */
+int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
+    
+    uint8_t request = 0x00;        // Request code (from client to server)
+    uint8_t configSel = 0x00;      // Configuration selector
+    uint8_t response = 0x00;       // Response code (from server to client)
+    int period = 0;                // Period [sec]
+    uint32_t periodUs = 0;         // Period [usec]
+    uint32_t value = 0;            // Config value
+    int error = 0;
+    int len;
+    
+    /* Check if there is an active connection */
+    if(INVALID_FD == pollArray[POLL_ARRAY_SOCKET].fd) {
+        
+        /* No active connection */
+        fprintf(stdout, MSG_USER_WARN_NO_CONN);
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Parse config field */
+    if(parseConfigArgs(&(args[1]), &configSel, &value) < 0) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Set period value based on config type */
+    if(REQ_CONF_PRD == (configSel & REQ_CONF_TYPE_MASK)) {
+        
+        period = (int)value;
+    }
+    else if(REQ_CONF_PRD_US == (configSel & REQ_CONF_TYPE_MASK)) {
+        
+        periodUs = value;
+    }
+    
     /* Note: at this point variable 'configSel' is fully configured */
     
     /* Set request to 'sconf' */
@@ -656,6 +860,7 @@ int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
     /* Note: at this point the whole request message is fully configured */
     
     // Period: server << request(uint8_t) << configSel(uint8_t) << period(int)
+    // Period [us]: server << request(uint8_t) << configSel(uint8_t) << periodUs(uint32_t)
     // Others: server << request(uint8_t) << configSel(uint8_t)
         
     /* Send request code to server */
@@ -752,6 +957,22 @@ int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
             return error;
         }
     }
+    else if(REQ_CONF_PRD_US == (configSel & REQ_CONF_TYPE_MASK)) {
+        
+        /* Send microsecond period value */
+        len = send(pollArray[POLL_ARRAY_SOCKET].fd, &periodUs, sizeof(periodUs), MSG_NOSIGNAL);
+        if(len < 0) {
+        
+            /* Failed to send period value to server */
+            perror("send");
+            fflush(stderr);
+            fprintf(stdout, MSG_USER_WARN_SEND_REQ_FAIL);
+            fflush(stdout);
+        
+            error = -1;
+            return error;
+        }
+    }
     
     /* Receive server response about the outcome of the remote configuration */
     len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
@@ -794,34 +1015,34 @@ int setSensorConfig(struct pollfd pollArray[], const char* args[]) {
 }
 
 /*
- * Function 'getSensorConfig': requests server to get sensor configuration.
+ * Function 'multiSetSensorConfig': requests server to set several sensor configurations at once.
+ * 
+ * Note:    Fields follow each other in the format of sconf, e.g.
+ *          mconf TMP ON OS_2X PRS ON OS_4X HUM OFF IIR ON COEFF_4 PRD 500ms
+ *          The server validates all of them before applying any.
  * 
- * Protocol:    Client --> Server: get configuration request code <1 byte>
+ * Protocol:    Client --> Server: multi-config request code <1 byte>
  *              Client <-- Server: result of request code validation <1 byte>
  * 
  *              ++ In case of successful request validation ++
  * 
- *              Client <-- Server: period value <4 bytes>
- *              Client <-- Server: temperature configuration <8 bytes>
- *              Client <-- Server: humidity configuration <8 bytes>
- *              Client <-- Server: pressure configuration <8 bytes>
- *              Client <-- Server: IIR filter configuration <16 bytes>
+ *              Client --> Server: number of config fields <1 byte>
+ *              Client --> Server: config fields <<number of config fields> * 5 bytes>
+ *                                 (configuration parameters <1 byte>, value <4 bytes>)
+ *              Client <-- Server: result of request processing <1 byte>
  */
-int getSensorConfig(struct pollfd pollArray[]) {
+int multiSetSensorConfig(struct pollfd pollArray[], const char* args[]) {
     
-    uint8_t request = 0;
-    uint8_t response = 0;
+    uint8_t count = 0;             // Number of config fields
+    uint8_t configSel = 0x00;      // Configuration selector
+    uint8_t response = 0x00;       // Response code (from server to client)
+    uint8_t fieldBuf[REQ_MCONF_FIELDS_MAX * REQ_MCONF_FIELD_LEN];
+    uint32_t value = 0;            // Config value
+    int argIndex = 1;
+    int argCount;
     int error = 0;
     int len;
     
-    int measPeriod = 0;                         // Measurement period [sec]
-    char envVarConfMsg[8];                      // String message of TMP/HUM/PRS configs (collective)
-    char iirFltrConfMsg[16];                    // String message of IIR filter config
-    
-    /* Initialize local variables */
-    memset(envVarConfMsg, 0, sizeof(envVarConfMsg));
-    memset(iirFltrConfMsg, 0, sizeof(iirFltrConfMsg));
-    
     /* Check if there is an active connection */
     if(INVALID_FD == pollArray[POLL_ARRAY_SOCKET].fd) {
         
@@ -834,12 +1055,60 @@ int getSensorConfig(struct pollfd pollArray[]) {
         return error;
     }
     
+    /* Parse config fields */
+    while(NULL != args[argIndex]) {
+        
+        if(REQ_MCONF_FIELDS_MAX == count) {
+            
+            /* Too many config fields */
+            fprintf(stdout, MSG_USER_WARN_INVALID_ARG);
+            fprintf(stdout, MSG_USER_INFO_HINT_MCONF);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
+        
+        argCount = parseConfigArgs(&(args[argIndex]), &configSel, &value);
+        if(argCount < 0) {
+            
+            error = -1;
+            return error;
+        }
+        
+        fieldBuf[count * REQ_MCONF_FIELD_LEN] = configSel;
+        memcpy(&(fieldBuf[count * REQ_MCONF_FIELD_LEN + 1]), &value, sizeof(value));
+        count++;
+        argIndex += argCount;
+    }
+    
+    if(0 == count) {
+        
+        /* No config field */
+        fprintf(stdout, MSG_USER_WARN_MISSING_ARG);
+        fprintf(stdout, MSG_USER_INFO_HINT_MCONF);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
     /* Send request code to server */
-    request = REQ_CODE_GCONF;
-    len = send(pollArray[POLL_ARRAY_SOCKET].fd, &request, sizeof(request), MSG_NOSIGNAL);
+    if(0 != sendRequestCode(pollArray, REQ_CODE_MCONF)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Send config fields to server */
+    len = send(pollArray[POLL_ARRAY_SOCKET].fd, &count, sizeof(count), MSG_NOSIGNAL | MSG_MORE);
+    if(len >= 0) {
+        
+        len = send(pollArray[POLL_ARRAY_SOCKET].fd, fieldBuf, count * REQ_MCONF_FIELD_LEN, MSG_NOSIGNAL);
+    }
     if(len < 0) {
         
-        /* Failed to send client request to server */
+        /* Failed to send config fields to server */
         perror("send");
         fflush(stderr);
         fprintf(stdout, MSG_USER_WARN_SEND_REQ_FAIL);
@@ -849,9 +1118,9 @@ int getSensorConfig(struct pollfd pollArray[]) {
         return error;
     }
     
-    /* Receive server response about the outcome of processing the reqest code */
+    /* Receive server response about the outcome of the remote configuration */
     len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
-    if(len < 0) {
+    if(len <= 0) {
      
         /* Failed to receive response from server */
         perror("recv");
@@ -864,134 +1133,148 @@ int getSensorConfig(struct pollfd pollArray[]) {
     }
     
     /* Process server response */
-    if(RES_CODE_REQ_ACCEPT == response) {
-        
-        /* Client request accepted */
-    }
-    else if(RES_CODE_REQ_NO_PERM == response) {
+    if(RES_CODE_REQ_SUCCESS == response) {
         
-        /* Client does not have permission for the issued request */
-        fprintf(stdout, MSG_USER_WARN_REQ_NO_PERM);
-        fprintf(stdout, MSG_USER_WARN_REQ_FAIL);
+        /* Client configuration request succeeded */
+        fprintf(stdout, MSG_USER_INFO_REQ_SUCCESS);
         fflush(stdout);
-        
-        error = -1;
-        return error;
     }
-    else if(RES_CODE_REQ_INVALID == response) {
+    else if(RES_CODE_REQ_FAIL == response) {
         
-        /* Client request was invalid */
-        fprintf(stdout, MSG_USER_WARN_REQ_INVALID);
-        fprintf(stdout, MSG_USER_WARN_REQ_FAIL);
+        /* Client configuration request failed (invalid field or server side error), nothing applied */
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL_SERVER);
         fflush(stdout);
-        
-        error = -1;
-        return error;
     }
     else {
-     
+        
         /* Invalid server response */
         fprintf(stdout, MSG_USER_WARN_RES_INVALID);
         fflush(stdout);
         
         error = -1;
-        return error;
     }
     
-    /* Receive config data from server and print it out */
+    return error;
+}
+
+/*
+ * Function 'getConfigString': returns the config string of a binary config parameter (gconf).
+ */
+static const char* getConfigString(uint8_t config, const char **strTable, size_t strTableSize) {
     
-    /* Receive measurement period from server */
-    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &measPeriod, sizeof(measPeriod), MSG_WAITALL);
-    if(len < 0) {
-     
-        /* Failed to receive measurement period from server */
-        perror("recv");
-        fflush(stderr);
-        fprintf(stdout, MSG_USER_WARN_RECV_CONF_PRD_FAIL);
-        fflush(stdout);
+    uint8_t index = (config & REQ_CONF_VALUE_MASK) >> 4;
+    
+    if(REQ_CONF_OFF == (config & REQ_CONF_STATUS_MASK)) {
         
-        error = -1;
-        return error;
+        return STR_CONF_OFF;
     }
     
-    /* Print measurement period */
-    fprintf(stdout, MSG_USER_INFO_CONF_HEADER);
-    fprintf(stdout, MSG_USER_INFO_CONF_PERIOD, measPeriod);
-    fflush(stdout);
+    return (index < strTableSize) ? strTable[index] : STR_CONF_ERR;
+}
+
+/*
+ * Function 'getSensorConfig': requests server to get sensor configuration.
+ * 
+ * Protocol:    Client --> Server: get binary configuration request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client <-- Server: config version <4 bytes>
+ *              Client <-- Server: period value <8 bytes> (microseconds)
+ *              Client <-- Server: temperature configuration <1 byte>
+ *              Client <-- Server: humidity configuration <1 byte>
+ *              Client <-- Server: pressure configuration <1 byte>
+ *              Client <-- Server: IIR filter configuration <1 byte>
+ *              Client <-- Server: acquisition mode configuration <1 byte>
+ * 
+ * Note:    Configurations are encoded like the set configuration requests and
+ *          rendered to strings here.
+ */
+int getSensorConfig(struct pollfd pollArray[]) {
     
+    int error = 0;
+    int len;
     
-    /* Receive temperature config from server */
-    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &envVarConfMsg, sizeof(envVarConfMsg), MSG_WAITALL);
-    if(len < 0) {
-     
-        /* Failed to receive temperature config from server */
-        perror("recv");
-        fflush(stderr);
-        fprintf(stdout, MSG_USER_WARN_RECV_CONF_TMP_FAIL);
-        fflush(stdout);
-        
-        error = -1;
-        return error;
-    }
+    uint8_t confMsg[RES_GCONFB_LEN];            // Binary config message
+    uint32_t confVersion = 0;                   // Config version
+    uint64_t measPeriodUs = 0;                  // Measurement period [usec]
+    const uint8_t *pConf = confMsg;
     
-    /* Print temperature config */
-    fprintf(stdout, MSG_USER_INFO_CONF_TEMPERATURE, envVarConfMsg);
-    fflush(stdout);
+    /* Oversampling config strings indexed by config value */
+    static const char *oversamplingStrTable[] = {
+        
+        STR_CMD_SCONF_OVERSAMPLING_OFF,
+        STR_CMD_SCONF_OVERSAMPLING_1X,
+        STR_CMD_SCONF_OVERSAMPLING_2X,
+        STR_CMD_SCONF_OVERSAMPLING_4X,
+        STR_CMD_SCONF_OVERSAMPLING_8X,
+        STR_CMD_SCONF_OVERSAMPLING_16X
+    };
     
-    /* Receive humidity config from server */
-    memset(envVarConfMsg, 0, sizeof(envVarConfMsg)); // Reset shared variable
-    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &envVarConfMsg, sizeof(envVarConfMsg), MSG_WAITALL);
-    if(len < 0) {
-     
-        /* Failed to receive humidity config from server */
-        perror("recv");
-        fflush(stderr);
-        fprintf(stdout, MSG_USER_WARN_RECV_CONF_HUM_FAIL);
-        fflush(stdout);
+    /* IIR filter config strings indexed by config value */
+    static const char *filterStrTable[] = {
+        
+        STR_CMD_SCONF_IIR_COEFF_OFF,
+        STR_CMD_SCONF_IIR_COEFF_2,
+        STR_CMD_SCONF_IIR_COEFF_4,
+        STR_CMD_SCONF_IIR_COEFF_8,
+        STR_CMD_SCONF_IIR_COEFF_16
+    };
+    
+    /* Send request code to server and check response */
+    if(0 != sendRequestCode(pollArray, REQ_CODE_GCONFB)) {
         
         error = -1;
         return error;
     }
     
-    /* Print humidity config */
-    fprintf(stdout, MSG_USER_INFO_CONF_HUMIDITY, envVarConfMsg);
-    fflush(stdout);
-    
-    /* Receive pressure config from server */
-    memset(envVarConfMsg, 0, sizeof(envVarConfMsg)); // Reset shared variable
-    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &envVarConfMsg, sizeof(envVarConfMsg), MSG_WAITALL);
-    if(len < 0) {
+    /* Receive config data from server */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, confMsg, sizeof(confMsg), MSG_WAITALL);
+    if(len != sizeof(confMsg)) {
      
-        /* Failed to receive pressure config from server */
+        /* Failed to receive config from server */
         perror("recv");
         fflush(stderr);
-        fprintf(stdout, MSG_USER_WARN_RECV_CONF_PRS_FAIL);
+        fprintf(stdout, MSG_USER_WARN_RECV_CONF_FAIL);
         fflush(stdout);
         
         error = -1;
         return error;
     }
     
-    /* Print pressure config */
-    fprintf(stdout, MSG_USER_INFO_CONF_PRESSURE, envVarConfMsg);
-    fflush(stdout);
+    memcpy(&confVersion, pConf, sizeof(confVersion));
+    pConf += sizeof(confVersion);
+    memcpy(&measPeriodUs, pConf, sizeof(measPeriodUs));
+    pConf += sizeof(measPeriodUs);
     
-    /* Receive IIR filter config from server */
-    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &iirFltrConfMsg, sizeof(iirFltrConfMsg), MSG_WAITALL);
-    if(len < 0) {
-     
-        /* Failed to receive IIR filer config from server */
-        perror("recv");
-        fflush(stderr);
-        fprintf(stdout, MSG_USER_WARN_RECV_CONF_IIR_FAIL);
-        fflush(stdout);
+    /* Print config version and measurement period in the largest unit representing it exactly */
+    fprintf(stdout, MSG_USER_INFO_CONF_HEADER);
+    fprintf(stdout, MSG_USER_INFO_CONF_VERSION, confVersion);
+    if(0 == (measPeriodUs % USEC_PER_SEC)) {
         
-        error = -1;
-        return error;
+        fprintf(stdout, MSG_USER_INFO_CONF_PERIOD, (unsigned long long)(measPeriodUs / USEC_PER_SEC));
+    }
+    else if(0 == (measPeriodUs % USEC_PER_MSEC)) {
+        
+        fprintf(stdout, MSG_USER_INFO_CONF_PERIOD_MS, (unsigned long long)(measPeriodUs / USEC_PER_MSEC));
+    }
+    else {
+        
+        fprintf(stdout, MSG_USER_INFO_CONF_PERIOD_US, (unsigned long long)measPeriodUs);
     }
     
-    /* Print IIR filter config */
-    fprintf(stdout, MSG_USER_INFO_CONF_FILTER, iirFltrConfMsg);
+    /* Print TMP, HUM, PRS, IIR and mode configs */
+    fprintf(stdout, MSG_USER_INFO_CONF_TEMPERATURE,
+            getConfigString(pConf[0], oversamplingStrTable, sizeof(oversamplingStrTable) / sizeof(oversamplingStrTable[0])));
+    fprintf(stdout, MSG_USER_INFO_CONF_HUMIDITY,
+            getConfigString(pConf[1], oversamplingStrTable, sizeof(oversamplingStrTable) / sizeof(oversamplingStrTable[0])));
+    fprintf(stdout, MSG_USER_INFO_CONF_PRESSURE,
+            getConfigString(pConf[2], oversamplingStrTable, sizeof(oversamplingStrTable) / sizeof(oversamplingStrTable[0])));
+    fprintf(stdout, MSG_USER_INFO_CONF_FILTER,
+            getConfigString(pConf[3], filterStrTable, sizeof(filterStrTable) / sizeof(filterStrTable[0])));
+    fprintf(stdout, MSG_USER_INFO_CONF_MODE,
+            (REQ_CONF_ON == (pConf[4] & REQ_CONF_STATUS_MASK)) ? STR_CONF_MODE_NORMAL : STR_CONF_MODE_FORCED);
     fprintf(stdout, MSG_USER_INFO_CONF_FOOTER);
     fflush(stdout);
     
@@ -1188,40 +1471,90 @@ int getSensorData(struct pollfd pollArray[]) {
 }
 
 /*
- * Function 'removeSensorData': requests server to remove sensor data.
+ * Function 'getSensorColumns': requests server to get selected columns of sensor data.
  * 
- * Protocol:    Client --> Server: remove measurement data request code <1 byte>
+ * Note:        The columns are saved to the local measurement data file as records, the
+ *              channels not requested hold MEAS_DATA_INVALID_VALUE, the time is 0 if
+ *              not requested.
+ * 
+ * Protocol:    Client --> Server: get data columns request code <1 byte>
  *              Client <-- Server: result of request code validation <1 byte>
  * 
  *              ++ In case of successful request validation ++
  * 
+ *              Client --> Server: columns <1 byte> (REQ_AGG_CH_..., REQ_GDATP_CH_TIME)
  *              Client <-- Server: result of request processing <1 byte>
+ * 
+ *              ++ In case of successful request processing ++
+ * 
+ *              Client <-- Server: number of records <4 bytes>
+ *              For each requested column in TMP, HUM, PRS, TIME order:
+ *              Client <-- Server: column <<number of records> * 4 bytes> (value, float)
+ *                                 or <<number of records> * 8 bytes> (time, UNIX time [usec])
  */
-int removeSensorData(struct pollfd pollArray[]) {
+int getSensorColumns(struct pollfd pollArray[], const char* args[]) {
     
-    uint8_t request = 0;
+    uint8_t columns = 0;
     uint8_t response = 0;
+    uint8_t buf[MEAS_DATA_RECV_RECORDS * RES_GDATP_TIME_LEN];
+    uint32_t recordCount = 0;
+    uint32_t index;
+    uint32_t blockCount;
+    uint32_t i;
+    uint64_t timeUs;
+    size_t width;
+    float *value;
+    int measDataFd = MEAS_DATA_FD_INVALID;
+    int argIndex;
+    int column;
     int error = 0;
     int len;
     
-    /* Check if there is an active connection */
-    if(INVALID_FD == pollArray[POLL_ARRAY_SOCKET].fd) {
+    struct MeasDataRecord *records = NULL;
+    
+    /* Parse columns */
+    for(argIndex = 1; NULL != args[argIndex]; argIndex++) {
         
-        /* No active connection */
-        fprintf(stdout, MSG_USER_WARN_NO_CONN);
-        fprintf(stdout, MSG_USER_WARN_REQ_FAIL);
-        fflush(stdout);
+        if(0 == strcmp(args[argIndex], STR_CMD_SCONF_TEMPERATURE)) {
+            
+            columns |= REQ_AGG_CH_TMP;
+        }
+        else if(0 == strcmp(args[argIndex], STR_CMD_SCONF_HUMIDITY)) {
+            
+            columns |= REQ_AGG_CH_HUM;
+        }
+        else if(0 == strcmp(args[argIndex], STR_CMD_SCONF_PRESSURE)) {
+            
+            columns |= REQ_AGG_CH_PRS;
+        }
+        else if(0 == strcmp(args[argIndex], STR_CMD_GDAT_TIME)) {
+            
+            columns |= REQ_GDATP_CH_TIME;
+        }
+        else {
+            
+            /* Invalid argument */
+            fprintf(stdout, MSG_USER_WARN_INVALID_ARG);
+            fprintf(stdout, MSG_USER_INFO_HINT_GDAT);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
+    }
+    
+    /* Send request code to server */
+    if(0 != sendRequestCode(pollArray, REQ_CODE_GDATP)) {
         
         error = -1;
         return error;
     }
     
-    /* Send request code to server */
-    request = REQ_CODE_RMDAT;
-    len = send(pollArray[POLL_ARRAY_SOCKET].fd, &request, sizeof(request), MSG_NOSIGNAL);
+    /* Send column selection to server */
+    len = send(pollArray[POLL_ARRAY_SOCKET].fd, &columns, sizeof(columns), MSG_NOSIGNAL);
     if(len < 0) {
         
-        /* Failed to send client request to server */
+        /* Failed to send column selection to server */
         perror("send");
         fflush(stderr);
         fprintf(stdout, MSG_USER_WARN_SEND_REQ_FAIL);
@@ -1231,9 +1564,9 @@ int removeSensorData(struct pollfd pollArray[]) {
         return error;
     }
     
-    /* Receive server response about the outcome of processing the reqest code */
+    /* Receive server response about the outcome of the request */
     len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
-    if(len < 0) {
+    if(len <= 0) {
      
         /* Failed to receive response from server */
         perror("recv");
@@ -1245,33 +1578,17 @@ int removeSensorData(struct pollfd pollArray[]) {
         return error;
     }
     
-    /* Process server response */
-    if(RES_CODE_REQ_ACCEPT == response) {
-        
-        /* Client request accepted */
-    }
-    else if(RES_CODE_REQ_NO_PERM == response) {
+    if(RES_CODE_REQ_FAIL == response) {
         
-        /* Client does not have permission for the issued request */
-        fprintf(stdout, MSG_USER_WARN_REQ_NO_PERM);
-        fprintf(stdout, MSG_USER_WARN_REQ_FAIL);
+        /* Server side error */
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL_SERVER);
         fflush(stdout);
         
         error = -1;
         return error;
     }
-    else if(RES_CODE_REQ_INVALID == response) {
-        
-        /* Client request was invalid */
-        fprintf(stdout, MSG_USER_WARN_REQ_INVALID);
-        fprintf(stdout, MSG_USER_WARN_REQ_FAIL);
-        fflush(stdout);
+    else if(RES_CODE_REQ_SUCCESS != response) {
         
-        error = -1;
-        return error;
-    }
-    else {
-     
         /* Invalid server response */
         fprintf(stdout, MSG_USER_WARN_RES_INVALID);
         fflush(stdout);
@@ -1280,97 +1597,2294 @@ int removeSensorData(struct pollfd pollArray[]) {
         return error;
     }
     
-    /* Receive server response about the outcome of measurement data removal */
-    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
-    if(len < 0) {
-     
-        /* Failed to receive response from server */
+    /* Receive number of records */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &recordCount, sizeof(recordCount), MSG_WAITALL);
+    if(len != sizeof(recordCount)) {
+        
         perror("recv");
         fflush(stderr);
-        fprintf(stdout, MSG_USER_WARN_RES_FAIL);
+        fprintf(stdout, MSG_USER_WARN_RECV_FDATA_FAIL);
         fflush(stdout);
         
         error = -1;
         return error;
     }
     
-    /* Process server response */
-    if(RES_CODE_REQ_SUCCESS == response) {
+    if(0 == recordCount) {
         
-        /* Data removal request succeeded */
-        fprintf(stdout, MSG_USER_INFO_REQ_SUCCESS);
+        /* Measurement data is not available on server */
+        fprintf(stdout, MSG_USER_WARN_RECV_FDATA_NOT_AVL);
         fflush(stdout);
-    }
-    else if(RES_CODE_REQ_FAIL == response) {
         
-        /* Data removal request failed due to server side error */
-        fprintf(stdout, MSG_USER_WARN_REQ_FAIL_SERVER);
-        fflush(stdout);
+        return error;
     }
-    else {
+    
+    records = calloc(recordCount, sizeof(struct MeasDataRecord));
+    if(NULL == records) {
         
-        /* Invalid server response */
-        fprintf(stdout, MSG_USER_WARN_RES_INVALID);
+        /* Columns cannot be received any more, drop the connection */
+        perror("calloc");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_RECV_FDATA_FAIL);
         fflush(stdout);
         
+        close(pollArray[POLL_ARRAY_SOCKET].fd);
+        pollArray[POLL_ARRAY_SOCKET].fd = INVALID_FD;
+        
         error = -1;
         return error;
     }
     
-    return error;
-}
-
-/*
- * Function 'showSensorData': show measurement data records transferred from server.
- */
-int showSensorData(struct pollfd pollArray[]) {
- 
-    int dataFd = -1;
-    int error = 0;
-    float dataRecord[3];
-    int len;
+    /* Receive columns and scatter them into records */
+    for(column = 0; column < MEAS_DATA_COLUMNS; column++) {
+        
+        width = (MEAS_DATA_COLUMN_TIME == column) ? RES_GDATP_TIME_LEN : RES_GDATP_VALUE_LEN;
+        for(index = 0; index < recordCount; index += blockCount) {
+            
+            blockCount = ((recordCount - index) < MEAS_DATA_RECV_RECORDS) ? (recordCount - index) : MEAS_DATA_RECV_RECORDS;
+            if(columns & (1 << column)) {
+                
+                len = recv(pollArray[POLL_ARRAY_SOCKET].fd, buf, blockCount * width, MSG_WAITALL);
+                if(len != (int)(blockCount * width)) {
+                    
+                    perror("recv");
+                    fflush(stderr);
+                    fprintf(stdout, MSG_USER_WARN_RECV_FDATA_FAIL);
+                    fflush(stdout);
+                    
+                    free(records);
+                    error = -1;
+                    return error;
+                }
+            }
+            
+            for(i = 0; i < blockCount; i++) {
+                
+                if(MEAS_DATA_COLUMN_TIME == column) {
+                    
+                    timeUs = 0;
+                    if(columns & (1 << column)) {
+                        
+                        memcpy(&timeUs, &buf[i * width], sizeof(timeUs));
+                    }
+                    records[index + i].timeSec = (uint32_t)(timeUs / USEC_PER_SEC);
+                    records[index + i].timeUsec = (uint32_t)(timeUs % USEC_PER_SEC);
+                }
+                else {
+                    
+                    value = (0 == column) ? &(records[index + i].temp) :
+                            ((1 == column) ? &(records[index + i].hum) : &(records[index + i].press));
+                    *value = MEAS_DATA_INVALID_VALUE;
+                    if(columns & (1 << column)) {
+                        
+                        memcpy(value, &buf[i * width], sizeof(*value));
+                    }
+                }
+            }
+        }
+    }
     
-    /* Open local file to read and print measurement data records */
-    dataFd = open(measDataFilePath, O_RDONLY | O_NONBLOCK);
-    if(dataFd < 0) {
+    /* Save records to local file */
+    measDataFd = open(measDataFilePath, O_CREAT | O_TRUNC | O_RDWR, 0644);
+    if(measDataFd < 0) {
         
         /* Failed to open local measurement data file */
         perror("open");
-        fprintf(stderr, "[ERROR] Failed to open measurement data file.\n");
-        fprintf(stderr, "[ERROR] Failed to show measurement data records.\n");
+        fprintf(stderr, MSG_USER_WARN_MEAS_FILE_OPEN_FAIL);
         fflush(stderr);
-
+        
+        free(records);
         error = -1;
         return error;
     }
     
-    /* Reset data record */
-    memset(dataRecord, 0, sizeof(dataRecord));
-    
-    fprintf(stdout, "\n------------- SENSOR DATA RECORDS ------------\n\n");
-    fflush(stdout);
-    
-    len = read(dataFd, &dataRecord, sizeof(dataRecord));
-    while(len > 0) {
+    if((ssize_t)(recordCount * sizeof(struct MeasDataRecord)) !=
+       write(measDataFd, records, recordCount * sizeof(struct MeasDataRecord))) {
         
-        fprintf(stdout, "  %0.2lf deg C       %0.2lf%%       %0.2lf hPa\n", dataRecord[0], dataRecord[1], dataRecord[2]);
+        perror("write");
+        fprintf(stderr, MSG_USER_WARN_MEAS_FILE_WRITE_FAIL);
+        fflush(stderr);
         
-        memset(dataRecord, 0, sizeof(dataRecord));
-        len = read(dataFd, &dataRecord, sizeof(dataRecord));
+        error = -1;
     }
-        
-    fprintf(stdout, "\n-----------------------------------------------\n");
-    fflush(stdout);
     
-    return error;
-}
-
+    close(measDataFd);
+    free(records);
+    
+    if(0 == error) {
+        
+        fprintf(stdout, MSG_USER_INFO_RECV_FCOL_SUCCESS, recordCount);
+        fflush(stdout);
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'removeSensorData': requests server to remove sensor data.
+ * 
+ * Protocol:    Client --> Server: remove measurement data request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client <-- Server: result of request processing <1 byte>
+ */
+int removeSensorData(struct pollfd pollArray[]) {
+    
+    uint8_t request = 0;
+    uint8_t response = 0;
+    int error = 0;
+    int len;
+    
+    /* Check if there is an active connection */
+    if(INVALID_FD == pollArray[POLL_ARRAY_SOCKET].fd) {
+        
+        /* No active connection */
+        fprintf(stdout, MSG_USER_WARN_NO_CONN);
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Send request code to server */
+    request = REQ_CODE_RMDAT;
+    len = send(pollArray[POLL_ARRAY_SOCKET].fd, &request, sizeof(request), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send client request to server */
+        perror("send");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_SEND_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive server response about the outcome of processing the reqest code */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
+    if(len < 0) {
+     
+        /* Failed to receive response from server */
+        perror("recv");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_RES_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Process server response */
+    if(RES_CODE_REQ_ACCEPT == response) {
+        
+        /* Client request accepted */
+    }
+    else if(RES_CODE_REQ_NO_PERM == response) {
+        
+        /* Client does not have permission for the issued request */
+        fprintf(stdout, MSG_USER_WARN_REQ_NO_PERM);
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    else if(RES_CODE_REQ_INVALID == response) {
+        
+        /* Client request was invalid */
+        fprintf(stdout, MSG_USER_WARN_REQ_INVALID);
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    else {
+     
+        /* Invalid server response */
+        fprintf(stdout, MSG_USER_WARN_RES_INVALID);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive server response about the outcome of measurement data removal */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
+    if(len < 0) {
+     
+        /* Failed to receive response from server */
+        perror("recv");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_RES_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Process server response */
+    if(RES_CODE_REQ_SUCCESS == response) {
+        
+        /* Data removal request succeeded */
+        fprintf(stdout, MSG_USER_INFO_REQ_SUCCESS);
+        fflush(stdout);
+    }
+    else if(RES_CODE_REQ_FAIL == response) {
+        
+        /* Data removal request failed due to server side error */
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL_SERVER);
+        fflush(stdout);
+    }
+    else {
+        
+        /* Invalid server response */
+        fprintf(stdout, MSG_USER_WARN_RES_INVALID);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'sendRequestCode': sends a request code to the server and checks its validation.
+ * 
+ * Protocol:    Client --> Server: request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ */
+int sendRequestCode(struct pollfd pollArray[], uint8_t request) {
+    
+    uint8_t response = 0;
+    int error = 0;
+    int len;
+    
+    /* Check if there is an active connection */
+    if(INVALID_FD == pollArray[POLL_ARRAY_SOCKET].fd) {
+        
+        /* No active connection */
+        fprintf(stdout, MSG_USER_WARN_NO_CONN);
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Send request code to server */
+    len = send(pollArray[POLL_ARRAY_SOCKET].fd, &request, sizeof(request), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send client request to server */
+        perror("send");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_SEND_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive server response about the outcome of processing the reqest code */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
+    if(len <= 0) {
+     
+        /* Failed to receive response from server */
+        perror("recv");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_RES_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Process server response */
+    if(RES_CODE_REQ_ACCEPT == response) {
+        
+        /* Client request accepted */
+    }
+    else if(RES_CODE_REQ_NO_PERM == response) {
+        
+        /* Client does not have permission for the issued request */
+        fprintf(stdout, MSG_USER_WARN_REQ_NO_PERM);
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+    }
+    else if(RES_CODE_REQ_INVALID == response) {
+        
+        /* Client request was invalid */
+        fprintf(stdout, MSG_USER_WARN_REQ_INVALID);
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+    }
+    else {
+     
+        /* Invalid server response */
+        fprintf(stdout, MSG_USER_WARN_RES_INVALID);
+        fflush(stdout);
+        
+        error = -1;
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'selectSensor': requests server to select the sensor subsequent requests refer to.
+ * 
+ * Protocol:    Client --> Server: select sensor request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: sensor ID <1 byte>
+ *              Client <-- Server: result of request processing <1 byte>
+ */
+int selectSensor(struct pollfd pollArray[], const char* args[]) {
+    
+    uint8_t sensorSel = 0;
+    uint8_t response = 0;
+    char *end = NULL;
+    long value;
+    int error = 0;
+    int len;
+    
+    /* Check sensor ID argument */
+    if(NULL == args[1]) {
+        
+        fprintf(stdout, MSG_USER_WARN_MISSING_ARG);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    value = strtol(args[1], &end, 10);
+    if(('\0' != *end) || (value < 0) || (value >= SENSOR_ARRAY_SIZE)) {
+        
+        fprintf(stdout, MSG_USER_WARN_INVALID_SENS_ARG);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    sensorSel = (uint8_t)value;
+    
+    /* Send request code to server */
+    if(0 != sendRequestCode(pollArray, REQ_CODE_SSEL)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Send sensor ID to server */
+    len = send(pollArray[POLL_ARRAY_SOCKET].fd, &sensorSel, sizeof(sensorSel), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send sensor ID to server */
+        perror("send");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_SEND_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive server response about the outcome of the sensor selection */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
+    if(len <= 0) {
+     
+        /* Failed to receive response from server */
+        perror("recv");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_RES_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Process server response */
+    if(RES_CODE_REQ_SUCCESS == response) {
+        
+        /* Sensor selected */
+        fprintf(stdout, MSG_USER_INFO_REQ_SUCCESS);
+        fflush(stdout);
+    }
+    else if(RES_CODE_REQ_FAIL == response) {
+        
+        /* Sensor not available on server */
+        fprintf(stdout, MSG_USER_WARN_INVALID_SENS_ARG);
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL_SERVER);
+        fflush(stdout);
+    }
+    else {
+        
+        /* Invalid server response */
+        fprintf(stdout, MSG_USER_WARN_RES_INVALID);
+        fflush(stdout);
+        
+        error = -1;
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'listSensors': requests server to list its sensors.
+ * 
+ * Protocol:    Client --> Server: list sensors request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client <-- Server: number of sensors <1 byte>
+ *              Client <-- Server: sensor descriptions <<number of sensors> * 64 bytes>
+ */
+int listSensors(struct pollfd pollArray[]) {
+    
+    uint8_t count = 0;
+    char sensorDesc[SENSOR_DESC_LEN];
+    int error = 0;
+    int i;
+    int len;
+    
+    /* Send request code to server */
+    if(0 != sendRequestCode(pollArray, REQ_CODE_SLIST)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive number of sensors */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &count, sizeof(count), MSG_WAITALL);
+    if((len <= 0) || (count > SENSOR_ARRAY_SIZE)) {
+        
+        /* Failed to receive sensor list */
+        fprintf(stdout, MSG_USER_WARN_RECV_SENS_LIST_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive and print sensor descriptions */
+    fprintf(stdout, MSG_USER_INFO_SENS_LIST_HEADER);
+    for(i = 0; i < count; i++) {
+        
+        len = recv(pollArray[POLL_ARRAY_SOCKET].fd, sensorDesc, sizeof(sensorDesc), MSG_WAITALL);
+        if(len != (int)sizeof(sensorDesc)) {
+            
+            /* Failed to receive sensor description */
+            fprintf(stdout, MSG_USER_WARN_RECV_SENS_LIST_FAIL);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
+        
+        sensorDesc[SENSOR_DESC_LEN - 1] = '\0';
+        fprintf(stdout, MSG_USER_INFO_SENS_LIST_ENTRY, sensorDesc);
+    }
+    fprintf(stdout, MSG_USER_INFO_SENS_LIST_FOOTER);
+    fflush(stdout);
+    
+    return error;
+}
+
+/*
+ * Function 'formatRecordTime': formats a record time [usec] as local date and time.
+ */
+static void formatRecordTime(uint64_t timeUs, char *buf, size_t bufLen) {
+    
+    time_t timeSec = (time_t)(timeUs / USEC_PER_SEC);
+    struct tm localTime;
+    
+    localtime_r(&timeSec, &localTime);
+    strftime(buf, bufLen, "%Y-%m-%d %H:%M:%S", &localTime);
+}
+
+/*
+ * Function 'parseAggTime': parses a time argument of the agg command [usec].
+ * 
+ * Note:    UNIX time in seconds, or seconds before now if negative (e.g. -3600).
+ */
+static int parseAggTime(const char *arg, uint64_t *timeUs) {
+    
+    long long value;
+    char *end = NULL;
+    int error = 0;
+    
+    errno = 0;
+    value = strtoll(arg, &end, 10);
+    if((0 != errno) || (end == arg) || ('\0' != *end)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    if(value < 0) {
+        
+        value += (long long)time(NULL);
+    }
+    if(value <= 0) {
+        
+        error = -1;
+        return error;
+    }
+    
+    *timeUs = (uint64_t)value * USEC_PER_SEC;
+    
+    return error;
+}
+
+/*
+ * Function 'parseAggDuration': parses a duration argument of the agg and dsmp commands [usec].
+ * 
+ * Note:    Positive integer with optional unit suffix (s, m, h, d), seconds by default.
+ */
+static int parseAggDuration(const char *arg, uint64_t *durationUs) {
+    
+    unsigned long long value;
+    char *unit = NULL;
+    int error = 0;
+    
+    errno = 0;
+    value = strtoull(arg, &unit, 10);
+    if((0 != errno) || (unit == arg) || ('-' == arg[0]) || (0 == value)) {
+        
+        error = -1;
+    }
+    else if(('\0' == *unit) || (0 == strcmp(unit, STR_CMD_AGG_UNIT_SEC))) {
+        
+        *durationUs = value * USEC_PER_SEC;
+    }
+    else if(0 == strcmp(unit, STR_CMD_AGG_UNIT_MIN)) {
+        
+        *durationUs = value * SEC_PER_MIN * USEC_PER_SEC;
+    }
+    else if(0 == strcmp(unit, STR_CMD_AGG_UNIT_HOUR)) {
+        
+        *durationUs = value * SEC_PER_HOUR * USEC_PER_SEC;
+    }
+    else if(0 == strcmp(unit, STR_CMD_AGG_UNIT_DAY)) {
+        
+        *durationUs = value * SEC_PER_DAY * USEC_PER_SEC;
+    }
+    else {
+        
+        error = -1;
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'aggregateSensorData': requests server to aggregate sensor data.
+ * 
+ * Protocol:    Client --> Server: aggregate data request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: start of time range <8 bytes> (UNIX time [usec], 0: first record)
+ *              Client --> Server: end of time range <8 bytes> (UNIX time [usec], exclusive, 0: last record)
+ *              Client --> Server: bucket width <8 bytes> ([usec], 0: whole range in one bucket)
+ *              Client --> Server: channels <1 byte> (REQ_AGG_CH_...)
+ *              Client <-- Server: result of request processing <1 byte>
+ * 
+ *              ++ In case of successful request processing ++
+ * 
+ *              Client <-- Server: number of buckets <4 bytes> (0: no data in range)
+ *              Client <-- Server: buckets <<number of buckets> * (8 + <number of channels> * 20) bytes>
+ *                                 (bucket start time <8 bytes> [usec], then for each requested channel
+ *                                 in TMP, HUM, PRS order: count <4 bytes>, min, max, mean, stddev <4 bytes each>)
+ */
+int aggregateSensorData(struct pollfd pollArray[], const char* args[]) {
+    
+    uint8_t queryBuf[REQ_AGG_LEN];
+    uint8_t response = 0;
+    uint8_t channels = 0;
+    uint8_t channelStats[RES_AGG_STATS_LEN];
+    uint64_t fromUs = 0;
+    uint64_t toUs = 0;
+    uint64_t bucketUs = 0;
+    uint64_t bucketStartUs = 0;
+    uint32_t bucketCount = 0;
+    uint32_t count;
+    uint32_t iBucket;
+    float stats[4];                 // min, max, mean, stddev
+    char timeStr[MEAS_DATA_TIME_STR_LEN];
+    int argIndex;
+    int channel;
+    int error = 0;
+    int len;
+    
+    const char *channelNames[] = {STR_CMD_SCONF_TEMPERATURE, STR_CMD_SCONF_HUMIDITY, STR_CMD_SCONF_PRESSURE};
+    
+    /* Parse channels and options */
+    for(argIndex = 1; NULL != args[argIndex]; argIndex++) {
+        
+        if(0 == strcmp(args[argIndex], STR_CMD_SCONF_TEMPERATURE)) {
+            
+            channels |= REQ_AGG_CH_TMP;
+        }
+        else if(0 == strcmp(args[argIndex], STR_CMD_SCONF_HUMIDITY)) {
+            
+            channels |= REQ_AGG_CH_HUM;
+        }
+        else if(0 == strcmp(args[argIndex], STR_CMD_SCONF_PRESSURE)) {
+            
+            channels |= REQ_AGG_CH_PRS;
+        }
+        else if((0 == strcmp(args[argIndex], STR_CMD_AGG_FROM)) && (NULL != args[argIndex + 1]) &&
+                (0 == parseAggTime(args[argIndex + 1], &fromUs))) {
+            
+            argIndex++;
+        }
+        else if((0 == strcmp(args[argIndex], STR_CMD_AGG_TO)) && (NULL != args[argIndex + 1]) &&
+                (0 == parseAggTime(args[argIndex + 1], &toUs))) {
+            
+            argIndex++;
+        }
+        else if((0 == strcmp(args[argIndex], STR_CMD_AGG_BUCKET)) && (NULL != args[argIndex + 1]) &&
+                (0 == parseAggDuration(args[argIndex + 1], &bucketUs))) {
+            
+            argIndex++;
+        }
+        else {
+            
+            /* Invalid argument */
+            fprintf(stdout, MSG_USER_WARN_INVALID_ARG);
+            fprintf(stdout, MSG_USER_INFO_HINT_AGG);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
+    }
+    
+    if(0 == channels) {
+        
+        /* No channel given */
+        fprintf(stdout, MSG_USER_WARN_MISSING_ARG);
+        fprintf(stdout, MSG_USER_INFO_HINT_AGG);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Send request code to server */
+    if(0 != sendRequestCode(pollArray, REQ_CODE_AGG)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Send query to server */
+    memcpy(&queryBuf[0], &fromUs, sizeof(fromUs));
+    memcpy(&queryBuf[8], &toUs, sizeof(toUs));
+    memcpy(&queryBuf[16], &bucketUs, sizeof(bucketUs));
+    queryBuf[24] = channels;
+    len = send(pollArray[POLL_ARRAY_SOCKET].fd, queryBuf, sizeof(queryBuf), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send query to server */
+        perror("send");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_SEND_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive server response about the outcome of the aggregation */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
+    if(len <= 0) {
+     
+        /* Failed to receive response from server */
+        perror("recv");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_RES_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    if(RES_CODE_REQ_FAIL == response) {
+        
+        /* Invalid query or server side error */
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL_SERVER);
+        fprintf(stdout, MSG_USER_INFO_HINT_AGG);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    else if(RES_CODE_REQ_SUCCESS != response) {
+        
+        /* Invalid server response */
+        fprintf(stdout, MSG_USER_WARN_RES_INVALID);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive number of buckets */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &bucketCount, sizeof(bucketCount), MSG_WAITALL);
+    if((len != sizeof(bucketCount)) || (bucketCount > REQ_AGG_BUCKETS_MAX)) {
+        
+        perror("recv");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_RECV_AGG_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    if(0 == bucketCount) {
+        
+        fprintf(stdout, MSG_USER_INFO_AGG_EMPTY);
+        fflush(stdout);
+        
+        return error;
+    }
+    
+    /* Receive and print buckets */
+    fprintf(stdout, MSG_USER_INFO_AGG_HEADER);
+    for(iBucket = 0; iBucket < bucketCount; iBucket++) {
+        
+        len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &bucketStartUs, sizeof(bucketStartUs), MSG_WAITALL);
+        if(len != sizeof(bucketStartUs)) {
+            
+            perror("recv");
+            fflush(stderr);
+            fprintf(stdout, MSG_USER_WARN_RECV_AGG_FAIL);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
+        
+        formatRecordTime(bucketStartUs, timeStr, sizeof(timeStr));
+        fprintf(stdout, MSG_USER_INFO_AGG_BUCKET, timeStr);
+        
+        for(channel = 0; channel < (int)(sizeof(channelNames) / sizeof(channelNames[0])); channel++) {
+            
+            if(0 == (channels & (1 << channel))) {
+                
+                continue;
+            }
+            
+            len = recv(pollArray[POLL_ARRAY_SOCKET].fd, channelStats, sizeof(channelStats), MSG_WAITALL);
+            if(len != sizeof(channelStats)) {
+                
+                perror("recv");
+                fflush(stderr);
+                fprintf(stdout, MSG_USER_WARN_RECV_AGG_FAIL);
+                fflush(stdout);
+                
+                error = -1;
+                return error;
+            }
+            
+            memcpy(&count, &channelStats[0], sizeof(count));
+            memcpy(stats, &channelStats[4], sizeof(stats));
+            if(0 == count) {
+                
+                fprintf(stdout, MSG_USER_INFO_AGG_STATS_NONE, channelNames[channel]);
+            }
+            else {
+                
+                fprintf(stdout, MSG_USER_INFO_AGG_STATS, channelNames[channel], count, stats[0], stats[1], stats[2], stats[3]);
+            }
+        }
+    }
+    fprintf(stdout, MSG_USER_INFO_AGG_FOOTER);
+    fflush(stdout);
+    
+    return error;
+}
+
+/*
+ * Function 'downsampleSensorData': requests server to downsample sensor data for charting.
+ * 
+ * Protocol:    Client --> Server: downsample data request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: start of time range <8 bytes> (UNIX time [usec], 0: first record)
+ *              Client --> Server: end of time range <8 bytes> (UNIX time [usec], exclusive, 0: last record)
+ *              Client --> Server: parameter <8 bytes> (LTTB: number of points, resample: interval [usec])
+ *              Client --> Server: mode <1 byte> (REQ_DSMP_MODE_...)
+ *              Client --> Server: channels <1 byte> (REQ_AGG_CH_...)
+ *              Client <-- Server: result of request processing <1 byte>
+ * 
+ *              ++ In case of successful request processing ++
+ * 
+ *              For each requested channel in TMP, HUM, PRS order:
+ *              Client <-- Server: number of points <4 bytes>
+ *              Client <-- Server: points <<number of points> * 12 bytes>
+ *                                 (time <8 bytes> (UNIX time [usec]), value <4 bytes, float>)
+ */
+int downsampleSensorData(struct pollfd pollArray[], const char* args[]) {
+    
+    uint8_t queryBuf[REQ_DSMP_LEN];
+    uint8_t response = 0;
+    uint8_t channels = 0;
+    uint8_t mode = 0;
+    uint8_t point[RES_DSMP_POINT_LEN];
+    uint64_t fromUs = 0;
+    uint64_t toUs = 0;
+    uint64_t param = 0;
+    uint64_t timeUs;
+    unsigned long long value;
+    uint32_t pointCount;
+    uint32_t iPoint;
+    float pointValue;
+    char timeStr[MEAS_DATA_TIME_STR_LEN];
+    char *end = NULL;
+    int argIndex;
+    int channel;
+    int error = 0;
+    int len;
+    
+    const char *channelNames[] = {STR_CMD_SCONF_TEMPERATURE, STR_CMD_SCONF_HUMIDITY, STR_CMD_SCONF_PRESSURE};
+    
+    /* Parse channels and options */
+    for(argIndex = 1; NULL != args[argIndex]; argIndex++) {
+        
+        if(0 == strcmp(args[argIndex], STR_CMD_SCONF_TEMPERATURE)) {
+            
+            channels |= REQ_AGG_CH_TMP;
+        }
+        else if(0 == strcmp(args[argIndex], STR_CMD_SCONF_HUMIDITY)) {
+            
+            channels |= REQ_AGG_CH_HUM;
+        }
+        else if(0 == strcmp(args[argIndex], STR_CMD_SCONF_PRESSURE)) {
+            
+            channels |= REQ_AGG_CH_PRS;
+        }
+        else if((0 == strcmp(args[argIndex], STR_CMD_AGG_FROM)) && (NULL != args[argIndex + 1]) &&
+                (0 == parseAggTime(args[argIndex + 1], &fromUs))) {
+            
+            argIndex++;
+        }
+        else if((0 == strcmp(args[argIndex], STR_CMD_AGG_TO)) && (NULL != args[argIndex + 1]) &&
+                (0 == parseAggTime(args[argIndex + 1], &toUs))) {
+            
+            argIndex++;
+        }
+        else if((0 == strcmp(args[argIndex], STR_CMD_DSMP_EVERY)) && (NULL != args[argIndex + 1]) &&
+                (0 == parseAggDuration(args[argIndex + 1], &param))) {
+            
+            /* Resample to fixed interval */
+            mode = REQ_DSMP_MODE_RESAMPLE;
+            argIndex++;
+        }
+        else if((0 == strcmp(args[argIndex], STR_CMD_DSMP_LTTB)) && (NULL != args[argIndex + 1])) {
+            
+            /* Largest-Triangle-Three-Buckets with number of points */
+            argIndex++;
+            errno = 0;
+            value = strtoull(args[argIndex], &end, 10);
+            if((0 != errno) || ('\0' != *end) || (value < REQ_DSMP_POINTS_MIN) || (value > REQ_DSMP_POINTS_MAX)) {
+                
+                fprintf(stdout, MSG_USER_WARN_INVALID_ARG);
+                fprintf(stdout, MSG_USER_INFO_HINT_DSMP);
+                fflush(stdout);
+                
+                error = -1;
+                return error;
+            }
+            mode = REQ_DSMP_MODE_LTTB;
+            param = value;
+        }
+        else {
+            
+            /* Invalid argument */
+            fprintf(stdout, MSG_USER_WARN_INVALID_ARG);
+            fprintf(stdout, MSG_USER_INFO_HINT_DSMP);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
+    }
+    
+    if((0 == channels) || (0 == mode)) {
+        
+        /* No channel or mode given */
+        fprintf(stdout, MSG_USER_WARN_MISSING_ARG);
+        fprintf(stdout, MSG_USER_INFO_HINT_DSMP);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Send request code to server */
+    if(0 != sendRequestCode(pollArray, REQ_CODE_DSMP)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Send query to server */
+    memcpy(&queryBuf[0], &fromUs, sizeof(fromUs));
+    memcpy(&queryBuf[8], &toUs, sizeof(toUs));
+    memcpy(&queryBuf[16], &param, sizeof(param));
+    queryBuf[24] = mode;
+    queryBuf[25] = channels;
+    len = send(pollArray[POLL_ARRAY_SOCKET].fd, queryBuf, sizeof(queryBuf), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send query to server */
+        perror("send");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_SEND_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive server response about the outcome of the downsampling */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
+    if(len <= 0) {
+     
+        /* Failed to receive response from server */
+        perror("recv");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_RES_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    if(RES_CODE_REQ_FAIL == response) {
+        
+        /* Invalid query or server side error */
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL_SERVER);
+        fprintf(stdout, MSG_USER_INFO_HINT_DSMP);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    else if(RES_CODE_REQ_SUCCESS != response) {
+        
+        /* Invalid server response */
+        fprintf(stdout, MSG_USER_WARN_RES_INVALID);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive and print points of each channel */
+    fprintf(stdout, MSG_USER_INFO_DSMP_HEADER);
+    for(channel = 0; channel < (int)(sizeof(channelNames) / sizeof(channelNames[0])); channel++) {
+        
+        if(0 == (channels & (1 << channel))) {
+            
+            continue;
+        }
+        
+        len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &pointCount, sizeof(pointCount), MSG_WAITALL);
+        if(len != sizeof(pointCount)) {
+            
+            perror("recv");
+            fflush(stderr);
+            fprintf(stdout, MSG_USER_WARN_RECV_DSMP_FAIL);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
+        
+        fprintf(stdout, MSG_USER_INFO_DSMP_CHANNEL, channelNames[channel], pointCount);
+        for(iPoint = 0; iPoint < pointCount; iPoint++) {
+            
+            len = recv(pollArray[POLL_ARRAY_SOCKET].fd, point, sizeof(point), MSG_WAITALL);
+            if(len != sizeof(point)) {
+                
+                perror("recv");
+                fflush(stderr);
+                fprintf(stdout, MSG_USER_WARN_RECV_DSMP_FAIL);
+                fflush(stdout);
+                
+                error = -1;
+                return error;
+            }
+            
+            memcpy(&timeUs, &point[0], sizeof(timeUs));
+            memcpy(&pointValue, &point[8], sizeof(pointValue));
+            formatRecordTime(timeUs, timeStr, sizeof(timeStr));
+            fprintf(stdout, MSG_USER_INFO_DSMP_POINT, timeStr, (unsigned)((timeUs % USEC_PER_SEC) / USEC_PER_MSEC), pointValue);
+        }
+    }
+    fprintf(stdout, MSG_USER_INFO_DSMP_FOOTER);
+    fflush(stdout);
+    
+    return error;
+}
+
+/*
+ * Function 'printLatestSample': prints a latest sample message and remembers its sequence number.
+ */
+static void printLatestSample(const uint8_t sampleMsg[RES_LATEST_LEN]) {
+    
+    uint64_t seq = 0;
+    uint64_t timeUs = 0;
+    uint32_t confVersion = 0;
+    float value[3];
+    char timeStr[MEAS_DATA_TIME_STR_LEN];
+    
+    memcpy(&seq, &sampleMsg[0], sizeof(seq));
+    memcpy(&timeUs, &sampleMsg[8], sizeof(timeUs));
+    memcpy(value, &sampleMsg[16], sizeof(value));
+    memcpy(&confVersion, &sampleMsg[28], sizeof(confVersion));
+    
+    if(0 == seq) {
+        
+        /* No sample taken yet */
+        fprintf(stdout, MSG_USER_WARN_RECV_FDATA_NOT_AVL);
+        fflush(stdout);
+        
+        return;
+    }
+    
+    lastSampleSeq = seq;
+    
+    formatRecordTime(timeUs, timeStr, sizeof(timeStr));
+    fprintf(stdout, MSG_USER_INFO_LATEST, (unsigned long long)seq, timeStr,
+            (unsigned)((timeUs % USEC_PER_SEC) / USEC_PER_MSEC), confVersion);
+    fprintf(stdout, "  %0.2lf deg C       %0.2lf%%       %0.2lf hPa\n", value[0], value[1], value[2]);
+    fflush(stdout);
+}
+
+/*
+ * Function 'getLatestSample': requests server to get the latest sample.
+ * 
+ * Protocol:    Client --> Server: get latest sample request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client <-- Server: sample sequence number <8 bytes> (0: no sample yet)
+ *              Client <-- Server: sample time <8 bytes> (UNIX time [usec])
+ *              Client <-- Server: temperature, humidity, pressure <4 bytes each, float>
+ *              Client <-- Server: config version of the sample <4 bytes>
+ */
+int getLatestSample(struct pollfd pollArray[]) {
+    
+    uint8_t sampleMsg[RES_LATEST_LEN];          // Latest sample message
+    int error = 0;
+    int len;
+    
+    /* Send request code to server and check response */
+    if(0 != sendRequestCode(pollArray, REQ_CODE_LATEST)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive latest sample from server */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, sampleMsg, sizeof(sampleMsg), MSG_WAITALL);
+    if(len != sizeof(sampleMsg)) {
+        
+        /* Failed to receive latest sample from server */
+        perror("recv");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_RECV_LATEST_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    printLatestSample(sampleMsg);
+    
+    return error;
+}
+
+/*
+ * Function 'waitSample': requests server to send the first sample newer than a known one.
+ * 
+ * Note:        By default waits for a sample newer than the last one shown.
+ * 
+ * Protocol:    Client --> Server: wait for sample request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: sequence number of the last known sample <8 bytes>
+ *              Client --> Server: timeout <4 bytes> (msec)
+ *              Client <-- Server: result of request processing <1 byte>
+ *                                 (RES_CODE_REQ_SUCCESS: newer sample, RES_CODE_REQ_TIMEOUT: timed out)
+ *              Client <-- Server: latest sample <32 bytes>
+ */
+int waitSample(struct pollfd pollArray[], const char* args[]) {
+    
+    uint8_t queryBuf[REQ_WAIT_LEN];
+    uint8_t response = 0;
+    uint8_t sampleMsg[RES_LATEST_LEN];
+    uint64_t afterSeq = lastSampleSeq;
+    uint32_t timeoutMs = WAIT_TIMEOUT_DEFAULT_MS;
+    unsigned long long value;
+    char *end = NULL;
+    int argIndex;
+    int error = 0;
+    int len;
+    
+    /* Parse options */
+    for(argIndex = 1; NULL != args[argIndex]; argIndex++) {
+        
+        if(NULL != args[argIndex + 1]) {
+            
+            errno = 0;
+            value = strtoull(args[argIndex + 1], &end, 10);
+            if((0 != errno) || ('\0' != *end) || ('-' == args[argIndex + 1][0])) {
+                
+                end = NULL;
+            }
+        }
+        
+        if((NULL != args[argIndex + 1]) && (NULL != end) && (0 == strcmp(args[argIndex], STR_CMD_WAIT_AFTER))) {
+            
+            afterSeq = value;
+            argIndex++;
+        }
+        else if((NULL != args[argIndex + 1]) && (NULL != end) && (0 == strcmp(args[argIndex], STR_CMD_WAIT_TIMEOUT)) &&
+                (value <= REQ_WAIT_TIMEOUT_MAX_MS)) {
+            
+            timeoutMs = (uint32_t)value;
+            argIndex++;
+        }
+        else {
+            
+            /* Invalid argument */
+            fprintf(stdout, MSG_USER_WARN_INVALID_ARG);
+            fprintf(stdout, MSG_USER_INFO_HINT_WAIT);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
+    }
+    
+    /* Send request code to server */
+    if(0 != sendRequestCode(pollArray, REQ_CODE_WAIT)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Send query to server */
+    memcpy(&queryBuf[0], &afterSeq, sizeof(afterSeq));
+    memcpy(&queryBuf[8], &timeoutMs, sizeof(timeoutMs));
+    len = send(pollArray[POLL_ARRAY_SOCKET].fd, queryBuf, sizeof(queryBuf), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send query to server */
+        perror("send");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_SEND_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive server response (blocks until a new sample or the timeout) */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
+    if(len <= 0) {
+     
+        /* Failed to receive response from server */
+        perror("recv");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_RES_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    if(RES_CODE_REQ_FAIL == response) {
+        
+        /* Invalid query or server side error */
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL_SERVER);
+        fprintf(stdout, MSG_USER_INFO_HINT_WAIT);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    else if((RES_CODE_REQ_SUCCESS != response) && (RES_CODE_REQ_TIMEOUT != response)) {
+        
+        /* Invalid server response */
+        fprintf(stdout, MSG_USER_WARN_RES_INVALID);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, sampleMsg, sizeof(sampleMsg), MSG_WAITALL);
+    if(len != sizeof(sampleMsg)) {
+        
+        /* Failed to receive sample from server */
+        perror("recv");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_RECV_LATEST_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    if(RES_CODE_REQ_TIMEOUT == response) {
+        
+        fprintf(stdout, MSG_USER_INFO_WAIT_TIMEOUT);
+    }
+    printLatestSample(sampleMsg);
+    
+    return error;
+}
+
+/*
+ * Function 'subscribeSamples': requests server to push new samples (live view).
+ * 
+ * Note:        The pushed frames are received by the main loop (see receiveLiveSamples)
+ *              until the user enters the next command (see stopLiveView).
+ * 
+ * Protocol:    Client --> Server: subscribe request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: channels <1 byte>, decimation <4 bytes>, policy <1 byte>
+ *              Client <-- Server: result of request processing <1 byte>
+ * 
+ *              ++ In case of successful request processing ++
+ * 
+ *              Client <-- Server: sample frames <RES_PUSH_HEADER_LEN + 4 bytes per channel>
+ */
+int subscribeSamples(struct pollfd pollArray[], const char* args[]) {
+    
+    uint8_t queryBuf[REQ_SUB_LEN];
+    uint8_t response = 0;
+    uint8_t channels = 0;
+    uint8_t policy = REQ_SUB_POLICY_DROP_OLDEST;
+    uint32_t decimation = 1;
+    unsigned long long value = 0;
+    char *end = NULL;
+    int argIndex;
+    int error = 0;
+    int len;
+    
+    /* Parse options */
+    for(argIndex = 1; NULL != args[argIndex]; argIndex++) {
+        
+        end = NULL;
+        if(NULL != args[argIndex + 1]) {
+            
+            errno = 0;
+            value = strtoull(args[argIndex + 1], &end, 10);
+            if((0 != errno) || ('\0' != *end) || ('-' == args[argIndex + 1][0])) {
+                
+                end = NULL;
+            }
+        }
+        
+        if(0 == strcmp(args[argIndex], STR_CMD_SCONF_TEMPERATURE)) {
+            
+            channels |= REQ_AGG_CH_TMP;
+        }
+        else if(0 == strcmp(args[argIndex], STR_CMD_SCONF_HUMIDITY)) {
+            
+            channels |= REQ_AGG_CH_HUM;
+        }
+        else if(0 == strcmp(args[argIndex], STR_CMD_SCONF_PRESSURE)) {
+            
+            channels |= REQ_AGG_CH_PRS;
+        }
+        else if((NULL != end) && (0 == strcmp(args[argIndex], STR_CMD_SUB_EVERY)) &&
+                (value > 0) && (value <= REQ_SUB_DECIMATION_MAX)) {
+            
+            decimation = (uint32_t)value;
+            argIndex++;
+        }
+        else if((NULL != args[argIndex + 1]) && (0 == strcmp(args[argIndex], STR_CMD_SUB_POLICY)) &&
+                (0 == strcmp(args[argIndex + 1], STR_CMD_SUB_POLICY_DROP))) {
+            
+            policy = REQ_SUB_POLICY_DROP_OLDEST;
+            argIndex++;
+        }
+        else if((NULL != args[argIndex + 1]) && (0 == strcmp(args[argIndex], STR_CMD_SUB_POLICY)) &&
+                (0 == strcmp(args[argIndex + 1], STR_CMD_SUB_POLICY_COALESCE))) {
+            
+            policy = REQ_SUB_POLICY_COALESCE;
+            argIndex++;
+        }
+        else if((NULL != args[argIndex + 1]) && (0 == strcmp(args[argIndex], STR_CMD_SUB_POLICY)) &&
+                (0 == strcmp(args[argIndex + 1], STR_CMD_SUB_POLICY_DISCONNECT))) {
+            
+            policy = REQ_SUB_POLICY_DISCONNECT;
+            argIndex++;
+        }
+        else {
+            
+            /* Invalid argument */
+            fprintf(stdout, MSG_USER_WARN_INVALID_ARG);
+            fprintf(stdout, MSG_USER_INFO_HINT_SUB);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
+    }
+    
+    if(0 == channels) {
+        
+        channels = REQ_AGG_CH_MASK;
+    }
+    
+    /* Send request code to server */
+    if(0 != sendRequestCode(pollArray, REQ_CODE_SUB)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Send query to server */
+    queryBuf[0] = channels;
+    memcpy(&queryBuf[1], &decimation, sizeof(decimation));
+    queryBuf[5] = policy;
+    len = send(pollArray[POLL_ARRAY_SOCKET].fd, queryBuf, sizeof(queryBuf), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send query to server */
+        perror("send");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_SEND_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive server response */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
+    if(len <= 0) {
+     
+        /* Failed to receive response from server */
+        perror("recv");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_RES_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    if(RES_CODE_REQ_FAIL == response) {
+        
+        /* Invalid query or server side error */
+        fprintf(stdout, MSG_USER_WARN_REQ_FAIL_SERVER);
+        fprintf(stdout, MSG_USER_INFO_HINT_SUB);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    else if(RES_CODE_REQ_SUCCESS != response) {
+        
+        /* Invalid server response */
+        fprintf(stdout, MSG_USER_WARN_RES_INVALID);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Start live view */
+    liveViewChannels = channels;
+    liveRecvLen = 0;
+    liveViewCondition = COND_LIVE_VIEW_TRUE;
+    
+    fprintf(stdout, MSG_USER_INFO_LIVE_START);
+    fflush(stdout);
+    
+    return error;
+}
+
+/*
+ * Function 'parseLiveFrames': prints the complete frames of the live view receive buffer.
+ * 
+ * Note:    Returns 1 once the end frame is parsed, -1 on an invalid frame and 0
+ *          otherwise. An incomplete frame is kept for the next call.
+ */
+static int parseLiveFrames(void) {
+    
+    uint64_t seq = 0;
+    uint64_t timeUs = 0;
+    uint32_t dropCount = 0;
+    size_t frameLen = RES_PUSH_HEADER_LEN;
+    size_t offset = 0;
+    size_t pos;
+    float value;
+    char timeStr[MEAS_DATA_TIME_STR_LEN];
+    int channel;
+    int result = 0;
+    
+    const char *channelUnits[] = {" deg C", "%", " hPa"};
+    
+    for(channel = 0; channel < 3; channel++) {
+        
+        frameLen += (liveViewChannels & (1 << channel)) ? sizeof(float) : 0;
+    }
+    
+    while((offset < liveRecvLen) && (0 == result)) {
+        
+        if(RES_CODE_PUSH_SAMPLE == liveRecvBuf[offset]) {
+            
+            if(liveRecvLen - offset < frameLen) {
+                
+                break;
+            }
+            
+            memcpy(&seq, &liveRecvBuf[offset + 1], sizeof(seq));
+            memcpy(&timeUs, &liveRecvBuf[offset + 9], sizeof(timeUs));
+            lastSampleSeq = seq;
+            
+            formatRecordTime(timeUs, timeStr, sizeof(timeStr));
+            fprintf(stdout, MSG_USER_INFO_LIVE_SAMPLE, (unsigned long long)seq, timeStr,
+                    (unsigned)((timeUs % USEC_PER_SEC) / USEC_PER_MSEC));
+            
+            pos = offset + RES_PUSH_HEADER_LEN;
+            for(channel = 0; channel < 3; channel++) {
+                
+                if(liveViewChannels & (1 << channel)) {
+                    
+                    memcpy(&value, &liveRecvBuf[pos], sizeof(value));
+                    fprintf(stdout, "    %0.2lf%s", value, channelUnits[channel]);
+                    pos += sizeof(value);
+                }
+            }
+            fprintf(stdout, "\n");
+            
+            offset += frameLen;
+        }
+        else if(RES_CODE_PUSH_END == liveRecvBuf[offset]) {
+            
+            if(liveRecvLen - offset < RES_PUSH_END_LEN) {
+                
+                break;
+            }
+            
+            memcpy(&dropCount, &liveRecvBuf[offset + 1], sizeof(dropCount));
+            fprintf(stdout, MSG_USER_INFO_LIVE_END, dropCount);
+            
+            offset += RES_PUSH_END_LEN;
+            result = 1;
+        }
+        else {
+            
+            /* Invalid server response */
+            fprintf(stdout, MSG_USER_WARN_RES_INVALID);
+            
+            offset = liveRecvLen;
+            result = -1;
+        }
+    }
+    fflush(stdout);
+    
+    /* Keep incomplete frame */
+    memmove(liveRecvBuf, &liveRecvBuf[offset], liveRecvLen - offset);
+    liveRecvLen -= offset;
+    
+    return result;
+}
+
+/*
+ * Function 'receiveLiveSamples': receives and prints the samples pushed by the server.
+ * 
+ * Note:    Called by the main loop when the socket is readable in live view. The live
+ *          view ends here if the server ends the subscription or closes the connection
+ *          (slow subscriber disconnected).
+ */
+int receiveLiveSamples(struct pollfd pollArray[]) {
+    
+    int error = 0;
+    int len;
+    
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &liveRecvBuf[liveRecvLen], sizeof(liveRecvBuf) - liveRecvLen, 0);
+    if(len <= 0) {
+        
+        /* Server closed connection */
+        if(len < 0) {
+            
+            perror("recv");
+            fflush(stderr);
+        }
+        fprintf(stdout, MSG_USER_WARN_SERVER_CLOSED);
+        fprintf(stdout, MSG_USER_INFO_DISCONNECT);
+        fflush(stdout);
+        
+        close(pollArray[POLL_ARRAY_SOCKET].fd);
+        pollArray[POLL_ARRAY_SOCKET].fd = INVALID_FD;
+        liveViewCondition = COND_LIVE_VIEW_FALSE;
+        
+        error = -1;
+        return error;
+    }
+    
+    liveRecvLen += len;
+    if(0 != parseLiveFrames()) {
+        
+        /* Subscription ended by server */
+        liveViewCondition = COND_LIVE_VIEW_FALSE;
+        liveRecvLen = 0;
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'stopLiveView': ends the subscription and waits for the remaining pushed samples.
+ * 
+ * Protocol:    Client --> Server: unsubscribe code <1 byte>
+ *              Client <-- Server: remaining sample frames, end frame <RES_PUSH_END_LEN bytes>
+ */
+int stopLiveView(struct pollfd pollArray[]) {
+    
+    uint8_t reqCode = REQ_CODE_UNSUB;
+    int result = 0;
+    int error = 0;
+    int len;
+    
+    liveViewCondition = COND_LIVE_VIEW_FALSE;
+    
+    len = send(pollArray[POLL_ARRAY_SOCKET].fd, &reqCode, sizeof(reqCode), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send unsubscribe code to server */
+        perror("send");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_SEND_REQ_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive frames until the end frame */
+    while(0 == result) {
+        
+        len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &liveRecvBuf[liveRecvLen], sizeof(liveRecvBuf) - liveRecvLen, 0);
+        if(len <= 0) {
+            
+            /* Failed to receive pushed samples from server */
+            perror("recv");
+            fflush(stderr);
+            fprintf(stdout, MSG_USER_WARN_RECV_LIVE_FAIL);
+            fflush(stdout);
+            
+            error = -1;
+            break;
+        }
+        
+        liveRecvLen += len;
+        result = parseLiveFrames();
+    }
+    
+    liveRecvLen = 0;
+    
+    return error;
+}
+
+/*
+ * Function 'startMulticastListener': joins the multicast feed of the server.
+ * 
+ * Note:        The server sends each sample once to the multicast group (server option -g).
+ *              Samples are printed as they arrive until 'mcast off', other commands
+ *              keep working meanwhile. Gaps are repaired over the connection to the
+ *              server if there is one (see receiveMulticastSamples).
+ */
+int startMulticastListener(struct pollfd pollArray[], const char* args[]) {
+    
+    unsigned long port = SAMPLE_MCAST_PORT;
+    char *end = NULL;
+    int reuseAddrState = 1;
+    int mcastFd;
+    int error = 0;
+    
+    struct sockaddr_in groupAddress;
+    struct ip_mreq membership;
+    
+    if(INVALID_FD != pollArray[POLL_ARRAY_MCAST].fd) {
+        
+        fprintf(stdout, MSG_USER_WARN_MCAST_EXIST);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    memset(&groupAddress, 0, sizeof(groupAddress));
+    memset(&membership, 0, sizeof(membership));
+    groupAddress.sin_family = AF_INET;
+    membership.imr_interface.s_addr = htonl(INADDR_ANY);
+    
+    /* Parse group, port and interface */
+    if(NULL != args[2]) {
+        
+        errno = 0;
+        port = strtoul(args[2], &end, 10);
+        if((0 != errno) || ('\0' != *end) || (0 == port) || (port > UINT16_MAX)) {
+            
+            port = 0;
+        }
+    }
+    
+    if((NULL == args[1]) || (0 == port) ||
+       (1 != inet_pton(AF_INET, args[1], &(groupAddress.sin_addr))) ||
+       !IN_MULTICAST(ntohl(groupAddress.sin_addr.s_addr)) ||
+       ((NULL != args[3]) && (1 != inet_pton(AF_INET, args[3], &(membership.imr_interface))))) {
+        
+        fprintf(stdout, MSG_USER_WARN_INVALID_ARG);
+        fprintf(stdout, MSG_USER_INFO_HINT_MCAST);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    groupAddress.sin_port = htons((uint16_t)port);
+    membership.imr_multiaddr = groupAddress.sin_addr;
+    
+    mcastFd = socket(AF_INET, SOCK_DGRAM, 0);
+    if(mcastFd < 0) {
+        
+        perror("socket");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_MCAST_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Several listeners may run on the same host, bound to the group they get its datagrams only */
+    if((setsockopt(mcastFd, SOL_SOCKET, SO_REUSEADDR, &reuseAddrState, sizeof(reuseAddrState)) < 0) ||
+       (bind(mcastFd, (struct sockaddr*)&groupAddress, sizeof(groupAddress)) < 0) ||
+       (setsockopt(mcastFd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0)) {
+        
+        perror("setsockopt");
+        fflush(stderr);
+        fprintf(stdout, MSG_USER_WARN_MCAST_FAIL);
+        fflush(stdout);
+        
+        close(mcastFd);
+        
+        error = -1;
+        return error;
+    }
+    
+    mcastStreamId = 0;
+    memset(mcastLastSeq, 0, sizeof(mcastLastSeq));
+    pollArray[POLL_ARRAY_MCAST].fd = mcastFd;
+    
+    fprintf(stdout, MSG_USER_INFO_MCAST_START, args[1], (unsigned)port);
+    fflush(stdout);
+    
+    return error;
+}
+
+/*
+ * Function 'stopMulticastListener': leaves the multicast feed of the server.
+ */
+int stopMulticastListener(struct pollfd pollArray[]) {
+    
+    if(INVALID_FD == pollArray[POLL_ARRAY_MCAST].fd) {
+        
+        fprintf(stdout, MSG_USER_WARN_MCAST_NONE);
+        fflush(stdout);
+        
+        return -1;
+    }
+    
+    /* Closing the socket leaves the group */
+    close(pollArray[POLL_ARRAY_MCAST].fd);
+    pollArray[POLL_ARRAY_MCAST].fd = INVALID_FD;
+    
+    fprintf(stdout, MSG_USER_INFO_MCAST_STOP);
+    fflush(stdout);
+    
+    return 0;
+}
+
+/*
+ * Function 'printMulticastSample': prints a sample of the multicast feed.
+ */
+static void printMulticastSample(uint8_t sensorId, const uint8_t sampleMsg[RES_LATEST_LEN], int repaired) {
+    
+    uint64_t seq = 0;
+    uint64_t timeUs = 0;
+    float value[3];
+    char timeStr[MEAS_DATA_TIME_STR_LEN];
+    
+    memcpy(&seq, &sampleMsg[0], sizeof(seq));
+    memcpy(&timeUs, &sampleMsg[8], sizeof(timeUs));
+    memcpy(value, &sampleMsg[16], sizeof(value));
+    
+    formatRecordTime(timeUs, timeStr, sizeof(timeStr));
+    fprintf(stdout, MSG_USER_INFO_MCAST_SAMPLE, (unsigned)sensorId, (unsigned long long)seq, timeStr,
+            (unsigned)((timeUs % USEC_PER_SEC) / USEC_PER_MSEC), value[0], value[1], value[2],
+            repaired ? " (repaired)" : "");
+}
+
+/*
+ * Function 'repairMulticastGap': fetches the samples lost by the multicast feed over TCP.
+ * 
+ * Note:        Only the last MCAST_REPAIR_MAX lost samples can be repaired, older ones are
+ *              not kept by the server. Not possible without connection or during live view.
+ * 
+ * Protocol:    Client --> Server: get recent samples request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: sensor ID <1 byte>
+ *              Client --> Server: sequence number of the first sample <8 bytes>
+ *              Client --> Server: number of samples <1 byte> (max. REQ_HIST_COUNT_MAX)
+ *              Client <-- Server: result of request processing <1 byte>
+ *              Client <-- Server: number of samples sent <1 byte>
+ *              Client <-- Server: samples <32 bytes each> (samples not kept are left out)
+ */
+static void repairMulticastGap(struct pollfd pollArray[], uint8_t sensorId, uint64_t firstSeq, uint64_t lastSeq) {
+    
+    uint8_t queryBuf[REQ_HIST_LEN];
+    uint8_t resBuf[2];
+    uint8_t sampleMsg[RES_LATEST_LEN];
+    uint64_t lostCount = lastSeq - firstSeq + 1;
+    uint64_t seq;
+    unsigned repairedCount = 0;
+    int count;
+    int len;
+    int i;
+    
+    if((INVALID_FD == pollArray[POLL_ARRAY_SOCKET].fd) || (COND_LIVE_VIEW_TRUE == liveViewCondition)) {
+        
+        fprintf(stdout, MSG_USER_WARN_MCAST_GAP, (unsigned)sensorId,
+                (unsigned long long)firstSeq, (unsigned long long)lastSeq);
+        fflush(stdout);
+        
+        return;
+    }
+    
+    seq = (lostCount > MCAST_REPAIR_MAX) ? (lastSeq - MCAST_REPAIR_MAX + 1) : firstSeq;
+    while(seq <= lastSeq) {
+        
+        count = ((lastSeq - seq + 1) > REQ_HIST_COUNT_MAX) ? REQ_HIST_COUNT_MAX : (int)(lastSeq - seq + 1);
+        
+        if(0 != sendRequestCode(pollArray, REQ_CODE_HIST)) {
+            
+            break;
+        }
+        
+        queryBuf[0] = sensorId;
+        memcpy(&queryBuf[1], &seq, sizeof(seq));
+        queryBuf[9] = (uint8_t)count;
+        
+        len = send(pollArray[POLL_ARRAY_SOCKET].fd, queryBuf, sizeof(queryBuf), MSG_NOSIGNAL);
+        if(len < 0) {
+            
+            perror("send");
+            fflush(stderr);
+            fprintf(stdout, MSG_USER_WARN_SEND_REQ_FAIL);
+            fflush(stdout);
+            
+            break;
+        }
+        
+        len = recv(pollArray[POLL_ARRAY_SOCKET].fd, resBuf, 1, MSG_WAITALL);
+        if((1 != len) || (RES_CODE_REQ_SUCCESS != resBuf[0])) {
+            
+            fprintf(stdout, MSG_USER_WARN_RECV_HIST_FAIL);
+            fflush(stdout);
+            
+            break;
+        }
+        
+        len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &resBuf[1], 1, MSG_WAITALL);
+        for(i = 0; (1 == len) && (i < resBuf[1]); i++) {
+            
+            len = recv(pollArray[POLL_ARRAY_SOCKET].fd, sampleMsg, sizeof(sampleMsg), MSG_WAITALL);
+            if((int)sizeof(sampleMsg) == len) {
+                
+                printMulticastSample(sensorId, sampleMsg, 1);
+                repairedCount++;
+                len = 1;
+            }
+        }
+        
+        if(1 != len) {
+            
+            perror("recv");
+            fflush(stderr);
+            fprintf(stdout, MSG_USER_WARN_RECV_HIST_FAIL);
+            fflush(stdout);
+            
+            break;
+        }
+        
+        seq += count;
+    }
+    
+    fprintf(stdout, MSG_USER_INFO_MCAST_REPAIR, (unsigned)sensorId, repairedCount, (unsigned long long)lostCount);
+    fflush(stdout);
+}
+
+/*
+ * Function 'receiveMulticastSamples': receives and prints a sample of the multicast feed.
+ * 
+ * Note:        Samples of every sensor are numbered one by one, a jump in the sequence
+ *              numbers of a sensor is a gap to repair. Late or duplicated datagrams are
+ *              dropped. A new stream ID means the server restarted its numbering.
+ * 
+ * Datagram:    version <1 byte> (SAMPLE_MCAST_VERSION)
+ *              sensor ID <1 byte>
+ *              reserved <2 bytes>
+ *              stream ID <4 bytes>
+ *              sample <32 bytes> (see getLatestSample)
+ */
+int receiveMulticastSamples(struct pollfd pollArray[]) {
+    
+    uint8_t dgram[SAMPLE_MCAST_DGRAM_LEN + 1];  // Longer datagrams are not ours
+    uint8_t sensorId;
+    uint32_t streamId = 0;
+    uint64_t seq = 0;
+    int len;
+    
+    len = recv(pollArray[POLL_ARRAY_MCAST].fd, dgram, sizeof(dgram), 0);
+    if((SAMPLE_MCAST_DGRAM_LEN != len) || (SAMPLE_MCAST_VERSION != dgram[0]) || (dgram[1] >= SENSOR_ARRAY_SIZE)) {
+        
+        /* Foreign or incompatible datagram */
+        return -1;
+    }
+    
+    sensorId = dgram[1];
+    memcpy(&streamId, &dgram[4], sizeof(streamId));
+    memcpy(&seq, &dgram[8], sizeof(seq));
+    
+    if(streamId != mcastStreamId) {
+        
+        if(0 != mcastStreamId) {
+            
+            fprintf(stdout, MSG_USER_INFO_MCAST_RESTART);
+        }
+        
+        mcastStreamId = streamId;
+        memset(mcastLastSeq, 0, sizeof(mcastLastSeq));
+    }
+    
+    if(seq <= mcastLastSeq[sensorId]) {
+        
+        /* Late (repaired already) or duplicated sample */
+        return 0;
+    }
+    
+    /* Nothing is lost before the first sample received */
+    if((0 != mcastLastSeq[sensorId]) && (seq > mcastLastSeq[sensorId] + 1)) {
+        
+        repairMulticastGap(pollArray, sensorId, mcastLastSeq[sensorId] + 1, seq - 1);
+    }
+    
+    mcastLastSeq[sensorId] = seq;
+    printMulticastSample(sensorId, &dgram[8], 0);
+    fflush(stdout);
+    
+    return 0;
+}
+
+/*
+ * Function 'formatStatsValue': formats a histogram value with a fitting unit.
+ */
+static void formatStatsValue(uint64_t value, int histId, char *buf, size_t bufLen) {
+    
+    if(STATS_HIST_GDAT_BYTES == histId) {
+        
+        /* Bytes */
+        if(value < 1024) {
+            
+            snprintf(buf, bufLen, "%lluB", (unsigned long long)value);
+        }
+        else if(value < 1024 * 1024) {
+            
+            snprintf(buf, bufLen, "%.1fKiB", (double)value / 1024.0);
+        }
+        else {
+            
+            snprintf(buf, bufLen, "%.1fMiB", (double)value / (1024.0 * 1024.0));
+        }
+    }
+    else {
+        
+        /* Nanoseconds */
+        if(value < 1000) {
+            
+            snprintf(buf, bufLen, "%lluns", (unsigned long long)value);
+        }
+        else if(value < 1000000) {
+            
+            snprintf(buf, bufLen, "%.1fus", (double)value / 1e3);
+        }
+        else if(value < 1000000000) {
+            
+            snprintf(buf, bufLen, "%.1fms", (double)value / 1e6);
+        }
+        else {
+            
+            snprintf(buf, bufLen, "%.2fs", (double)value / 1e9);
+        }
+    }
+}
+
+/*
+ * Function 'getServerStats': requests server statistics and prints them.
+ * 
+ * Note:        Histograms are summarized by the server, latencies are in nanoseconds.
+ * 
+ * Protocol:    Client --> Server: statistics request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client <-- Server: result of request processing <1 byte>
+ *              Client <-- Server: uptime <8 bytes> (usec)
+ *              Client <-- Server: number of counters <1 byte>
+ *              Client <-- Server: number of histograms <1 byte>
+ *              Client <-- Server: counters <<number of counters> * 9 bytes> (ID <1>, value <8>)
+ *              Client <-- Server: histograms <<number of histograms> * 66 bytes>
+ *                                 (ID <1>, key <1>, count, mean, min, p50, p90, p99, p99.9, max <8 each>)
+ */
+int getServerStats(struct pollfd pollArray[]) {
+    
+    static const char *counterNameTable[STATS_CNT_COUNT] = {
+        
+        "Connections accepted",
+        "Authentications failed",
+        "Requests served",
+        "Requests failed",
+        "GDAT bytes sent",
+        "Samples measured",
+        "Measurements failed",
+        "Log events forwarded",
+        "Log events dropped",
+        "Log events suppressed"
+    };
+    
+    static const char *histNameTable[STATS_HIST_COUNT] = {
+        
+        "Accept to auth",
+        "Request",
+        "GDAT bytes",
+        "Sensor bus",
+        "Sensor conversion",
+        "Storage append",
+        "Sampling jitter",
+        "Lock wait",
+        "Lock hold"
+    };
+    
+    uint8_t response = 0;
+    uint8_t headerBuf[RES_STATS_HEADER_LEN];
+    uint8_t entry[RES_STATS_HIST_LEN];
+    uint64_t uptimeUs = 0;
+    uint64_t value[8];                          // count, mean, min, p50, p90, p99, p99.9, max
+    char valueStr[7][16];
+    char nameStr[24];
+    int error = 0;
+    int len;
+    int i;
+    int j;
+    
+    /* Send request code to server and check response */
+    if(0 != sendRequestCode(pollArray, REQ_CODE_STATS)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive result and statistics header */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
+    if((len == (int)sizeof(response)) && (RES_CODE_REQ_SUCCESS == response)) {
+        
+        len = recv(pollArray[POLL_ARRAY_SOCKET].fd, headerBuf, sizeof(headerBuf), MSG_WAITALL);
+    }
+    
+    if((RES_CODE_REQ_SUCCESS != response) || (len != (int)sizeof(headerBuf))) {
+        
+        /* Failed to receive statistics */
+        fprintf(stdout, MSG_USER_WARN_RECV_STATS_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    memcpy(&uptimeUs, &headerBuf[0], sizeof(uptimeUs));
+    fprintf(stdout, MSG_USER_INFO_STATS_HEADER, (unsigned long long)(uptimeUs / USEC_PER_SEC),
+            (unsigned long long)((uptimeUs % USEC_PER_SEC) / USEC_PER_MSEC));
+    
+    /* Counters */
+    for(i = 0; i < headerBuf[8]; i++) {
+        
+        len = recv(pollArray[POLL_ARRAY_SOCKET].fd, entry, RES_STATS_COUNTER_LEN, MSG_WAITALL);
+        if(len != RES_STATS_COUNTER_LEN) {
+            
+            fprintf(stdout, MSG_USER_WARN_RECV_STATS_FAIL);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
+        
+        memcpy(&value[0], &entry[1], sizeof(value[0]));
+        if(entry[0] < STATS_CNT_COUNT) {
+            
+            fprintf(stdout, MSG_USER_INFO_STATS_COUNTER, counterNameTable[entry[0]], (unsigned long long)value[0]);
+        }
+    }
+    
+    /* Histogram summaries */
+    fprintf(stdout, MSG_USER_INFO_STATS_HIST_HEADER, "", "count", "mean", "min", "p50", "p90", "p99", "p99.9", "max");
+    for(i = 0; i < headerBuf[9]; i++) {
+        
+        len = recv(pollArray[POLL_ARRAY_SOCKET].fd, entry, RES_STATS_HIST_LEN, MSG_WAITALL);
+        if(len != RES_STATS_HIST_LEN) {
+            
+            fprintf(stdout, MSG_USER_WARN_RECV_STATS_FAIL);
+            fflush(stdout);
+            
+            error = -1;
+            return error;
+        }
+        
+        if(entry[0] >= STATS_HIST_COUNT) {
+            
+            /* Unknown histogram of a newer server */
+            continue;
+        }
+        
+        memcpy(value, &entry[2], sizeof(value));
+        for(j = 0; j < 7; j++) {
+            
+            formatStatsValue(value[j + 1], entry[0], valueStr[j], sizeof(valueStr[j]));
+        }
+        
+        if(STATS_HIST_REQUEST == entry[0]) {
+            
+            snprintf(nameStr, sizeof(nameStr), "%s 0x%02X", histNameTable[entry[0]], (unsigned)entry[1]);
+        }
+        else if((STATS_HIST_LOCK_WAIT == entry[0]) || (STATS_HIST_LOCK_HOLD == entry[0])) {
+            
+            /* Key: lock site ID (logged by the server on the first use of the site) */
+            snprintf(nameStr, sizeof(nameStr), "%s site %u", histNameTable[entry[0]], (unsigned)entry[1]);
+        }
+        else {
+            
+            snprintf(nameStr, sizeof(nameStr), "%s", histNameTable[entry[0]]);
+        }
+        
+        fprintf(stdout, MSG_USER_INFO_STATS_HIST, nameStr, (unsigned long long)value[0], valueStr[0], valueStr[1],
+                valueStr[2], valueStr[3], valueStr[4], valueStr[5], valueStr[6]);
+    }
+    fprintf(stdout, MSG_USER_INFO_SENS_LIST_FOOTER);
+    fflush(stdout);
+    
+    return error;
+}
+
+/*
+ * Function 'getServerTrace': requests the recorded spans of the server and saves them to a file.
+ * 
+ * Note:        The file is Chrome trace-event JSON as sent by the server.
+ * 
+ * Protocol:    Client --> Server: trace request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client <-- Server: result of request processing <1 byte>
+ *              Client <-- Server: JSON length <4 bytes>
+ *              Client <-- Server: JSON <<JSON length> bytes>
+ */
+int getServerTrace(struct pollfd pollArray[], const char *path) {
+    
+    uint8_t response = 0;
+    uint8_t chunk[TRACE_CHUNK_LEN];
+    uint32_t jsonLen = 0;
+    uint32_t received = 0;
+    int traceFd = -1;
+    int error = 0;
+    int len = 0;
+    
+    /* Send request code to server and check response */
+    if(0 != sendRequestCode(pollArray, REQ_CODE_TRACE)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive result and JSON length */
+    len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &response, sizeof(response), MSG_WAITALL);
+    if((len == (int)sizeof(response)) && (RES_CODE_REQ_SUCCESS == response)) {
+        
+        len = recv(pollArray[POLL_ARRAY_SOCKET].fd, &jsonLen, sizeof(jsonLen), MSG_WAITALL);
+    }
+    
+    if((RES_CODE_REQ_SUCCESS != response) || (len != (int)sizeof(jsonLen))) {
+        
+        /* Failed to receive trace */
+        fprintf(stdout, MSG_USER_WARN_RECV_TRACE_FAIL);
+        fflush(stdout);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* JSON is received even if the file cannot be written (keeps the protocol in sync) */
+    traceFd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if(traceFd < 0) {
+        
+        perror("open");
+        fprintf(stdout, MSG_USER_WARN_TRACE_FILE_FAIL);
+        fflush(stdout);
+        error = -1;
+    }
+    
+    while(received < jsonLen) {
+        
+        len = recv(pollArray[POLL_ARRAY_SOCKET].fd, chunk,
+                   (jsonLen - received < sizeof(chunk)) ? (jsonLen - received) : sizeof(chunk), MSG_WAITALL);
+        if(len <= 0) {
+            
+            fprintf(stdout, MSG_USER_WARN_RECV_TRACE_FAIL);
+            fflush(stdout);
+            
+            if(traceFd >= 0) {
+                
+                close(traceFd);
+            }
+            
+            error = -1;
+            return error;
+        }
+        
+        if((traceFd >= 0) && (len != write(traceFd, chunk, len))) {
+            
+            perror("write");
+            fprintf(stdout, MSG_USER_WARN_TRACE_FILE_FAIL);
+            fflush(stdout);
+            
+            close(traceFd);
+            traceFd = -1;
+            error = -1;
+        }
+        
+        received += (uint32_t)len;
+    }
+    
+    if(traceFd >= 0) {
+        
+        close(traceFd);
+        fprintf(stdout, MSG_USER_INFO_TRACE_SAVED, (unsigned)jsonLen, path);
+        fflush(stdout);
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'showSensorData': show measurement data records transferred from server.
+ */
+int showSensorData(struct pollfd pollArray[]) {
+ 
+    int dataFd = -1;
+    int error = 0;
+    struct MeasDataRecord dataRecord;
+    char timeStr[MEAS_DATA_TIME_STR_LEN];
+    int len;
+    
+    /* Open local file to read and print measurement data records */
+    dataFd = open(measDataFilePath, O_RDONLY | O_NONBLOCK);
+    if(dataFd < 0) {
+        
+        /* Failed to open local measurement data file */
+        perror("open");
+        fprintf(stderr, "[ERROR] Failed to open measurement data file.\n");
+        fprintf(stderr, "[ERROR] Failed to show measurement data records.\n");
+        fflush(stderr);
+
+        error = -1;
+        return error;
+    }
+    
+    /* Reset data record */
+    memset(&dataRecord, 0, sizeof(dataRecord));
+    
+    fprintf(stdout, "\n----------------------- SENSOR DATA RECORDS -----------------------\n\n");
+    fflush(stdout);
+    
+    len = read(dataFd, &dataRecord, sizeof(dataRecord));
+    while(len > 0) {
+        
+        formatRecordTime((uint64_t)dataRecord.timeSec * USEC_PER_SEC, timeStr, sizeof(timeStr));
+        fprintf(stdout, "  %s.%03u    %0.2lf deg C       %0.2lf%%       %0.2lf hPa\n", timeStr,
+                dataRecord.timeUsec / (unsigned)USEC_PER_MSEC, dataRecord.temp, dataRecord.hum, dataRecord.press);
+        
+        memset(&dataRecord, 0, sizeof(dataRecord));
+        len = read(dataFd, &dataRecord, sizeof(dataRecord));
+    }
+        
+    fprintf(stdout, "\n-------------------------------------------------------------------\n");
+    fflush(stdout);
+    
+    close(dataFd);
+    
+    return error;
+}
+
 /* 
  * Function 'interpretUserCommand': parse and interprets the command line user isntructions.
  */
 int interpretUserCommand(struct pollfd pollArray[]) {
     
-    const char* args[MAX_NUM_OF_ARGS];
+    const char* args[MAX_NUM_OF_ARGS + 1];     // NULL terminated
     const char delim[] = " ";
     char inputBuffer[INPUT_BUFFER_SIZE];
     int argIndex = 0;
@@ -1407,6 +3921,19 @@ int interpretUserCommand(struct pollfd pollArray[]) {
     //    fflush(stdout);
     //}
     
+    /* Any user command ends the live view first */
+    if(COND_LIVE_VIEW_TRUE == liveViewCondition) {
+        
+        fprintf(stdout, "[INFO] STOP LIVE VIEW\n");
+        fflush(stdout);
+        stopLiveView(pollArray);
+        
+        if((NULL == args[0]) || (0 == strcmp(args[0], STR_CMD_UNSUBSCRIBE))) {
+            
+            return 0;
+        }
+    }
+    
     /* Check NULL of user command */
     if(NULL == args[0]) {
      
@@ -1424,6 +3951,13 @@ int interpretUserCommand(struct pollfd pollArray[]) {
         fflush(stdout);
         setSensorConfig(pollArray, args);
     }
+    else if(0 == strcmp(args[0], STR_CMD_MULTI_SET_CONFIG)) {
+        
+        /* SET SEVERAL SENSOR CONFIGURATIONS AT ONCE */
+        fprintf(stdout, "[INFO] SET CONFIG (MULTI)\n");
+        fflush(stdout);
+        multiSetSensorConfig(pollArray, args);
+    }
     else if(0 == strcmp(args[0], STR_CMD_GET_CONFIG)) {
         
         /* GET SENSOR CONFIGURATION */
@@ -1436,7 +3970,69 @@ int interpretUserCommand(struct pollfd pollArray[]) {
         /* GET SENSOR DATA */
         fprintf(stdout, "[INFO] GET DATA\n");
         fflush(stdout);
-        getSensorData(pollArray);
+        if(NULL == args[1]) {
+            
+            getSensorData(pollArray);
+        }
+        else {
+            
+            getSensorColumns(pollArray, args);
+        }
+    }
+    else if(0 == strcmp(args[0], STR_CMD_LATEST)) {
+        
+        /* GET LATEST SAMPLE */
+        fprintf(stdout, "[INFO] LATEST SAMPLE\n");
+        fflush(stdout);
+        getLatestSample(pollArray);
+    }
+    else if(0 == strcmp(args[0], STR_CMD_WAIT)) {
+        
+        /* WAIT FOR NEW SAMPLE */
+        fprintf(stdout, "[INFO] WAIT FOR SAMPLE\n");
+        fflush(stdout);
+        waitSample(pollArray, args);
+    }
+    else if(0 == strcmp(args[0], STR_CMD_SUBSCRIBE)) {
+        
+        /* SUBSCRIBE TO NEW SAMPLES (LIVE VIEW) */
+        fprintf(stdout, "[INFO] SUBSCRIBE\n");
+        fflush(stdout);
+        subscribeSamples(pollArray, args);
+    }
+    else if(0 == strcmp(args[0], STR_CMD_UNSUBSCRIBE)) {
+        
+        /* Live view ended above if there was one */
+        fprintf(stdout, MSG_USER_WARN_LIVE_NONE);
+        fflush(stdout);
+    }
+    else if(0 == strcmp(args[0], STR_CMD_MULTICAST)) {
+        
+        /* LISTEN TO MULTICAST FEED */
+        fprintf(stdout, "[INFO] MULTICAST\n");
+        fflush(stdout);
+        if((NULL != args[1]) && (0 == strcmp(args[1], STR_CMD_MULTICAST_OFF))) {
+            
+            stopMulticastListener(pollArray);
+        }
+        else {
+            
+            startMulticastListener(pollArray, args);
+        }
+    }
+    else if(0 == strcmp(args[0], STR_CMD_STATS)) {
+        
+        /* GET SERVER STATISTICS */
+        fprintf(stdout, "[INFO] STATISTICS\n");
+        fflush(stdout);
+        getServerStats(pollArray);
+    }
+    else if(0 == strcmp(args[0], STR_CMD_TRACE)) {
+        
+        /* GET SERVER TRACE */
+        fprintf(stdout, "[INFO] TRACE\n");
+        fflush(stdout);
+        getServerTrace(pollArray, (NULL != args[1]) ? args[1] : TRACE_FILE_NAME);
     }
     else if(0 == strcmp(args[0], STR_CMD_REMOVE_DATA)) {
         
@@ -1469,6 +4065,38 @@ int interpretUserCommand(struct pollfd pollArray[]) {
         fflush(stdout);
         showSensorData(pollArray);
     }
+    else if(0 == strcmp(args[0], STR_CMD_LIST_SENSORS)) {
+        
+        /* LIST SENSORS */
+        
+        fprintf(stdout, "[INFO] LIST SENSORS\n");
+        fflush(stdout);
+        listSensors(pollArray);
+    }
+    else if(0 == strcmp(args[0], STR_CMD_SELECT_SENSOR)) {
+        
+        /* SELECT SENSOR */
+        
+        fprintf(stdout, "[INFO] SELECT SENSOR\n");
+        fflush(stdout);
+        selectSensor(pollArray, args);
+    }
+    else if(0 == strcmp(args[0], STR_CMD_AGGREGATE)) {
+        
+        /* AGGREGATE SENSOR DATA */
+        
+        fprintf(stdout, "[INFO] AGGREGATE DATA\n");
+        fflush(stdout);
+        aggregateSensorData(pollArray, args);
+    }
+    else if(0 == strcmp(args[0], STR_CMD_DOWNSAMPLE)) {
+        
+        /* DOWNSAMPLE SENSOR DATA */
+        
+        fprintf(stdout, "[INFO] DOWNSAMPLE DATA\n");
+        fflush(stdout);
+        downsampleSensorData(pollArray, args);
+    }
     else if(0 == strcmp(args[0], STR_CMD_EXIT)) {
         
         /* EXIT PROGRAM */
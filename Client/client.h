@@ -15,18 +15,58 @@
 #include <stdint.h>
 
 /* Const message strings */
+#define MSG_USER_INFO_AGG_BUCKET                    ("Bucket %s\n")
+#define MSG_USER_INFO_AGG_EMPTY                     ("[INFO] No measurement data in the requested range.\n")
+#define MSG_USER_INFO_AGG_FOOTER                    ("\n------------------------------------------\n")
+#define MSG_USER_INFO_AGG_HEADER                    ("\n------- AGGREGATES OF SENSOR DATA --------\n\n")
+#define MSG_USER_INFO_AGG_STATS                     ("  %s  count %-8u min %-10.2f max %-10.2f mean %-10.2f stddev %.2f\n")
+#define MSG_USER_INFO_AGG_STATS_NONE                ("  %s  count 0\n")
+#define MSG_USER_INFO_DSMP_CHANNEL                  ("%s (%u points)\n")
+#define MSG_USER_INFO_DSMP_FOOTER                   ("\n------------------------------------------\n")
+#define MSG_USER_INFO_DSMP_HEADER                   ("\n------- DOWNSAMPLED SENSOR DATA ----------\n\n")
+#define MSG_USER_INFO_DSMP_POINT                    ("  %s.%03u    %0.2f\n")
 #define MSG_USER_INFO_CONF_FOOTER                   ("\n------------------------------------------\n")
 #define MSG_USER_INFO_CONF_HEADER                   ("\n----- ACTUAL CONFIG OF BME280 SENSOR -----\n\n")
 #define MSG_USER_INFO_CONF_FILTER                   ("IIR filter config:\t%s\n")
+#define MSG_USER_INFO_CONF_MODE                     ("Mode config:\t\t%s\n")
 #define MSG_USER_INFO_CONF_HUMIDITY                 ("Humidity config:\t%s\n")
-#define MSG_USER_INFO_CONF_PERIOD                   ("Period config:\t\t%d [sec]\n")
+#define MSG_USER_INFO_CONF_PERIOD                   ("Period config:\t\t%llu [sec]\n")
+#define MSG_USER_INFO_CONF_PERIOD_MS                ("Period config:\t\t%llu [ms]\n")
+#define MSG_USER_INFO_CONF_PERIOD_US                ("Period config:\t\t%llu [us]\n")
 #define MSG_USER_INFO_CONF_PRESSURE                 ("Pressure config:\t%s\n")
+#define MSG_USER_INFO_CONF_VERSION                  ("Config version:\t\t%u\n")
 #define MSG_USER_INFO_CONF_TEMPERATURE              ("Temperature config:\t%s\n")
 #define MSG_USER_INFO_CONNECT_SUCCESS               ("[INFO] Connected to server.\n")
 #define MSG_USER_INFO_DISCONNECT                    ("[INFO] Disconnected from server.\n")
 #define MSG_USER_INFO_DISCONNECT_NONE               ("[INFO] There is no server to disconnect from.\n")
 #define MSG_USER_INFO_EXIT                          ("[INFO] Exited program.\n")
-#define MSG_USER_INFO_HINT_CONF                     ("[INFO] Hint: sconf <TMP|PRS|HUM|IIR|PRD> <ON|OFF> [value].\n")
+#define MSG_USER_INFO_SENS_LIST_FOOTER              ("\n------------------------------------------\n")
+#define MSG_USER_INFO_SENS_LIST_HEADER              ("\n------------ SENSORS ON SERVER -----------\n\n")
+#define MSG_USER_INFO_SENS_LIST_ENTRY               ("  %s\n")
+#define MSG_USER_INFO_STATS_HEADER                  ("\n----------- SERVER STATISTICS ------------\n\nUptime: %llu.%03llu [sec]\n\n")
+#define MSG_USER_INFO_STATS_COUNTER                 ("  %-28s %12llu\n")
+#define MSG_USER_INFO_STATS_HIST_HEADER             ("\n  %-20s %10s %9s %9s %9s %9s %9s %9s %9s\n")
+#define MSG_USER_INFO_STATS_HIST                    ("  %-20s %10llu %9s %9s %9s %9s %9s %9s %9s\n")
+#define MSG_USER_INFO_TRACE_SAVED                   ("[INFO] Saved %u bytes of server trace to %s (open it in chrome://tracing or Perfetto).\n")
+#define MSG_USER_INFO_HINT_AGG                      ("[INFO] Hint: agg <TMP|HUM|PRS> [...] [from <UNIX time|-sec>] [to <UNIX time|-sec>] [bucket <value>[s|m|h|d]].\n")
+#define MSG_USER_INFO_HINT_DSMP                     ("[INFO] Hint: dsmp <TMP|HUM|PRS> [...] <lttb <points>|every <value>[s|m|h|d]> [from <UNIX time|-sec>] [to <UNIX time|-sec>].\n")
+#define MSG_USER_INFO_HINT_GDAT                     ("[INFO] Hint: gdat [TMP] [HUM] [PRS] [TIME] (all records if none given).\n")
+#define MSG_USER_INFO_HINT_WAIT                     ("[INFO] Hint: wait [after <sample number>] [timeout <msec>] (default: last sample shown, 10000 msec).\n")
+#define MSG_USER_INFO_HINT_MCONF                    ("[INFO] Hint: mconf <field> [field ...], fields as in sconf, e.g. mconf TMP ON OS_2X PRS ON OS_4X PRD 1s.\n")
+#define MSG_USER_INFO_HINT_CONF                     ("[INFO] Hint: sconf <TMP|PRS|HUM|IIR|MOD> <ON|OFF> [value] or sconf PRD <value>[s|ms|us].\n")
+#define MSG_USER_INFO_HINT_SUB                      ("[INFO] Hint: sub [TMP] [HUM] [PRS] [every <n>] [policy <drop|coalesce|disconnect>] (default: all, every sample, drop).\n")
+#define MSG_USER_INFO_LIVE_END                      ("[INFO] Live view ended (%u samples dropped by server).\n")
+#define MSG_USER_INFO_LIVE_SAMPLE                   ("  #%-8llu %s.%03u")
+#define MSG_USER_INFO_LIVE_START                    ("[INFO] Live view started, enter any command to stop it.\n")
+#define MSG_USER_INFO_HINT_MCAST                    ("[INFO] Hint: mcast <group> [port] [interface address] or mcast off (default port: 2234, any interface).\n")
+#define MSG_USER_INFO_MCAST_REPAIR                  ("[INFO] Sensor %u: repaired %u of %llu lost samples over TCP.\n")
+#define MSG_USER_INFO_MCAST_RESTART                 ("[INFO] Multicast feed restarted by server.\n")
+#define MSG_USER_INFO_MCAST_SAMPLE                  ("  S%u #%-8llu %s.%03u    %0.2lf deg C    %0.2lf%%    %0.2lf hPa%s\n")
+#define MSG_USER_INFO_MCAST_START                   ("[INFO] Listening to multicast group %s port %u, enter mcast off to stop.\n")
+#define MSG_USER_INFO_MCAST_STOP                    ("[INFO] Multicast listener stopped.\n")
+#define MSG_USER_INFO_LATEST                        ("Sample %llu at %s.%03u (config version %u):\n")
+#define MSG_USER_INFO_WAIT_TIMEOUT                  ("[INFO] No new sample until timeout, latest sample:\n")
+#define MSG_USER_INFO_RECV_FCOL_SUCCESS             ("[INFO] Saved selected columns of %u records from remote server to local file.\n")
 #define MSG_USER_INFO_RECV_FDATA_SUCCESS            ("[INFO] Saved measurement data from remote server to local file.\n")
 #define MSG_USER_INFO_REQ_SUCCESS                   ("[INFO] Client request completed.\n")
 #define MSG_USER_REQ_NAME                           ("Username: ")
@@ -44,7 +84,13 @@
 #define MSG_USER_WARN_INVALID_CONF_PRD_ARG          ("[WARNING] Invalid config period argument.\n")
 #define MSG_USER_WARN_INVALID_CONF_STAT_ARG         ("[WARNING] Invalid config status argument.\n")
 #define MSG_USER_WARN_INVALID_CONF_TYPE_ARG         ("[WARNING] Invalid config type argument.\n")
+#define MSG_USER_WARN_INVALID_SENS_ARG              ("[WARNING] Invalid sensor ID argument.\n")
 #define MSG_USER_WARN_INVALID_CONF_VAL_ARG          ("[WARNIGN] Invalid config value argument.\n")
+#define MSG_USER_WARN_LIVE_NONE                     ("[WARNING] There is no live view to stop.\n")
+#define MSG_USER_WARN_MCAST_EXIST                   ("[WARNING] Multicast listener already running.\n")
+#define MSG_USER_WARN_MCAST_FAIL                    ("[WARNING] Failed to join multicast group.\n")
+#define MSG_USER_WARN_MCAST_GAP                     ("[WARNING] Sensor %u: lost samples %llu-%llu (connect to the server to repair gaps).\n")
+#define MSG_USER_WARN_MCAST_NONE                    ("[WARNING] There is no multicast listener to stop.\n")
 #define MSG_USER_WARN_MEAS_FILE_OPEN_FAIL           ("[WARNING] Failed to open local measurement data file.\n")
 #define MSG_USER_WARN_MEAS_FILE_WRITE_FAIL          ("[WARNING] Failed to write into local measurement data file.\n")
 #define MSG_USER_WARN_MEAS_PATH_INIT_FAIL           ("[WARNING] Failed to initialize measurement data file path.\n")
@@ -59,13 +105,18 @@
 #define MSG_USER_WARN_RES_FAIL                      ("[WARNING] Failed to receive response from server.\n")
 #define MSG_USER_WARN_RES_INVALID                   ("[WARNING] Invalid server response.\n")
 #define MSG_USER_WARN_RECV_AUTH_FAIL                ("[WARNING] Failed to receive authentication response from server.\n")
-#define MSG_USER_WARN_RECV_CONF_HUM_FAIL            ("[WARNING] Failed to receive humidity config from server.\n")
-#define MSG_USER_WARN_RECV_CONF_IIR_FAIL            ("[WARNING] Failed to receive IIR filter config from server.\n")
-#define MSG_USER_WARN_RECV_CONF_PRD_FAIL            ("[WARNING] Failed to receive measurement period from server.\n")
-#define MSG_USER_WARN_RECV_CONF_PRS_FAIL            ("[WARNING] Failed to receive pressure config from server.\n")
-#define MSG_USER_WARN_RECV_CONF_TMP_FAIL            ("[WARNING] Failed to receive temperature config from server.\n")
+#define MSG_USER_WARN_RECV_AGG_FAIL                 ("[WARNING] Failed to receive aggregates from server.\n")
+#define MSG_USER_WARN_RECV_DSMP_FAIL                ("[WARNING] Failed to receive downsampled data from server.\n")
+#define MSG_USER_WARN_RECV_LATEST_FAIL              ("[WARNING] Failed to receive latest sample from server.\n")
+#define MSG_USER_WARN_RECV_LIVE_FAIL                ("[WARNING] Failed to receive pushed samples from server.\n")
+#define MSG_USER_WARN_RECV_STATS_FAIL               ("[WARNING] Failed to receive server statistics.\n")
+#define MSG_USER_WARN_RECV_TRACE_FAIL               ("[WARNING] Failed to receive server trace.\n")
+#define MSG_USER_WARN_TRACE_FILE_FAIL               ("[WARNING] Failed to write server trace file.\n")
+#define MSG_USER_WARN_RECV_HIST_FAIL                ("[WARNING] Failed to receive recent samples from server.\n")
+#define MSG_USER_WARN_RECV_CONF_FAIL                ("[WARNING] Failed to receive sensor config from server.\n")
 #define MSG_USER_WARN_RECV_FDATA_FAIL               ("[WARNING] Failed to receive measurement data from remote server.\n")
 #define MSG_USER_WARN_RECV_FDATA_SIZE_FAIL          ("[WARNING] Failed to receive measurement data file size from server.\n")
+#define MSG_USER_WARN_RECV_SENS_LIST_FAIL           ("[WARNING] Failed to receive sensor list from server.\n")
 #define MSG_USER_WARN_RECV_FDATA_NOT_AVL            ("[WARNING] Measurement data not available on server.\n")
 #define MSG_USER_WARN_SEND_NAME_FAIL                ("[WARNING] Failed to send username to server.\n")
 #define MSG_USER_WARN_SEND_PWD_FAIL                 ("[WARNING] Failed to send password to server.\n")
@@ -76,38 +127,97 @@
 #define MEAS_DATA_FD_INVALID                       (-1)                // Measurement data invalid file descriptor
 #define MEAS_DATA_FILE_NAME                        ("meas_data")   // Measurement data file name
 #define MEAS_DATA_FILE_NAME_LEN                    (14)                // Measurement data file name length
+#define TRACE_FILE_NAME                            ("trace.json")  // Server trace file name (without one given)
+#define TRACE_CHUNK_LEN                            (4096)              // Server trace received and written at once
 #define MEAS_DATA_FILE_PATH_LEN                    (PATH_MAX + 1 + MEAS_DATA_FILE_NAME_LEN)
+#define MEAS_DATA_INVALID_VALUE                     (-1.0f)     // [SHARED UNDER SAVED_DATA_INVALID_VALUE] Value of disabled channels
+#define MEAS_DATA_COLUMNS                           (4)         // Columns of a data columns request (TMP, HUM, PRS, TIME)
+#define MEAS_DATA_COLUMN_TIME                       (3)         // Index of the time column
+#define MEAS_DATA_RECV_RECORDS                      (256)       // Column entries received at once
+#define WAIT_TIMEOUT_DEFAULT_MS                     (10000)     // Default timeout of the wait command [msec]
+#define LIVE_VIEW_RECV_BUF_SIZE                     (1024)      // Receive buffer of pushed sample frames
+#define MCAST_REPAIR_MAX                            (256)       // Lost samples fetched at most (samples kept in server memory)
+#define MEAS_DATA_TIME_STR_LEN                      (32)        // Length of printed record time
 
 /* Conditions */
 #define COND_EXIT_FALSE                             ((uint8_t)0)
 #define COND_EXIT_TRUE                              ((uint8_t)1)
+#define COND_LIVE_VIEW_FALSE                        ((uint8_t)0)
+#define COND_LIVE_VIEW_TRUE                         ((uint8_t)1)
 
 /* Pollset entries */
-#define POLL_ARRAY_SIZE                             (2)
+#define POLL_ARRAY_SIZE                             (3)
 #define POLL_ARRAY_SOCKET                           (0)
 #define POLL_ARRAY_STDIN                            (1)
+#define POLL_ARRAY_MCAST                            (2)         // Multicast listener (INVALID_FD: not listening)
 
 #define INVALID_FD                                  ((int)-1)
 
-#define INPUT_BUFFER_SIZE                           (60)
-#define MAX_NUM_OF_ARGS                             (4)
+#define USEC_PER_MSEC                               (1000ULL)
+#define USEC_PER_SEC                                (1000000ULL)
+#define SEC_PER_MIN                                 (60ULL)
+#define SEC_PER_HOUR                                (3600ULL)
+#define SEC_PER_DAY                                 (86400ULL)
+
+#define INPUT_BUFFER_SIZE                           (160)
+#define MAX_NUM_OF_ARGS                             (28)        // Command and up to 8 config fields (mconf)
 
 /* User command string representations */
 #define STR_CMD_CONNECT                             ("conn")
 #define STR_CMD_DISCONNECT                          ("dconn")
 #define STR_CMD_SET_CONFIG                          ("sconf")
+#define STR_CMD_MULTI_SET_CONFIG                    ("mconf")
 #define STR_CMD_SHOW_DATA                           ("show")
 #define STR_CMD_GET_CONFIG                          ("gconf")
+#define STR_CMD_LATEST                              ("latest")
+#define STR_CMD_WAIT                                ("wait")
 #define STR_CMD_REMOVE_DATA                         ("rmdat")
 #define STR_CMD_GET_DATA                            ("gdat")
 #define STR_CMD_EXIT                                ("exit")
+#define STR_CMD_LIST_SENSORS                        ("lsens")
+#define STR_CMD_SELECT_SENSOR                       ("ssel")
+#define STR_CMD_AGGREGATE                           ("agg")
+#define STR_CMD_DOWNSAMPLE                          ("dsmp")
+#define STR_CMD_SUBSCRIBE                           ("sub")
+#define STR_CMD_UNSUBSCRIBE                         ("unsub")
+#define STR_CMD_MULTICAST                           ("mcast")
+#define STR_CMD_MULTICAST_OFF                       ("off")
+#define STR_CMD_STATS                               ("stats")
+#define STR_CMD_TRACE                               ("trace")
+
+#define STR_CMD_WAIT_AFTER                          ("after")
+#define STR_CMD_WAIT_TIMEOUT                        ("timeout")
+
+#define STR_CMD_SUB_EVERY                           ("every")
+#define STR_CMD_SUB_POLICY                          ("policy")
+#define STR_CMD_SUB_POLICY_DROP                     ("drop")
+#define STR_CMD_SUB_POLICY_COALESCE                 ("coalesce")
+#define STR_CMD_SUB_POLICY_DISCONNECT               ("disconnect")
+
+#define STR_CMD_GDAT_TIME                           ("TIME")
+
+#define STR_CMD_AGG_FROM                            ("from")
+#define STR_CMD_AGG_TO                              ("to")
+#define STR_CMD_AGG_BUCKET                          ("bucket")
+#define STR_CMD_AGG_UNIT_SEC                        ("s")
+#define STR_CMD_AGG_UNIT_MIN                        ("m")
+#define STR_CMD_AGG_UNIT_HOUR                       ("h")
+#define STR_CMD_AGG_UNIT_DAY                        ("d")
+
+#define STR_CMD_DSMP_LTTB                           ("lttb")
+#define STR_CMD_DSMP_EVERY                          ("every")
 
 #define STR_CMD_SCONF_IIR_FILTER                    ("IIR")
 #define STR_CMD_SCONF_HUMIDITY                      ("HUM")
+#define STR_CMD_SCONF_MODE                          ("MOD")     // ON: normal (continuous) mode, OFF: forced mode
 #define STR_CMD_SCONF_PERIOD                        ("PRD")
 #define STR_CMD_SCONF_PRESSURE                      ("PRS")
 #define STR_CMD_SCONF_TEMPERATURE                   ("TMP")
 
+#define STR_CMD_SCONF_PERIOD_UNIT_SEC               ("s")
+#define STR_CMD_SCONF_PERIOD_UNIT_MS                ("ms")
+#define STR_CMD_SCONF_PERIOD_UNIT_US                ("us")
+
 #define STR_CMD_SCONF_OFF                           ("OFF")
 #define STR_CMD_SCONF_ON                            ("ON")
 
@@ -124,10 +234,24 @@
 #define STR_CMD_SCONF_IIR_COEFF_8                   ("COEFF_8")     // [SHARED UNDER RES_STR_SCONF_IIR_CO...]
 #define STR_CMD_SCONF_IIR_COEFF_16                  ("COEFF_16")    // [SHARED UNDER RES_STR_SCONF_IIR_CO...]
 
+#define STR_CONF_MODE_FORCED                        ("FORCED")  // Config strings of 'gconf' (not commands)
+#define STR_CONF_MODE_NORMAL                        ("NORMAL")
+#define STR_CONF_OFF                                ("X")
+#define STR_CONF_ERR                                ("ERROR")
+
 /* User data related macros */
 #define USR_NAME_MAX_LENGTH                         (32)        // [SHARED]
 #define USR_PWD_MAX_LENGTH                          (32)        // [SHARED]
 
+/* Multi-sensor related macros */
+#define SENSOR_ARRAY_SIZE                           (8)         // [SHARED] Max. number of sensors
+#define SENSOR_DESC_LEN                             (64)        // [SHARED] Sensor description length (list sensors)
+
+/* UDP multicast sample feed related macros */
+#define SAMPLE_MCAST_PORT                           (2234)      // [SHARED] Default UDP port of the multicast feed
+#define SAMPLE_MCAST_VERSION                        (1)         // [SHARED] Datagram layout version
+#define SAMPLE_MCAST_DGRAM_LEN                      (40)        // [SHARED] Datagram: version <1>, sensor ID <1>, reserved <2>, stream ID <4>, sample <RES_LATEST_LEN>
+
 /* Server response related macros */
 #define RES_CODE_AUTH_FAIL                          (0x00)      // [SHARED] Client authentication failed
 #define RES_CODE_AUTH_SUCCESS                       (0x01)      // [SHARED] Client authentication suceeded
@@ -136,6 +260,9 @@
 #define RES_CODE_REQ_INVALID                        (0x04)      // [SHARED] Client request invalid
 #define RES_CODE_REQ_NO_PERM                        (0x05)      // [SHARED] Client does not have permission for request
 #define RES_CODE_REQ_SUCCESS                        (0x06)      // [SHARED] Client request succeeded
+#define RES_CODE_REQ_TIMEOUT                        (0x07)      // [SHARED] Client request timed out
+#define RES_CODE_PUSH_SAMPLE                        (0x08)      // [SHARED] Pushed sample frame
+#define RES_CODE_PUSH_END                           (0x09)      // [SHARED] End of pushed samples
 
 /* Client request related macros */
 #define REQ_CODE_DCONN                              (0x00)      // [SHARED] Request disconnection
@@ -143,12 +270,28 @@
 #define REQ_CODE_GCONF                              (0x02)      // [SHARED] Request to get sensor configuration
 #define REQ_CODE_RMDAT                              (0x04)      // [SHARED] Request to remove sensor data
 #define REQ_CODE_GDAT                               (0x08)      // [SHARED] Request to get sensor data
+#define REQ_CODE_SSEL                               (0x10)      // [SHARED] Request to select sensor
+#define REQ_CODE_SLIST                              (0x11)      // [SHARED] Request to list sensors
+#define REQ_CODE_MCONF                              (0x12)      // [SHARED] Request to set several sensor configurations at once
+#define REQ_CODE_GCONFB                             (0x13)      // [SHARED] Request to get sensor configuration (binary)
+#define REQ_CODE_AGG                                (0x14)      // [SHARED] Request to aggregate sensor data
+#define REQ_CODE_DSMP                               (0x15)      // [SHARED] Request to get downsampled sensor data
+#define REQ_CODE_GDATP                              (0x16)      // [SHARED] Request to get selected columns of sensor data
+#define REQ_CODE_LATEST                             (0x17)      // [SHARED] Request to get latest sample
+#define REQ_CODE_WAIT                               (0x18)      // [SHARED] Request to wait for a new sample
+#define REQ_CODE_SUB                                (0x19)      // [SHARED] Request to subscribe to new samples
+#define REQ_CODE_UNSUB                              (0x1A)      // [SHARED] End of subscription (sent while subscribed)
+#define REQ_CODE_HIST                               (0x1B)      // [SHARED] Request to get recent samples by sequence number
+#define REQ_CODE_STATS                              (0x1C)      // [SHARED] Request to get server statistics
+#define REQ_CODE_TRACE                              (0x1D)      // [SHARED] Request to get recorded spans (Chrome trace JSON)
 
 #define REQ_CONF_PRD                                (0x01)      // [SHARED] Request to config period
 #define REQ_CONF_IIR                                (0x02)      // [SHARED] Request to config IIR filter
 #define REQ_CONF_HUM                                (0x03)      // [SHARED] Request to config humidity
 #define REQ_CONF_PRS                                (0x04)      // [SHARED] Request to config pressure
 #define REQ_CONF_TMP                                (0x05)      // [SHARED] Request to config temperature
+#define REQ_CONF_PRD_US                             (0x06)      // [SHARED] Request to config period in microseconds
+#define REQ_CONF_MODE                               (0x07)      // [SHARED] Request to config acquisition mode (ON: normal, OFF: forced)
 
 #define REQ_CONF_TYPE_MASK                          (0x07)      // [SHARED] Config type mask
 
@@ -172,9 +315,89 @@
 
 #define REQ_CONF_VALUE_MASK                         (0xF0)      // [SHARED] Config value mask
 
+#define REQ_MCONF_FIELDS_MAX                        (8)         // [SHARED] Max. number of config fields per multi-config request
+#define REQ_MCONF_FIELD_LEN                         (5)         // [SHARED] Config field: parameters <1 byte>, value <4 bytes>
+
+#define RES_GCONFB_LEN                              (17)        // [SHARED] Binary config: version <4>, period <8>, TMP, HUM, PRS, IIR, MOD <1 each>
+#define RES_AGG_BUCKET_LEN                          (8)         // [SHARED] Aggregate bucket: start time <8> (usec), then stats per channel
+#define RES_AGG_STATS_LEN                           (20)        // [SHARED] Channel stats: count <4>, min, max, mean, stddev <4 each, float>
+#define RES_DSMP_POINT_LEN                          (12)        // [SHARED] Point: time <8> (usec), value <4, float>
+#define RES_GDATP_TIME_LEN                          (8)         // [SHARED] Time column entry: time <8> (usec)
+#define RES_GDATP_VALUE_LEN                         (4)         // [SHARED] Channel column entry: value <4, float>
+#define RES_LATEST_LEN                              (32)        // [SHARED] Latest sample: seq <8>, time <8> (usec), TMP, HUM, PRS <4 each, float>, config version <4>
+#define RES_PUSH_HEADER_LEN                         (17)        // [SHARED] Sample frame: code <1>, seq <8>, time <8> (usec), then subscribed channels <4 each, float>
+#define RES_PUSH_FRAME_MAX_LEN                      (29)        // [SHARED] Sample frame with all channels
+#define RES_PUSH_END_LEN                            (5)         // [SHARED] End frame: code <1>, dropped samples <4>
+#define RES_STATS_HEADER_LEN                        (10)        // [SHARED] Statistics: uptime <8> (usec), number of counters <1>, number of histograms <1>
+#define RES_STATS_COUNTER_LEN                       (9)         // [SHARED] Counter: ID <1>, value <8>
+#define RES_STATS_HIST_LEN                          (66)        // [SHARED] Histogram: ID <1>, key <1>, count, mean, min, p50, p90, p99, p99.9, max <8 each>
+#define RES_TRACE_HEADER_LEN                        (5)         // [SHARED] Trace: code <1>, JSON length <4>, then JSON
+
+#define STATS_CNT_CONN                              (0x00)      // [SHARED] Connections accepted
+#define STATS_CNT_AUTH_FAIL                         (0x01)      // [SHARED] Authentications failed
+#define STATS_CNT_REQ                               (0x02)      // [SHARED] Requests served
+#define STATS_CNT_REQ_FAIL                          (0x03)      // [SHARED] Requests failed
+#define STATS_CNT_GDAT_BYTES                        (0x04)      // [SHARED] Bytes sent by GDAT requests
+#define STATS_CNT_SAMPLE                            (0x05)      // [SHARED] Samples measured
+#define STATS_CNT_SAMPLE_FAIL                       (0x06)      // [SHARED] Measurements failed
+#define STATS_CNT_LOG_FORWARDED                     (0x07)      // [SHARED] Log events forwarded to syslog
+#define STATS_CNT_LOG_DROPPED                       (0x08)      // [SHARED] Log events dropped
+#define STATS_CNT_LOG_SUPPRESSED                    (0x09)      // [SHARED] Log events suppressed by rate limiting
+#define STATS_CNT_COUNT                             (10)        // [SHARED] Number of counters
+
+#define STATS_HIST_ACCEPT_AUTH                      (0x00)      // [SHARED] Accept to authentication [nsec]
+#define STATS_HIST_REQUEST                          (0x01)      // [SHARED] Request handler latency [nsec] (key: request code)
+#define STATS_HIST_GDAT_BYTES                       (0x02)      // [SHARED] Bytes sent per GDAT request
+#define STATS_HIST_SENS_BUS                         (0x03)      // [SHARED] Sensor bus transactions per sample [nsec]
+#define STATS_HIST_SENS_CONV                        (0x04)      // [SHARED] Sensor conversion, trigger to completion [nsec]
+#define STATS_HIST_SAVE_APPEND                      (0x05)      // [SHARED] Saved data batch append [nsec]
+#define STATS_HIST_SAMPLE_JITTER                    (0x06)      // [SHARED] Measure thread wake-up past schedule [nsec]
+#define STATS_HIST_LOCK_WAIT                        (0x07)      // [SHARED] Lock wait [nsec] (key: lock site ID, see server log)
+#define STATS_HIST_LOCK_HOLD                        (0x08)      // [SHARED] Lock hold [nsec] (key: lock site ID, see server log)
+#define STATS_HIST_COUNT                            (9)         // Number of histogram IDs
+
+#define REQ_AGG_CH_TMP                              (0x01)      // [SHARED] Aggregate temperature
+#define REQ_AGG_CH_HUM                              (0x02)      // [SHARED] Aggregate humidity
+#define REQ_AGG_CH_PRS                              (0x04)      // [SHARED] Aggregate pressure
+#define REQ_AGG_CH_MASK                             (0x07)      // [SHARED] Aggregated channel mask
+#define REQ_AGG_LEN                                 (25)        // [SHARED] Query: from <8>, to <8>, bucket width <8> (usec), channels <1>
+#define REQ_AGG_BUCKETS_MAX                         (1024)      // [SHARED] Max. number of buckets per query
+
+#define REQ_GDATP_CH_TIME                           (0x08)      // [SHARED] Sample time column (channels use REQ_AGG_CH_...)
+#define REQ_GDATP_CH_MASK                           (0x0F)      // [SHARED] Column mask
+
+#define REQ_WAIT_LEN                                (12)        // [SHARED] Query: sequence number <8>, timeout <4> (msec)
+#define REQ_WAIT_TIMEOUT_MAX_MS                     (300000)    // [SHARED] Max. wait timeout [msec]
+
+#define REQ_SUB_POLICY_DROP_OLDEST                  (0x01)      // [SHARED] Slow subscriber: drop oldest queued samples
+#define REQ_SUB_POLICY_COALESCE                     (0x02)      // [SHARED] Slow subscriber: replace newest queued sample
+#define REQ_SUB_POLICY_DISCONNECT                   (0x03)      // [SHARED] Slow subscriber: disconnect
+#define REQ_SUB_LEN                                 (6)         // [SHARED] Query: channels <1>, decimation <4>, policy <1>
+#define REQ_SUB_DECIMATION_MAX                      (1000000)   // [SHARED] Max. decimation (push every n-th sample)
+
+#define REQ_HIST_LEN                                (10)        // [SHARED] Query: sensor ID <1>, first sequence number <8>, count <1>
+#define REQ_HIST_COUNT_MAX                          (64)        // [SHARED] Max. samples per query
+
+#define REQ_DSMP_MODE_LTTB                          (0x01)      // [SHARED] Largest-Triangle-Three-Buckets (parameter: number of points)
+#define REQ_DSMP_MODE_RESAMPLE                      (0x02)      // [SHARED] Linear interpolation to a fixed interval (parameter: interval [usec])
+#define REQ_DSMP_LEN                                (26)        // [SHARED] Query: from <8>, to <8>, parameter <8>, mode <1>, channels <1>
+#define REQ_DSMP_POINTS_MIN                         (3)         // [SHARED] Min. number of points per channel (LTTB)
+#define REQ_DSMP_POINTS_MAX                         (10000)     // [SHARED] Max. number of points per channel
+
+/* Measurement data record (file layout) [SHARED UNDER SavedDataRecord] */
+struct MeasDataRecord {
+    
+    uint32_t timeSec;                   // Sample time (UNIX time) [sec]
+    uint32_t timeUsec;                  // Sample time fraction [usec]
+    float temp;
+    float hum;
+    float press;
+};
+
 /* Global variable declarations */
 extern uint8_t exitCondition;
 extern char measDataFilePath[MEAS_DATA_FILE_PATH_LEN];
+extern uint8_t liveViewCondition;
 
 /* Function declarations */
 
@@ -183,6 +406,11 @@ extern char measDataFilePath[MEAS_DATA_FILE_PATH_LEN];
  */
 int initMeasDataFilePath(char filePathBuf[]);
 
+/*
+ * Function 'openServerSocket': opens a socket connected to the server.
+ */
+int openServerSocket(const char *address, const char *portNumber);
+
 /*
  * Function 'connectServer': connects to the remote server.
  */
@@ -203,21 +431,111 @@ int exitProgram(struct pollfd pollArray[]);
  */
 int setSensorConfig(struct pollfd pollArray[], const char* args[]);
 
+/*
+ * Function 'parseConfigArgs': parses a config field of the sconf and mconf commands.
+ */
+int parseConfigArgs(const char* args[], uint8_t *configSel, uint32_t *confValue);
+
+/*
+ * Function 'multiSetSensorConfig': requests server to set several sensor configurations at once.
+ */
+int multiSetSensorConfig(struct pollfd pollArray[], const char* args[]);
+
 /*
  * Function 'getSensorConfig': requests server to get sensor configuration.
  */
 int getSensorConfig(struct pollfd pollArray[]);
 
+/*
+ * Function 'getLatestSample': requests server to get the latest sample.
+ */
+int getLatestSample(struct pollfd pollArray[]);
+
 /*
  * Function 'getSensorData': requests server to get sensor data.
  */
 int getSensorData(struct pollfd pollArray[]);
 
+/*
+ * Function 'getSensorColumns': requests server to get selected columns of sensor data.
+ */
+int getSensorColumns(struct pollfd pollArray[], const char* args[]);
+
 /*
  * Function 'removeSensorData': requests server to remove sensor data.
  */
 int removeSensorData(struct pollfd pollArray[]);
 
+/*
+ * Function 'sendRequestCode': sends a request code to the server and checks its validation.
+ */
+int sendRequestCode(struct pollfd pollArray[], uint8_t request);
+
+/*
+ * Function 'selectSensor': requests server to select the sensor subsequent requests refer to.
+ */
+int selectSensor(struct pollfd pollArray[], const char* args[]);
+
+/*
+ * Function 'listSensors': requests server to list its sensors.
+ */
+int listSensors(struct pollfd pollArray[]);
+
+/*
+ * Function 'aggregateSensorData': requests server to aggregate sensor data.
+ */
+int aggregateSensorData(struct pollfd pollArray[], const char* args[]);
+
+/*
+ * Function 'downsampleSensorData': requests server to downsample sensor data for charting.
+ */
+int downsampleSensorData(struct pollfd pollArray[], const char* args[]);
+
+/*
+ * Function 'waitSample': requests server to send the first sample newer than a known one.
+ */
+int waitSample(struct pollfd pollArray[], const char* args[]);
+
+/*
+ * Function 'subscribeSamples': requests server to push new samples (live view).
+ */
+int subscribeSamples(struct pollfd pollArray[], const char* args[]);
+
+/*
+ * Function 'receiveLiveSamples': receives and prints the samples pushed by the server.
+ */
+int receiveLiveSamples(struct pollfd pollArray[]);
+
+/*
+ * Function 'stopLiveView': ends the subscription and waits for the remaining pushed samples.
+ */
+int stopLiveView(struct pollfd pollArray[]);
+
+/*
+ * Function 'startMulticastListener': joins the multicast feed of the server.
+ */
+int startMulticastListener(struct pollfd pollArray[], const char* args[]);
+
+/*
+ * Function 'stopMulticastListener': leaves the multicast feed of the server.
+ */
+int stopMulticastListener(struct pollfd pollArray[]);
+
+/*
+ * Function 'receiveMulticastSamples': receives and prints a sample of the multicast feed.
+ */
+int receiveMulticastSamples(struct pollfd pollArray[]);
+
+/*
+ * Function 'getServerStats': requests server statistics and prints them.
+ */
+int getServerStats(struct pollfd pollArray[]);
+
+/*
+ * Function 'getServerTrace': requests the recorded spans of the server and saves them to a file.
+ */
+int getServerTrace(struct pollfd pollArray[], const char *path);
+
 /*
  * Function 'showSensorData': show measurement data records transferred from server.
  */
@@ -8,6 +8,8 @@
  * Compile like this:
  * 
  * gcc -O0 -ggdb -Wall -o mysensor mysensor.c client.c -I/home/lprog/MyLinuxProg/LinuxHomework/Client
+ * 
+ * Run like this: ./mysensor ::1 2233 or ./mysensor /tmp/myserver.sock (Unix socket of a local server)
  */
 
 #include <stdio.h>
@@ -22,6 +24,7 @@
 /* Declare global variables */
 uint8_t exitCondition;
 char measDataFilePath[MEAS_DATA_FILE_PATH_LEN];
+uint8_t liveViewCondition;
 
 int main(int argc, char* argv[]) {
     
@@ -29,15 +32,16 @@ int main(int argc, char* argv[]) {
     struct pollfd pollArray[POLL_ARRAY_SIZE];
     
     /* Check arguments */
-    if((argc != 3) && (argc != 1)) {
+    if((argc != 3) && (argc != 2) && (argc != 1)) {
         
-        fprintf(stdout, "Usage: %s [server IP] [server port]\n", argv[0]);
+        fprintf(stdout, "Usage: %s [server IP server port | server socket path]\n", argv[0]);
         fflush(stdout);
         return EXIT_FAILURE;
     }
     
     /* Initialize global variables */
     exitCondition = COND_EXIT_FALSE;
+    liveViewCondition = COND_LIVE_VIEW_FALSE;
     
     memset(measDataFilePath, 0 ,sizeof(measDataFilePath));
     initMeasDataFilePath(measDataFilePath);
@@ -47,12 +51,18 @@ int main(int argc, char* argv[]) {
     pollArray[POLL_ARRAY_SOCKET].events = POLLIN;
     pollArray[POLL_ARRAY_STDIN].fd = STDIN_FILENO;
     pollArray[POLL_ARRAY_STDIN].events = POLLIN;
+    pollArray[POLL_ARRAY_MCAST].fd = INVALID_FD;
+    pollArray[POLL_ARRAY_MCAST].events = POLLIN;
     
     /* Connect to server if specified in the launch arguments */
     if(3 == argc) {
         
         connectServer(argv[1], argv[2], pollArray);
     }
+    else if(2 == argc) {
+        
+        connectServer(argv[1], NULL, pollArray);
+    }
     
     while(!exitCondition) {
         
@@ -69,16 +79,32 @@ int main(int argc, char* argv[]) {
                 
                 close(pollArray[POLL_ARRAY_SOCKET].fd);
                 pollArray[POLL_ARRAY_SOCKET].fd = INVALID_FD;
+                liveViewCondition = COND_LIVE_VIEW_FALSE;
             }
             else if(pollArray[POLL_ARRAY_SOCKET].revents & (POLLIN)) {
                 
                 /* Message received from server */
                 
-                /*
-                 * Default: server should not send data if not requested !
-                 * Empty buffer to prevent possible errors.
-                 */
-                recv(pollArray[POLL_ARRAY_SOCKET].fd ,&trash, sizeof(trash), 0);
+                if(COND_LIVE_VIEW_TRUE == liveViewCondition) {
+                    
+                    /* Samples pushed by server (live view) */
+                    receiveLiveSamples(pollArray);
+                }
+                else {
+                    
+                    /*
+                     * Default: server should not send data if not requested !
+                     * Empty buffer to prevent possible errors.
+                     */
+                    recv(pollArray[POLL_ARRAY_SOCKET].fd ,&trash, sizeof(trash), 0);
+                }
+            }
+            
+            if(pollArray[POLL_ARRAY_MCAST].revents & (POLLIN)) {
+                
+                /* Sample received from multicast feed */
+                
+                receiveMulticastSamples(pollArray);
             }
             
             if(pollArray[POLL_ARRAY_STDIN].revents & (POLLIN)) {
@@ -0,0 +1,699 @@
+/*
+ * FileName:    sensorbench.c
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ * 
+ * Desc.:       Load generator and protocol benchmark of the server. Opens several
+ *              authenticated connections at once, drives a weighted mix of GCONF, SCONF,
+ *              GDAT and LATEST requests on each of them (one thread per connection),
+ *              then prints the throughput and the latency distribution per request type.
+ * 
+ *              Closed loop (default): each connection sends its next request as soon as
+ *              the previous one is answered. Target rate (-r): requests are scheduled at
+ *              fixed intervals spread over the connections, latency is measured from the
+ *              scheduled time, so a server falling behind shows in the latency instead
+ *              of silently lowering the offered load.
+ * 
+ *              Each connection takes a service thread of the server for its lifetime,
+ *              connections beyond the thread pool of the server are not authenticated
+ *              within BENCH_RECV_TIMEOUT_SEC and are left out of the measurement.
+ * 
+ *              SCONF writes back the temperature configuration read at connect time, so
+ *              the benchmark exercises the configuration path without changing it.
+ * 
+ * Compile like this:
+ * 
+ * gcc -O2 -Wall -o sensorbench sensorbench.c client.c -pthread -I/home/lprog/MyLinuxProg/LinuxHomework/Client
+ * 
+ * Run like this: ./sensorbench -c 8 -d 10 -m gconf=4,latest=4,sconf=1,gdat=1 ::1 2233
+ *                (e.g. against a server started as ./myserver -t sim, SCONF needs a user of the config group)
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include "client.h"
+
+#define BENCH_CONN_DEFAULT          (4)         // Number of connections
+#define BENCH_CONN_MAX              (1024)
+#define BENCH_DURATION_DEFAULT      (10)        // Duration of the measurement [sec]
+#define BENCH_MIX_DEFAULT           ("gconf=4,latest=4,sconf=1,gdat=1")
+#define BENCH_USER_DEFAULT          ("user1")
+#define BENCH_PWD_DEFAULT           ("pass1")
+#define BENCH_OPT_STRING            ("c:d:r:m:u:p:")
+#define BENCH_USAGE                 ("Usage: %s [-c connections] [-d duration sec] [-r target rate req/s (0: closed loop)] [-m mix, e.g. %s] [-u username] [-p password] <server IP server port | server socket path>\n")
+#define BENCH_RECV_BUF_SIZE         (65536)     // Scratch buffer of received data (GDAT)
+#define BENCH_LATENCY_INIT_LEN      (4096)      // Initial latency records per request type and connection
+#define BENCH_RECV_TIMEOUT_SEC      (5)         // Authentications and responses not received in time fail
+#define BENCH_NSEC_PER_SEC          (1000000000ULL)
+#define BENCH_NSEC_PER_USEC         (1000ULL)
+
+#define BENCH_REQ_GCONF             (0)
+#define BENCH_REQ_SCONF             (1)
+#define BENCH_REQ_GDAT              (2)
+#define BENCH_REQ_LATEST            (3)
+#define BENCH_REQ_COUNT             (4)
+
+#define BENCH_GCONFB_TMP_OFFSET     (12)        // Temperature config in the binary config (after version and period)
+
+/* Benchmarked request type */
+struct BenchRequest {
+    
+    const char *name;                   // Name in the mix (user command)
+    uint8_t requestCode;
+};
+
+/* Connection under load (written by its thread only) */
+struct BenchConn {
+    
+    pthread_t thread;
+    int id;
+    int socket;
+    uint8_t tmpConfig;                  // Temperature config written back by SCONF
+    uint64_t *latency[BENCH_REQ_COUNT]; // Request latencies [nsec]
+    size_t latencyCount[BENCH_REQ_COUNT];
+    size_t latencySize[BENCH_REQ_COUNT];
+    uint64_t errorCount[BENCH_REQ_COUNT];
+    uint64_t reconnectCount;
+};
+
+/* Request types (GCONF is sent in the binary form, as by mysensor) */
+static const struct BenchRequest benchRequestTable[BENCH_REQ_COUNT] = {
+    
+    {STR_CMD_GET_CONFIG, REQ_CODE_GCONFB},
+    {STR_CMD_SET_CONFIG, REQ_CODE_SCONF},
+    {STR_CMD_GET_DATA, REQ_CODE_GDAT},
+    {STR_CMD_LATEST, REQ_CODE_LATEST}
+};
+
+/* Declare global variables (used by client.c) */
+uint8_t exitCondition;
+char measDataFilePath[MEAS_DATA_FILE_PATH_LEN];
+uint8_t liveViewCondition;
+
+/* Benchmark settings */
+static const char *benchAddress = NULL;
+static const char *benchPort = NULL;
+static const char *benchUser = BENCH_USER_DEFAULT;
+static const char *benchPassword = BENCH_PWD_DEFAULT;
+static uint32_t benchWeight[BENCH_REQ_COUNT];
+static uint32_t benchWeightSum = 0;
+static int benchConnCount = BENCH_CONN_DEFAULT;
+static double benchRate = 0.0;                          // Target rate of all connections [req/s] (0: closed loop)
+
+/* Measurement window (set by the main thread between the barriers) */
+static pthread_barrier_t benchBarrier;
+static uint64_t benchStartNs = 0;
+static uint64_t benchEndNs = 0;
+
+/*
+ * Function 'getBenchTimeNs': returns the time of the monotonic clock in nanoseconds.
+ */
+static uint64_t getBenchTimeNs(void) {
+    
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return (uint64_t)now.tv_sec * BENCH_NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+/*
+ * Function 'sleepBenchUntil': sleeps until a time of the monotonic clock [nsec].
+ */
+static void sleepBenchUntil(uint64_t timeNs) {
+    
+    struct timespec wakeup;
+    
+    wakeup.tv_sec = (time_t)(timeNs / BENCH_NSEC_PER_SEC);
+    wakeup.tv_nsec = (long)(timeNs % BENCH_NSEC_PER_SEC);
+    
+    while(0 != clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, NULL));
+}
+
+/*
+ * Function 'recvBench': receives an exact number of bytes.
+ */
+static int recvBench(int socket, void *buf, size_t len) {
+    
+    return ((ssize_t)len == recv(socket, buf, len, MSG_WAITALL)) ? 0 : -1;
+}
+
+/*
+ * Function 'sendBenchRequestCode': sends a request code and checks its validation.
+ */
+static int sendBenchRequestCode(int socket, uint8_t request) {
+    
+    uint8_t response = 0;
+    
+    if((sizeof(request) != send(socket, &request, sizeof(request), MSG_NOSIGNAL)) ||
+       (0 != recvBench(socket, &response, sizeof(response))) || (RES_CODE_REQ_ACCEPT != response)) {
+        
+        return -1;
+    }
+    
+    return 0;
+}
+
+/*
+ * Function 'runBenchRequest': sends a request and receives its whole response.
+ * 
+ * Note:    Protocols as in client.c (getSensorConfig, setSensorConfig, getSensorData,
+ *          getLatestSample), the received data is discarded.
+ */
+static int runBenchRequest(struct BenchConn *conn, int type, uint8_t recvBuf[BENCH_RECV_BUF_SIZE]) {
+    
+    uint8_t response = 0;
+    int32_t dataFileSize = 0;
+    size_t len;
+    
+    if(0 != sendBenchRequestCode(conn->socket, benchRequestTable[type].requestCode)) {
+        
+        return -1;
+    }
+    
+    if(BENCH_REQ_GCONF == type) {
+        
+        return recvBench(conn->socket, recvBuf, RES_GCONFB_LEN);
+    }
+    
+    if(BENCH_REQ_LATEST == type) {
+        
+        return recvBench(conn->socket, recvBuf, RES_LATEST_LEN);
+    }
+    
+    if(BENCH_REQ_SCONF == type) {
+        
+        if((sizeof(conn->tmpConfig) != send(conn->socket, &(conn->tmpConfig), sizeof(conn->tmpConfig), MSG_NOSIGNAL)) ||
+           (0 != recvBench(conn->socket, &response, sizeof(response))) || (RES_CODE_REQ_SUCCESS != response)) {
+            
+            return -1;
+        }
+        
+        return 0;
+    }
+    
+    /* GDAT: file size, then file content */
+    if((0 != recvBench(conn->socket, &dataFileSize, sizeof(dataFileSize))) || (dataFileSize < 0)) {
+        
+        return -1;
+    }
+    
+    while(dataFileSize > 0) {
+        
+        len = ((size_t)dataFileSize < BENCH_RECV_BUF_SIZE) ? (size_t)dataFileSize : BENCH_RECV_BUF_SIZE;
+        if(0 != recvBench(conn->socket, recvBuf, len)) {
+            
+            return -1;
+        }
+        
+        dataFileSize -= (int32_t)len;
+    }
+    
+    return 0;
+}
+
+/*
+ * Function 'openBenchConn': connects and authenticates a connection, then reads the temperature config.
+ * 
+ * Protocol:    Client --> Server: username <USR_NAME_MAX_LENGTH bytes>, password <USR_PWD_MAX_LENGTH bytes>
+ *              Client <-- Server: result of authentication <1 byte>
+ */
+static int openBenchConn(struct BenchConn *conn) {
+    
+    char username[USR_NAME_MAX_LENGTH];
+    char password[USR_PWD_MAX_LENGTH];
+    uint8_t confMsg[RES_GCONFB_LEN];
+    uint8_t response = 0;
+    struct timeval timeout;
+    
+    memset(username, 0, sizeof(username));
+    memset(password, 0, sizeof(password));
+    strncpy(username, benchUser, sizeof(username) - 1);
+    strncpy(password, benchPassword, sizeof(password) - 1);
+    
+    conn->socket = openServerSocket(benchAddress, benchPort);
+    if(INVALID_FD == conn->socket) {
+        
+        return -1;
+    }
+    
+    /* Do not wait forever for a busy server */
+    timeout.tv_sec = BENCH_RECV_TIMEOUT_SEC;
+    timeout.tv_usec = 0;
+    setsockopt(conn->socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    
+    if((sizeof(username) != send(conn->socket, username, sizeof(username), MSG_NOSIGNAL)) ||
+       (sizeof(password) != send(conn->socket, password, sizeof(password), MSG_NOSIGNAL)) ||
+       (0 != recvBench(conn->socket, &response, sizeof(response))) || (RES_CODE_AUTH_SUCCESS != response)) {
+        
+        fprintf(stdout, MSG_USER_WARN_CONNECT_FAIL_AUTH);
+        fflush(stdout);
+        
+        close(conn->socket);
+        conn->socket = INVALID_FD;
+        return -1;
+    }
+    
+    if((0 != sendBenchRequestCode(conn->socket, REQ_CODE_GCONFB)) ||
+       (0 != recvBench(conn->socket, confMsg, sizeof(confMsg)))) {
+        
+        fprintf(stdout, MSG_USER_WARN_RECV_CONF_FAIL);
+        fflush(stdout);
+        
+        close(conn->socket);
+        conn->socket = INVALID_FD;
+        return -1;
+    }
+    
+    conn->tmpConfig = confMsg[BENCH_GCONFB_TMP_OFFSET];
+    
+    return 0;
+}
+
+/*
+ * Function 'closeBenchConn': disconnects a connection.
+ */
+static void closeBenchConn(struct BenchConn *conn) {
+    
+    uint8_t request = REQ_CODE_DCONN;
+    
+    if(INVALID_FD == conn->socket) {
+        
+        return;
+    }
+    
+    send(conn->socket, &request, sizeof(request), MSG_NOSIGNAL);
+    close(conn->socket);
+    conn->socket = INVALID_FD;
+}
+
+/*
+ * Function 'recordBenchLatency': records the latency of a request.
+ */
+static void recordBenchLatency(struct BenchConn *conn, int type, uint64_t latencyNs) {
+    
+    uint64_t *latency = NULL;
+    size_t size;
+    
+    if(conn->latencyCount[type] == conn->latencySize[type]) {
+        
+        size = (0 == conn->latencySize[type]) ? BENCH_LATENCY_INIT_LEN : conn->latencySize[type] * 2;
+        latency = (uint64_t*)realloc(conn->latency[type], size * sizeof(uint64_t));
+        if(NULL == latency) {
+            
+            /* Keep the records so far */
+            return;
+        }
+        
+        conn->latency[type] = latency;
+        conn->latencySize[type] = size;
+    }
+    
+    conn->latency[type][conn->latencyCount[type]++] = latencyNs;
+}
+
+/*
+ * Function 'pickBenchRequest': picks a request type by the weights of the mix.
+ */
+static int pickBenchRequest(unsigned int *seed) {
+    
+    uint32_t pick = (uint32_t)rand_r(seed) % benchWeightSum;
+    int type;
+    
+    for(type = 0; pick >= benchWeight[type]; type++) {
+        
+        pick -= benchWeight[type];
+    }
+    
+    return type;
+}
+
+/*
+ * Function 'benchThreadFunction': drives the load of a connection.
+ */
+static void* benchThreadFunction(void *arg) {
+    
+    struct BenchConn *conn = (struct BenchConn*)arg;
+    uint8_t recvBuf[BENCH_RECV_BUF_SIZE];
+    unsigned int seed = (unsigned int)(conn->id * 7919 + 1);
+    uint64_t intervalNs = 0;
+    uint64_t nextNs;
+    uint64_t startNs;
+    int connected;
+    int type;
+    
+    connected = (0 == openBenchConn(conn));
+    
+    /* Wait for every connection, then for the measurement window */
+    pthread_barrier_wait(&benchBarrier);
+    pthread_barrier_wait(&benchBarrier);
+    
+    if(!connected) {
+        
+        return NULL;
+    }
+    
+    /* Target rate: connections send in turn at fixed intervals */
+    if(benchRate > 0.0) {
+        
+        intervalNs = (uint64_t)((double)benchConnCount * (double)BENCH_NSEC_PER_SEC / benchRate);
+    }
+    
+    nextNs = benchStartNs + intervalNs * (uint64_t)conn->id / (uint64_t)benchConnCount;
+    
+    while(1) {
+        
+        if(0 != intervalNs) {
+            
+            if(nextNs >= benchEndNs) {
+                
+                break;
+            }
+            
+            sleepBenchUntil(nextNs);
+            startNs = nextNs;
+            nextNs += intervalNs;
+        }
+        else {
+            
+            startNs = getBenchTimeNs();
+            if(startNs >= benchEndNs) {
+                
+                break;
+            }
+        }
+        
+        type = pickBenchRequest(&seed);
+        if(0 != runBenchRequest(conn, type, recvBuf)) {
+            
+            /* The stream may be out of step, start over on a new connection */
+            conn->errorCount[type]++;
+            close(conn->socket);
+            conn->socket = INVALID_FD;
+            
+            conn->reconnectCount++;
+            if(0 != openBenchConn(conn)) {
+                
+                break;
+            }
+            
+            continue;
+        }
+        
+        recordBenchLatency(conn, type, getBenchTimeNs() - startNs);
+    }
+    
+    closeBenchConn(conn);
+    
+    return NULL;
+}
+
+/*
+ * Function 'parseBenchMix': parses the request mix, e.g. "gconf=4,latest=4,sconf=1,gdat=1".
+ */
+static int parseBenchMix(const char *mix) {
+    
+    char mixBuf[INPUT_BUFFER_SIZE];
+    char *save = NULL;
+    char *field = NULL;
+    char *value = NULL;
+    char *end = NULL;
+    unsigned long weight;
+    int type;
+    
+    memset(benchWeight, 0, sizeof(benchWeight));
+    benchWeightSum = 0;
+    
+    memset(mixBuf, 0, sizeof(mixBuf));
+    strncpy(mixBuf, mix, sizeof(mixBuf) - 1);
+    
+    for(field = strtok_r(mixBuf, ",", &save); NULL != field; field = strtok_r(NULL, ",", &save)) {
+        
+        value = strchr(field, '=');
+        if(NULL == value) {
+            
+            return -1;
+        }
+        
+        *value++ = '\0';
+        weight = strtoul(value, &end, 10);
+        if(('\0' != *end) || (end == value) || (weight > UINT16_MAX)) {
+            
+            return -1;
+        }
+        
+        for(type = 0; (type < BENCH_REQ_COUNT) && (0 != strcmp(field, benchRequestTable[type].name)); type++);
+        if(BENCH_REQ_COUNT == type) {
+            
+            return -1;
+        }
+        
+        benchWeight[type] = (uint32_t)weight;
+    }
+    
+    for(type = 0; type < BENCH_REQ_COUNT; type++) {
+        
+        benchWeightSum += benchWeight[type];
+    }
+    
+    return (0 == benchWeightSum) ? -1 : 0;
+}
+
+/*
+ * Function 'compareLatency': orders latency values for qsort.
+ */
+static int compareLatency(const void *a, const void *b) {
+    
+    uint64_t x = *((const uint64_t*)a);
+    uint64_t y = *((const uint64_t*)b);
+    
+    return (x > y) - (x < y);
+}
+
+/*
+ * Function 'getPercentile': returns a percentile of sorted values (quantile: 0.0 - 1.0).
+ */
+static uint64_t getPercentile(const uint64_t *sorted, size_t count, double quantile) {
+    
+    size_t rank = (size_t)(quantile * (double)count);
+    
+    /* Rank rounded up, 1-based */
+    if((double)rank < quantile * (double)count) {
+        
+        rank++;
+    }
+    
+    return sorted[(rank < 1) ? 0 : rank - 1];
+}
+
+/*
+ * Function 'printBenchResult': prints the throughput and the latency distribution of requests.
+ */
+static void printBenchResult(const char *name, uint64_t *latency, size_t count, uint64_t errorCount, double elapsedSec) {
+    
+    uint64_t sum = 0;
+    size_t i;
+    
+    if((0 == count) && (0 == errorCount)) {
+        
+        return;
+    }
+    
+    if(0 == count) {
+        
+        fprintf(stdout, "  %-8s %10zu %8llu %10.1f\n", name, count, (unsigned long long)errorCount, 0.0);
+        return;
+    }
+    
+    qsort(latency, count, sizeof(uint64_t), compareLatency);
+    for(i = 0; i < count; i++) {
+        
+        sum += latency[i];
+    }
+    
+    fprintf(stdout, "  %-8s %10zu %8llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", name, count, (unsigned long long)errorCount,
+            (double)count / elapsedSec,
+            (double)sum / (double)count / (double)BENCH_NSEC_PER_USEC,
+            (double)getPercentile(latency, count, 0.5) / (double)BENCH_NSEC_PER_USEC,
+            (double)getPercentile(latency, count, 0.99) / (double)BENCH_NSEC_PER_USEC,
+            (double)getPercentile(latency, count, 0.999) / (double)BENCH_NSEC_PER_USEC,
+            (double)latency[count - 1] / (double)BENCH_NSEC_PER_USEC);
+}
+
+int main(int argc, char* argv[]) {
+    
+    struct BenchConn *connArray = NULL;
+    uint64_t *latency = NULL;
+    uint64_t *allLatency = NULL;
+    size_t count;
+    size_t allCount = 0;
+    uint64_t errorCount;
+    uint64_t allErrorCount = 0;
+    uint64_t reconnectCount = 0;
+    unsigned long duration = BENCH_DURATION_DEFAULT;
+    const char *mix = BENCH_MIX_DEFAULT;
+    double elapsedSec;
+    int connected = 0;
+    int opt;
+    int type;
+    int i;
+    
+    /* Parse options */
+    while(-1 != (opt = getopt(argc, argv, BENCH_OPT_STRING))) {
+        
+        if('c' == opt) {
+            
+            benchConnCount = atoi(optarg);
+        }
+        else if('d' == opt) {
+            
+            duration = strtoul(optarg, NULL, 10);
+        }
+        else if('r' == opt) {
+            
+            benchRate = atof(optarg);
+        }
+        else if('m' == opt) {
+            
+            mix = optarg;
+        }
+        else if('u' == opt) {
+            
+            benchUser = optarg;
+        }
+        else if('p' == opt) {
+            
+            benchPassword = optarg;
+        }
+        else {
+            
+            /* Invalid option */
+            fprintf(stdout, BENCH_USAGE, argv[0], BENCH_MIX_DEFAULT);
+            return EXIT_FAILURE;
+        }
+    }
+    
+    if((optind + 1 != argc) && (optind + 2 != argc)) {
+        
+        fprintf(stdout, BENCH_USAGE, argv[0], BENCH_MIX_DEFAULT);
+        return EXIT_FAILURE;
+    }
+    
+    benchAddress = argv[optind];
+    benchPort = (optind + 2 == argc) ? argv[optind + 1] : NULL;
+    
+    if((benchConnCount < 1) || (benchConnCount > BENCH_CONN_MAX) || (0 == duration) || (benchRate < 0.0) ||
+       (0 != parseBenchMix(mix))) {
+        
+        fprintf(stdout, MSG_USER_WARN_INVALID_ARG);
+        fprintf(stdout, BENCH_USAGE, argv[0], BENCH_MIX_DEFAULT);
+        return EXIT_FAILURE;
+    }
+    
+    connArray = (struct BenchConn*)calloc((size_t)benchConnCount, sizeof(struct BenchConn));
+    if((NULL == connArray) || (0 != pthread_barrier_init(&benchBarrier, NULL, (unsigned int)benchConnCount + 1))) {
+        
+        perror("calloc");
+        return EXIT_FAILURE;
+    }
+    
+    /* Connect */
+    for(i = 0; i < benchConnCount; i++) {
+        
+        connArray[i].id = i;
+        connArray[i].socket = INVALID_FD;
+        if(0 != pthread_create(&(connArray[i].thread), NULL, benchThreadFunction, &(connArray[i]))) {
+            
+            perror("pthread_create");
+            return EXIT_FAILURE;
+        }
+    }
+    
+    pthread_barrier_wait(&benchBarrier);
+    
+    for(i = 0; i < benchConnCount; i++) {
+        
+        connected += (INVALID_FD != connArray[i].socket);
+    }
+    
+    fprintf(stdout, "[INFO] %d of %d connections authenticated, %s for %lu [sec], mix %s.\n", connected, benchConnCount,
+            (benchRate > 0.0) ? "target rate" : "closed loop", duration, mix);
+    fflush(stdout);
+    
+    /* Measure */
+    benchStartNs = getBenchTimeNs();
+    benchEndNs = benchStartNs + (uint64_t)duration * BENCH_NSEC_PER_SEC;
+    pthread_barrier_wait(&benchBarrier);
+    
+    for(i = 0; i < benchConnCount; i++) {
+        
+        pthread_join(connArray[i].thread, NULL);
+        reconnectCount += connArray[i].reconnectCount;
+    }
+    
+    elapsedSec = (double)(getBenchTimeNs() - benchStartNs) / (double)BENCH_NSEC_PER_SEC;
+    if(benchRate > 0.0) {
+        
+        fprintf(stdout, "[INFO] Target rate %.1f [req/s], ", benchRate);
+    }
+    else {
+        
+        fprintf(stdout, "[INFO] ");
+    }
+    
+    fprintf(stdout, "%lu reconnects after failed requests.\n\n", (unsigned long)reconnectCount);
+    fprintf(stdout, "  %-8s %10s %8s %10s %10s %10s %10s %10s %10s\n", "request", "count", "errors", "req/s",
+            "mean[us]", "p50[us]", "p99[us]", "p99.9[us]", "max[us]");
+    
+    /* Merge the connections per request type, then all types */
+    for(type = 0; type < BENCH_REQ_COUNT; type++) {
+        
+        count = 0;
+        errorCount = 0;
+        for(i = 0; i < benchConnCount; i++) {
+            
+            count += connArray[i].latencyCount[type];
+            errorCount += connArray[i].errorCount[type];
+        }
+        
+        latency = (uint64_t*)malloc((count + 1) * sizeof(uint64_t));
+        allLatency = (uint64_t*)realloc(allLatency, (allCount + count + 1) * sizeof(uint64_t));
+        if((NULL == latency) || (NULL == allLatency)) {
+            
+            perror("malloc");
+            return EXIT_FAILURE;
+        }
+        
+        count = 0;
+        for(i = 0; i < benchConnCount; i++) {
+            
+            memcpy(latency + count, connArray[i].latency[type], connArray[i].latencyCount[type] * sizeof(uint64_t));
+            count += connArray[i].latencyCount[type];
+            free(connArray[i].latency[type]);
+        }
+        
+        memcpy(allLatency + allCount, latency, count * sizeof(uint64_t));
+        allCount += count;
+        allErrorCount += errorCount;
+        
+        printBenchResult(benchRequestTable[type].name, latency, count, errorCount, elapsedSec);
+        free(latency);
+    }
+    
+    printBenchResult("total", allLatency, allCount, allErrorCount, elapsedSec);
+    fflush(stdout);
+    
+    free(allLatency);
+    free(connArray);
+    pthread_barrier_destroy(&benchBarrier);
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,210 @@
+/*
+ * FileName:    samplefeed.c
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ * 
+ * Desc.:       Source file of the reader library of the shared memory sample feed
+ *              (see createSampleFeed of the server). Reads take no syscalls, only
+ *              opening and closing the feed does.
+ */
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "samplefeed.h"
+
+/* Function definitions */
+
+/*
+ * Function 'openSampleFeed': maps the shared memory sample feed of the server.
+ * 
+ * Note:    Feed name NULL selects the default (SAMPLE_FEED_NAME). Fails if the server
+ *          does not publish a feed or its layout differs from this library.
+ */
+int openSampleFeed(const char *feedName, struct SampleFeed *feed) {
+    
+    const struct FeedSegment *segment = NULL;
+    struct stat feedStat;
+    int feedFd;
+    int error = 0;
+    
+    feed->segment = NULL;
+    
+    feedFd = shm_open((NULL != feedName) ? feedName : SAMPLE_FEED_NAME, O_RDONLY, 0);
+    if(feedFd < 0) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Mapping beyond the object would fault on access */
+    if((fstat(feedFd, &feedStat) < 0) || (feedStat.st_size < (off_t)sizeof(struct FeedSegment))) {
+        
+        close(feedFd);
+        
+        error = -1;
+        return error;
+    }
+    
+    segment = mmap(NULL, sizeof(struct FeedSegment), PROT_READ, MAP_SHARED, feedFd, 0);
+    close(feedFd);
+    if(MAP_FAILED == segment) {
+        
+        error = -1;
+        return error;
+    }
+    
+    if((SAMPLE_FEED_MAGIC != __atomic_load_n(&(segment->magic), __ATOMIC_ACQUIRE)) ||
+       (SAMPLE_FEED_VERSION != segment->version) || (SAMPLE_FEED_HISTORY_SIZE != segment->historySize)) {
+        
+        /* Feed not ready, removed or incompatible */
+        munmap((void*)segment, sizeof(struct FeedSegment));
+        
+        error = -1;
+        return error;
+    }
+    
+    feed->segment = segment;
+    
+    return error;
+}
+
+/*
+ * Function 'closeSampleFeed': unmaps the shared memory sample feed.
+ */
+void closeSampleFeed(struct SampleFeed *feed) {
+    
+    if(NULL != feed->segment) {
+        
+        munmap((void*)feed->segment, sizeof(struct FeedSegment));
+        feed->segment = NULL;
+    }
+}
+
+/*
+ * Function 'getFeedSensor': returns the feed of a sensor or NULL if it can not be read.
+ */
+static const struct FeedSensor* getFeedSensor(const struct SampleFeed *feed, uint32_t sensorId) {
+    
+    if((NULL == feed->segment) || (SAMPLE_FEED_MAGIC != __atomic_load_n(&(feed->segment->magic), __ATOMIC_ACQUIRE)) ||
+       (sensorId >= feed->segment->sensorCount) || (sensorId >= SENSOR_ARRAY_SIZE)) {
+        
+        return NULL;
+    }
+    
+    return &(feed->segment->sensor[sensorId]);
+}
+
+/*
+ * Function 'readFeedLatest': copies the latest sample of a sensor.
+ * 
+ * Note:    Reader side of the feed seqlock: the copy is retried while the server
+ *          writes a new sample. Fails if the feed was removed (reopen it once the
+ *          server is restarted), no sample is published yet or the server kept
+ *          writing for SAMPLE_FEED_READ_RETRIES attempts.
+ */
+int readFeedLatest(const struct SampleFeed *feed, uint32_t sensorId, struct FeedSample *sample) {
+    
+    const struct FeedSensor *sensor = getFeedSensor(feed, sensorId);
+    uint32_t lockBegin;
+    uint32_t lockEnd;
+    int retry;
+    int error = -1;
+    
+    if(NULL == sensor) {
+        
+        return error;
+    }
+    
+    for(retry = 0; retry < SAMPLE_FEED_READ_RETRIES; retry++) {
+        
+        lockBegin = __atomic_load_n(&(sensor->lock), __ATOMIC_ACQUIRE);
+        if(lockBegin & 1) {
+            
+            /* Writer in progress */
+            continue;
+        }
+        
+        *sample = sensor->latest;
+        
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        lockEnd = __atomic_load_n(&(sensor->lock), __ATOMIC_RELAXED);
+        if(lockBegin == lockEnd) {
+            
+            error = (0 != sample->seq) ? 0 : -1;
+            break;
+        }
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'readFeedHistory': copies the recent samples of a sensor newer than a known one.
+ * 
+ * Note:    Copies the newest samples after sequence number 'afterSeq' (at most
+ *          'maxCount' and SAMPLE_FEED_HISTORY_SIZE of them), oldest first. Returns
+ *          the number of samples copied or -1 as readFeedLatest.
+ */
+int readFeedHistory(const struct SampleFeed *feed, uint32_t sensorId, uint64_t afterSeq,
+                    struct FeedSample samples[], int maxCount) {
+    
+    const struct FeedSensor *sensor = getFeedSensor(feed, sensorId);
+    uint64_t latestSeq;
+    uint64_t firstSeq;
+    uint64_t seq;
+    uint32_t lockBegin;
+    uint32_t lockEnd;
+    int count = -1;
+    int retry;
+    
+    if((NULL == sensor) || (maxCount < 0)) {
+        
+        return count;
+    }
+    
+    for(retry = 0; retry < SAMPLE_FEED_READ_RETRIES; retry++) {
+        
+        lockBegin = __atomic_load_n(&(sensor->lock), __ATOMIC_ACQUIRE);
+        if(lockBegin & 1) {
+            
+            /* Writer in progress */
+            continue;
+        }
+        
+        latestSeq = sensor->latest.seq;
+        
+        /* Skip samples overwritten already and the ones not fitting the buffer */
+        firstSeq = afterSeq + 1;
+        if((latestSeq >= SAMPLE_FEED_HISTORY_SIZE) && (firstSeq <= latestSeq - SAMPLE_FEED_HISTORY_SIZE)) {
+            
+            firstSeq = latestSeq - SAMPLE_FEED_HISTORY_SIZE + 1;
+        }
+        
+        if((latestSeq >= (uint64_t)maxCount) && (firstSeq <= latestSeq - maxCount)) {
+            
+            firstSeq = latestSeq - maxCount + 1;
+        }
+        
+        count = 0;
+        for(seq = firstSeq; seq <= latestSeq; seq++) {
+            
+            samples[count] = sensor->history[seq & (SAMPLE_FEED_HISTORY_SIZE - 1)];
+            count++;
+        }
+        
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        lockEnd = __atomic_load_n(&(sensor->lock), __ATOMIC_RELAXED);
+        if(lockBegin == lockEnd) {
+            
+            return count;
+        }
+        
+        count = -1;
+    }
+    
+    return count;
+}
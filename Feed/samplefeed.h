@@ -0,0 +1,94 @@
+/*
+ * FileName:    samplefeed.h
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ * 
+ * Desc.:       Header file of the reader library of the shared memory sample feed.
+ *              Local processes (e.g. a display or a fan controller) read the latest
+ *              samples published by the server without syscalls, authentication or
+ *              server CPU time.
+ * 
+ *              Note that some macros and types marked as 'SHARED' must be synchronized
+ *              with the corresponding items of myserver.h header file.
+ * 
+ * Use like this:
+ * 
+ *  struct SampleFeed feed;
+ *  struct FeedSample sample;
+ * 
+ *  openSampleFeed(NULL, &feed);
+ *  if(0 == readFeedLatest(&feed, 0, &sample)) { ... }
+ *  closeSampleFeed(&feed);
+ * 
+ * Compile samplefeed.c together with the reader (add -lrt on glibc older than 2.34).
+ */
+
+#include <stdint.h>
+
+/* Shared memory sample feed related macros */
+#define SAMPLE_FEED_NAME                            ("/myserver_feed")  // [SHARED] Default POSIX shared memory object name
+#define SAMPLE_FEED_MAGIC                           (0x44454546)        // [SHARED] Segment ready ("FEED"), 0 once removed
+#define SAMPLE_FEED_VERSION                         (1)                 // [SHARED] Segment layout version
+#define SAMPLE_FEED_HISTORY_SIZE                    (64)                // [SHARED] Recent samples per sensor (power of 2)
+#define SAMPLE_FEED_READ_RETRIES                    (1000)              // Reads retried while the server writes
+
+#define SENSOR_ARRAY_SIZE                           (8)         // [SHARED] Max. number of sensors
+
+/* Sample of the shared memory feed [SHARED] */
+struct FeedSample {
+    
+    uint64_t seq;                       // Sample sequence number (0: no sample yet)
+    uint64_t timeUs;                    // Sample time (UNIX time) [usec]
+    float temp;                         // Disabled channels hold -1.0
+    float hum;
+    float press;
+    uint32_t configVersion;
+};
+
+/* Feed of a sensor (seqlock: written by the measure thread, read by other processes) [SHARED] */
+struct FeedSensor {
+    
+    uint32_t lock;                      // Odd while a new sample is being written
+    uint32_t reserved;
+    struct FeedSample latest;
+    struct FeedSample history[SAMPLE_FEED_HISTORY_SIZE];        // Recent samples (slot: seq % size)
+} __attribute__((aligned(64)));
+
+/* Shared memory feed segment [SHARED] */
+struct FeedSegment {
+    
+    uint32_t magic;                     // Written last on creation (SAMPLE_FEED_MAGIC)
+    uint32_t version;                   // SAMPLE_FEED_VERSION
+    uint32_t sensorCount;
+    uint32_t historySize;               // SAMPLE_FEED_HISTORY_SIZE
+    struct FeedSensor sensor[SENSOR_ARRAY_SIZE];                // Index: sensor ID
+};
+
+/* Opened sample feed */
+struct SampleFeed {
+    
+    const struct FeedSegment *segment;  // Read-only mapping (NULL: not opened)
+};
+
+/* Function declarations */
+
+/*
+ * Function 'openSampleFeed': maps the shared memory sample feed of the server.
+ */
+int openSampleFeed(const char *feedName, struct SampleFeed *feed);
+
+/*
+ * Function 'closeSampleFeed': unmaps the shared memory sample feed.
+ */
+void closeSampleFeed(struct SampleFeed *feed);
+
+/*
+ * Function 'readFeedLatest': copies the latest sample of a sensor.
+ */
+int readFeedLatest(const struct SampleFeed *feed, uint32_t sensorId, struct FeedSample *sample);
+
+/*
+ * Function 'readFeedHistory': copies the recent samples of a sensor newer than a known one.
+ */
+int readFeedHistory(const struct SampleFeed *feed, uint32_t sensorId, uint64_t afterSeq,
+                    struct FeedSample samples[], int maxCount);
@@ -0,0 +1,173 @@
+/*
+ * FileName:    bme280_bench.c
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ *
+ * Desc.:       Acquisition latency benchmark. Measures the trigger-to-data latency
+ *              of forced mode samples acquired with the fixed worst-case delay
+ *              (get_sensor_data) and with status register polling (get_sensor_data_poll),
+ *              each with the control register shadow disabled and enabled, then prints
+ *              the latency distribution and the bus transactions per sample.
+ *
+ * Compile like this:
+ *
+ * gcc -DBME280_FLOAT_ENABLE -O2 -Wall -o bme280_bench bme280_bench.c bme280_qt_interf_v2.c bme280_transport.c bme280.c bme280_sim.c -I/home/lprog/MyLinuxProg/LinuxHomework/Server
+ *
+ * Run like this: ./bme280_bench [number of samples] [i2c|sim|replay] [I2C device or trace file]
+ *                (stop the server first when measuring the real sensor, it owns the bus)
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bme280_qt_interf_v2.h"
+
+#define BENCH_SAMPLES_DEFAULT       (200)       // Number of samples per method
+#define BENCH_SAMPLES_MAX           (100000)    // Upper limit of samples per method
+
+/* Acquisition function under test */
+typedef int (*acqFuncPntr)(struct identifier*, struct bme280_dev*, uint32_t, struct sensor_data*);
+
+/*
+ * Function 'nowUs': returns the time of the monotonic clock in microseconds.
+ */
+static uint64_t nowUs(void) {
+
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+/*
+ * Function 'compareLatency': orders latency values for qsort.
+ */
+static int compareLatency(const void *a, const void *b) {
+
+    uint32_t x = *((const uint32_t*)a);
+    uint32_t y = *((const uint32_t*)b);
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Function 'runBenchmark': acquires samples with the given method and prints the latency distribution.
+ */
+static int runBenchmark(const char *name, acqFuncPntr acquire, struct identifier *id, struct bme280_dev *dev,
+                        uint32_t reqDelayMs, uint32_t *latency, int samples) {
+
+    struct sensor_data data;
+    struct bus_stats before = id->stats;
+    uint64_t start;
+    uint64_t sum = 0;
+    int i;
+
+    /* Acquire samples */
+    for(i = 0; i < samples; i++) {
+
+        start = nowUs();
+        if(0 != acquire(id, dev, reqDelayMs, &data)) {
+
+            fprintf(stderr, "%s: acquisition failed at sample %d.\n", name, i);
+            return -1;
+        }
+        latency[i] = (uint32_t)(nowUs() - start);
+        sum += latency[i];
+    }
+
+    /* Print distribution */
+    qsort(latency, samples, sizeof(latency[0]), compareLatency);
+    fprintf(stdout, "%-9s %8u %8u %8u %8u %8u %8u %8llu %8.2f %8.2f %8.2f %8.2f\n", name,
+            latency[0],
+            latency[samples / 2],
+            latency[(samples * 90) / 100],
+            latency[(samples * 99) / 100],
+            latency[(samples * 999) / 1000],
+            latency[samples - 1],
+            (unsigned long long)(sum / samples),
+            (double)(id->stats.reads - before.reads) / samples,
+            (double)(id->stats.writes - before.writes) / samples,
+            (double)(id->stats.reads_cached - before.reads_cached) / samples,
+            (double)(id->stats.writes_skipped - before.writes_skipped) / samples);
+
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+
+    struct identifier id;
+    struct bme280_dev dev;
+    uint32_t reqDelayMs;
+    uint32_t *latency = NULL;
+    int samples = BENCH_SAMPLES_DEFAULT;
+    int error = 0;
+
+    /* Parse arguments */
+    if(argc > 1) {
+
+        samples = atoi(argv[1]);
+        if((samples <= 0) || (samples > BENCH_SAMPLES_MAX)) {
+
+            fprintf(stdout, "Usage: %s [number of samples (1-%d)] [i2c|sim|replay] [I2C device or trace file]\n",
+                    argv[0], BENCH_SAMPLES_MAX);
+            return EXIT_FAILURE;
+        }
+    }
+
+    latency = malloc(samples * sizeof(latency[0]));
+    if(NULL == latency) {
+
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+
+    /* Initialize sensor */
+    memset(&id, 0, sizeof(id));
+    memset(&dev, 0, sizeof(dev));
+    id.transport_name = (argc > 2) ? argv[2] : NULL;
+    id.bus_path = (argc > 3) ? argv[3] : NULL;
+    if(0 != init_dev_weather(&id, &dev)) {
+
+        fprintf(stderr, "Failed to initialize sensor.\n");
+        free(latency);
+        return EXIT_FAILURE;
+    }
+    reqDelayMs = get_min_delay(&id, &dev);
+
+    fprintf(stdout, "Target: %s (%s), %d samples per method\n", id.transport_name, id.bus_path, samples);
+    fprintf(stdout, "Worst-case conversion delay: %u ms\n\n", reqDelayMs);
+    fprintf(stdout, "Trigger-to-data latency [usec], bus transactions per sample (+sh: register shadow enabled):\n");
+    fprintf(stdout, "%-9s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s\n", "method", "min", "p50", "p90", "p99", "p999", "max", "mean",
+            "reads", "writes", "cached", "skipped");
+
+    /* Compare the fixed delay with status polling, without and with the register shadow */
+    id.shadow_enabled = 0;
+    if((0 != runBenchmark("fixed", get_sensor_data, &id, &dev, reqDelayMs, latency, samples)) ||
+       (0 != runBenchmark("poll", get_sensor_data_poll, &id, &dev, reqDelayMs, latency, samples))) {
+
+        error = -1;
+    }
+
+    id.shadow_enabled = 1;
+    if((0 == error) &&
+       ((0 != runBenchmark("fixed+sh", get_sensor_data, &id, &dev, reqDelayMs, latency, samples)) ||
+        (0 != runBenchmark("poll+sh", get_sensor_data_poll, &id, &dev, reqDelayMs, latency, samples)))) {
+
+        error = -1;
+    }
+
+    if(0 == error) {
+
+        fprintf(stdout, "\nLearned conversion time: %u us\n", id.conv_est_us);
+    }
+
+    close_dev_connection(&id, &dev);
+    free(latency);
+
+    return (0 == error) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
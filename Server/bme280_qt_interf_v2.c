@@ -26,46 +26,285 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <fcntl.h>
-// Explicit kernel specific includes for this version of I2C read/write implementation:
-#include <linux/i2c.h>
-#include <linux/i2c-dev.h>
-#include <sys/ioctl.h>
+#include <time.h>
 
 #include "bme280_qt_interf_v2.h"
 
+/******************************************************************************/
+/*!                         Own macros                                        */
+#define STANDBY_TABLE_SIZE  (8)
+
+/* ctrl_meas value selecting forced mode (mode bits 01 or 10) */
+#define IS_FORCED_MODE(ctrl_meas)   ((0x01 == ((ctrl_meas) & BME280_SENSOR_MODE_MSK)) || \
+                                     (0x02 == ((ctrl_meas) & BME280_SENSOR_MODE_MSK)))
+
+/* Standby time register values ordered by standby duration [usec] */
+static const struct {
+    uint32_t standby_us;
+    uint8_t standby_time;
+} standby_table[STANDBY_TABLE_SIZE] = {
+    { 1000000, BME280_STANDBY_TIME_1000_MS },
+    { 500000, BME280_STANDBY_TIME_500_MS },
+    { 250000, BME280_STANDBY_TIME_250_MS },
+    { 125000, BME280_STANDBY_TIME_125_MS },
+    { 62500, BME280_STANDBY_TIME_62_5_MS },
+    { 20000, BME280_STANDBY_TIME_20_MS },
+    { 10000, BME280_STANDBY_TIME_10_MS },
+    { 500, BME280_STANDBY_TIME_0_5_MS }
+};
+
+/*!
+ * @brief This internal API returns the time of the monotonic clock in microseconds.
+ */
+static uint64_t monotonic_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+/*!
+ * @brief This internal API converts/formats the compensated data based on the enabled settings.
+ */
+static void convert_sensor_data(const struct bme280_data *comp_data, struct sensor_data *data)
+{
+#ifdef BME280_FLOAT_ENABLE
+    data->temp = comp_data->temperature;
+    data->press = 0.01 * comp_data->pressure;
+    data->hum = comp_data->humidity;
+#else
+#ifdef BME280_64BIT_ENABLE
+    data->temp = 0.01f * comp_data->temperature;
+    data->press = 0.0001f * comp_data->pressure;
+    data->hum = 1.0f / 1024.0f * comp_data->humidity;
+#else
+    data->temp = 0.01f * comp_data->temperature;
+    data->press = 0.01f * comp_data->pressure;
+    data->hum = 1.0f / 1024.0f * comp_data->humidity;
+#endif
+#endif
+}
+
 /*!
- * @brief This function reads the sensor's registers through I2C bus.
+ * @brief This function reads the sensor's registers through the transport of the identifier.
  */
 int8_t user_i2c_read(uint8_t reg_addr, uint8_t *data, uint32_t len, void *intf_ptr)
 {
-    
-    const struct identifier *id;
-    
-    struct i2c_msg msgs[2];
-    struct i2c_rdwr_ioctl_data msgSet[1];
-    
-    id = (const struct identifier*)intf_ptr;
-    
-    msgs[0].addr = id->dev_addr;
-    msgs[0].flags = 0;
-    msgs[0].len = 1;
-    msgs[0].buf = &reg_addr;
-    
-    msgs[1].addr = id->dev_addr;
-    msgs[1].flags = I2C_M_RD;
-    msgs[1].len = len;
-    msgs[1].buf = data;
-    
-    msgSet[0].msgs = msgs;
-    msgSet[0].nmsgs = 2;
-    
-    if(ioctl(id->fd, I2C_RDWR, msgSet) < 0) {
-     
-        perror("ioctl(I2C_RDWR) in user_i2c_read");
-        return BME280_E_COMM_FAIL;
+    struct identifier *id = (struct identifier*)intf_ptr;
+
+    return bme280_transport_read(&id->transport, reg_addr, data, len);
+}
+
+/*!
+ * @brief This internal API returns the shadow slot of a register (-1 if the register is not shadowed).
+ */
+static int shadow_index(uint8_t reg_addr)
+{
+    switch (reg_addr)
+    {
+        case BME280_CTRL_HUM_ADDR:
+            return 0;
+        case BME280_CTRL_MEAS_ADDR:
+            return 1;
+        case BME280_CONFIG_ADDR:
+            return 2;
+        default:
+            return -1;
     }
-    
-    return 0;
+}
+
+/*!
+ * @brief This internal API records a value written to (or read from) a shadowed register.
+ */
+static void shadow_store(struct reg_shadow *shadow, uint8_t reg_addr, uint8_t value)
+{
+    int idx = shadow_index(reg_addr);
+
+    if (idx < 0)
+    {
+        return;
+    }
+
+    if (BME280_CTRL_MEAS_ADDR == reg_addr)
+    {
+        /*
+         * A forced conversion returns the sensor to sleep mode when it
+         * completes, so keep the sleep value and mark the register
+         * volatile until a status read shows the conversion is over.
+         */
+        shadow->forced_pending = IS_FORCED_MODE(value);
+        if (shadow->forced_pending)
+        {
+            value &= ~BME280_SENSOR_MODE_MSK;
+        }
+    }
+
+    shadow->val[idx] = value;
+    shadow->valid[idx] = 1;
+}
+
+/*!
+ * @brief This function reads the sensor's registers through the control register shadow.
+ */
+int8_t shadow_i2c_read(uint8_t reg_addr, uint8_t *data, uint32_t len, void *intf_ptr)
+{
+    struct identifier *id = (struct identifier*)intf_ptr;
+    struct reg_shadow *shadow = &id->shadow;
+    int8_t rslt;
+    uint32_t i;
+    int idx;
+    int hit = id->shadow_enabled;
+
+    /* Serve the read from the shadow if every register is shadowed and valid */
+    for (i = 0; (i < len) && hit; i++)
+    {
+        idx = shadow_index(reg_addr + i);
+        if ((idx < 0) || !shadow->valid[idx] ||
+            ((BME280_CTRL_MEAS_ADDR == reg_addr + i) && shadow->forced_pending))
+        {
+            hit = 0;
+        }
+    }
+
+    if (hit)
+    {
+        for (i = 0; i < len; i++)
+        {
+            data[i] = shadow->val[shadow_index(reg_addr + i)];
+        }
+        id->stats.reads_cached++;
+
+        return BME280_OK;
+    }
+
+    /* Read the bus and refresh the shadow from the result */
+    rslt = user_i2c_read(reg_addr, data, len, intf_ptr);
+    id->stats.reads++;
+    if ((rslt != BME280_OK) || !id->shadow_enabled)
+    {
+        return rslt;
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        if ((BME280_STATUS_REG_ADDR == reg_addr + i) && !(data[i] & BME280_STATUS_MEASURING))
+        {
+            /* Forced conversion over, ctrl_meas is back in sleep mode */
+            shadow->forced_pending = 0;
+        }
+        else
+        {
+            shadow_store(shadow, reg_addr + i, data[i]);
+        }
+    }
+
+    return rslt;
+}
+
+/*!
+ * @brief This function writes the sensor's registers through the control register shadow.
+ */
+int8_t shadow_i2c_write(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *intf_ptr)
+{
+    struct identifier *id = (struct identifier*)intf_ptr;
+    struct reg_shadow *shadow = &id->shadow;
+    uint8_t pair_addr[SHADOW_BURST_MAX];
+    uint8_t pair_data[SHADOW_BURST_MAX];
+    uint8_t buf[SHADOW_BURST_MAX];
+    uint32_t pairs = 0;
+    uint32_t kept = 0;
+    uint32_t i;
+    int8_t rslt;
+    int idx;
+    uint8_t soft_reset = 0;
+
+    if (!id->shadow_enabled || (len > SHADOW_BURST_MAX))
+    {
+        /* Write bypasses the shadow, so it can not be trusted afterwards */
+        memset(shadow, 0, sizeof(*shadow));
+        id->stats.writes++;
+
+        return user_i2c_write(reg_addr, data, len, intf_ptr);
+    }
+
+    /* Split the (interleaved) burst into register address / data pairs */
+    pair_addr[pairs] = reg_addr;
+    pair_data[pairs++] = data[0];
+    for (i = 1; (i + 1) < len; i += 2)
+    {
+        pair_addr[pairs] = data[i];
+        pair_data[pairs++] = data[i + 1];
+    }
+
+    /* Drop pairs that would not change the sensor state */
+    for (i = 0; i < pairs; i++)
+    {
+        idx = shadow_index(pair_addr[i]);
+        if ((BME280_RESET_ADDR == pair_addr[i]) && (BME280_SOFT_RESET_COMMAND == pair_data[i]))
+        {
+            soft_reset = 1;
+        }
+        else if ((idx >= 0) && shadow->valid[idx] && (shadow->val[idx] == pair_data[i]))
+        {
+            /* ctrl_meas writes also latch ctrl_hum and trigger forced conversions */
+            if ((BME280_CTRL_MEAS_ADDR != pair_addr[i]) ||
+                (!shadow->hum_latch_pending && !shadow->forced_pending && !IS_FORCED_MODE(pair_data[i])))
+            {
+                continue;
+            }
+        }
+        pair_addr[kept] = pair_addr[i];
+        pair_data[kept++] = pair_data[i];
+    }
+
+    if (0 == kept)
+    {
+        id->stats.writes_skipped++;
+
+        return BME280_OK;
+    }
+
+    /* Interleave the remaining pairs again */
+    buf[0] = pair_data[0];
+    for (i = 1; i < kept; i++)
+    {
+        buf[2 * i - 1] = pair_addr[i];
+        buf[2 * i] = pair_data[i];
+    }
+
+    rslt = user_i2c_write(pair_addr[0], buf, 2 * kept - 1, intf_ptr);
+    id->stats.writes++;
+    if (rslt != BME280_OK)
+    {
+        /* Unknown sensor state */
+        memset(shadow, 0, sizeof(*shadow));
+
+        return rslt;
+    }
+
+    /* Write-through */
+    for (i = 0; i < kept; i++)
+    {
+        if (BME280_CTRL_HUM_ADDR == pair_addr[i])
+        {
+            shadow->hum_latch_pending = 1;
+        }
+        else if (BME280_CTRL_MEAS_ADDR == pair_addr[i])
+        {
+            shadow->hum_latch_pending = 0;
+        }
+        shadow_store(shadow, pair_addr[i], pair_data[i]);
+    }
+
+    /* Soft reset restores the power-on values of the control registers */
+    if (soft_reset)
+    {
+        memset(shadow, 0, sizeof(*shadow));
+    }
+
+    return rslt;
 }
 
 /*!
@@ -78,39 +317,13 @@ void user_delay_us(uint32_t period, void *intf_ptr)
 }
 
 /*!
- * @brief This function for writing the sensor's registers through I2C bus.
+ * @brief This function for writing the sensor's registers through the transport of the identifier.
  */
 int8_t user_i2c_write(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *intf_ptr)
 {
-    uint8_t *buf;
-    const struct identifier *id;
-    
-    struct i2c_msg msgs[1];
-    struct i2c_rdwr_ioctl_data msgSet[1];
-    
-    id = (const struct identifier*)intf_ptr;
-    
-    buf = (uint8_t*)calloc(len + 1, sizeof(uint8_t));
-    buf[0] = reg_addr;
-    memcpy(buf + 1, data, len);
-    
-    msgs[0].addr = id->dev_addr;
-    msgs[0].flags = 0;
-    msgs[0].len = len + 1;
-    msgs[0].buf = buf;
-    
-    msgSet[0].msgs = msgs;
-    msgSet[0].nmsgs = 1;
-    
-    if(ioctl(id->fd, I2C_RDWR, msgSet) < 0) {
-     
-        perror("ioctl(I2C_RDWR) in user_i2c_write");
-        return BME280_E_COMM_FAIL;
-    }
+    struct identifier *id = (struct identifier*)intf_ptr;
 
-    free(buf);
-
-    return BME280_OK;
+    return bme280_transport_write(&id->transport, reg_addr, data, len);
 }
 
 /*!
@@ -214,19 +427,41 @@ int init_dev_weather(struct identifier *id, struct bme280_dev *dev) {
     /* Variable to define the selecting sensors */
     uint8_t settings_sel = 0;
     
-    /* Open I2C bus driver as character device */
-    if ((id->fd = open(I2C_DRIVER_PATH, O_RDWR)) < 0)
+    /* Select defaults for the unset transport fields */
+    if (0 == id->dev_addr)
+    {
+        id->dev_addr = BME280_I2C_ADDR_PRIM;
+    }
+    if (NULL == id->transport_name)
+    {
+        id->transport_name = TRANSPORT_DEFAULT;
+    }
+    if (NULL == id->bus_path)
+    {
+        id->bus_path = I2C_DRIVER_PATH;
+    }
+    
+    /* Open transport (I2C bus, simulated sensor or trace replay) */
+    rslt = bme280_transport_open(&id->transport, id->transport_name, id->bus_path, id->dev_addr, id->trace_path);
+    if (rslt != BME280_OK)
     {
-        fprintf(stderr, "Failed to open the i2c bus %s\n", I2C_DRIVER_PATH);
+        fprintf(stderr, "Failed to open sensor transport %s (code %+d).\n", id->transport_name, rslt);
         return -1;
     }
     
     /* Initialize device structure and interface data */
-    id->dev_addr = BME280_I2C_ADDR_PRIM;
+    id->conv_est_us = 0;
+    id->conv_est_key_ms = 0;
+    id->conv_polls = 0;
     
     dev->intf = BME280_I2C_INTF;
-    dev->read = user_i2c_read;
-    dev->write = user_i2c_write;
+    dev->read = shadow_i2c_read;
+    dev->write = shadow_i2c_write;
+    
+    /* Start with an empty register shadow */
+    id->shadow_enabled = 1;
+    memset(&id->shadow, 0, sizeof(id->shadow));
+    memset(&id->stats, 0, sizeof(id->stats));
     dev->delay_us = user_delay_us;
     
     /* Update interface pointer */
@@ -237,6 +472,7 @@ int init_dev_weather(struct identifier *id, struct bme280_dev *dev) {
     if (rslt != BME280_OK)
     {
         fprintf(stderr, "Failed to initialize the device (code %+d).\n", rslt);
+        bme280_transport_close(&id->transport);
         return -1;
     }
     
@@ -253,6 +489,7 @@ int init_dev_weather(struct identifier *id, struct bme280_dev *dev) {
     if (rslt != BME280_OK)
     {
         fprintf(stderr, "Failed to set sensor settings (code %+d).", rslt);
+        bme280_transport_close(&id->transport);
         return -1;
     }
     
@@ -317,36 +554,338 @@ int get_sensor_data(struct identifier *id, struct bme280_dev *dev, uint32_t req_
     }
     
     /* Convert/format the sensor datas based on the enabled settings */
-#ifdef BME280_FLOAT_ENABLE
-    data->temp = comp_data.temperature;
-    data->press = 0.01 * comp_data.pressure;
-    data->hum = comp_data.humidity;
-#else
-#ifdef BME280_64BIT_ENABLE
-    data->temp = 0.01f * comp_data.temperature;
-    data->press = 0.0001f * comp_data.pressure;
-    data->hum = 1.0f / 1024.0f * comp_data.humidity;
-#else
-    data->temp = 0.01f * comp_data.temperature;
-    data->press = 0.01f * comp_data.pressure;
-    ata->hum = 1.0f / 1024.0f * comp_data.humidity;
-#endif
-#endif
+    convert_sensor_data(&comp_data, data);
 
     return 0;
 }
 
 /*!
- * @brief This API closes communication with the sensor device.
+ * @brief This API triggers a forced mode conversion and returns the time to wait before the first status poll.
  */
-int close_dev_connection(struct identifier *id, struct bme280_dev *dev) {
+int start_conversion(struct identifier *id, struct bme280_dev *dev, uint32_t req_delay_ms, uint32_t *wait_us) {
+    
+    /* Variable to define the result */
+    int8_t rslt = BME280_OK;
+    
+    /*
+     * Note:
+     * 
+     * The worst-case delay (bme280_cal_meas_delay) uses the maximum
+     * conversion times of the datasheet, while a typical conversion
+     * completes noticeably earlier. The sensor sets the measuring bit
+     * of the status register while the conversion is running, so:
+     * 
+     * #1 Trigger a conversion in FORCED MODE (start_conversion)
+     * #2 Sleep until shortly before the learned conversion time
+     * #3 Read the status register until the measuring bit clears,
+     *    doubling the interval between reads (poll_conversion)
+     * #4 Read the data registers (read_sensor_data)
+     * 
+     * The caller may release its locks while sleeping in #2 and #3.
+     * The estimate is dropped whenever the worst-case delay changes,
+     * because that means the oversampling settings have changed.
+     */
+    if (id->conv_est_key_ms != req_delay_ms)
+    {
+        id->conv_est_us = 0;
+        id->conv_est_key_ms = req_delay_ms;
+    }
+    
+    /* Set the sensor to forced mode (to start new measurement) */
+    rslt = bme280_set_sensor_mode(BME280_FORCED_MODE, dev);
+    if (rslt != BME280_OK)
+    {
+        fprintf(stderr, "Failed to set sensor mode (code %+d).", rslt);
+        return -1;
+    }
+    id->conv_start_us = monotonic_us();
+    id->conv_timeout_us = req_delay_ms * 1000 * POLL_TIMEOUT_FACTOR;
+    id->conv_backoff_us = POLL_BACKOFF_MIN_US;
+    id->conv_polls = 0;
+    
+    /* Sleep through the bulk of the conversion (half of the worst case until learned) */
+    if (0 == id->conv_est_us)
+    {
+        *wait_us = req_delay_ms * 1000 / 2;
+    }
+    else
+    {
+        *wait_us = id->conv_est_us - id->conv_est_us / POLL_EST_MARGIN_DIV;
+    }
+    
+    return 0;
+}
+
+/*!
+ * @brief This API reads the status register once and tells whether the triggered conversion has completed.
+ */
+int poll_conversion(struct identifier *id, struct bme280_dev *dev, uint32_t *wait_us) {
+    
+    /* Variable to define the result */
+    int8_t rslt = BME280_OK;
+    
+    /* Content of the status register */
+    uint8_t status = 0;
+    
+    /* Time since the conversion was triggered [usec] */
+    uint64_t elapsed_us;
+    
+    rslt = bme280_get_regs(BME280_STATUS_REG_ADDR, &status, 1, dev);
+    if (rslt != BME280_OK)
+    {
+        fprintf(stderr, "Failed to read status register (code %+d).", rslt);
+        return -1;
+    }
+    id->conv_polls++;
+    
+    elapsed_us = monotonic_us() - id->conv_start_us;
+    if (status & BME280_STATUS_MEASURING)
+    {
+        /* Still converting: back off exponentially (bounded) */
+        if (elapsed_us >= id->conv_timeout_us)
+        {
+            fprintf(stderr, "Sensor conversion timed out (%u us).", (unsigned int)elapsed_us);
+            return -1;
+        }
+        
+        *wait_us = id->conv_backoff_us;
+        id->conv_backoff_us = (2 * id->conv_backoff_us < POLL_BACKOFF_MAX_US) ? (2 * id->conv_backoff_us) : POLL_BACKOFF_MAX_US;
+        
+        return 0;
+    }
+    
+    /* Update the learned conversion time */
+    if (0 == id->conv_est_us)
+    {
+        id->conv_est_us = (uint32_t)elapsed_us;
+    }
+    else if (1 == id->conv_polls)
+    {
+        /* Already complete at the first read: the estimate may be too long, probe downwards */
+        id->conv_est_us -= id->conv_est_us / POLL_EST_MARGIN_DIV;
+    }
+    else
+    {
+        /* Follow the observed completion time */
+        id->conv_est_us = (uint32_t)((int64_t)id->conv_est_us + ((int64_t)elapsed_us - (int64_t)id->conv_est_us) / POLL_EST_GAIN_DIV);
+    }
+    if (id->conv_est_us < POLL_BACKOFF_MIN_US)
+    {
+        id->conv_est_us = POLL_BACKOFF_MIN_US;
+    }
+    
+    return 1;
+}
+
+/*!
+ * @brief This API reads the raw content of the data registers.
+ */
+int read_sensor_regs(struct identifier *id, struct bme280_dev *dev, struct bme280_uncomp_data *uncomp_data) {
+    
+    /* Variable to define the result */
+    int8_t rslt = BME280_OK;
+    
+    /* Array to store the pressure, temperature and humidity data read from the sensor */
+    uint8_t reg_data[BME280_P_T_H_DATA_LEN] = { 0 };
+    
+    /* Get the latest measurement data from the sensor (data registers are shadowed during burst read) */
+    rslt = bme280_get_regs(BME280_DATA_ADDR, reg_data, BME280_P_T_H_DATA_LEN, dev);
+    if (rslt != BME280_OK)
+    {
+        fprintf(stderr, "Failed to get sensor data (code %+d).", rslt);
+        return -1;
+    }
+    
+    /* Parse the read data from the sensor */
+    bme280_parse_sensor_data(reg_data, uncomp_data);
+    
+    return 0;
+}
+
+/*!
+ * @brief This API compensates and converts raw data register content.
+ */
+int compensate_sensor_data(struct bme280_dev *dev, const struct bme280_uncomp_data *uncomp_data, struct sensor_data *data) {
+    
+    /* Variable to define the result */
+    int8_t rslt = BME280_OK;
+    
+    /* Structure to get the pressure, temperature and humidity values */
+    struct bme280_data comp_data;
+    
+    /* Compensate the pressure, temperature and humidity data (calibration read at init) */
+    rslt = bme280_compensate_data(BME280_ALL, uncomp_data, &comp_data, &dev->calib_data);
+    if (rslt != BME280_OK)
+    {
+        fprintf(stderr, "Failed to compensate sensor data (code %+d).", rslt);
+        return -1;
+    }
+    
+    /* Convert/format the sensor datas based on the enabled settings */
+    convert_sensor_data(&comp_data, data);
+    
+    return 0;
+}
+
+/*!
+ * @brief This API reads and converts the content of the data registers.
+ */
+int read_sensor_data(struct identifier *id, struct bme280_dev *dev, struct sensor_data *data) {
     
-    /* Close I2C bus file descriptor */
-    if (close(id->fd) < 0)
+    /* Structure to get the raw pressure, temperature and humidity values */
+    struct bme280_uncomp_data uncomp_data = { 0 };
+    
+    if (read_sensor_regs(id, dev, &uncomp_data) < 0)
     {
-        fprintf(stderr, "Failed to close I2C bus file descriptor.\n");
         return -1;
     }
     
+    return compensate_sensor_data(dev, &uncomp_data, data);
+}
+
+/*!
+ * @brief This API returns sensor data based on the device settings using status register polling.
+ */
+int get_sensor_data_poll(struct identifier *id, struct bme280_dev *dev, uint32_t req_delay_ms, struct sensor_data *data) {
+    
+    /* Variable to define the result */
+    int rslt;
+    
+    /* Time to wait before the next status read [usec] */
+    uint32_t wait_us = 0;
+    
+    /* Trigger conversion */
+    if (start_conversion(id, dev, req_delay_ms, &wait_us) < 0)
+    {
+        return -1;
+    }
+    
+    /* Wait for its completion */
+    do
+    {
+        dev->delay_us(wait_us, dev->intf_ptr);
+        rslt = poll_conversion(id, dev, &wait_us);
+    } while (0 == rslt);
+    
+    if (rslt < 0)
+    {
+        return -1;
+    }
+    
+    return read_sensor_data(id, dev, data);
+}
+
+/*!
+ * @brief This API puts the sensor into normal mode with standby time derived from the read period.
+ */
+int set_normal_mode(struct identifier *id, struct bme280_dev *dev, uint64_t period_us) {
+    
+    /* Variable to define the result */
+    int8_t rslt = BME280_OK;
+    
+    /* Conversion time for the current settings */
+    uint32_t meas_delay_us;
+    
+    int i;
+    
+    /*
+     * Note:
+     * 
+     * In NORMAL MODE the sensor cycles between a conversion (t_meas)
+     * and an inactive standby period (t_standby). The data registers
+     * always hold the result of the latest completed conversion, so
+     * the application may read them at any time with a single burst
+     * read. Choose the longest standby for which t_meas + t_standby
+     * still does not exceed the read period; fall back to the shortest
+     * one (0.5 ms) for periods shorter than a conversion. The data
+     * registers become valid after the first conversion, the caller
+     * waits for it (without holding its locks).
+     */
+    meas_delay_us = bme280_cal_meas_delay(&dev->settings) * 1000;
+    
+    dev->settings.standby_time = BME280_STANDBY_TIME_0_5_MS;
+    for (i = 0; i < STANDBY_TABLE_SIZE; i++)
+    {
+        if ((uint64_t)meas_delay_us + standby_table[i].standby_us <= period_us)
+        {
+            dev->settings.standby_time = standby_table[i].standby_time;
+            break;
+        }
+    }
+    
+    /* Write standby time (config register) */
+    rslt = bme280_set_sensor_settings(BME280_STANDBY_SEL, dev);
+    if (rslt != BME280_OK)
+    {
+        fprintf(stderr, "Failed to set sensor settings (code %+d).", rslt);
+        return -1;
+    }
+    
+    /* Start continuous conversions */
+    rslt = bme280_set_sensor_mode(BME280_NORMAL_MODE, dev);
+    if (rslt != BME280_OK)
+    {
+        fprintf(stderr, "Failed to set sensor mode (code %+d).", rslt);
+        return -1;
+    }
+    
+    return 0;
+}
+
+/*!
+ * @brief This API writes the sensor settings of the device structure in a single register burst.
+ */
+int write_sensor_settings(struct identifier *id, struct bme280_dev *dev) {
+    
+    /* Variable to define the result */
+    int8_t rslt = BME280_OK;
+    
+    uint8_t reg_addr[SETTINGS_REG_COUNT] = { BME280_CTRL_HUM_ADDR, BME280_CTRL_MEAS_ADDR, BME280_CONFIG_ADDR };
+    uint8_t reg_data[SETTINGS_REG_COUNT] = { 0 };
+    
+    /*
+     * Note:
+     * 
+     * The whole register image is computed from the settings and written
+     * with one interleaved burst. The order matters: a ctrl_hum write only
+     * takes effect with the ctrl_meas write that follows it, and ctrl_meas
+     * puts the sensor to sleep before config is written (config writes may
+     * be ignored in normal mode). The register shadow drops the registers
+     * whose value does not change.
+     */
+    reg_data[0] = BME280_SET_BITS_POS_0(reg_data[0], BME280_CTRL_HUM, dev->settings.osr_h);
+    reg_data[1] = BME280_SET_BITS(reg_data[1], BME280_CTRL_TEMP, dev->settings.osr_t);
+    reg_data[1] = BME280_SET_BITS(reg_data[1], BME280_CTRL_PRESS, dev->settings.osr_p);
+    reg_data[1] = BME280_SET_BITS_POS_0(reg_data[1], BME280_SENSOR_MODE, BME280_SLEEP_MODE);
+    reg_data[2] = BME280_SET_BITS(reg_data[2], BME280_FILTER, dev->settings.filter);
+    reg_data[2] = BME280_SET_BITS(reg_data[2], BME280_STANDBY, dev->settings.standby_time);
+    
+    rslt = bme280_set_regs(reg_addr, reg_data, SETTINGS_REG_COUNT, dev);
+    if (rslt != BME280_OK)
+    {
+        fprintf(stderr, "Failed to set sensor settings (code %+d).", rslt);
+        return -1;
+    }
+    
+    return 0;
+}
+
+/*!
+ * @brief This API returns the latest sensor data while the sensor runs in normal mode.
+ */
+int get_sensor_data_normal_mode(struct identifier *id, struct bme280_dev *dev, struct sensor_data *data) {
+    
+    /* Data registers hold the result of the latest completed conversion */
+    return read_sensor_data(id, dev, data);
+}
+
+/*!
+ * @brief This API closes communication with the sensor device.
+ */
+int close_dev_connection(struct identifier *id, struct bme280_dev *dev) {
+    
+    /* Close transport (I2C bus file descriptor, loaded trace, recording) */
+    bme280_transport_close(&id->transport);
+    
     return 0;
 }
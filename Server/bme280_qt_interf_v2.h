@@ -16,22 +16,104 @@
 /******************************************************************************/
 /*!                         Own header files                                  */
 #include "bme280.h"
+#include "bme280_transport.h"
 
 /******************************************************************************/
 /*!								Own macros									  */
 #define I2C_DRIVER_PATH	("/dev/i2c-1")
+#define TRANSPORT_DEFAULT	(BME280_TRANSPORT_I2C)
+
+#define BME280_STATUS_MEASURING		(0x08)	// Status register bit set while a conversion is running
+
+#define POLL_BACKOFF_MIN_US			(50)	// First interval between status register reads [usec]
+#define POLL_BACKOFF_MAX_US			(1000)	// Upper limit of the status polling interval [usec]
+#define POLL_TIMEOUT_FACTOR			(2)		// Conversion timeout as multiple of the worst-case delay
+#define POLL_EST_GAIN_DIV			(4)		// Conversion time estimate follows 1/4 of each new observation
+#define POLL_EST_MARGIN_DIV			(16)	// First status read is issued 1/16 before the estimate
+
+#define SHADOW_REG_COUNT			(3)		// Shadowed control registers: ctrl_hum, ctrl_meas, config
+#define SHADOW_BURST_MAX			(20)	// Largest interleaved burst written by the driver
+#define SETTINGS_REG_COUNT			(3)		// Registers of a settings update: ctrl_hum, ctrl_meas, config
 
 /******************************************************************************/
 /*!                               Structures                                  */
 
+/* Structure that contains the write-through shadow of the control registers */
+struct reg_shadow
+{
+    /* Shadowed values of ctrl_hum, ctrl_meas and config */
+    uint8_t val[SHADOW_REG_COUNT];
+
+    /* Validity flag of each shadowed value */
+    uint8_t valid[SHADOW_REG_COUNT];
+
+    /* ctrl_hum was written and takes effect on the next ctrl_meas write only */
+    uint8_t hum_latch_pending;
+
+    /* Forced conversion running: ctrl_meas returns to sleep mode by itself */
+    uint8_t forced_pending;
+};
+
+/* Structure that contains bus transaction counters */
+struct bus_stats
+{
+    /* Register reads issued on the bus */
+    uint32_t reads;
+
+    /* Register writes issued on the bus */
+    uint32_t writes;
+
+    /* Register reads served from the shadow */
+    uint32_t reads_cached;
+
+    /* Register writes skipped because the values did not change */
+    uint32_t writes_skipped;
+};
+
 /* Structure that contains identifier details used in example */
 struct identifier
 {
-    /* Variable to hold device address */
+    /* Variable to hold device address (0 -> BME280_I2C_ADDR_PRIM) */
     uint8_t dev_addr;
 
-    /* Variable that contains file descriptor */
-    int8_t fd;
+    /* Transport backend name (NULL -> TRANSPORT_DEFAULT) */
+    const char *transport_name;
+
+    /* I2C bus device or trace file of the transport (NULL -> I2C_DRIVER_PATH) */
+    const char *bus_path;
+
+    /* File to record the register transactions to (NULL -> no recording) */
+    const char *trace_path;
+
+    /* Register transport */
+    struct bme280_transport transport;
+
+    /* Learned forced mode conversion time in microseconds (0 -> not learned yet) */
+    uint32_t conv_est_us;
+
+    /* Worst-case conversion delay in milliseconds the estimate was learned for */
+    uint32_t conv_est_key_ms;
+
+    /* Monotonic time of the last conversion trigger in microseconds */
+    uint64_t conv_start_us;
+
+    /* Conversion timeout in microseconds */
+    uint32_t conv_timeout_us;
+
+    /* Next status polling interval in microseconds */
+    uint32_t conv_backoff_us;
+
+    /* Number of status register reads for the current conversion */
+    uint32_t conv_polls;
+
+    /* Register shadow enable (0 -> every access goes to the bus) */
+    uint8_t shadow_enabled;
+
+    /* Register shadow of the control registers */
+    struct reg_shadow shadow;
+
+    /* Bus transaction counters */
+    struct bus_stats stats;
 };
 
 /* Structure that contains ambient data measured by the sensor device  */
@@ -78,7 +160,7 @@ void user_delay_us(uint32_t period, void *intf_ptr);
 void print_sensor_data(struct bme280_data *comp_data);
 
 /*!
- *  @brief Function for reading the sensor's registers through I2C bus.
+ *  @brief Function for reading the sensor's registers through the transport of the identifier.
  *
  *  @param[in] reg_addr       : Register address.
  *  @param[out] data          : Pointer to the data buffer to store the read data.
@@ -95,7 +177,7 @@ void print_sensor_data(struct bme280_data *comp_data);
 int8_t user_i2c_read(uint8_t reg_addr, uint8_t *data, uint32_t len, void *intf_ptr);
 
 /*!
- *  @brief Function for writing the sensor's registers through I2C bus.
+ *  @brief Function for writing the sensor's registers through the transport of the identifier.
  *
  *  @param[in] reg_addr       : Register address.
  *  @param[in] data           : Pointer to the data buffer whose value is to be written.
@@ -111,6 +193,41 @@ int8_t user_i2c_read(uint8_t reg_addr, uint8_t *data, uint32_t len, void *intf_p
  */
 int8_t user_i2c_write(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *intf_ptr);
 
+/*!
+ *  @brief Function for reading the sensor's registers through the control register shadow.
+ *         Reads of valid shadowed registers are served without bus access.
+ *
+ *  @param[in] reg_addr       : Register address.
+ *  @param[out] data          : Pointer to the data buffer to store the read data.
+ *  @param[in] len            : No of bytes to read.
+ *  @param[in, out] intf_ptr  : Sensor device identifier structure
+ *
+ *  @return Status of execution
+ *
+ *  @retval 0 -> Success
+ *  @retval > 0 -> Failure Info
+ *
+ */
+int8_t shadow_i2c_read(uint8_t reg_addr, uint8_t *data, uint32_t len, void *intf_ptr);
+
+/*!
+ *  @brief Function for writing the sensor's registers through the control register shadow.
+ *         Writes that would not change shadowed registers are skipped, soft reset
+ *         invalidates the shadow.
+ *
+ *  @param[in] reg_addr       : Register address.
+ *  @param[in] data           : Pointer to the data buffer whose value is to be written.
+ *  @param[in] len            : No of bytes to write.
+ *  @param[in, out] intf_ptr  : Sensor device identifier structure
+ *
+ *  @return Status of execution
+ *
+ *  @retval BME280_OK -> Success
+ *  @retval BME280_E_COMM_FAIL -> Communication failure.
+ *
+ */
+int8_t shadow_i2c_write(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *intf_ptr);
+
 /*!
  * @brief Function reads temperature, humidity and pressure data in forced mode.
  *
@@ -128,6 +245,8 @@ int8_t stream_sensor_data_forced_mode(struct bme280_dev *dev);
 
 /*!
  * @brief Initializes the sensor device with settings optimized for weather monitoring.
+ *        Opens the transport selected by the transport_name, bus_path, dev_addr and
+ *        trace_path fields of the identifier (unset fields select the defaults).
  *
  * @param[in, out] id              	: Sensor device identifier structure
  * @param[in, out] dev       		: Sensor device settings structure
@@ -167,6 +286,146 @@ uint32_t get_min_delay(struct identifier *id, struct bme280_dev *dev);
  */
  int get_sensor_data(struct identifier *id, struct bme280_dev *dev, uint32_t req_delay_ms, struct sensor_data *data);
  
+/*!
+ * @brief Function that triggers a forced mode conversion (first phase of an acquisition).
+ *        Locks protecting the sensor may be released until poll_conversion is called.
+ *
+ * @param[in, out] id              	: Sensor device identifier structure
+ * @param[in, out] dev       		: Sensor device settings structure
+ * @param[in] req_delay_ms			: Worst-case delay in milliseconds required for measurement completion
+ * @param[out] wait_us				: Time in microseconds to wait before the first poll_conversion call
+ * 
+ * @return Status of execution.
+ *
+ * @retval 0  -> Success
+ * @retval -1 -> Failure
+ */
+ int start_conversion(struct identifier *id, struct bme280_dev *dev, uint32_t req_delay_ms, uint32_t *wait_us);
+ 
+/*!
+ * @brief Function that reads the measuring bit of the status register once (second phase of an acquisition).
+ *
+ * @param[in, out] id              	: Sensor device identifier structure
+ * @param[in, out] dev       		: Sensor device settings structure
+ * @param[out] wait_us				: Time in microseconds to wait before the next call (if still converting)
+ * 
+ * @return Status of execution.
+ *
+ * @retval 1  -> Conversion completed
+ * @retval 0  -> Conversion still running
+ * @retval -1 -> Failure (including conversion timeout)
+ */
+ int poll_conversion(struct identifier *id, struct bme280_dev *dev, uint32_t *wait_us);
+ 
+/*!
+ * @brief Function that reads the data registers (last phase of an acquisition).
+ *
+ * @param[in, out] id              	: Sensor device identifier structure
+ * @param[in, out] dev       		: Sensor device settings structure
+ * @param[out] data					: Ambient data measured by the sensor device
+ * 
+ * @return Status of execution.
+ *
+ * @retval 0  -> Success
+ * @retval -1 -> Failure
+ */
+ int read_sensor_data(struct identifier *id, struct bme280_dev *dev, struct sensor_data *data);
+ 
+/*!
+ * @brief Function that reads the raw data registers (first half of read_sensor_data).
+ *
+ * @param[in, out] id              	: Sensor device identifier structure
+ * @param[in, out] dev       		: Sensor device settings structure
+ * @param[out] uncomp_data			: Raw pressure, temperature and humidity data
+ * 
+ * @return Status of execution.
+ *
+ * @retval 0  -> Success
+ * @retval -1 -> Failure
+ */
+ int read_sensor_regs(struct identifier *id, struct bme280_dev *dev, struct bme280_uncomp_data *uncomp_data);
+ 
+/*!
+ * @brief Function that compensates raw data registers (second half of read_sensor_data, no bus access).
+ *
+ * @param[in] dev       			: Sensor device settings structure (calibration data)
+ * @param[in] uncomp_data			: Raw pressure, temperature and humidity data
+ * @param[out] data					: Ambient data measured by the sensor device
+ * 
+ * @return Status of execution.
+ *
+ * @retval 0  -> Success
+ * @retval -1 -> Failure
+ */
+ int compensate_sensor_data(struct bme280_dev *dev, const struct bme280_uncomp_data *uncomp_data, struct sensor_data *data);
+ 
+/*!
+ * @brief Function that returns sensor data based on the device settings. Instead of sleeping
+ *        the worst-case delay it polls the measuring bit of the status register with
+ *        exponential backoff and reads the data as soon as the conversion completes.
+ *        The expected conversion time is learned per sensor, so the first status read
+ *        is normally issued just before completion.
+ *
+ * @param[in, out] id              	: Sensor device identifier structure
+ * @param[in, out] dev       		: Sensor device settings structure
+ * @param[in] req_delay_ms			: Worst-case delay in milliseconds required for measurement completion
+ * @param[out] data					: Ambient data measured by the sensor device
+ * 
+ * @return Status of execution.
+ *
+ * @retval 0  -> Success
+ * @retval -1 -> Failure (including conversion timeout)
+ */
+ int get_sensor_data_poll(struct identifier *id, struct bme280_dev *dev, uint32_t req_delay_ms, struct sensor_data *data);
+ 
+/*!
+ * @brief Function that puts the sensor into normal mode (continuous conversions) with
+ *        the largest standby time that still yields a fresh sample every period.
+ *        Call again after changing the sensor settings (they put the sensor to sleep).
+ *        The data registers are valid after the first conversion (see get_min_delay).
+ *
+ * @param[in, out] id              	: Sensor device identifier structure
+ * @param[in, out] dev       		: Sensor device settings structure
+ * @param[in] period_us				: Period in microseconds the data registers are read with
+ * 
+ * @return Status of execution.
+ *
+ * @retval 0  -> Success
+ * @retval -1 -> Failure
+ */
+ int set_normal_mode(struct identifier *id, struct bme280_dev *dev, uint64_t period_us);
+ 
+/*!
+ * @brief Function that writes the oversampling, filter and standby settings of the device
+ *        structure to the sensor in a single register burst (ctrl_hum, ctrl_meas, config).
+ *        Leaves the sensor in sleep mode. Unlike bme280_set_sensor_settings it neither
+ *        reads the registers back nor soft-resets the sensor.
+ *
+ * @param[in, out] id              	: Sensor device identifier structure
+ * @param[in, out] dev       		: Sensor device settings structure
+ * 
+ * @return Status of execution.
+ *
+ * @retval 0  -> Success
+ * @retval -1 -> Failure
+ */
+int write_sensor_settings(struct identifier *id, struct bme280_dev *dev);
+
+/*!
+ * @brief Function that returns the latest sensor data while the sensor runs in normal mode.
+ *        Only reads the data registers (single burst read, no mode change or delay).
+ *
+ * @param[in, out] id              	: Sensor device identifier structure
+ * @param[in, out] dev       		: Sensor device settings structure
+ * @param[out] data					: Ambient data measured by the sensor device
+ * 
+ * @return Status of execution.
+ *
+ * @retval 0  -> Success
+ * @retval -1 -> Failure
+ */
+ int get_sensor_data_normal_mode(struct identifier *id, struct bme280_dev *dev, struct sensor_data *data);
+ 
  /*!
  * @brief Function that closes communication with the sensor device.
  *
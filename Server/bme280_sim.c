@@ -0,0 +1,341 @@
+/*
+ * FileName:    bme280_sim.c
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ *
+ * Desc.:       Simulated BME280 register model. Conversions take the typical
+ *              measurement time of the datasheet (appendix B) for the latched
+ *              oversampling settings; normal mode cycles through conversion and
+ *              standby periods on CLOCK_MONOTONIC. Skipped channels read back
+ *              their reset values (0x80000 / 0x8000) like the real sensor.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "bme280_defs.h"
+#include "bme280_sim.h"
+
+/******************************************************************************/
+/*!                         Own macros                                        */
+#define SIM_NSEC_PER_USEC           (1000ULL)
+#define SIM_NVM_COPY_US             (1000)
+#define SIM_PATTERN_PERIOD          (600)       // Samples per data pattern period
+
+#define SIM_ADC_T_BASE              (519888)    // ~25 deg C with the calibration below
+#define SIM_ADC_T_SWING             (4000)
+#define SIM_ADC_P_BASE              (415148)    // ~1006 hPa with the calibration below
+#define SIM_ADC_P_SWING             (1500)
+#define SIM_ADC_H_BASE              (27000)     // ~45 %RH with the calibration below
+#define SIM_ADC_H_SWING             (1200)
+
+#define SIM_ADC_PT_SKIPPED          (0x80000)
+#define SIM_ADC_H_SKIPPED           (0x8000)
+
+/* Calibration data (temperature and pressure trimming: datasheet example values) */
+static const uint8_t sim_calib_tp[BME280_TEMP_PRESS_CALIB_DATA_LEN] = {
+    0x70, 0x6B,     /* dig_T1 = 27504 */
+    0x43, 0x67,     /* dig_T2 = 26435 */
+    0x18, 0xFC,     /* dig_T3 = -1000 */
+    0x7D, 0x8E,     /* dig_P1 = 36477 */
+    0x43, 0xD6,     /* dig_P2 = -10685 */
+    0xD0, 0x0B,     /* dig_P3 = 3024 */
+    0x27, 0x0B,     /* dig_P4 = 2855 */
+    0x8C, 0x00,     /* dig_P5 = 140 */
+    0xF9, 0xFF,     /* dig_P6 = -7 */
+    0x8C, 0x3C,     /* dig_P7 = 15500 */
+    0xF8, 0xC6,     /* dig_P8 = -14600 */
+    0x70, 0x17,     /* dig_P9 = 6000 */
+    0x00,           /* reserved */
+    0x4B            /* dig_H1 = 75 */
+};
+
+/* Calibration data (humidity trimming) */
+static const uint8_t sim_calib_h[BME280_HUMIDITY_CALIB_DATA_LEN] = {
+    0x6A, 0x01,     /* dig_H2 = 362 */
+    0x00,           /* dig_H3 = 0 */
+    0x14, 0x44,     /* dig_H4 = 324, dig_H5 = 68 */
+    0x04,
+    0x1E            /* dig_H6 = 30 */
+};
+
+/* Map oversampling register value to number of samples */
+static const uint8_t sim_osr_to_samples[8] = { 0, 1, 2, 4, 8, 16, 16, 16 };
+
+/* Map standby register value to standby time [usec] */
+static const uint32_t sim_standby_us[8] = { 500, 62500, 125000, 250000, 500000, 1000000, 10000, 20000 };
+
+/*!
+ * @brief This internal API returns the monotonic time in nanoseconds.
+ */
+static uint64_t sim_now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/*!
+ * @brief This internal API returns a triangle wave in [-swing, swing] over the sample index.
+ */
+static int32_t sim_triangle(uint32_t index, int32_t swing)
+{
+    int32_t phase = (int32_t)(index % SIM_PATTERN_PERIOD);
+    int32_t half = SIM_PATTERN_PERIOD / 2;
+
+    if (phase > half)
+    {
+        phase = SIM_PATTERN_PERIOD - phase;
+    }
+
+    return (((2 * phase) - half) * swing) / half;
+}
+
+/*!
+ * @brief This internal API computes the typical conversion time for the given settings.
+ */
+static uint32_t sim_conv_time_us(uint8_t ctrl_meas, uint8_t osr_h)
+{
+    uint32_t osr_t = sim_osr_to_samples[BME280_GET_BITS(ctrl_meas, BME280_CTRL_TEMP)];
+    uint32_t osr_p = sim_osr_to_samples[BME280_GET_BITS(ctrl_meas, BME280_CTRL_PRESS)];
+    uint32_t osr_hum = sim_osr_to_samples[osr_h & BME280_CTRL_HUM_MSK];
+    uint32_t conv_us = 1000;
+
+    conv_us += 2000 * osr_t;
+
+    if (osr_p)
+    {
+        conv_us += (2000 * osr_p) + 500;
+    }
+
+    if (osr_hum)
+    {
+        conv_us += (2000 * osr_hum) + 500;
+    }
+
+    return conv_us;
+}
+
+/*!
+ * @brief This internal API writes the data registers for the given conversion.
+ */
+static void sim_latch_data(struct bme280_sim *sim, uint32_t index)
+{
+    uint8_t ctrl_meas = sim->regs[BME280_CTRL_MEAS_ADDR];
+    uint32_t adc_t = SIM_ADC_PT_SKIPPED;
+    uint32_t adc_p = SIM_ADC_PT_SKIPPED;
+    uint32_t adc_h = SIM_ADC_H_SKIPPED;
+    uint8_t *data = &sim->regs[BME280_DATA_ADDR];
+
+    if (BME280_GET_BITS(ctrl_meas, BME280_CTRL_TEMP))
+    {
+        adc_t = (uint32_t)(SIM_ADC_T_BASE + sim_triangle(index, SIM_ADC_T_SWING));
+    }
+
+    if (BME280_GET_BITS(ctrl_meas, BME280_CTRL_PRESS))
+    {
+        adc_p = (uint32_t)(SIM_ADC_P_BASE + sim_triangle(index + (SIM_PATTERN_PERIOD / 4), SIM_ADC_P_SWING));
+    }
+
+    if (sim->osr_h & BME280_CTRL_HUM_MSK)
+    {
+        adc_h = (uint32_t)(SIM_ADC_H_BASE + sim_triangle(index + (SIM_PATTERN_PERIOD / 2), SIM_ADC_H_SWING));
+    }
+
+    data[0] = (uint8_t)(adc_p >> 12);
+    data[1] = (uint8_t)(adc_p >> 4);
+    data[2] = (uint8_t)(adc_p << 4);
+    data[3] = (uint8_t)(adc_t >> 12);
+    data[4] = (uint8_t)(adc_t >> 4);
+    data[5] = (uint8_t)(adc_t << 4);
+    data[6] = (uint8_t)(adc_h >> 8);
+    data[7] = (uint8_t)adc_h;
+}
+
+/*!
+ * @brief This internal API advances the model to the current time.
+ */
+static void sim_update(struct bme280_sim *sim)
+{
+    uint64_t now = sim_now_ns();
+    uint64_t elapsed_us;
+    uint64_t cycle_us;
+    uint32_t completed;
+    uint8_t status = 0;
+
+    if (now < sim->reset_done_ns)
+    {
+        status |= BME280_STATUS_IM_UPDATE;
+    }
+
+    if (sim->mode == BME280_FORCED_MODE)
+    {
+        if (now >= sim->start_ns + (uint64_t)sim->conv_us * SIM_NSEC_PER_USEC)
+        {
+            /* Conversion finished: latch data and return to sleep mode */
+            sim_latch_data(sim, sim->sample_count++);
+            sim->mode = BME280_SLEEP_MODE;
+            sim->regs[BME280_CTRL_MEAS_ADDR] &= (uint8_t)~BME280_SENSOR_MODE_MSK;
+        }
+        else
+        {
+            status |= BME280_SIM_STATUS_MEASURING;
+        }
+    }
+    else if (sim->mode == BME280_NORMAL_MODE)
+    {
+        elapsed_us = (now - sim->start_ns) / SIM_NSEC_PER_USEC;
+        cycle_us = (uint64_t)sim->conv_us + sim->standby_us;
+        completed = (uint32_t)(elapsed_us / cycle_us);
+
+        if ((elapsed_us % cycle_us) >= sim->conv_us)
+        {
+            completed++;
+        }
+        else
+        {
+            status |= BME280_SIM_STATUS_MEASURING;
+        }
+
+        if (completed > sim->cycle_count)
+        {
+            /* Data registers hold the result of the most recent conversion */
+            sim->sample_count += completed - sim->cycle_count;
+            sim->cycle_count = completed;
+            sim_latch_data(sim, sim->sample_count - 1);
+        }
+    }
+
+    sim->regs[BME280_STATUS_REG_ADDR] = status;
+}
+
+/*!
+ * @brief This internal API resets the control and data registers.
+ */
+static void sim_reset(struct bme280_sim *sim)
+{
+    sim->regs[BME280_CTRL_HUM_ADDR] = 0;
+    sim->regs[BME280_CTRL_MEAS_ADDR] = 0;
+    sim->regs[BME280_CONFIG_ADDR] = 0;
+    sim->regs[BME280_STATUS_REG_ADDR] = 0;
+    sim->mode = BME280_SLEEP_MODE;
+    sim->osr_h = 0;
+    sim->reset_done_ns = sim_now_ns() + (uint64_t)SIM_NVM_COPY_US * SIM_NSEC_PER_USEC;
+
+    /* Skipped/reset values in the data registers */
+    sim->regs[BME280_DATA_ADDR + 0] = 0x80;
+    sim->regs[BME280_DATA_ADDR + 1] = 0x00;
+    sim->regs[BME280_DATA_ADDR + 2] = 0x00;
+    sim->regs[BME280_DATA_ADDR + 3] = 0x80;
+    sim->regs[BME280_DATA_ADDR + 4] = 0x00;
+    sim->regs[BME280_DATA_ADDR + 5] = 0x00;
+    sim->regs[BME280_DATA_ADDR + 6] = 0x80;
+    sim->regs[BME280_DATA_ADDR + 7] = 0x00;
+}
+
+/*!
+ * @brief This internal API applies a single register write.
+ */
+static void sim_write_reg(struct bme280_sim *sim, uint8_t reg_addr, uint8_t value)
+{
+    switch (reg_addr)
+    {
+        case BME280_RESET_ADDR:
+            if (value == BME280_SOFT_RESET_COMMAND)
+            {
+                sim_reset(sim);
+            }
+
+            break;
+
+        case BME280_CTRL_HUM_ADDR:
+            /* Takes effect after the next ctrl_meas write */
+            sim->regs[reg_addr] = value & BME280_CTRL_HUM_MSK;
+            break;
+
+        case BME280_CTRL_MEAS_ADDR:
+            sim->regs[reg_addr] = value;
+            sim->osr_h = sim->regs[BME280_CTRL_HUM_ADDR];
+            sim->conv_us = sim_conv_time_us(value, sim->osr_h);
+            sim->standby_us = sim_standby_us[BME280_GET_BITS(sim->regs[BME280_CONFIG_ADDR], BME280_STANDBY)];
+            sim->mode = BME280_GET_BITS_POS_0(value, BME280_SENSOR_MODE);
+
+            /* Both 01 and 10 select forced mode */
+            if (sim->mode == 0x02)
+            {
+                sim->mode = BME280_FORCED_MODE;
+            }
+
+            sim->start_ns = sim_now_ns();
+            sim->cycle_count = 0;
+            break;
+
+        case BME280_CONFIG_ADDR:
+            sim->regs[reg_addr] = value;
+            sim->standby_us = sim_standby_us[BME280_GET_BITS(value, BME280_STANDBY)];
+            break;
+
+        default:
+            /* Read-only or reserved register */
+            break;
+    }
+}
+
+/*!
+ * @brief This API puts the simulated sensor into power-on reset state.
+ */
+void bme280_sim_init(struct bme280_sim *sim)
+{
+    memset(sim, 0, sizeof(*sim));
+
+    sim->regs[BME280_CHIP_ID_ADDR] = BME280_CHIP_ID;
+    memcpy(&sim->regs[BME280_TEMP_PRESS_CALIB_DATA_ADDR], sim_calib_tp, sizeof(sim_calib_tp));
+    memcpy(&sim->regs[BME280_HUMIDITY_CALIB_DATA_ADDR], sim_calib_h, sizeof(sim_calib_h));
+
+    sim_reset(sim);
+    sim->reset_done_ns = 0;
+}
+
+/*!
+ * @brief This API reads the registers of the simulated sensor.
+ */
+int8_t bme280_sim_read(struct bme280_sim *sim, uint8_t reg_addr, uint8_t *data, uint32_t len)
+{
+    uint32_t i;
+
+    sim_update(sim);
+
+    for (i = 0; i < len; i++)
+    {
+        data[i] = sim->regs[(uint8_t)(reg_addr + i)];
+    }
+
+    return BME280_OK;
+}
+
+/*!
+ * @brief This API writes the registers of the simulated sensor.
+ */
+int8_t bme280_sim_write(struct bme280_sim *sim, uint8_t reg_addr, const uint8_t *data, uint32_t len)
+{
+    uint32_t i;
+
+    sim_update(sim);
+
+    if (len == 0)
+    {
+        return BME280_OK;
+    }
+
+    /* First register, then (address, data) pairs */
+    sim_write_reg(sim, reg_addr, data[0]);
+
+    for (i = 1; (i + 1) < len; i += 2)
+    {
+        sim_write_reg(sim, data[i], data[i + 1]);
+    }
+
+    return BME280_OK;
+}
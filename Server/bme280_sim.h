@@ -0,0 +1,97 @@
+/*
+ * FileName:    bme280_sim.h
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ *
+ * Desc.:       Simulated BME280 register model. The model implements the register
+ *              file of the sensor (chip id, calibration, control, status and data
+ *              registers) with datasheet conversion timing for sleep, forced and
+ *              normal modes, so the driver and the server can be exercised without
+ *              a sensor attached. Measurement values are deterministic.
+ */
+
+#ifndef BME280_SIM_H_
+#define BME280_SIM_H_
+
+#include <stdint.h>
+
+/******************************************************************************/
+/*!                               Macros                                      */
+#define BME280_SIM_REG_FILE_SIZE    (256)
+
+#define BME280_SIM_STATUS_MEASURING (0x08)
+
+/******************************************************************************/
+/*!                               Structures                                  */
+
+/* Structure that contains the state of a simulated sensor */
+struct bme280_sim
+{
+    /* Register file */
+    uint8_t regs[BME280_SIM_REG_FILE_SIZE];
+
+    /* Power mode latched at the last ctrl_meas write */
+    uint8_t mode;
+
+    /* Humidity oversampling latched at the last ctrl_meas write */
+    uint8_t osr_h;
+
+    /* Start of the current conversion (forced) or of the first cycle (normal) [nsec] */
+    uint64_t start_ns;
+
+    /* End of NVM copy after soft reset [nsec] */
+    uint64_t reset_done_ns;
+
+    /* Conversion time for the latched settings [usec] */
+    uint32_t conv_us;
+
+    /* Standby time for the latched settings [usec] */
+    uint32_t standby_us;
+
+    /* Number of conversions completed since power-on (drives data pattern) */
+    uint32_t sample_count;
+
+    /* Number of conversions completed in the current normal mode run */
+    uint32_t cycle_count;
+};
+
+/****************************************************************************/
+/*!                         Functions                                       */
+
+/*!
+ * @brief Function that puts the simulated sensor into power-on reset state.
+ *
+ * @param[out] sim          : Simulated sensor state
+ */
+void bme280_sim_init(struct bme280_sim *sim);
+
+/*!
+ * @brief Function that reads the registers of the simulated sensor (auto-increment).
+ *
+ * @param[in, out] sim      : Simulated sensor state
+ * @param[in] reg_addr      : Register address.
+ * @param[out] data         : Pointer to the data buffer to store the read data.
+ * @param[in] len           : No of bytes to read.
+ *
+ * @return Status of execution
+ *
+ * @retval 0 -> Success
+ */
+int8_t bme280_sim_read(struct bme280_sim *sim, uint8_t reg_addr, uint8_t *data, uint32_t len);
+
+/*!
+ * @brief Function that writes the registers of the simulated sensor.
+ *        Burst writes use the register address / data pair format of the driver.
+ *
+ * @param[in, out] sim      : Simulated sensor state
+ * @param[in] reg_addr      : Register address.
+ * @param[in] data          : Pointer to the data buffer whose value is to be written.
+ * @param[in] len           : No of bytes to write.
+ *
+ * @return Status of execution
+ *
+ * @retval 0 -> Success
+ */
+int8_t bme280_sim_write(struct bme280_sim *sim, uint8_t reg_addr, const uint8_t *data, uint32_t len);
+
+#endif /* BME280_SIM_H_ */
@@ -0,0 +1,479 @@
+/*
+ * FileName:    bme280_transport.c
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ *
+ * Desc.:       Register transport backends of the BME280 sensor interface
+ *              (i2c-dev, simulated register model, trace replay) and trace recording.
+ *
+ *              Trace file format: the BME280_TRACE_MAGIC header followed by records of
+ *              <op> <register address> <length> <length bytes of data>, where the data of
+ *              a write record is the driver burst buffer (data[0], then address / data pairs).
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "bme280_defs.h"
+#include "bme280_transport.h"
+
+/******************************************************************************/
+/*!                         I2C backend                                       */
+
+/*!
+ * @brief This internal API opens the I2C bus character device.
+ */
+static int8_t i2c_open(struct bme280_transport *tp)
+{
+    if ((tp->fd = open(tp->path, O_RDWR)) < 0)
+    {
+        fprintf(stderr, "Failed to open the i2c bus %s\n", tp->path);
+        return BME280_E_COMM_FAIL;
+    }
+
+    return BME280_OK;
+}
+
+/*!
+ * @brief This internal API closes the I2C bus character device.
+ */
+static void i2c_close(struct bme280_transport *tp)
+{
+    if ((tp->fd >= 0) && (close(tp->fd) < 0))
+    {
+        fprintf(stderr, "Failed to close I2C bus file descriptor.\n");
+    }
+    tp->fd = -1;
+}
+
+/*!
+ * @brief This internal API reads registers with a combined write-address / read-data I2C transfer.
+ */
+static int8_t i2c_read(struct bme280_transport *tp, uint8_t reg_addr, uint8_t *data, uint32_t len)
+{
+    struct i2c_msg msgs[2];
+    struct i2c_rdwr_ioctl_data msgSet[1];
+
+    msgs[0].addr = tp->dev_addr;
+    msgs[0].flags = 0;
+    msgs[0].len = 1;
+    msgs[0].buf = &reg_addr;
+
+    msgs[1].addr = tp->dev_addr;
+    msgs[1].flags = I2C_M_RD;
+    msgs[1].len = len;
+    msgs[1].buf = data;
+
+    msgSet[0].msgs = msgs;
+    msgSet[0].nmsgs = 2;
+
+    if (ioctl(tp->fd, I2C_RDWR, msgSet) < 0)
+    {
+        perror("ioctl(I2C_RDWR) in i2c_read");
+        return BME280_E_COMM_FAIL;
+    }
+
+    return BME280_OK;
+}
+
+/*!
+ * @brief This internal API writes registers with a single I2C transfer (address byte + data on the stack).
+ */
+static int8_t i2c_write(struct bme280_transport *tp, uint8_t reg_addr, const uint8_t *data, uint32_t len)
+{
+    uint8_t buf[BME280_TRANSPORT_WRITE_MAX + 1];
+
+    struct i2c_msg msgs[1];
+    struct i2c_rdwr_ioctl_data msgSet[1];
+
+    buf[0] = reg_addr;
+    memcpy(buf + 1, data, len);
+
+    msgs[0].addr = tp->dev_addr;
+    msgs[0].flags = 0;
+    msgs[0].len = len + 1;
+    msgs[0].buf = buf;
+
+    msgSet[0].msgs = msgs;
+    msgSet[0].nmsgs = 1;
+
+    if (ioctl(tp->fd, I2C_RDWR, msgSet) < 0)
+    {
+        perror("ioctl(I2C_RDWR) in i2c_write");
+        return BME280_E_COMM_FAIL;
+    }
+
+    return BME280_OK;
+}
+
+/******************************************************************************/
+/*!                         Simulated sensor backend                          */
+
+/*!
+ * @brief This internal API powers on the simulated sensor.
+ */
+static int8_t sim_open(struct bme280_transport *tp)
+{
+    bme280_sim_init(&tp->sim);
+
+    return BME280_OK;
+}
+
+/*!
+ * @brief This internal API powers off the simulated sensor (nothing to release).
+ */
+static void sim_close(struct bme280_transport *tp)
+{
+}
+
+/*!
+ * @brief This internal API reads the registers of the simulated sensor.
+ */
+static int8_t sim_read(struct bme280_transport *tp, uint8_t reg_addr, uint8_t *data, uint32_t len)
+{
+    return bme280_sim_read(&tp->sim, reg_addr, data, len);
+}
+
+/*!
+ * @brief This internal API writes the registers of the simulated sensor.
+ */
+static int8_t sim_write(struct bme280_transport *tp, uint8_t reg_addr, const uint8_t *data, uint32_t len)
+{
+    return bme280_sim_write(&tp->sim, reg_addr, data, len);
+}
+
+/******************************************************************************/
+/*!                         Trace replay backend                              */
+
+/*!
+ * @brief This internal API loads and validates the trace file.
+ */
+static int8_t replay_open(struct bme280_transport *tp)
+{
+    struct bme280_replay *replay = &tp->replay;
+    struct stat st;
+    uint8_t magic[BME280_TRACE_MAGIC_LEN];
+    uint32_t pos;
+    ssize_t len;
+    int fd;
+
+    memset(replay, 0, sizeof(*replay));
+
+    if ((fd = open(tp->path, O_RDONLY)) < 0)
+    {
+        fprintf(stderr, "Failed to open register trace %s\n", tp->path);
+        return BME280_E_COMM_FAIL;
+    }
+
+    if ((fstat(fd, &st) < 0) || (st.st_size <= BME280_TRACE_MAGIC_LEN) ||
+        (read(fd, magic, sizeof(magic)) != sizeof(magic)) ||
+        (0 != memcmp(magic, BME280_TRACE_MAGIC, BME280_TRACE_MAGIC_LEN)))
+    {
+        fprintf(stderr, "Invalid register trace %s\n", tp->path);
+        close(fd);
+        return BME280_E_COMM_FAIL;
+    }
+
+    /* Load records */
+    replay->len = (uint32_t)(st.st_size - BME280_TRACE_MAGIC_LEN);
+    replay->buf = (uint8_t*)malloc(replay->len);
+    if (NULL == replay->buf)
+    {
+        close(fd);
+        return BME280_E_COMM_FAIL;
+    }
+
+    len = read(fd, replay->buf, replay->len);
+    close(fd);
+    if (len != (ssize_t)replay->len)
+    {
+        fprintf(stderr, "Failed to read register trace %s\n", tp->path);
+        free(replay->buf);
+        replay->buf = NULL;
+        return BME280_E_COMM_FAIL;
+    }
+
+    /* Drop a truncated last record */
+    pos = 0;
+    while ((pos + BME280_TRACE_HDR_LEN <= replay->len) &&
+           (pos + BME280_TRACE_HDR_LEN + replay->buf[pos + 2] <= replay->len))
+    {
+        pos += BME280_TRACE_HDR_LEN + replay->buf[pos + 2];
+    }
+    replay->len = pos;
+
+    if (0 == replay->len)
+    {
+        fprintf(stderr, "Empty register trace %s\n", tp->path);
+        free(replay->buf);
+        replay->buf = NULL;
+        return BME280_E_COMM_FAIL;
+    }
+
+    return BME280_OK;
+}
+
+/*!
+ * @brief This internal API releases the loaded trace.
+ */
+static void replay_close(struct bme280_transport *tp)
+{
+    free(tp->replay.buf);
+    tp->replay.buf = NULL;
+    tp->replay.len = 0;
+}
+
+/*!
+ * @brief This internal API answers a read with the next matching read record of the trace.
+ */
+static int8_t replay_read(struct bme280_transport *tp, uint8_t reg_addr, uint8_t *data, uint32_t len)
+{
+    struct bme280_replay *replay = &tp->replay;
+    uint32_t pos = replay->pos;
+    uint32_t scanned = 0;
+    uint32_t rec_len;
+    uint32_t next;
+    uint32_t i;
+    uint8_t local = 1;
+
+    /*
+     * Note:
+     *
+     * Registers the driver wrote (control registers) and registers the
+     * trace never read are answered from a register file. Other reads
+     * (chip id, calibration, status, data) take the next matching read
+     * record; the search starts at the last match and wraps around, so
+     * a short recording is replayed in a loop. A run of identical reads
+     * (e.g. status polls while measuring) is replayed as a single read,
+     * since replay does not reproduce the timing of the recording.
+     */
+    for (i = 0; i < len; i++)
+    {
+        local &= replay->local[(uint8_t)(reg_addr + i)];
+    }
+
+    while (!local && (scanned < replay->len))
+    {
+        if (pos >= replay->len)
+        {
+            pos = 0;
+        }
+
+        rec_len = replay->buf[pos + 2];
+        next = pos + BME280_TRACE_HDR_LEN + rec_len;
+        if ((BME280_TRACE_OP_READ == replay->buf[pos]) && (reg_addr == replay->buf[pos + 1]) && (len == rec_len))
+        {
+            memcpy(data, &replay->buf[pos + BME280_TRACE_HDR_LEN], len);
+
+            /* Skip repetitions of the same read */
+            while ((next < replay->len) &&
+                   (0 == memcmp(&replay->buf[pos], &replay->buf[next], BME280_TRACE_HDR_LEN + rec_len)))
+            {
+                next += BME280_TRACE_HDR_LEN + rec_len;
+            }
+            replay->pos = next;
+
+            return BME280_OK;
+        }
+
+        scanned += next - pos;
+        pos = next;
+    }
+    replay->local[reg_addr] = 1;
+
+    for (i = 0; i < len; i++)
+    {
+        data[i] = replay->regs[(uint8_t)(reg_addr + i)];
+    }
+
+    return BME280_OK;
+}
+
+/*!
+ * @brief This internal API applies a register write to the register file of the replay backend.
+ */
+static void replay_write_reg(struct bme280_replay *replay, uint8_t reg_addr, uint8_t value)
+{
+    /* Forced conversions complete at once, the sensor is back in sleep mode */
+    if ((BME280_CTRL_MEAS_ADDR == reg_addr) &&
+        ((BME280_FORCED_MODE == (value & BME280_SENSOR_MODE_MSK)) || (0x02 == (value & BME280_SENSOR_MODE_MSK))))
+    {
+        value &= ~BME280_SENSOR_MODE_MSK;
+    }
+
+    /* Soft reset restores the power-on values of the control registers */
+    if ((BME280_RESET_ADDR == reg_addr) && (BME280_SOFT_RESET_COMMAND == value))
+    {
+        replay->regs[BME280_CTRL_HUM_ADDR] = 0;
+        replay->regs[BME280_CTRL_MEAS_ADDR] = 0;
+        replay->regs[BME280_CONFIG_ADDR] = 0;
+
+        return;
+    }
+
+    replay->regs[reg_addr] = value;
+    replay->local[reg_addr] = 1;
+}
+
+/*!
+ * @brief This internal API applies a write to the register file of the replay backend.
+ */
+static int8_t replay_write(struct bme280_transport *tp, uint8_t reg_addr, const uint8_t *data, uint32_t len)
+{
+    uint32_t i;
+
+    replay_write_reg(&tp->replay, reg_addr, data[0]);
+    for (i = 1; (i + 1) < len; i += 2)
+    {
+        replay_write_reg(&tp->replay, data[i], data[i + 1]);
+    }
+
+    return BME280_OK;
+}
+
+/******************************************************************************/
+/*!                         Transport                                         */
+
+/* Available backends */
+static const struct bme280_transport_ops transport_ops[] = {
+    { BME280_TRANSPORT_I2C, i2c_open, i2c_close, i2c_read, i2c_write },
+    { BME280_TRANSPORT_SIM, sim_open, sim_close, sim_read, sim_write },
+    { BME280_TRANSPORT_REPLAY, replay_open, replay_close, replay_read, replay_write }
+};
+
+/*!
+ * @brief This internal API appends a transaction to the trace file.
+ */
+static void trace_record(struct bme280_transport *tp, uint8_t op, uint8_t reg_addr, const uint8_t *data, uint32_t len)
+{
+    uint8_t rec[BME280_TRACE_HDR_LEN + UINT8_MAX];
+
+    if ((tp->trace_fd < 0) || (len > UINT8_MAX))
+    {
+        return;
+    }
+
+    rec[0] = op;
+    rec[1] = reg_addr;
+    rec[2] = (uint8_t)len;
+    memcpy(&rec[BME280_TRACE_HDR_LEN], data, len);
+
+    if (write(tp->trace_fd, rec, BME280_TRACE_HDR_LEN + len) < 0)
+    {
+        perror("write in trace_record");
+    }
+}
+
+/*!
+ * @brief This API opens a transport.
+ */
+int8_t bme280_transport_open(struct bme280_transport *tp, const char *name, const char *path, uint8_t dev_addr,
+                             const char *trace_path)
+{
+    int8_t rslt;
+    uint32_t i;
+
+    tp->ops = NULL;
+    tp->path = path;
+    tp->dev_addr = dev_addr;
+    tp->fd = -1;
+    tp->trace_fd = -1;
+
+    /* Select backend */
+    for (i = 0; i < sizeof(transport_ops) / sizeof(transport_ops[0]); i++)
+    {
+        if (0 == strcmp(name, transport_ops[i].name))
+        {
+            tp->ops = &transport_ops[i];
+        }
+    }
+
+    if (NULL == tp->ops)
+    {
+        fprintf(stderr, "Unknown sensor transport %s\n", name);
+        return BME280_E_DEV_NOT_FOUND;
+    }
+
+    rslt = tp->ops->open(tp);
+    if (rslt != BME280_OK)
+    {
+        return rslt;
+    }
+
+    /* Start recording */
+    if (NULL != trace_path)
+    {
+        tp->trace_fd = open(trace_path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+        if ((tp->trace_fd < 0) || (write(tp->trace_fd, BME280_TRACE_MAGIC, BME280_TRACE_MAGIC_LEN) < 0))
+        {
+            fprintf(stderr, "Failed to create register trace %s\n", trace_path);
+            bme280_transport_close(tp);
+            return BME280_E_COMM_FAIL;
+        }
+    }
+
+    return BME280_OK;
+}
+
+/*!
+ * @brief This API closes a transport.
+ */
+void bme280_transport_close(struct bme280_transport *tp)
+{
+    if (tp->trace_fd >= 0)
+    {
+        close(tp->trace_fd);
+        tp->trace_fd = -1;
+    }
+
+    if (NULL != tp->ops)
+    {
+        tp->ops->close(tp);
+    }
+}
+
+/*!
+ * @brief This API reads registers through the transport.
+ */
+int8_t bme280_transport_read(struct bme280_transport *tp, uint8_t reg_addr, uint8_t *data, uint32_t len)
+{
+    int8_t rslt;
+
+    rslt = tp->ops->read(tp, reg_addr, data, len);
+    if (rslt == BME280_OK)
+    {
+        trace_record(tp, BME280_TRACE_OP_READ, reg_addr, data, len);
+    }
+
+    return rslt;
+}
+
+/*!
+ * @brief This API writes registers through the transport.
+ */
+int8_t bme280_transport_write(struct bme280_transport *tp, uint8_t reg_addr, const uint8_t *data, uint32_t len)
+{
+    int8_t rslt;
+
+    if ((0 == len) || (len > BME280_TRANSPORT_WRITE_MAX))
+    {
+        fprintf(stderr, "Invalid register write length %u\n", (unsigned int)len);
+        return BME280_E_INVALID_LEN;
+    }
+
+    rslt = tp->ops->write(tp, reg_addr, data, len);
+    if (rslt == BME280_OK)
+    {
+        trace_record(tp, BME280_TRACE_OP_WRITE, reg_addr, data, len);
+    }
+
+    return rslt;
+}
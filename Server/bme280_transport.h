@@ -0,0 +1,166 @@
+/*
+ * FileName:    bme280_transport.h
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ *
+ * Desc.:       Register transport of the BME280 sensor interface. A transport moves
+ *              register reads and writes between the driver and one of the backends:
+ *
+ *              i2c    : real sensor through the i2c-dev character device (I2C_RDWR)
+ *              sim    : simulated register model with datasheet timing (bme280_sim.c)
+ *              replay : register trace recorded earlier with any transport
+ *
+ *              Register accesses do not allocate memory. Any transport can record the
+ *              transactions it carries to a trace file which the replay backend reads.
+ */
+
+#ifndef BME280_TRANSPORT_H_
+#define BME280_TRANSPORT_H_
+
+#include <stdint.h>
+
+#include "bme280_sim.h"
+
+/******************************************************************************/
+/*!                               Macros                                      */
+#define BME280_TRANSPORT_I2C            ("i2c")
+#define BME280_TRANSPORT_SIM            ("sim")
+#define BME280_TRANSPORT_REPLAY         ("replay")
+
+#define BME280_TRANSPORT_WRITE_MAX      (32)        // Largest register write (interleaved burst) in bytes
+#define BME280_TRANSPORT_REG_COUNT      (256)       // Size of the register address space
+
+#define BME280_TRACE_MAGIC              ("BME280T1")  // Trace file header
+#define BME280_TRACE_MAGIC_LEN          (8)
+#define BME280_TRACE_OP_READ            ('R')
+#define BME280_TRACE_OP_WRITE           ('W')
+#define BME280_TRACE_HDR_LEN            (3)         // Record header: op, register address, length
+
+/******************************************************************************/
+/*!                               Structures                                  */
+
+struct bme280_transport;
+
+/* Structure that contains the operations of a transport backend */
+struct bme280_transport_ops
+{
+    /* Backend name */
+    const char *name;
+
+    /* Open backend (path: device or trace file) */
+    int8_t (*open)(struct bme280_transport *tp);
+
+    /* Close backend */
+    void (*close)(struct bme280_transport *tp);
+
+    /* Read registers (auto-increment) */
+    int8_t (*read)(struct bme280_transport *tp, uint8_t reg_addr, uint8_t *data, uint32_t len);
+
+    /* Write registers (driver burst format: data[0], then address / data pairs) */
+    int8_t (*write)(struct bme280_transport *tp, uint8_t reg_addr, const uint8_t *data, uint32_t len);
+};
+
+/* Structure that contains the state of the trace replay backend */
+struct bme280_replay
+{
+    /* Trace records (loaded once on open) */
+    uint8_t *buf;
+
+    /* Length of the trace records in bytes */
+    uint32_t len;
+
+    /* Offset of the record following the last matched read */
+    uint32_t pos;
+
+    /* Register file answering reads the trace has no record for */
+    uint8_t regs[BME280_TRANSPORT_REG_COUNT];
+
+    /* Registers answered from the register file (written by the driver or never read in the trace) */
+    uint8_t local[BME280_TRANSPORT_REG_COUNT];
+};
+
+/* Structure that contains a transport instance */
+struct bme280_transport
+{
+    /* Backend operations */
+    const struct bme280_transport_ops *ops;
+
+    /* I2C bus device or trace file path */
+    const char *path;
+
+    /* I2C slave address */
+    uint8_t dev_addr;
+
+    /* I2C bus file descriptor */
+    int fd;
+
+    /* Simulated sensor state */
+    struct bme280_sim sim;
+
+    /* Trace replay state */
+    struct bme280_replay replay;
+
+    /* Trace recording file descriptor (-1 -> not recording) */
+    int trace_fd;
+};
+
+/****************************************************************************/
+/*!                         Functions                                       */
+
+/*!
+ * @brief Function that opens a transport.
+ *
+ * @param[out] tp           : Transport instance
+ * @param[in] name          : Backend name (BME280_TRANSPORT_*)
+ * @param[in] path          : I2C bus device (i2c) or trace file (replay), unused for sim
+ * @param[in] dev_addr      : I2C slave address of the sensor
+ * @param[in] trace_path    : File to record the transactions to (NULL -> no recording)
+ *
+ * @return Status of execution
+ *
+ * @retval BME280_OK -> Success
+ * @retval BME280_E_DEV_NOT_FOUND -> Unknown backend
+ * @retval BME280_E_COMM_FAIL -> Failed to open device or trace file
+ */
+int8_t bme280_transport_open(struct bme280_transport *tp, const char *name, const char *path, uint8_t dev_addr,
+                             const char *trace_path);
+
+/*!
+ * @brief Function that closes a transport.
+ *
+ * @param[in, out] tp       : Transport instance
+ */
+void bme280_transport_close(struct bme280_transport *tp);
+
+/*!
+ * @brief Function that reads registers through the transport.
+ *
+ * @param[in, out] tp       : Transport instance
+ * @param[in] reg_addr      : Register address.
+ * @param[out] data         : Pointer to the data buffer to store the read data.
+ * @param[in] len           : No of bytes to read.
+ *
+ * @return Status of execution
+ *
+ * @retval BME280_OK -> Success
+ * @retval BME280_E_COMM_FAIL -> Communication failure.
+ */
+int8_t bme280_transport_read(struct bme280_transport *tp, uint8_t reg_addr, uint8_t *data, uint32_t len);
+
+/*!
+ * @brief Function that writes registers through the transport.
+ *
+ * @param[in, out] tp       : Transport instance
+ * @param[in] reg_addr      : Register address.
+ * @param[in] data          : Pointer to the data buffer whose value is to be written.
+ * @param[in] len           : No of bytes to write.
+ *
+ * @return Status of execution
+ *
+ * @retval BME280_OK -> Success
+ * @retval BME280_E_INVALID_LEN -> Write longer than BME280_TRANSPORT_WRITE_MAX
+ * @retval BME280_E_COMM_FAIL -> Communication failure.
+ */
+int8_t bme280_transport_write(struct bme280_transport *tp, uint8_t reg_addr, const uint8_t *data, uint32_t len);
+
+#endif /* BME280_TRANSPORT_H_ */
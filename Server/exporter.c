@@ -0,0 +1,712 @@
+/*
+ * FileName:    exporter.c
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ * 
+ * Desc.:       Source file containing the metrics exposition of the server.
+ * 
+ *              A minimal HTTP/1.1 listener serves the metrics registry (see metrics.c)
+ *              in the Prometheus text format (GET /metrics) to the monitoring. It runs
+ *              on its own thread with its own epoll loop and connection table, so scrapes
+ *              never take a service thread from the clients. Every response closes its
+ *              connection, idle connections are dropped after EXPORT_IDLE_TIMEOUT_MS.
+ *              The span trace (see tracer.c) is served as well (GET /trace).
+ * 
+ *              Histograms are exported with fixed 'le' buckets: a bucket counts the
+ *              values of the registry buckets lying wholly below its limit, so it may
+ *              miss values within the registry precision (see METRIC_HIST_SUB_BITS).
+ */
+
+#define _GNU_SOURCE                     // accept4
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include "bme280_qt_interf_v2.h"
+#include "myserver.h"
+
+/* Connection of a scraper */
+struct ExportConn {
+    
+    int socket;                         // -1: free slot
+    uint64_t lastActiveNs;              // Time of the last read or write [nsec]
+    size_t reqLen;
+    char req[EXPORT_REQ_MAX_LEN + 1];   // Request head (null terminated)
+    char *res;                          // Response (NULL: request head not complete yet)
+    size_t resLen;
+    size_t resSent;
+};
+
+/* Limits of the exported time histogram buckets [nsec] */
+static const uint64_t exportTimeBucketTable[] = {
+    
+    1000ULL, 2500ULL, 5000ULL, 10000ULL, 25000ULL, 50000ULL,
+    100000ULL, 250000ULL, 500000ULL, 1000000ULL, 2500000ULL, 5000000ULL,
+    10000000ULL, 25000000ULL, 50000000ULL, 100000000ULL, 250000000ULL, 500000000ULL,
+    1000000000ULL, 2500000000ULL, 5000000000ULL, 10000000000ULL
+};
+
+/* Limits of the exported size histogram buckets [byte] */
+static const uint64_t exportByteBucketTable[] = {
+    
+    256ULL, 1024ULL, 4096ULL, 16384ULL, 65536ULL, 262144ULL,
+    1048576ULL, 4194304ULL, 16777216ULL, 67108864ULL
+};
+
+static int exportSocket = -1;                           // Listening socket (-1: exposition disabled)
+static pthread_t exportThread;
+static struct ExportConn exportConnTable[EXPORT_CONN_MAX];
+
+/*
+ * Function 'appendExportText': appends formatted text to the response text.
+ */
+void appendExportText(struct ExportText *text, const char *format, ...) {
+    
+    va_list args;
+    char *data = NULL;
+    size_t size;
+    int len;
+    
+    if(0 != text->error) {
+        
+        return;
+    }
+    
+    while(1) {
+        
+        va_start(args, format);
+        len = vsnprintf(text->data + text->len, text->size - text->len, format, args);
+        va_end(args);
+        
+        if(len < 0) {
+            
+            text->error = -1;
+            return;
+        }
+        
+        if((size_t)len < text->size - text->len) {
+            
+            text->len += (size_t)len;
+            return;
+        }
+        
+        /* Grow the buffer and format again */
+        size = text->size * 2;
+        while(size - text->len <= (size_t)len) {
+            
+            size *= 2;
+        }
+        
+        data = (char*)realloc(text->data, size);
+        if(NULL == data) {
+            
+            text->error = -1;
+            return;
+        }
+        
+        text->data = data;
+        text->size = size;
+    }
+}
+
+/*
+ * Function 'appendExportHist': appends a histogram of the registry in the Prometheus text format.
+ * 
+ * Note:    Time histograms (scale: NSEC_PER_SEC) are exported in seconds, size histograms
+ *          (scale: 1) in bytes. Label is empty or a label pair followed by a comma.
+ */
+static void appendExportHist(struct ExportText *text, const char *name, const char *label, const struct MetricHist *hist,
+                             const uint64_t *bucketTable, int bucketCount, uint64_t scale) {
+    
+    int i;
+    
+    for(i = 0; i < bucketCount; i++) {
+        
+        appendExportText(text, "%s_bucket{%sle=\"%g\"} %llu\n", name, label, (double)bucketTable[i] / (double)scale,
+                         (unsigned long long)getMetricCountBelow(hist, bucketTable[i]));
+    }
+    
+    appendExportText(text, "%s_bucket{%sle=\"+Inf\"} %llu\n", name, label, (unsigned long long)hist->count);
+    
+    /* Label pairs without the trailing comma */
+    if('\0' == label[0]) {
+        
+        appendExportText(text, "%s_sum %.9g\n", name, (double)hist->sum / (double)scale);
+        appendExportText(text, "%s_count %llu\n", name, (unsigned long long)hist->count);
+    }
+    else {
+        
+        appendExportText(text, "%s_sum{%.*s} %.9g\n", name, (int)strlen(label) - 1, label, (double)hist->sum / (double)scale);
+        appendExportText(text, "%s_count{%.*s} %llu\n", name, (int)strlen(label) - 1, label, (unsigned long long)hist->count);
+    }
+}
+
+/*
+ * Function 'appendExportHead': appends the HELP and TYPE lines of a metric.
+ */
+static void appendExportHead(struct ExportText *text, const char *name, const char *type, const char *help) {
+    
+    appendExportText(text, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+/*
+ * Function 'buildExportMetrics': builds the metrics page in the Prometheus text format (version 0.0.4).
+ */
+static int buildExportMetrics(struct ExportText *text) {
+    
+    struct MetricSnapshot *snapshot = NULL;
+    struct LogCounters logCounters;
+    struct stat fileStat;
+    uint64_t requestCount;
+    uint64_t failCount;
+    off_t fileSize;
+    int recordCount;
+    char label[EXPORT_LABEL_MAX_LEN];
+    int i;
+    int error = 0;
+    
+    snapshot = (struct MetricSnapshot*)malloc(sizeof(struct MetricSnapshot));
+    if((NULL == snapshot) || (0 != getMetricSnapshot(snapshot))) {
+        
+        free(snapshot);
+        
+        error = -1;
+        return error;
+    }
+    
+    getLogCounters(&logCounters);
+    
+    appendExportHead(text, "myserver_uptime_seconds", "gauge", "Time since the server started.");
+    appendExportText(text, "myserver_uptime_seconds %.3f\n", (double)snapshot->uptimeNs / (double)NSEC_PER_SEC);
+    
+    /* Connections */
+    appendExportHead(text, "myserver_connections_accepted_total", "counter", "Client connections accepted.");
+    appendExportText(text, "myserver_connections_accepted_total %llu\n", (unsigned long long)snapshot->counter[STATS_CNT_CONN]);
+    appendExportHead(text, "myserver_auth_failures_total", "counter", "Client authentications failed.");
+    appendExportText(text, "myserver_auth_failures_total %llu\n", (unsigned long long)snapshot->counter[STATS_CNT_AUTH_FAIL]);
+    appendExportHead(text, "myserver_accept_to_auth_seconds", "histogram", "Time from accepting a client to its authentication.");
+    appendExportHist(text, "myserver_accept_to_auth_seconds", "", &(snapshot->hist[METRIC_HIST_ACCEPT_AUTH]),
+                     exportTimeBucketTable, sizeof(exportTimeBucketTable) / sizeof(exportTimeBucketTable[0]), NSEC_PER_SEC);
+    
+    /* Requests by code and result */
+    appendExportHead(text, "myserver_requests_total", "counter", "Client requests by request code and result.");
+    for(i = 0; i < REQ_ARRAY_SIZE; i++) {
+        
+        requestCount = snapshot->hist[METRIC_HIST_REQUEST + i].count;
+        failCount = snapshot->counter[METRIC_CNT_REQ_CODE_FAIL + i];
+        if((0 == requestCount) && (0 == snapshot->counter[METRIC_CNT_REQ_CODE_DENIED + i])) {
+            
+            continue;
+        }
+        
+        appendExportText(text, "myserver_requests_total{code=\"0x%02X\",result=\"success\"} %llu\n",
+                         requestArray[i].requestCode, (unsigned long long)(requestCount - failCount));
+        appendExportText(text, "myserver_requests_total{code=\"0x%02X\",result=\"failure\"} %llu\n",
+                         requestArray[i].requestCode, (unsigned long long)failCount);
+        appendExportText(text, "myserver_requests_total{code=\"0x%02X\",result=\"denied\"} %llu\n",
+                         requestArray[i].requestCode, (unsigned long long)snapshot->counter[METRIC_CNT_REQ_CODE_DENIED + i]);
+    }
+    
+    appendExportText(text, "myserver_requests_total{code=\"invalid\",result=\"invalid\"} %llu\n",
+                     (unsigned long long)snapshot->counter[METRIC_CNT_REQ_INVALID]);
+    
+    appendExportHead(text, "myserver_request_duration_seconds", "histogram", "Request handling time by request code.");
+    for(i = 0; i < REQ_ARRAY_SIZE; i++) {
+        
+        if(0 == snapshot->hist[METRIC_HIST_REQUEST + i].count) {
+            
+            continue;
+        }
+        
+        snprintf(label, sizeof(label), "code=\"0x%02X\",", requestArray[i].requestCode);
+        appendExportHist(text, "myserver_request_duration_seconds", label, &(snapshot->hist[METRIC_HIST_REQUEST + i]),
+                         exportTimeBucketTable, sizeof(exportTimeBucketTable) / sizeof(exportTimeBucketTable[0]), NSEC_PER_SEC);
+    }
+    
+    /* Sampling */
+    appendExportHead(text, "myserver_samples_total", "counter", "Sensor samples measured.");
+    appendExportText(text, "myserver_samples_total %llu\n", (unsigned long long)snapshot->counter[STATS_CNT_SAMPLE]);
+    appendExportHead(text, "myserver_sample_failures_total", "counter", "Sensor measurements failed.");
+    appendExportText(text, "myserver_sample_failures_total %llu\n", (unsigned long long)snapshot->counter[STATS_CNT_SAMPLE_FAIL]);
+    appendExportHead(text, "myserver_sample_jitter_seconds", "histogram", "Measure thread wake-up past its schedule.");
+    appendExportHist(text, "myserver_sample_jitter_seconds", "", &(snapshot->hist[METRIC_HIST_SAMPLE_JITTER]),
+                     exportTimeBucketTable, sizeof(exportTimeBucketTable) / sizeof(exportTimeBucketTable[0]), NSEC_PER_SEC);
+    appendExportHead(text, "myserver_sensor_bus_seconds", "histogram", "Sensor bus transactions per sample.");
+    appendExportHist(text, "myserver_sensor_bus_seconds", "", &(snapshot->hist[METRIC_HIST_SENS_BUS]),
+                     exportTimeBucketTable, sizeof(exportTimeBucketTable) / sizeof(exportTimeBucketTable[0]), NSEC_PER_SEC);
+    appendExportHead(text, "myserver_sensor_conversion_seconds", "histogram", "Sensor conversion from trigger to completion.");
+    appendExportHist(text, "myserver_sensor_conversion_seconds", "", &(snapshot->hist[METRIC_HIST_SENS_CONV]),
+                     exportTimeBucketTable, sizeof(exportTimeBucketTable) / sizeof(exportTimeBucketTable[0]), NSEC_PER_SEC);
+    
+    /* Storage */
+    appendExportHead(text, "myserver_storage_bytes", "gauge", "Size of the saved measurement data file by sensor.");
+    for(i = 0; i < sensorCount; i++) {
+        
+        SAVED_DATA_MUTEX_LOCK(&(sensorArray[i]));
+        fileSize = ((sensorArray[i].savedDataFd >= 0) && (0 == fstat(sensorArray[i].savedDataFd, &fileStat))) ? fileStat.st_size : 0;
+        SAVED_DATA_MUTEX_UNLOCK(&(sensorArray[i]));
+        
+        appendExportText(text, "myserver_storage_bytes{sensor=\"%d\"} %lld\n", i, (long long)fileSize);
+    }
+    
+    appendExportHead(text, "myserver_storage_pending_records", "gauge", "Samples buffered but not yet appended to the file by sensor.");
+    for(i = 0; i < sensorCount; i++) {
+        
+        SAVED_DATA_MUTEX_LOCK(&(sensorArray[i]));
+        recordCount = sensorArray[i].savedDataBufCount;
+        SAVED_DATA_MUTEX_UNLOCK(&(sensorArray[i]));
+        
+        appendExportText(text, "myserver_storage_pending_records{sensor=\"%d\"} %d\n", i, recordCount);
+    }
+    
+    appendExportHead(text, "myserver_storage_append_seconds", "histogram", "Saved data batch append time.");
+    appendExportHist(text, "myserver_storage_append_seconds", "", &(snapshot->hist[METRIC_HIST_SAVE_APPEND]),
+                     exportTimeBucketTable, sizeof(exportTimeBucketTable) / sizeof(exportTimeBucketTable[0]), NSEC_PER_SEC);
+    
+    /* Locks (recorded with lock profiling only, see lockprof.c) */
+    appendExportHead(text, "myserver_lock_wait_seconds", "histogram", "Time waited for a server mutex by lock and call site.");
+    for(i = 0; i < getLockSiteCount(); i++) {
+        
+        if(0 == snapshot->hist[METRIC_HIST_LOCK_WAIT + i].count) {
+            
+            continue;
+        }
+        
+        snprintf(label, sizeof(label), "lock=\"%s\",site=\"%s:%d\",", getLockName(getLockSite(i)->lockId),
+                 getLockSite(i)->file, getLockSite(i)->line);
+        appendExportHist(text, "myserver_lock_wait_seconds", label, &(snapshot->hist[METRIC_HIST_LOCK_WAIT + i]),
+                         exportTimeBucketTable, sizeof(exportTimeBucketTable) / sizeof(exportTimeBucketTable[0]), NSEC_PER_SEC);
+    }
+    
+    appendExportHead(text, "myserver_lock_hold_seconds", "histogram", "Time a server mutex was held by lock and call site.");
+    for(i = 0; i < getLockSiteCount(); i++) {
+        
+        if(0 == snapshot->hist[METRIC_HIST_LOCK_HOLD + i].count) {
+            
+            continue;
+        }
+        
+        snprintf(label, sizeof(label), "lock=\"%s\",site=\"%s:%d\",", getLockName(getLockSite(i)->lockId),
+                 getLockSite(i)->file, getLockSite(i)->line);
+        appendExportHist(text, "myserver_lock_hold_seconds", label, &(snapshot->hist[METRIC_HIST_LOCK_HOLD + i]),
+                         exportTimeBucketTable, sizeof(exportTimeBucketTable) / sizeof(exportTimeBucketTable[0]), NSEC_PER_SEC);
+    }
+    
+    /* Transfer */
+    appendExportHead(text, "myserver_gdat_sent_bytes_total", "counter", "Saved measurement data bytes sent to clients.");
+    appendExportText(text, "myserver_gdat_sent_bytes_total %llu\n", (unsigned long long)snapshot->counter[STATS_CNT_GDAT_BYTES]);
+    appendExportHead(text, "myserver_gdat_response_bytes", "histogram", "Bytes sent per GDAT request.");
+    appendExportHist(text, "myserver_gdat_response_bytes", "", &(snapshot->hist[METRIC_HIST_GDAT_BYTES]),
+                     exportByteBucketTable, sizeof(exportByteBucketTable) / sizeof(exportByteBucketTable[0]), 1);
+    
+    /* Logging */
+    appendExportHead(text, "myserver_log_events_total", "counter", "Logged events by result.");
+    appendExportText(text, "myserver_log_events_total{result=\"forwarded\"} %llu\n", (unsigned long long)logCounters.forwarded);
+    appendExportText(text, "myserver_log_events_total{result=\"dropped\"} %llu\n", (unsigned long long)logCounters.dropped);
+    appendExportText(text, "myserver_log_events_total{result=\"suppressed\"} %llu\n", (unsigned long long)logCounters.suppressed);
+    
+    free(snapshot);
+    
+    error = text->error;
+    return error;
+}
+
+/*
+ * Function 'getExportStatusText': returns the status line text of an HTTP status code.
+ */
+static const char* getExportStatusText(int status) {
+    
+    switch(status) {
+        
+        case EXPORT_STATUS_OK:          return "200 OK";
+        case EXPORT_STATUS_BAD_REQUEST: return "400 Bad Request";
+        case EXPORT_STATUS_NOT_FOUND:   return "404 Not Found";
+        case EXPORT_STATUS_NOT_ALLOWED: return "405 Method Not Allowed";
+        default:                        return "500 Internal Server Error";
+    }
+}
+
+/*
+ * Function 'buildExportResponse': builds the HTTP response to a complete request head.
+ * 
+ * Note:    Only GET and HEAD of EXPORT_PATH and EXPORT_TRACE_PATH (query ignored) are
+ *          served, the connection is closed after every response.
+ */
+static int buildExportResponse(struct ExportConn *conn) {
+    
+    struct ExportText body;
+    struct ExportText response;
+    int status = EXPORT_STATUS_OK;
+    char *method = NULL;
+    char *path = NULL;
+    char *version = NULL;
+    char *save = NULL;
+    int head = 0;
+    int trace = 0;
+    int error = 0;
+    
+    memset(&body, 0, sizeof(body));
+    memset(&response, 0, sizeof(response));
+    
+    body.size = EXPORT_BODY_INIT_LEN;
+    body.data = (char*)malloc(body.size);
+    response.size = EXPORT_BODY_INIT_LEN;
+    response.data = (char*)malloc(response.size);
+    if((NULL == body.data) || (NULL == response.data)) {
+        
+        free(body.data);
+        free(response.data);
+        
+        error = -1;
+        return error;
+    }
+    
+    body.data[0] = '\0';
+    
+    /* Request line: method, path and version */
+    method = strtok_r(conn->req, " \r\n", &save);
+    path = (NULL != method) ? strtok_r(NULL, " \r\n", &save) : NULL;
+    version = (NULL != path) ? strtok_r(NULL, " \r\n", &save) : NULL;
+    
+    if((NULL == version) || (0 != strncmp(version, "HTTP/1.", 7))) {
+        
+        status = EXPORT_STATUS_BAD_REQUEST;
+    }
+    else if((0 != strcmp(method, "GET")) && (0 != strcmp(method, "HEAD"))) {
+        
+        status = EXPORT_STATUS_NOT_ALLOWED;
+    }
+    else {
+        
+        head = (0 == strcmp(method, "HEAD"));
+        path[strcspn(path, "?")] = '\0';
+        
+        trace = (0 == strcmp(path, EXPORT_TRACE_PATH));
+        
+        if((0 != strcmp(path, EXPORT_PATH)) && (0 == trace)) {
+            
+            status = EXPORT_STATUS_NOT_FOUND;
+        }
+        else if(0 != (trace ? buildTraceJson(&body) : buildExportMetrics(&body))) {
+            
+            status = EXPORT_STATUS_ERROR;
+            body.len = 0;
+        }
+    }
+    
+    if(EXPORT_STATUS_OK != status) {
+        
+        body.error = 0;
+        body.len = 0;
+        appendExportText(&body, "%s\n", getExportStatusText(status));
+    }
+    
+    appendExportText(&response, "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %lu\r\n%sConnection: close\r\n\r\n%.*s",
+                     getExportStatusText(status),
+                     (EXPORT_STATUS_OK != status) ? "text/plain; charset=utf-8" : (trace ? TRACE_CONTENT_TYPE : EXPORT_CONTENT_TYPE),
+                     (unsigned long)body.len, (EXPORT_STATUS_NOT_ALLOWED == status) ? "Allow: GET, HEAD\r\n" : "",
+                     head ? 0 : (int)body.len, body.data);
+    
+    free(body.data);
+    
+    if(0 != response.error) {
+        
+        free(response.data);
+        
+        error = -1;
+        return error;
+    }
+    
+    conn->res = response.data;
+    conn->resLen = response.len;
+    conn->resSent = 0;
+    
+    return error;
+}
+
+/*
+ * Function 'closeExportConn': closes a scraper connection and frees its slot.
+ */
+static void closeExportConn(struct ExportConn *conn) {
+    
+    close(conn->socket);
+    free(conn->res);
+    
+    conn->socket = -1;
+    conn->res = NULL;
+    conn->reqLen = 0;
+}
+
+/*
+ * Function 'serveExportConn': reads the request of a scraper connection and writes its response.
+ * 
+ * Note:    Returns 1 while the connection is in progress, 0 once it can be closed.
+ */
+static int serveExportConn(int epollFd, struct ExportConn *conn) {
+    
+    struct epoll_event event;
+    ssize_t len;
+    
+    conn->lastActiveNs = getMetricTimeNs();
+    
+    /* Read the request head */
+    while(NULL == conn->res) {
+        
+        len = recv(conn->socket, conn->req + conn->reqLen, EXPORT_REQ_MAX_LEN - conn->reqLen, 0);
+        if(len < 0) {
+            
+            return ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno)) ? 1 : 0;
+        }
+        
+        if(0 == len) {
+            
+            /* Closed by the scraper */
+            return 0;
+        }
+        
+        conn->reqLen += (size_t)len;
+        conn->req[conn->reqLen] = '\0';
+        
+        if(NULL != strstr(conn->req, "\r\n\r\n")) {
+            
+            if(0 != buildExportResponse(conn)) {
+                
+                logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_EXPORT_RES_FAIL);
+                return 0;
+            }
+            
+            /* Wait for the socket to become writable from now on */
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLOUT;
+            event.data.ptr = conn;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, conn->socket, &event);
+        }
+        else if(EXPORT_REQ_MAX_LEN == conn->reqLen) {
+            
+            /* Request head too long */
+            return 0;
+        }
+    }
+    
+    /* Write the response */
+    while(conn->resSent < conn->resLen) {
+        
+        len = send(conn->socket, conn->res + conn->resSent, conn->resLen - conn->resSent, MSG_NOSIGNAL);
+        if(len < 0) {
+            
+            return ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno)) ? 1 : 0;
+        }
+        
+        conn->resSent += (size_t)len;
+    }
+    
+    return 0;
+}
+
+/*
+ * Function 'exportThreadFunction': serves the metrics to the scrapers.
+ * 
+ * Note:    Sleeps in epoll_wait on the listening socket and on the scraper connections
+ *          (at most EXPORT_CONN_MAX, further ones are closed at once). The sockets
+ *          are non-blocking, so a slow scraper never stalls the others.
+ */
+static void* exportThreadFunction(void *arg) {
+    
+    struct epoll_event event;
+    struct epoll_event events[EXPORT_EPOLL_EVENTS];
+    struct ExportConn *conn = NULL;
+    uint64_t nowNs;
+    int epollFd;
+    int eventNum;
+    int iEvent;
+    int clientSocket;
+    int i;
+    
+    epollFd = epoll_create1(0);
+    if(epollFd < 0) {
+
+#ifdef SERVER_DEBUG
+        perror("epoll_create1");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_EXPORT_INIT_FAIL);
+        
+        return NULL;
+    }
+    
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, exportSocket, &event);
+    
+    /* Loop */
+    while(1) {
+        
+        eventNum = epoll_wait(epollFd, events, EXPORT_EPOLL_EVENTS, EXPORT_IDLE_TIMEOUT_MS);
+        for(iEvent = 0; iEvent < eventNum; iEvent++) {
+            
+            conn = (struct ExportConn*)events[iEvent].data.ptr;
+            if(NULL != conn) {
+                
+                /* Scraper connection event */
+                if(0 == serveExportConn(epollFd, conn)) {
+                    
+                    closeExportConn(conn);
+                }
+                
+                continue;
+            }
+            
+            /* Accept new scrapers */
+            while(0 <= (clientSocket = accept4(exportSocket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC))) {
+                
+                for(i = 0; (i < EXPORT_CONN_MAX) && (exportConnTable[i].socket >= 0); i++);
+                if(EXPORT_CONN_MAX == i) {
+                    
+                    /* No free slot */
+                    close(clientSocket);
+                    continue;
+                }
+                
+                conn = &(exportConnTable[i]);
+                conn->socket = clientSocket;
+                conn->lastActiveNs = getMetricTimeNs();
+                
+                memset(&event, 0, sizeof(event));
+                event.events = EPOLLIN;
+                event.data.ptr = conn;
+                if(0 > epoll_ctl(epollFd, EPOLL_CTL_ADD, clientSocket, &event)) {
+                    
+                    closeExportConn(conn);
+                }
+            }
+        }
+        
+        /* Drop idle scrapers */
+        nowNs = getMetricTimeNs();
+        for(i = 0; i < EXPORT_CONN_MAX; i++) {
+            
+            if((exportConnTable[i].socket >= 0) &&
+               (nowNs - exportConnTable[i].lastActiveNs > (uint64_t)EXPORT_IDLE_TIMEOUT_MS * NSEC_PER_MSEC)) {
+                
+                closeExportConn(&(exportConnTable[i]));
+            }
+        }
+    }
+    
+    return NULL;
+}
+
+/*
+ * Function 'startMetricsExport': opens the metrics listener and starts its thread.
+ * 
+ * Note:    Address is "[IPv4 address:]port", the listener is bound to EXPORT_DEFAULT_ADDRESS
+ *          (this host only) by default. Failure is not fatal: the server runs without
+ *          the exposition.
+ */
+int startMetricsExport(const char *address) {
+    
+    char hostName[INET_ADDRSTRLEN];
+    const char *portName = strrchr(address, ':');
+    unsigned long port;
+    char *end = NULL;
+    int reuseAddrState = 1;
+    int i;
+    int error = 0;
+    
+    struct sockaddr_in exportAddress;
+    
+    memset(&exportAddress, 0, sizeof(exportAddress));
+    exportAddress.sin_family = AF_INET;
+    
+    /* Split address and port */
+    memset(hostName, 0, sizeof(hostName));
+    strncpy(hostName, EXPORT_DEFAULT_ADDRESS, sizeof(hostName) - 1);
+    if(NULL != portName) {
+        
+        memset(hostName, 0, sizeof(hostName));
+        strncpy(hostName, address, sizeof(hostName) - 1);
+        if((size_t)(portName - address) < sizeof(hostName)) {
+            
+            hostName[portName - address] = '\0';
+        }
+        
+        portName++;
+    }
+    else {
+        
+        portName = address;
+    }
+    
+    port = strtoul(portName, &end, 10);
+    if(('\0' != *end) || (end == portName) || (0 == port) || (port > UINT16_MAX) ||
+       (1 != inet_pton(AF_INET, hostName, &(exportAddress.sin_addr)))) {
+        
+        /* Invalid address */
+        logEvent(LOG_WARNING, LOG_SYS_WARN_SERVER_EXPORT_FAIL, address);
+        
+        error = -1;
+        return error;
+    }
+    
+    exportAddress.sin_port = htons((uint16_t)port);
+    
+    exportSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(exportSocket < 0) {
+
+#ifdef SERVER_DEBUG
+        perror("socket");
+        fflush(stderr);
+#endif
+        logEvent(LOG_WARNING, LOG_SYS_WARN_SERVER_EXPORT_FAIL, address);
+        
+        error = -1;
+        return error;
+    }
+    
+    if((setsockopt(exportSocket, SOL_SOCKET, SO_REUSEADDR, &reuseAddrState, sizeof(reuseAddrState)) < 0) ||
+       (bind(exportSocket, (struct sockaddr*)&exportAddress, sizeof(exportAddress)) < 0) ||
+       (listen(exportSocket, EXPORT_CONN_MAX) < 0)) {
+
+#ifdef SERVER_DEBUG
+        perror("bind");
+        fflush(stderr);
+#endif
+        logEvent(LOG_WARNING, LOG_SYS_WARN_SERVER_EXPORT_FAIL, address);
+        close(exportSocket);
+        exportSocket = -1;
+        
+        error = -1;
+        return error;
+    }
+    
+    for(i = 0; i < EXPORT_CONN_MAX; i++) {
+        
+        exportConnTable[i].socket = -1;
+    }
+    
+    if(0 != pthread_create(&exportThread, NULL, exportThreadFunction, NULL)) {
+        
+        /* Failed to create export thread */
+        logEvent(LOG_ERR, LOG_SYS_ERR_THREAD_EXPORT_CREAT_FAIL);
+        close(exportSocket);
+        exportSocket = -1;
+        
+        error = -1;
+        return error;
+    }
+    
+    logEvent(LOG_INFO, LOG_SYS_INFO_SERVER_EXPORT, hostName, (unsigned int)port, EXPORT_PATH);
+    
+    return error;
+}
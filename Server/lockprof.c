@@ -0,0 +1,207 @@
+/*
+ * FileName:    lockprof.c
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ * 
+ * Desc.:       Source file containing the lock contention profiler of the server.
+ * 
+ *              serviceMutex, sensorMutex and savedDataMutex are taken through the
+ *              *_MUTEX_LOCK / *_MUTEX_UNLOCK macros. With profiling enabled (-L, or
+ *              built with -DSERVER_LOCK_PROFILE) they record the time waited for the
+ *              mutex and the time it was held into the metrics registry, per call
+ *              site of the lock (registered on its first use, see LOCK_SITE_MAX).
+ *              Hold times are charged to the site that took the mutex.
+ * 
+ *              An uncontended lock costs one clock read more than without profiling
+ *              (trylock first), the unlock one more. Disabled, only a flag is tested.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <syslog.h>
+
+#include "bme280_qt_interf_v2.h"
+#include "myserver.h"
+
+#ifdef SERVER_LOCK_PROFILE
+uint8_t lockProfileEnabled = 1;                     // Lock wait and hold times are recorded (see -L)
+#else
+uint8_t lockProfileEnabled = 0;                     // Lock wait and hold times are recorded (see -L)
+#endif
+
+/* Names of the profiled locks indexed by LOCK_ID_... */
+static const char *lockNameTable[LOCK_ID_COUNT] = {
+    
+    "sensor",
+    "saved_data",
+    "service"
+};
+
+/* Call sites of the profiled locks (registered on their first use) */
+static struct LockSite lockSiteTable[LOCK_SITE_MAX];
+static int lockSiteCount = 0;
+static pthread_mutex_t lockSiteMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Locks held by the calling thread: acquisition time [nsec] (0: not held) and site */
+static __thread uint64_t threadLockHeldNs[LOCK_ID_COUNT];
+static __thread int threadLockHeldSite[LOCK_ID_COUNT];
+
+/*
+ * Function 'registerLockSite': assigns an ID to a lock call site on its first use.
+ * 
+ * Note:    Sites beyond LOCK_SITE_MAX get LOCK_SITE_NONE and are not recorded.
+ */
+static int registerLockSite(int *siteId, int lockId, const char *file, int line) {
+    
+    int id;
+    
+    pthread_mutex_lock(&lockSiteMutex);
+    
+    id = __atomic_load_n(siteId, __ATOMIC_RELAXED);
+    if(LOCK_SITE_UNKNOWN == id) {
+        
+        if(lockSiteCount < LOCK_SITE_MAX) {
+            
+            id = lockSiteCount;
+            
+            /* Source file name only (labels of the metrics page are limited) */
+            lockSiteTable[id].file = (NULL != strrchr(file, '/')) ? (strrchr(file, '/') + 1) : file;
+            lockSiteTable[id].line = line;
+            lockSiteTable[id].lockId = lockId;
+            __atomic_store_n(&lockSiteCount, id + 1, __ATOMIC_RELEASE);
+            
+            logEvent(LOG_INFO, LOG_SYS_INFO_LOCK_SITE, id, lockNameTable[lockId], lockSiteTable[id].file, line);
+        }
+        else {
+            
+            id = LOCK_SITE_NONE;
+        }
+        
+        __atomic_store_n(siteId, id, __ATOMIC_RELAXED);
+    }
+    
+    pthread_mutex_unlock(&lockSiteMutex);
+    
+    return id;
+}
+
+/*
+ * Function 'lockProfiledMutex': locks a mutex, records the time waited for it at the call site.
+ */
+void lockProfiledMutex(pthread_mutex_t *mutex, int lockId, int *siteId, const char *file, int line) {
+    
+    uint64_t startNs;
+    uint64_t lockedNs;
+    int id = __atomic_load_n(siteId, __ATOMIC_RELAXED);
+    
+    if(LOCK_SITE_UNKNOWN == id) {
+        
+        id = registerLockSite(siteId, lockId, file, line);
+    }
+    
+    /* Not contended: no wait to measure */
+    if(0 == pthread_mutex_trylock(mutex)) {
+        
+        lockedNs = getMetricTimeNs();
+        startNs = lockedNs;
+    }
+    else {
+        
+        startNs = getMetricTimeNs();
+        pthread_mutex_lock(mutex);
+        lockedNs = getMetricTimeNs();
+    }
+    
+    if(id >= 0) {
+        
+        recordMetricValue(METRIC_HIST_LOCK_WAIT + id, lockedNs - startNs);
+    }
+    
+    threadLockHeldNs[lockId] = lockedNs;
+    threadLockHeldSite[lockId] = id;
+}
+
+/*
+ * Function 'recordLockHold': records the time a lock of the calling thread was held so far.
+ */
+static void recordLockHold(int lockId, uint64_t nowNs) {
+    
+    if((0 != threadLockHeldNs[lockId]) && (threadLockHeldSite[lockId] >= 0)) {
+        
+        recordMetricValue(METRIC_HIST_LOCK_HOLD + threadLockHeldSite[lockId], nowNs - threadLockHeldNs[lockId]);
+    }
+    
+    threadLockHeldNs[lockId] = 0;
+}
+
+/*
+ * Function 'unlockProfiledMutex': unlocks a mutex, records the time it was held.
+ */
+void unlockProfiledMutex(pthread_mutex_t *mutex, int lockId) {
+    
+    recordLockHold(lockId, getMetricTimeNs());
+    
+    pthread_mutex_unlock(mutex);
+}
+
+/*
+ * Function 'waitProbedCond': waits for a condition with a profiled mutex (pthread_cond_timedwait).
+ * 
+ * Note:    The mutex is released while waiting: its hold time ends before the wait
+ *          and starts again after it (time spent relocking it is not recorded).
+ */
+int waitProbedCond(pthread_cond_t *cond, pthread_mutex_t *mutex, int lockId, int sensorId, const struct timespec *deadline) {
+    
+    int result;
+    int id;
+    
+    SERVER_PROBE3(lock__release, lockId, sensorId, mutex);
+    
+    if(0 == lockProfileEnabled) {
+        
+        result = pthread_cond_timedwait(cond, mutex, deadline);
+    }
+    else {
+        
+        id = threadLockHeldSite[lockId];
+        recordLockHold(lockId, getMetricTimeNs());
+        
+        result = pthread_cond_timedwait(cond, mutex, deadline);
+        
+        threadLockHeldNs[lockId] = getMetricTimeNs();
+        threadLockHeldSite[lockId] = id;
+    }
+    
+    SERVER_PROBE3(lock__acquired, lockId, sensorId, mutex);
+    
+    return result;
+}
+
+/*
+ * Function 'getLockSiteCount': returns the number of registered lock call sites.
+ */
+int getLockSiteCount(void) {
+    
+    return __atomic_load_n(&lockSiteCount, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Function 'getLockSite': returns a registered lock call site (NULL: invalid site ID).
+ */
+const struct LockSite* getLockSite(int siteId) {
+    
+    if((siteId < 0) || (siteId >= getLockSiteCount())) {
+        
+        return NULL;
+    }
+    
+    return &(lockSiteTable[siteId]);
+}
+
+/*
+ * Function 'getLockName': returns the name of a profiled lock.
+ */
+const char* getLockName(int lockId) {
+    
+    return ((lockId >= 0) && (lockId < LOCK_ID_COUNT)) ? lockNameTable[lockId] : "unknown";
+}
@@ -0,0 +1,662 @@
+/*
+ * FileName:    logger.c
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ * 
+ * Desc.:       Source file containing the asynchronous logging of the server.
+ * 
+ *              Threads on the hot paths (service, measure and event threads) do not
+ *              call syslog: logEvent copies the format string pointer and the raw
+ *              arguments into a fixed-size event of the lock-free ring of the calling
+ *              thread (single producer, single consumer). The log thread formats the
+ *              events in time order and forwards them to syslog (and to stdout/stderr
+ *              in debug builds). Events of a full ring are dropped and counted.
+ * 
+ *              Repetitive messages are rate limited per format string: the first
+ *              LOG_RATE_BURST events of a window are forwarded, then only every
+ *              LOG_RATE_SAMPLE-th one. The number of suppressed events is reported
+ *              when the window ends.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bme280_qt_interf_v2.h"
+#include "myserver.h"
+
+/* Argument of a log event, the type follows from the conversion of the format string */
+union LogArg {
+    
+    int64_t i;
+    uint64_t u;
+    double d;
+    const void *p;
+};
+
+/* Log event (fixed size, copied into the ring of the producer thread) */
+struct LogEvent {
+    
+    uint64_t timeNs;                                // Monotonic time of the event [nsec]
+    const char *format;                             // LOG_SYS_... string (static storage)
+    int priority;                                   // LOG_ERR, LOG_WARNING, LOG_INFO, ...
+    int argCount;
+    union LogArg arg[LOG_EVENT_ARGS_MAX];
+    char strBuf[LOG_EVENT_STR_LEN];                 // String arguments (arg[].u: offset)
+};
+
+/* Lock-free event ring of a producer thread */
+struct LogRing {
+    
+    uint32_t head __attribute__((aligned(64)));     // Written by the producer
+    uint32_t dropCount;                             // Events dropped on full ring (producer)
+    uint32_t tail __attribute__((aligned(64)));     // Written by the log thread
+    struct LogEvent event[LOG_RING_SIZE];
+};
+
+/* Rate limit of a format string (log thread only) */
+struct LogRate {
+    
+    const char *format;                             // NULL: free slot
+    uint64_t windowStartNs;
+    uint32_t count;                                 // Events in the current window
+    uint32_t suppressed;                            // Events suppressed in the current window
+};
+
+/* Rings of the producer threads (registered on their first event) */
+static struct LogRing *logRingTable[LOG_RING_MAX];
+static uint32_t logRingCount = 0;
+static __thread struct LogRing *threadLogRing = NULL;
+
+static uint64_t logDropNoRing = 0;                  // Events of threads without ring
+static uint64_t logSuppressed = 0;                  // Events suppressed by rate limiting
+static uint64_t logForwarded = 0;                   // Events forwarded to syslog
+
+static struct LogRate logRateTable[LOG_RATE_TABLE_SIZE];
+
+static pthread_t logThread;
+static uint8_t logThreadRunning = 0;
+static uint8_t logThreadStop = 0;
+
+/*
+ * Function 'getLogTimeNs': returns the monotonic time [nsec] (vDSO, no syscall).
+ */
+static uint64_t getLogTimeNs(void) {
+    
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+/*
+ * Function 'parseLogConversion': finds the next conversion of a format string.
+ * 
+ * Note:    Returns the conversion character (0 at the end of the format) and sets
+ *          'begin' and 'end' to the conversion specification (e.g. "%-8llu") and
+ *          'lengthMod' to its length modifier ('l': l, 'L': ll, 'z': z, j or t).
+ *          "%%" is skipped as literal text. '*' width or precision is not supported.
+ */
+static char parseLogConversion(const char *format, const char **begin, const char **end, char *lengthMod) {
+    
+    const char *pos = format;
+    
+    while(1) {
+        
+        pos = strchr(pos, '%');
+        if(NULL == pos) {
+            
+            return 0;
+        }
+        
+        if('%' != pos[1]) {
+            
+            break;
+        }
+        
+        pos += 2;
+    }
+    
+    *begin = pos++;
+    *lengthMod = 0;
+    
+    while(('\0' != *pos) && (NULL != strchr("-+ #0'", *pos))) {
+        
+        pos++;
+    }
+    
+    while((('0' <= *pos) && ('9' >= *pos)) || ('.' == *pos)) {
+        
+        pos++;
+    }
+    
+    if('h' == *pos) {
+        
+        pos += ('h' == pos[1]) ? 2 : 1;
+    }
+    else if('l' == *pos) {
+        
+        *lengthMod = ('l' == pos[1]) ? 'L' : 'l';
+        pos += ('l' == pos[1]) ? 2 : 1;
+    }
+    else if(('z' == *pos) || ('j' == *pos) || ('t' == *pos)) {
+        
+        *lengthMod = 'z';
+        pos++;
+    }
+    
+    *end = ('\0' != *pos) ? (pos + 1) : pos;
+    
+    return *pos;
+}
+
+/*
+ * Function 'getThreadLogRing': returns the ring of the calling thread, registers it on first use.
+ */
+static struct LogRing* getThreadLogRing(void) {
+    
+    uint32_t index;
+    struct LogRing *ring = NULL;
+    
+    if(NULL != threadLogRing) {
+        
+        return threadLogRing;
+    }
+    
+    if(__atomic_load_n(&logRingCount, __ATOMIC_RELAXED) >= LOG_RING_MAX) {
+        
+        return NULL;
+    }
+    
+    if(0 != posix_memalign((void**)&ring, 64, sizeof(struct LogRing))) {
+        
+        return NULL;
+    }
+    
+    memset(ring, 0, sizeof(struct LogRing));
+    
+    index = __atomic_fetch_add(&logRingCount, 1, __ATOMIC_RELAXED);
+    if(index >= LOG_RING_MAX) {
+        
+        free(ring);
+        return NULL;
+    }
+    
+    __atomic_store_n(&(logRingTable[index]), ring, __ATOMIC_RELEASE);
+    threadLogRing = ring;
+    
+    return ring;
+}
+
+/*
+ * Function 'logEvent': logs a message of the server without blocking.
+ * 
+ * Note:    Use like syslog with a LOG_SYS_... format string (it must outlive the log
+ *          thread, only its pointer is kept). String arguments are copied, longer ones
+ *          are truncated to fit LOG_EVENT_STR_LEN. Never blocks and takes no lock:
+ *          the event is dropped if the ring of the thread is full.
+ */
+void logEvent(int priority, const char *format, ...) {
+    
+    va_list args;
+    struct LogRing *ring = getThreadLogRing();
+    struct LogEvent *event = NULL;
+    const char *convBegin = NULL;
+    const char *convEnd = NULL;
+    const char *pos = format;
+    const char *str = NULL;
+    size_t strLen = 0;
+    uint32_t head;
+    char conv;
+    char lengthMod;
+    
+    if(NULL == ring) {
+        
+        __atomic_fetch_add(&logDropNoRing, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    
+    head = ring->head;
+    if(head - __atomic_load_n(&(ring->tail), __ATOMIC_ACQUIRE) >= LOG_RING_SIZE) {
+        
+        /* Ring full */
+        __atomic_store_n(&(ring->dropCount), ring->dropCount + 1, __ATOMIC_RELAXED);
+        return;
+    }
+    
+    event = &(ring->event[head & (LOG_RING_SIZE - 1)]);
+    event->timeNs = getLogTimeNs();
+    event->format = format;
+    event->priority = priority;
+    event->argCount = 0;
+    
+    /* Copy arguments by the conversions of the format */
+    va_start(args, format);
+    while((event->argCount < LOG_EVENT_ARGS_MAX) && (0 != (conv = parseLogConversion(pos, &convBegin, &convEnd, &lengthMod)))) {
+        
+        if(('d' == conv) || ('i' == conv)) {
+            
+            event->arg[event->argCount].i = ('L' == lengthMod) ? va_arg(args, long long) :
+                                            ('l' == lengthMod) ? va_arg(args, long) :
+                                            ('z' == lengthMod) ? (int64_t)va_arg(args, ssize_t) : va_arg(args, int);
+        }
+        else if(NULL != strchr("uoxXc", conv)) {
+            
+            event->arg[event->argCount].u = ('L' == lengthMod) ? va_arg(args, unsigned long long) :
+                                            ('l' == lengthMod) ? va_arg(args, unsigned long) :
+                                            ('z' == lengthMod) ? va_arg(args, size_t) : va_arg(args, unsigned int);
+        }
+        else if(NULL != strchr("fFeEgGaA", conv)) {
+            
+            event->arg[event->argCount].d = va_arg(args, double);
+        }
+        else if('p' == conv) {
+            
+            event->arg[event->argCount].p = va_arg(args, void*);
+        }
+        else if('s' == conv) {
+            
+            /* Copy string, the argument holds its offset */
+            str = va_arg(args, const char*);
+            if(NULL == str) {
+                
+                str = "(null)";
+            }
+            
+            event->arg[event->argCount].u = strLen;
+            while((strLen < LOG_EVENT_STR_LEN - 1) && ('\0' != *str)) {
+                
+                event->strBuf[strLen++] = *str++;
+            }
+            event->strBuf[strLen++] = '\0';
+            if(strLen >= LOG_EVENT_STR_LEN) {
+                
+                strLen = LOG_EVENT_STR_LEN - 1;
+            }
+        }
+        else {
+            
+            /* Unsupported conversion: the rest of the format is printed as it is */
+            break;
+        }
+        
+        event->argCount++;
+        pos = convEnd;
+    }
+    va_end(args);
+    
+    /* Publish event */
+    __atomic_store_n(&(ring->head), head + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Function 'appendLogText': appends literal text of a format to a formatted message ("%%" gives '%').
+ */
+static void appendLogText(char *line, size_t *len, size_t lineLen, const char *text, const char *textEnd) {
+    
+    while((text < textEnd) && ('\0' != *text) && (*len < lineLen - 1)) {
+        
+        if(('%' == text[0]) && ('%' == text[1])) {
+            
+            text++;
+        }
+        
+        line[(*len)++] = *text++;
+    }
+    
+    line[*len] = '\0';
+}
+
+/*
+ * Function 'formatLogEvent': formats the message of a log event.
+ */
+static void formatLogEvent(const struct LogEvent *event, char *line, size_t lineLen) {
+    
+    char spec[LOG_SPEC_MAX_LEN];
+    const char *convBegin = NULL;
+    const char *convEnd = NULL;
+    const char *pos = event->format;
+    size_t len = 0;
+    size_t specLen;
+    size_t left;
+    int argIndex = 0;
+    int ret = 0;
+    char conv;
+    char lengthMod;
+    
+    line[0] = '\0';
+    
+    while((argIndex < event->argCount) && (0 != (conv = parseLogConversion(pos, &convBegin, &convEnd, &lengthMod)))) {
+        
+        appendLogText(line, &len, lineLen, pos, convBegin);
+        
+        specLen = (size_t)(convEnd - convBegin);
+        if(specLen >= sizeof(spec)) {
+            
+            break;
+        }
+        
+        memcpy(spec, convBegin, specLen);
+        spec[specLen] = '\0';
+        left = lineLen - len;
+        
+        if(('d' == conv) || ('i' == conv)) {
+            
+            ret = ('L' == lengthMod) ? snprintf(&line[len], left, spec, (long long)event->arg[argIndex].i) :
+                  ('l' == lengthMod) ? snprintf(&line[len], left, spec, (long)event->arg[argIndex].i) :
+                  ('z' == lengthMod) ? snprintf(&line[len], left, spec, (ssize_t)event->arg[argIndex].i) :
+                                       snprintf(&line[len], left, spec, (int)event->arg[argIndex].i);
+        }
+        else if(NULL != strchr("uoxXc", conv)) {
+            
+            ret = ('L' == lengthMod) ? snprintf(&line[len], left, spec, (unsigned long long)event->arg[argIndex].u) :
+                  ('l' == lengthMod) ? snprintf(&line[len], left, spec, (unsigned long)event->arg[argIndex].u) :
+                  ('z' == lengthMod) ? snprintf(&line[len], left, spec, (size_t)event->arg[argIndex].u) :
+                                       snprintf(&line[len], left, spec, (unsigned int)event->arg[argIndex].u);
+        }
+        else if(NULL != strchr("fFeEgGaA", conv)) {
+            
+            ret = snprintf(&line[len], left, spec, event->arg[argIndex].d);
+        }
+        else if('p' == conv) {
+            
+            ret = snprintf(&line[len], left, spec, event->arg[argIndex].p);
+        }
+        else {
+            
+            ret = snprintf(&line[len], left, spec, &(event->strBuf[event->arg[argIndex].u]));
+        }
+        
+        len = ((ret < 0) || ((size_t)ret >= left)) ? (lineLen - 1) : (len + ret);
+        argIndex++;
+        pos = convEnd;
+    }
+    
+    /* Remaining text (conversions without copied argument are printed as they are) */
+    appendLogText(line, &len, lineLen, pos, pos + strlen(pos));
+}
+
+/*
+ * Function 'forwardLogLine': writes a formatted message to syslog (and the terminal in debug builds).
+ */
+static void forwardLogLine(int priority, const char *line) {
+
+#ifdef SERVER_DEBUG
+    FILE *stream = (priority <= LOG_WARNING) ? stderr : stdout;
+    
+    fputs(line, stream);
+    fflush(stream);
+#endif
+    syslog(LOG_DAEMON | priority, "%s", line);
+    __atomic_fetch_add(&logForwarded, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * Function 'reportSuppressed': reports the events suppressed by the rate limit of a format.
+ */
+static void reportSuppressed(struct LogRate *rate) {
+    
+    char line[LOG_LINE_MAX_LEN];
+    
+    snprintf(line, sizeof(line), LOG_SYS_WARN_LOG_SUPPRESSED, rate->suppressed, rate->format);
+    forwardLogLine(LOG_WARNING, line);
+}
+
+/*
+ * Function 'passLogRate': applies the rate limit of its format to an event.
+ * 
+ * Note:    Returns non-zero if the event is to be forwarded. Formats are tracked in
+ *          an open addressing table by their address; formats not fitting the table
+ *          are not rate limited.
+ */
+static int passLogRate(const struct LogEvent *event) {
+    
+    uint32_t index = (uint32_t)(((uintptr_t)event->format >> 3) * 2654435761u) & (LOG_RATE_TABLE_SIZE - 1);
+    uint32_t probe;
+    struct LogRate *rate = NULL;
+    
+    for(probe = 0; probe < LOG_RATE_TABLE_SIZE; probe++) {
+        
+        rate = &(logRateTable[(index + probe) & (LOG_RATE_TABLE_SIZE - 1)]);
+        if((event->format == rate->format) || (NULL == rate->format)) {
+            
+            break;
+        }
+    }
+    
+    if(probe == LOG_RATE_TABLE_SIZE) {
+        
+        return 1;
+    }
+    
+    if(NULL == rate->format) {
+        
+        rate->format = event->format;
+        rate->windowStartNs = event->timeNs;
+    }
+    
+    /* Start a new window */
+    if(event->timeNs - rate->windowStartNs >= LOG_RATE_WINDOW_MS * NSEC_PER_MSEC) {
+        
+        if(0 != rate->suppressed) {
+            
+            reportSuppressed(rate);
+        }
+        
+        rate->windowStartNs = event->timeNs;
+        rate->count = 0;
+        rate->suppressed = 0;
+    }
+    
+    rate->count++;
+    if((rate->count <= LOG_RATE_BURST) || (0 == ((rate->count - LOG_RATE_BURST) % LOG_RATE_SAMPLE))) {
+        
+        return 1;
+    }
+    
+    rate->suppressed++;
+    __atomic_fetch_add(&logSuppressed, 1, __ATOMIC_RELAXED);
+    
+    return 0;
+}
+
+/*
+ * Function 'flushLogRates': reports the suppressed events of the windows ended by now.
+ */
+static void flushLogRates(uint64_t nowNs) {
+    
+    int i;
+    
+    for(i = 0; i < LOG_RATE_TABLE_SIZE; i++) {
+        
+        if((NULL != logRateTable[i].format) && (0 != logRateTable[i].suppressed) &&
+           (nowNs - logRateTable[i].windowStartNs >= LOG_RATE_WINDOW_MS * NSEC_PER_MSEC)) {
+            
+            reportSuppressed(&(logRateTable[i]));
+            logRateTable[i].windowStartNs = nowNs;
+            logRateTable[i].count = 0;
+            logRateTable[i].suppressed = 0;
+        }
+    }
+}
+
+/*
+ * Function 'drainLogRings': forwards the events of all rings in time order.
+ * 
+ * Note:    Returns the number of events taken from the rings.
+ */
+static int drainLogRings(void) {
+    
+    char line[LOG_LINE_MAX_LEN];
+    struct LogRing *ring = NULL;
+    struct LogRing *oldest = NULL;
+    struct LogEvent *event = NULL;
+    uint32_t count = __atomic_load_n(&logRingCount, __ATOMIC_RELAXED);
+    uint32_t i;
+    int drained = 0;
+    
+    if(count > LOG_RING_MAX) {
+        
+        count = LOG_RING_MAX;
+    }
+    
+    while(1) {
+        
+        /* Merge rings: take the oldest head event */
+        oldest = NULL;
+        for(i = 0; i < count; i++) {
+            
+            ring = __atomic_load_n(&(logRingTable[i]), __ATOMIC_ACQUIRE);
+            if((NULL != ring) && (ring->tail != __atomic_load_n(&(ring->head), __ATOMIC_ACQUIRE))) {
+                
+                if((NULL == oldest) ||
+                   (ring->event[ring->tail & (LOG_RING_SIZE - 1)].timeNs < oldest->event[oldest->tail & (LOG_RING_SIZE - 1)].timeNs)) {
+                    
+                    oldest = ring;
+                }
+            }
+        }
+        
+        if(NULL == oldest) {
+            
+            break;
+        }
+        
+        event = &(oldest->event[oldest->tail & (LOG_RING_SIZE - 1)]);
+        if(passLogRate(event)) {
+            
+            formatLogEvent(event, line, sizeof(line));
+            forwardLogLine(event->priority, line);
+        }
+        
+        /* Release slot to the producer */
+        __atomic_store_n(&(oldest->tail), oldest->tail + 1, __ATOMIC_RELEASE);
+        drained++;
+    }
+    
+    return drained;
+}
+
+/*
+ * Function 'getLogCounters': returns the counters of the asynchronous logging.
+ */
+void getLogCounters(struct LogCounters *counters) {
+    
+    struct LogRing *ring = NULL;
+    uint32_t count = __atomic_load_n(&logRingCount, __ATOMIC_RELAXED);
+    uint32_t i;
+    
+    counters->dropped = __atomic_load_n(&logDropNoRing, __ATOMIC_RELAXED);
+    for(i = 0; (i < count) && (i < LOG_RING_MAX); i++) {
+        
+        ring = __atomic_load_n(&(logRingTable[i]), __ATOMIC_ACQUIRE);
+        if(NULL != ring) {
+            
+            counters->dropped += __atomic_load_n(&(ring->dropCount), __ATOMIC_RELAXED);
+        }
+    }
+    
+    counters->suppressed = __atomic_load_n(&logSuppressed, __ATOMIC_RELAXED);
+    counters->forwarded = __atomic_load_n(&logForwarded, __ATOMIC_RELAXED);
+}
+
+/*
+ * Function 'logThreadFunction': formats and forwards the events logged by the other threads.
+ * 
+ * Note:    Sleeps LOG_THREAD_IDLE_MS whenever the rings are empty, so producers never
+ *          have to wake it up (no syscall on the hot paths). Reports newly dropped
+ *          events and the suppressed ones once a second.
+ */
+static void* logThreadFunction(void *arg) {
+    
+    struct LogCounters counters;
+    struct timespec idle;
+    uint64_t reportedDrops = 0;
+    uint64_t lastReportNs = getLogTimeNs();
+    uint64_t nowNs;
+    char line[LOG_LINE_MAX_LEN];
+    
+    idle.tv_sec = 0;
+    idle.tv_nsec = LOG_THREAD_IDLE_MS * NSEC_PER_MSEC;
+    
+    while(!__atomic_load_n(&logThreadStop, __ATOMIC_ACQUIRE)) {
+        
+        if(0 == drainLogRings()) {
+            
+            nanosleep(&idle, NULL);
+        }
+        
+        nowNs = getLogTimeNs();
+        if(nowNs - lastReportNs >= LOG_RATE_WINDOW_MS * NSEC_PER_MSEC) {
+            
+            lastReportNs = nowNs;
+            flushLogRates(nowNs);
+            
+            getLogCounters(&counters);
+            if(counters.dropped != reportedDrops) {
+                
+                snprintf(line, sizeof(line), LOG_SYS_WARN_LOG_DROPPED,
+                         (unsigned long long)(counters.dropped - reportedDrops), (unsigned long long)counters.dropped);
+                forwardLogLine(LOG_WARNING, line);
+                reportedDrops = counters.dropped;
+            }
+        }
+    }
+    
+    /* Forward what is left */
+    drainLogRings();
+    flushLogRates(UINT64_MAX);
+    
+    return NULL;
+}
+
+/*
+ * Function 'startLogThread': starts the thread forwarding the logged events.
+ * 
+ * Note:    Call after openlog. Events logged before are kept in the rings until then.
+ *          Without the thread the events are dropped once the rings are full, so its
+ *          creation failure is logged synchronously.
+ */
+int startLogThread(void) {
+    
+    int error = 0;
+    
+    if(0 != pthread_create(&logThread, NULL, logThreadFunction, NULL)) {
+        
+        /* Failed to create log thread */
+#ifdef SERVER_DEBUG
+        fprintf(stderr, LOG_SYS_ERR_THREAD_LOG_CREAT_FAIL);
+        fflush(stderr);
+#endif
+        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_THREAD_LOG_CREAT_FAIL);
+        
+        error = -1;
+        return error;
+    }
+    
+    logThreadRunning = 1;
+    
+    return error;
+}
+
+/*
+ * Function 'stopLogThread': forwards the remaining events and stops the log thread.
+ * 
+ * Note:    Call before closelog when the server exits.
+ */
+void stopLogThread(void) {
+    
+    if(0 == logThreadRunning) {
+        
+        return;
+    }
+    
+    __atomic_store_n(&logThreadStop, 1, __ATOMIC_RELEASE);
+    pthread_join(logThread, NULL);
+    logThreadRunning = 0;
+}
@@ -0,0 +1,377 @@
+/*
+ * FileName:    metrics.c
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ * 
+ * Desc.:       Source file containing the metrics registry of the server.
+ * 
+ *              Counters and latency histograms are sharded per thread: each thread
+ *              records into its own shard (registered on first use), so recording
+ *              takes no lock and no shared cache line. Shards are guarded by a
+ *              seqlock, readers (STATS request) sum consistent copies of them.
+ * 
+ *              Histograms are HDR-style (log-linear): values below METRIC_HIST_SUB_COUNT
+ *              have their own bucket, larger ones share a bucket with the values of the
+ *              same power of two and the same METRIC_HIST_SUB_BITS leading bits, so the
+ *              relative error stays below 1 / METRIC_HIST_SUB_COUNT over the whole range.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bme280_qt_interf_v2.h"
+#include "myserver.h"
+
+/* Metrics shard of a thread (written by its thread only) */
+struct MetricShard {
+    
+    uint32_t lock __attribute__((aligned(64)));     // Odd while the shard is being written
+    uint64_t counter[METRIC_CNT_COUNT];
+    struct MetricHist hist[METRIC_HIST_COUNT];
+};
+
+/* Shards of the recording threads (registered on their first record) */
+static struct MetricShard *metricShardTable[METRIC_SHARD_MAX];
+static uint32_t metricShardCount = 0;
+static __thread struct MetricShard *threadMetricShard = NULL;
+
+static uint64_t metricStartNs = 0;                  // Time of initMetrics
+
+/*
+ * Function 'getMetricTimeNs': returns the monotonic time [nsec] (vDSO, no syscall).
+ */
+uint64_t getMetricTimeNs(void) {
+    
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+/*
+ * Function 'initMetrics': starts the uptime of the metrics registry.
+ */
+void initMetrics(void) {
+    
+    metricStartNs = getMetricTimeNs();
+}
+
+/*
+ * Function 'getThreadMetricShard': returns the shard of the calling thread, registers it on first use.
+ */
+static struct MetricShard* getThreadMetricShard(void) {
+    
+    uint32_t index;
+    struct MetricShard *shard = NULL;
+    
+    if(NULL != threadMetricShard) {
+        
+        return threadMetricShard;
+    }
+    
+    if(__atomic_load_n(&metricShardCount, __ATOMIC_RELAXED) >= METRIC_SHARD_MAX) {
+        
+        return NULL;
+    }
+    
+    if(0 != posix_memalign((void**)&shard, 64, sizeof(struct MetricShard))) {
+        
+        return NULL;
+    }
+    
+    memset(shard, 0, sizeof(struct MetricShard));
+    
+    index = __atomic_fetch_add(&metricShardCount, 1, __ATOMIC_RELAXED);
+    if(index >= METRIC_SHARD_MAX) {
+        
+        free(shard);
+        return NULL;
+    }
+    
+    __atomic_store_n(&(metricShardTable[index]), shard, __ATOMIC_RELEASE);
+    threadMetricShard = shard;
+    
+    return shard;
+}
+
+/*
+ * Function 'getMetricBucket': returns the histogram bucket of a value.
+ */
+static uint32_t getMetricBucket(uint64_t value) {
+    
+    uint32_t exponent;
+    
+    if(value < METRIC_HIST_SUB_COUNT) {
+        
+        return (uint32_t)value;
+    }
+    
+    if(value > METRIC_HIST_VALUE_MAX) {
+        
+        value = METRIC_HIST_VALUE_MAX;
+    }
+    
+    /* Position of the leading bit, then the METRIC_HIST_SUB_BITS bits following it */
+    exponent = 63 - __builtin_clzll(value);
+    
+    return (exponent - METRIC_HIST_SUB_BITS + 1) * METRIC_HIST_SUB_COUNT +
+           (uint32_t)(value >> (exponent - METRIC_HIST_SUB_BITS)) - METRIC_HIST_SUB_COUNT;
+}
+
+/*
+ * Function 'getMetricBucketMax': returns the highest value of a histogram bucket.
+ */
+static uint64_t getMetricBucketMax(uint32_t bucket) {
+    
+    uint32_t shift;
+    
+    if(bucket < METRIC_HIST_SUB_COUNT) {
+        
+        return bucket;
+    }
+    
+    shift = bucket / METRIC_HIST_SUB_COUNT - 1;
+    
+    return (((uint64_t)(bucket % METRIC_HIST_SUB_COUNT + METRIC_HIST_SUB_COUNT) + 1) << shift) - 1;
+}
+
+/*
+ * Function 'addMetricCounter': adds a value to a counter of the calling thread.
+ */
+void addMetricCounter(int counter, uint64_t value) {
+    
+    struct MetricShard *shard = getThreadMetricShard();
+    uint32_t lock;
+    
+    if(NULL == shard) {
+        
+        return;
+    }
+    
+    lock = shard->lock;
+    
+    /* Mark shard as being written */
+    __atomic_store_n(&(shard->lock), lock + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    shard->counter[counter] += value;
+    
+    /* Mark shard as complete */
+    __atomic_store_n(&(shard->lock), lock + 2, __ATOMIC_RELEASE);
+}
+
+/*
+ * Function 'recordMetricValue': records a value (e.g. latency [nsec]) in a histogram of the calling thread.
+ */
+void recordMetricValue(int histogram, uint64_t value) {
+    
+    struct MetricShard *shard = getThreadMetricShard();
+    struct MetricHist *hist = NULL;
+    uint32_t lock;
+    
+    if(NULL == shard) {
+        
+        return;
+    }
+    
+    hist = &(shard->hist[histogram]);
+    lock = shard->lock;
+    
+    /* Mark shard as being written */
+    __atomic_store_n(&(shard->lock), lock + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    if((0 == hist->count) || (value < hist->min)) {
+        
+        hist->min = value;
+    }
+    
+    if(value > hist->max) {
+        
+        hist->max = value;
+    }
+    
+    hist->count++;
+    hist->sum += value;
+    hist->bucket[getMetricBucket(value)]++;
+    
+    /* Mark shard as complete */
+    __atomic_store_n(&(shard->lock), lock + 2, __ATOMIC_RELEASE);
+}
+
+/*
+ * Function 'mergeMetricHist': adds a histogram to another one.
+ */
+static void mergeMetricHist(struct MetricHist *total, const struct MetricHist *hist) {
+    
+    uint32_t i;
+    
+    if(0 == hist->count) {
+        
+        return;
+    }
+    
+    if((0 == total->count) || (hist->min < total->min)) {
+        
+        total->min = hist->min;
+    }
+    
+    if(hist->max > total->max) {
+        
+        total->max = hist->max;
+    }
+    
+    total->count += hist->count;
+    total->sum += hist->sum;
+    for(i = 0; i < METRIC_HIST_BUCKETS; i++) {
+        
+        total->bucket[i] += hist->bucket[i];
+    }
+}
+
+/*
+ * Function 'getMetricSnapshot': sums the shards of all threads.
+ * 
+ * Note:    Reader side of the shard seqlocks: each shard is copied until the copy
+ *          is not torn by its thread (at most METRIC_READ_RETRIES attempts), so
+ *          the counts and buckets of a histogram always match. Snapshot is large
+ *          (see METRIC_HIST_BUCKETS), do not place it on the stack.
+ */
+int getMetricSnapshot(struct MetricSnapshot *snapshot) {
+    
+    struct MetricShard *shard = NULL;
+    struct MetricShard *copy = NULL;
+    uint32_t count = __atomic_load_n(&metricShardCount, __ATOMIC_RELAXED);
+    uint32_t lockBegin;
+    uint32_t lockEnd;
+    uint32_t i;
+    int retry;
+    int j;
+    int error = 0;
+    
+    if(0 != posix_memalign((void**)&copy, 64, sizeof(struct MetricShard))) {
+        
+        error = -1;
+        return error;
+    }
+    
+    memset(snapshot, 0, sizeof(struct MetricSnapshot));
+    snapshot->uptimeNs = getMetricTimeNs() - metricStartNs;
+    
+    for(i = 0; (i < count) && (i < METRIC_SHARD_MAX); i++) {
+        
+        shard = __atomic_load_n(&(metricShardTable[i]), __ATOMIC_ACQUIRE);
+        if(NULL == shard) {
+            
+            continue;
+        }
+        
+        for(retry = 0; retry < METRIC_READ_RETRIES; retry++) {
+            
+            lockBegin = __atomic_load_n(&(shard->lock), __ATOMIC_ACQUIRE);
+            if(lockBegin & 1) {
+                
+                /* Writer in progress */
+                continue;
+            }
+            
+            memcpy(copy, shard, sizeof(struct MetricShard));
+            
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            lockEnd = __atomic_load_n(&(shard->lock), __ATOMIC_RELAXED);
+            if(lockBegin == lockEnd) {
+                
+                break;
+            }
+        }
+        
+        /* A shard busy for every attempt is taken as copied last */
+        for(j = 0; j < METRIC_CNT_COUNT; j++) {
+            
+            snapshot->counter[j] += copy->counter[j];
+        }
+        
+        for(j = 0; j < METRIC_HIST_COUNT; j++) {
+            
+            mergeMetricHist(&(snapshot->hist[j]), &(copy->hist[j]));
+        }
+    }
+    
+    free(copy);
+    
+    return error;
+}
+
+/*
+ * Function 'getMetricCountBelow': returns the number of values not above a limit (e.g. Prometheus 'le' bucket).
+ * 
+ * Note:    Buckets are counted if their highest value is not above the limit, so
+ *          values sharing a bucket with the limit may be left out (see METRIC_HIST_SUB_BITS).
+ */
+uint64_t getMetricCountBelow(const struct MetricHist *hist, uint64_t limit) {
+    
+    uint64_t count = 0;
+    uint32_t i;
+    
+    for(i = 0; (i < METRIC_HIST_BUCKETS) && (getMetricBucketMax(i) <= limit); i++) {
+        
+        count += hist->bucket[i];
+    }
+    
+    return count;
+}
+
+/*
+ * Function 'getMetricPercentile': returns a percentile of a histogram (quantile: 0.0 - 1.0).
+ * 
+ * Note:    Returns the highest value of the bucket holding the percentile (within
+ *          the histogram precision), limited by the recorded extremes.
+ */
+uint64_t getMetricPercentile(const struct MetricHist *hist, double quantile) {
+    
+    uint64_t target;
+    uint64_t seen = 0;
+    uint64_t value = 0;
+    uint32_t i;
+    
+    if(0 == hist->count) {
+        
+        return 0;
+    }
+    
+    /* Rank of the percentile (rounded up) */
+    target = (uint64_t)(quantile * (double)hist->count);
+    if((double)target < quantile * (double)hist->count) {
+        
+        target++;
+    }
+    
+    if(target < 1) {
+        
+        target = 1;
+    }
+    
+    for(i = 0; i < METRIC_HIST_BUCKETS; i++) {
+        
+        seen += hist->bucket[i];
+        if(seen >= target) {
+            
+            value = getMetricBucketMax(i);
+            break;
+        }
+    }
+    
+    if(value > hist->max) {
+        
+        value = hist->max;
+    }
+    
+    if(value < hist->min) {
+        
+        value = hist->min;
+    }
+    
+    return value;
+}
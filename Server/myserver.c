@@ -7,18 +7,52 @@
  * 
  * Compile like this:
  * 
- * gcc -DSERVER_DEBUG -DBME280_FLOAT_ENABLE -O0 -ggdb -Wall -o myserver myserver.c thread.c services.c bme280_qt_interf_v2.c bme280.c -pthread -I/home/lprog/MyLinuxProg/LinuxHomework/Server
+ * gcc -DSERVER_DEBUG -DBME280_FLOAT_ENABLE -O0 -ggdb -Wall -o myserver myserver.c thread.c services.c logger.c metrics.c exporter.c tracer.c lockprof.c bme280_qt_interf_v2.c bme280_transport.c bme280.c bme280_sim.c storage.c -pthread -lm -lrt -I/home/lprog/MyLinuxProg/LinuxHomework/Server
+ * 
+ * USDT probes for bpftrace / SystemTap (see SERVER_PROBE in myserver.h) are compiled in if <sys/sdt.h>
+ * is installed (e.g. systemtap-sdt-dev), add -DSERVER_NO_USDT to leave them out. List them like this:
+ * 
+ * bpftrace -l 'usdt:./myserver:*'
  * 
  * Run like this: ./myserver (depending on the current directory you might run it as sudo)
  * 
+ * Sensor transport options (use absolute paths, the daemon changes its directory to /):
+ * 
+ *  -t i2c|sim|replay   Real sensor on the I2C bus (default), simulated sensor or recorded trace
+ *  -d <path>           I2C bus device (default: /dev/i2c-1) or trace file to replay
+ *  -w <path>           Record the register transactions of the sensor to a trace file
+ *  -c <path>           Sensor configuration file listing several sensors (overrides -t, -d and -w),
+ *                      one per line: <i2c|sim|replay> <I2C device or trace file> <I2C address> [trace file to record]
+ *                      e.g. "i2c /dev/i2c-1 0x76", "i2c /dev/i2c-1 0x77", "i2c /dev/i2c-3 0x76"
+ *                      Clients select the sensor they refer to by its line number (0: first sensor).
+ *  -m <name>           POSIX shared memory object the latest samples are published to for local
+ *                      readers (default: /myserver_feed, see Feed/samplefeed.h)
+ *  -u <path>           Unix domain socket local clients connect to (default: /tmp/myserver.sock,
+ *                      empty: TCP only)
+ *  -p                  Clients of the Unix socket running as root or as the server user log in
+ *                      by their peer credentials (any password)
+ *  -g <group[:port]>   Publish every sample once to an IPv4 multicast group (default port: 2234)
+ *  -i <address>        Address of the interface the multicast datagrams are sent on
+ *                      (e.g. 127.0.0.1 for receivers on this host only)
+ *  -e <[address:]port> Serve the metrics in the Prometheus text format on http://<address>:<port>/metrics
+ *                      (default address: 127.0.0.1), the recorded spans on http://<address>:<port>/trace
+ *  -T                  Do not record request and sample spans (recorded by default, send SIGUSR1 to dump
+ *                      them to myserver_trace.json next to meas_data, open it in chrome://tracing or Perfetto)
+ *  -L                  Record the wait and hold times of serviceMutex, sensorMutex and savedDataMutex
+ *                      per call site (on by default if built with -DSERVER_LOCK_PROFILE), shown by the
+ *                      STATS request and the metrics page (sites are logged on their first use)
+ * 
  */
 
 #include <netinet/in.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <syslog.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "bme280_qt_interf_v2.h"
@@ -27,30 +61,140 @@
 /* Declare global variables */
 
 int serverSocket;
-int savedDataFd = SAVED_DATA_FD_INVALID;
-char savedDataFilePath[SAVED_DATA_FILE_PATH_LEN];
+int unixServerSocket = -1;                              // Local clients (-1: TCP only)
+uint8_t peerCredAuth = 0;                               // Local clients may authenticate by peer credentials
 pthread_mutex_t serviceMutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t sensorMutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t savedDataMutex = PTHREAD_MUTEX_INITIALIZER;
 
-/* Sensor and measurement settings */
+/* Sensors and their measurement contexts */
+
+struct SensorContext sensorArray[SENSOR_ARRAY_SIZE];    // Sensors (index: sensor ID)
+int sensorCount = 0;                                    // Number of sensors in use
+
+/* Client sessions parked by long-poll requests (see eventThreadFunction) */
+
+pthread_mutex_t parkMutex = PTHREAD_MUTEX_INITIALIZER;
+struct ParkedSession *parkQueue = NULL;                 // Parked by service threads, taken by the event thread
+struct ParkedSession *resumeQueue = NULL;               // Completed by the event thread, taken by service threads
+int parkEventFd = -1;                                   // Signalled on parkQueue push
+int resumeEventFd = -1;                                 // Signalled on resumeQueue push (semaphore)
+
+/* Latest samples published to local processes (see createSampleFeed) */
+
+struct FeedSegment *sampleFeed = NULL;                  // Shared memory sample feed (NULL: disabled)
+int sampleMcastSocket = -1;                             // UDP multicast sample feed (-1: disabled)
+uint32_t sampleMcastStreamId = 0;                       // Tells receivers the server restarted
 
-struct identifier sensorId;     // Sensor interface identifier
-struct bme280_dev sensorDev;    // Sensor device and settings
-uint8_t sensorSettingSel;       // Sensor setting selection
-uint32_t minDelay;              // Minimal delay after requesting a measurement
-int measPeriod;                 // Measurement period [sec]
+/* Trace dump requested by TRACE_DUMP_SIGNAL (served by the main loop) */
+
+static volatile sig_atomic_t traceDumpRequested = 0;
+
+/*
+ * Function 'traceDumpSignalHandler': requests a trace dump from the main loop.
+ */
+static void traceDumpSignalHandler(int signum) {
+    
+    traceDumpRequested = 1;
+}
+
+/* Termination requested by SIGTERM or SIGINT (served by the main loop) */
+
+static volatile sig_atomic_t terminateRequested = 0;
+
+/*
+ * Function 'terminateSignalHandler': requests the main loop to shut the server down.
+ */
+static void terminateSignalHandler(int signum) {
+    
+    terminateRequested = 1;
+}
 
 int main(int argc, char* argv[]) {
     
     struct sockaddr_in6 serverAddress;
-    pthread_t measureThread;
     pthread_t threadPool[SERVER_THREAD_POOL_SIZE];
+    pthread_t eventThread;
     
     int i;
-    int *measureThreadId = NULL;
     int *serviceThreadId = NULL;
     int reuseAddrState = 1;
+    int opt;
+    
+    struct sigaction traceDumpAction;
+    struct sigaction terminateAction;
+    sigset_t mainSignalSet;             // Signals served by the main thread only
+    char traceDumpPath[SAVED_DATA_FILE_PATH_LEN + sizeof(TRACE_DUMP_FILE_NAME)];   // Next to the saved data of sensor 0
+    const char *traceDumpDir = NULL;    // Saved data file of sensor 0 (path up to its last '/')
+    
+    const char *transportName = NULL;   // Transport of the single sensor (no config file)
+    const char *busPath = NULL;         // I2C device or trace file of the single sensor
+    const char *tracePath = NULL;       // Trace file to record for the single sensor
+    const char *sensorConfigPath = NULL;    // Sensor configuration file
+    const char *feedName = SAMPLE_FEED_NAME;    // Shared memory sample feed
+    const char *unixPath = SERVER_UNIX_PATH;    // Unix socket of local clients
+    const char *mcastGroup = NULL;              // Multicast group of the sample feed (NULL: disabled)
+    const char *mcastInterface = NULL;          // Interface of the multicast feed
+    const char *exportAddress = NULL;           // Metrics listener (NULL: disabled)
+    
+    /* Parse sensor transport options */
+    while(-1 != (opt = getopt(argc, argv, SERVER_OPT_STRING))) {
+        
+        if('t' == opt) {
+            
+            transportName = optarg;
+        }
+        else if('d' == opt) {
+            
+            busPath = optarg;
+        }
+        else if('w' == opt) {
+            
+            tracePath = optarg;
+        }
+        else if('c' == opt) {
+            
+            sensorConfigPath = optarg;
+        }
+        else if('m' == opt) {
+            
+            feedName = optarg;
+        }
+        else if('u' == opt) {
+            
+            unixPath = optarg;
+        }
+        else if('p' == opt) {
+            
+            peerCredAuth = 1;
+        }
+        else if('g' == opt) {
+            
+            mcastGroup = optarg;
+        }
+        else if('i' == opt) {
+            
+            mcastInterface = optarg;
+        }
+        else if('e' == opt) {
+            
+            exportAddress = optarg;
+        }
+        else if('T' == opt) {
+            
+            traceEnabled = 0;
+        }
+        else if('L' == opt) {
+            
+            lockProfileEnabled = 1;
+        }
+        else {
+            
+            /* Invalid option */
+            fprintf(stdout, SERVER_USAGE, argv[0]);
+            fflush(stdout);
+            
+            return EXIT_FAILURE;
+        }
+    }
     
 #ifndef SERVER_DEBUG
     /* Run program as system daemon */
@@ -64,23 +208,64 @@ int main(int argc, char* argv[]) {
     }
 #endif
     
+    /* Trace dumps are served by the main loop: threads created from here on keep the signal blocked */
+    sigemptyset(&mainSignalSet);
+    sigaddset(&mainSignalSet, TRACE_DUMP_SIGNAL);
+    sigaddset(&mainSignalSet, SIGTERM);
+    sigaddset(&mainSignalSet, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &mainSignalSet, NULL);
+    
+    memset(&traceDumpAction, 0, sizeof(traceDumpAction));
+    traceDumpAction.sa_handler = traceDumpSignalHandler;
+    sigemptyset(&(traceDumpAction.sa_mask));
+    sigaction(TRACE_DUMP_SIGNAL, &traceDumpAction, NULL);
+    
+    /* Termination as well: buffered measurement data is written out before exit */
+    memset(&terminateAction, 0, sizeof(terminateAction));
+    terminateAction.sa_handler = terminateSignalHandler;
+    sigemptyset(&(terminateAction.sa_mask));
+    sigaction(SIGTERM, &terminateAction, NULL);
+    sigaction(SIGINT, &terminateAction, NULL);
+    
     /* Open connection to the system logger */
     openlog(SERVER_SYSLOG_NAME, LOG_PID | LOG_NDELAY, LOG_DAEMON);
     
+    /* Start forwarding the asynchronous log events of the threads */
+    if(0 != startLogThread()) {
+        
+        closelog();
+        
+        return EXIT_FAILURE;
+    }
+    
+    /* Start uptime of the statistics */
+    initMetrics();
+    
     /* Log startup. */
     syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_SERVER_START);
     
-    /* Initialize saved data file path */
-    memset(savedDataFilePath, 0 ,sizeof(savedDataFilePath));
-#ifdef SERVER_DEBUG
+    if(lockProfileEnabled) {
+        
+        syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_SERVER_LOCK_PROFILE);
+    }
     
-    /* Use actual directory for debugging mode */
-    initSavedDataFilePath(savedDataFilePath);
-#else
+    /* Set up sensor list: sensor configuration file or the single sensor of the transport options */
+    if(NULL != sensorConfigPath) {
+        
+        opt = loadSensorConfig(sensorConfigPath);
+    }
+    else {
+        
+        opt = addSensor(transportName, busPath, 0, tracePath);
+    }
     
-    /* Use /home/pi/ directory for daemon mode */
-    strcpy(savedDataFilePath, SAVED_DATA_FILE_PATH_PI);
-#endif
+    if(0 != opt) {
+        
+        stopLogThread();
+        closelog();
+        
+        return EXIT_FAILURE;
+    }
     
     /*
      * Note: If the current directory requires elevated rights
@@ -96,6 +281,7 @@ int main(int argc, char* argv[]) {
         fflush(stderr);
 #endif
         syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SOCK_CREAT_FAIL);
+        stopLogThread();
         closelog();
         
         return EXIT_FAILURE;
@@ -124,6 +310,7 @@ int main(int argc, char* argv[]) {
             /* Let the OS deal with it after terminating the program */
         }
         
+        stopLogThread();
         closelog();
         
         return EXIT_FAILURE;
@@ -158,6 +345,7 @@ int main(int argc, char* argv[]) {
             /* Let the OS deal with it after terminating the program */
         }
         
+        stopLogThread();
         closelog();
         
         return EXIT_FAILURE;
@@ -186,62 +374,120 @@ int main(int argc, char* argv[]) {
             /* Let the OS deal with it after terminating the program */
         }
         
+        stopLogThread();
         closelog();
         
         return EXIT_FAILURE;
     }
     
-    /* Initialize BME280 sensor for weather monitoring */
-    if(init_dev_weather(&sensorId, &sensorDev) < 0) {
-		 
-        /* Failed to initialize BME280 sensor */
-#ifdef SERVER_DEBUG
-        fprintf(stderr, LOG_SYS_ERR_SENS_INIT_FAIL);
-        fflush(stderr);
-#endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SENS_INIT_FAIL);
+    /* Listen for local clients as well (server runs TCP only on failure) */
+    if('\0' != unixPath[0]) {
         
-        closelog();
+        openUnixServerSocket(unixPath);
+    }
+    
+    /* Initialize BME280 sensors for weather monitoring */
+    for(i = 0; i < sensorCount; i++) {
         
-        return EXIT_FAILURE;
-	 }
+        if(0 != initSensor(&(sensorArray[i]))) {
+            
+            /* Failed to initialize BME280 sensor */
+#ifdef SERVER_DEBUG
+            fprintf(stderr, LOG_SYS_ERR_SENS_INIT_FAIL);
+            fflush(stderr);
+#endif
+            syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SENS_INIT_FAIL);
+            
+            stopLogThread();
+            closelog();
+            
+            return EXIT_FAILURE;
+        }
+    }
     
-    /* Calculate minimal delay */
-    minDelay = get_min_delay(&sensorId, &sensorDev);
+    /* Trace dumps go to the directory of the saved data (not a shared one like /tmp) */
+    traceDumpDir = sensorArray[0].savedDataFilePath;
+    if(NULL == strrchr(traceDumpDir, '/')) {
+        
+        traceDumpDir = SAVED_DATA_FILE_PATH_PI;
+    }
+    snprintf(traceDumpPath, sizeof(traceDumpPath), "%.*s%s", (int)(strrchr(traceDumpDir, '/') + 1 - traceDumpDir),
+             traceDumpDir, TRACE_DUMP_FILE_NAME);
     
-    /* Initialize measurement period */
-    measPeriod = MEAS_PERIOD_INIT_SEC;
+    if(traceEnabled) {
+        
+        syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_SERVER_TRACE, TRACE_DUMP_SIGNAL, traceDumpPath);
+    }
     
-    /* Initialize sensor setting selection */
-    sensorSettingSel = 0;
-    sensorSettingSel = BME280_OSR_PRESS_SEL | BME280_OSR_TEMP_SEL | BME280_OSR_HUM_SEL | BME280_FILTER_SEL;
+    /* Publish latest samples to local processes (server runs without the feed on failure) */
+    createSampleFeed(feedName);
     
-    /* Create measure thread */
-    measureThreadId = (int*)malloc(sizeof(int));
-    *measureThreadId = 0;
-    if(0 != pthread_create(&measureThread, NULL, measureThreadFunction, measureThreadId)) {
+    /* Publish samples to the LAN if requested (server runs without it on failure) */
+    if(NULL != mcastGroup) {
         
-        /* Failed to create measure thread */
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_THREAD_MEAS_CREAT_FAIL);
-        
-        /* Close server socket */
-        if(close(serverSocket) < 0) {
+        openSampleMulticast(mcastGroup, mcastInterface);
+    }
+    
+    /* Create a measure thread per sensor */
+    for(i = 0; i < sensorCount; i++) {
         
-            /* Failed to close server socket */
+        if(0 != pthread_create(&(sensorArray[i].measureThread), NULL, measureThreadFunction, &(sensorArray[i]))) {
+            
+            /* Failed to create measure thread */
+            syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_THREAD_MEAS_CREAT_FAIL);
+            
+            /* Close server socket */
+            if(close(serverSocket) < 0) {
+            
+                /* Failed to close server socket */
 #ifdef SERVER_DEBUG
-            perror("close");
-            fflush(stderr);
+                perror("close");
+                fflush(stderr);
 #endif
-            syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SOCK_CLOSE_FAIL);
-        
-            /* Let the OS deal with it after terminating the program */
+                syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SOCK_CLOSE_FAIL);
+            
+                /* Let the OS deal with it after terminating the program */
+            }
+            
+            stopLogThread();
+            closelog();
+            
+            return EXIT_FAILURE;
         }
+    }
+    
+    /* Create event thread waking up parked client sessions */
+    parkEventFd = eventfd(0, EFD_NONBLOCK);
+    resumeEventFd = eventfd(0, EFD_NONBLOCK | EFD_SEMAPHORE);
+    if((parkEventFd < 0) || (resumeEventFd < 0)) {
         
+        /* Failed to create event notification */
+#ifdef SERVER_DEBUG
+        perror("eventfd");
+        fflush(stderr);
+#endif
+        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_EVENT_INIT_FAIL);
+        
+        stopLogThread();
         closelog();
         
         return EXIT_FAILURE;
     }
     
+    if(0 != pthread_create(&eventThread, NULL, eventThreadFunction, NULL)) {
+        
+        /* Failed to create event thread (long-poll requests time out immediately) */
+        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_THREAD_EVENT_CREAT_FAIL);
+        close(parkEventFd);
+        parkEventFd = -1;
+    }
+    
+    /* Serve metrics to the monitoring if requested (server runs without it on failure) */
+    if(NULL != exportAddress) {
+        
+        startMetricsExport(exportAddress);
+    }
+    
     /* Create service threads */
     for(i = 0; i < SERVER_THREAD_POOL_SIZE; i++) {
         
@@ -254,13 +500,24 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    /* Receive the trace dump and termination signals on the main thread only */
+    pthread_sigmask(SIG_UNBLOCK, &mainSignalSet, NULL);
+    
     /* Main loop */
-    while(1) {
+    while(!terminateRequested) {
         
-        /* Idle on main thread */
+        /* Idle on main thread (woken up early by the trace dump and termination signals) */
         sleep(1);
+        
+        if(traceDumpRequested) {
+            
+            traceDumpRequested = 0;
+            dumpTraceFile(traceDumpPath);
+        }
     }
     
+    syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_SERVER_STOP);
+    
     /* Close server socket */
     if(close(serverSocket) < 0) {
         
@@ -274,13 +531,36 @@ int main(int argc, char* argv[]) {
         /* Let the OS deal with it after terminating the program */
     }
     
+    /* Close Unix server socket */
+    if(unixServerSocket >= 0) {
+        
+        close(unixServerSocket);
+        unlink(unixPath);
+    }
+    
     // TODO Kill service and measure threads 
     
-    /* Close saved data file */
-    close(savedDataFd);
-    savedDataFd = SAVED_DATA_FD_INVALID;
+    /* Remove shared memory sample feed */
+    removeSampleFeed(feedName);
+    
+    /*
+     * Write out buffered measurement data and close saved data files. savedDataMutex
+     * is kept until exit: threads still running must not reopen (recreate) the files.
+     */
+    for(i = 0; i < sensorCount; i++) {
+        
+        SAVED_DATA_MUTEX_LOCK(&(sensorArray[i]));
+        flushSavedData(&(sensorArray[i]));
+        closeSavedColumns(&(sensorArray[i]));
+        if(sensorArray[i].savedDataFd >= 0) {
+            
+            close(sensorArray[i].savedDataFd);
+        }
+        sensorArray[i].savedDataFd = SAVED_DATA_FD_INVALID;
+    }
     
     /* Close connection to the system logger */
+    stopLogThread();
     closelog();
     
     return EXIT_SUCCESS;
@@ -13,41 +13,87 @@
 #include <limits.h>
 #include <pthread.h>
 #include <stdint.h>
+#include <sys/types.h>
+
+/* USDT probes are compiled in wherever the SystemTap SDT header is installed (see SERVER_PROBE) */
+#if !defined(SERVER_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define SERVER_USDT
+#endif
+#endif
 
 /* Server config related macros */
 #define SERVER_PORT_NUMBER                          (2233)
 #define SERVER_PENDING_QUEUE_LIMIT                  (4)
 #define SERVER_SYSLOG_NAME                          ("SensorServer")
 #define SERVER_THREAD_POOL_SIZE                     (4)
+#define SERVER_OPT_STRING                           ("t:d:w:c:m:u:pg:i:e:TL") // -t transport, -d device/trace, -w record trace, -c sensor config, -m sample feed, -u Unix socket, -p peer auth, -g multicast group, -i multicast interface, -e metrics listener, -T no tracing, -L lock profiling
+#define SERVER_USAGE                                ("Usage: %s [-t i2c|sim|replay] [-d I2C device or trace file] [-w trace file to record] [-c sensor config file] [-m sample feed name] [-u Unix socket path] [-p] [-g multicast group[:port]] [-i multicast interface address] [-e [metrics address:]port] [-T] [-L]\n")
+#define SERVER_UNIX_PATH                            ("/tmp/myserver.sock")  // Default Unix socket path (empty: TCP only)
+#define SERVER_UNIX_MODE                            (0666)          // Unix socket permissions (clients still authenticate)
 
 /* Const log strings */
+#define LOG_SYS_ERR_CLIENT_REQ_AGG_FAIL             ("Failed to receive client aggregation query. (%s)\n")
+#define LOG_SYS_ERR_CLIENT_REQ_AGG_INVAL            ("Invalid aggregation query requested by client. (%s)\n")
+#define LOG_SYS_ERR_CLIENT_REQ_DSMP_FAIL            ("Failed to receive client downsampling query. (%s)\n")
+#define LOG_SYS_ERR_CLIENT_REQ_DSMP_INVAL           ("Invalid downsampling query requested by client. (%s)\n")
+#define LOG_SYS_ERR_CLIENT_REQ_GDATP_FAIL           ("Failed to receive client column selection. (%s)\n")
+#define LOG_SYS_ERR_CLIENT_REQ_GDATP_INVAL          ("Invalid column selection requested by client. (%s)\n")
+#define LOG_SYS_ERR_CLIENT_REQ_HIST_FAIL            ("Failed to receive client history query. (%s)\n")
+#define LOG_SYS_ERR_CLIENT_REQ_HIST_INVAL           ("Invalid history query requested by client. (%s)\n")
+#define LOG_SYS_ERR_CLIENT_REQ_WAIT_FAIL            ("Failed to receive client wait query. (%s)\n")
+#define LOG_SYS_ERR_CLIENT_REQ_WAIT_INVAL           ("Invalid wait query requested by client. (%s)\n")
+#define LOG_SYS_ERR_CLIENT_REQ_SUB_FAIL             ("Failed to receive client subscription. (%s)\n")
+#define LOG_SYS_ERR_CLIENT_REQ_SUB_INVAL            ("Invalid subscription requested by client. (%s)\n")
 #define LOG_SYS_ERR_CLIENT_REQ_CONF_FAIL            ("Failed to receive client config request. (%s)\n")
 #define LOG_SYS_ERR_CLIENT_REQ_CONF_TYP_INVAL       ("Invalid configuration type requested by client. (%s)\n")
 #define LOG_SYS_ERR_CLIENT_REQ_CONF_VAL_INVAL       ("Invalid configuration value requested by client. (%s)\n")
 #define LOG_SYS_ERR_CLIENT_REQ_FAIL                 ("Failed to accomplish client request. (%s --> %x)\n")
 #define LOG_SYS_ERR_CLIENT_REQ_RECV_FAIL            ("Failed to receive client request.\n")
+#define LOG_SYS_ERR_CLIENT_REQ_SENS_INVAL           ("Invalid sensor selected by client. (%s)\n")
 #define LOG_SYS_ERR_INVALID_ARGS                    ("Invalid function arguments.\n")
 #define LOG_SYS_ERR_INVALID_SOCK                    ("Invalid socket descriptor.\n")
+#define LOG_SYS_ERR_SENS_CONF_EMPTY                 ("No sensor found in sensor configuration file.\n")
+#define LOG_SYS_ERR_SENS_CONF_LINE_INVAL            ("Invalid line %d in sensor configuration file.\n")
+#define LOG_SYS_ERR_SENS_CONF_OPEN_FAIL             ("Failed to open sensor configuration file.\n")
+#define LOG_SYS_ERR_SENS_CONF_TOO_MANY              ("Too many sensors in sensor configuration file (max. %d).\n")
 #define LOG_SYS_ERR_SENS_INIT_FAIL                  ("Failed to initialize BME280 sensor.\n")
+#define LOG_SYS_ERR_SENS_INIT_ID_FAIL               ("Failed to initialize BME280 sensor %d.\n")
 #define LOG_SYS_ERR_SENS_MEAS_FAIL                  ("Failed to get BME280 sensor measurement data.\n")
+#define LOG_SYS_ERR_SENS_MODE_SET_FAIL              ("Failed to put BME280 sensor into normal mode.\n")
 #define LOG_SYS_ERR_SENS_STGS_SET_FAIL              ("Failed to set BME280 sensor settings.\n")
-#define LOG_SYS_ERR_SERVER_CONF_HUM_SEND_FAIL       ("Failed to send humidity config to client. (Client: %s)\n")
-#define LOG_SYS_ERR_SERVER_CONF_IIR_SEND_FAIL       ("Failed to send IIR filter config to client. (Client: %s)\n")
-#define LOG_SYS_ERR_SERVER_CONF_PRD_SEND_FAIL       ("Failed to send measurement period to client. (Client: %s)\n")
-#define LOG_SYS_ERR_SERVER_CONF_PRS_SEND_FAIL       ("Failed to send pressure config to client. (Client: %s)\n")
-#define LOG_SYS_ERR_SERVER_CONF_TMP_SEND_FAIL       ("Failed to send temperature config to client. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_AGG_SEND_FAIL            ("Failed to send aggregates to client. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_AGG_SCAN_FAIL            ("Failed to scan saved measurement data. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_DSMP_SEND_FAIL           ("Failed to send downsampled data to client. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_CONF_SEND_FAIL           ("Failed to send sensor config to client. (Client: %s)\n")
 #define LOG_SYS_ERR_SERVER_FCONT_ACCESS_FAIL        ("Failed to access measurement data file: closed or not existing. (Client: %s)\n")
 #define LOG_SYS_ERR_SERVER_FCONT_SEND_FAIL          ("Failed to send measurement data file content to client. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_GDATP_SEND_FAIL          ("Failed to send measurement data columns to client. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_LATEST_SEND_FAIL         ("Failed to send latest sample to client. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_HIST_SEND_FAIL           ("Failed to send recent samples to client. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_STATS_FAIL               ("Failed to take snapshot of server statistics. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_STATS_SEND_FAIL          ("Failed to send server statistics to client. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_TRACE_FAIL               ("Failed to build trace of recorded spans. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_TRACE_SEND_FAIL          ("Failed to send trace of recorded spans to client. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_TRACE_DUMP_FAIL          ("Failed to dump trace of recorded spans to %s.\n")
+#define LOG_SYS_ERR_SERVER_WAIT_SEND_FAIL           ("Failed to send awaited sample to client. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_SUB_SEND_FAIL            ("Failed to send subscription response to client. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_PARK_FAIL                ("Failed to park client session. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_EVENT_INIT_FAIL          ("Failed to initialize event notification.\n")
+#define LOG_SYS_ERR_SERVER_EXPORT_INIT_FAIL         ("Failed to initialize metrics export loop.\n")
+#define LOG_SYS_ERR_SERVER_EXPORT_RES_FAIL          ("Failed to build metrics export response.\n")
 #define LOG_SYS_ERR_SERVER_FSIZE_SEND_FAIL          ("Failed to send saved data file size to client. (Client: %s)\n")
+#define LOG_SYS_ERR_SERVER_SENS_LIST_SEND_FAIL      ("Failed to send sensor list to client. (Client: %s)\n")
 #define LOG_SYS_ERR_SERVER_FSTAT_GET_FAIL           ("Failed to get measurement data file information. \n")
 #define LOG_SYS_ERR_SERVER_RMV_DATA_FAIL            ("Failed to remove measurement data requested by client. (Client: %s)\n")
 #define LOG_SYS_ERR_SERVER_RES_FAIL                 ("Failed to send server response to client. (%s <-- %x)\n")
+#define LOG_SYS_ERR_SERVER_SAVE_BATCH_FAIL          ("Failed to save batch of measurement data. (%d records)\n")
+#define LOG_SYS_ERR_SERVER_SAVE_COL_FAIL            ("Failed to save measurement data columns, serving them from saved records.\n")
 #define LOG_SYS_ERR_SERVER_SAVE_CLOSE_FAIL          ("Failed to close saved data file.\n")
-#define LOG_SYS_ERR_SERVER_SAVE_HUMID_FAIL          ("Failed to save humidity measurement data.\n")
 #define LOG_SYS_ERR_SERVER_SAVE_OPEN_FAIL           ("Failed to open or create saved data file.\n")
 #define LOG_SYS_ERR_SERVER_SAVE_PATH_INIT_FAIL      ("Failed to initialize saved data file path.\n")
-#define LOG_SYS_ERR_SERVER_SAVE_PRESS_FAIL          ("Failed to save pressure measurement data.\n")
-#define LOG_SYS_ERR_SERVER_SAVE_TEMP_FAIL           ("Failed to save temperature measurement data.\n")
+#define LOG_SYS_ERR_SERVER_SAVE_UNLINK_FAIL         ("Failed to remove old saved data file %s.\n")
 #define LOG_SYS_ERR_SERVER_SOCK_ACCEPT_FAIL         ("Failed to accept client connection on thread %d.\n")
 #define LOG_SYS_ERR_SERVER_SOCK_BIND_FAIL           ("Failed to bind server socket.\n")
 #define LOG_SYS_ERR_SERVER_SOCK_CLOSE_FAIL          ("Failed to close server socket.\n")
@@ -55,36 +101,265 @@
 #define LOG_SYS_ERR_SERVER_SOCK_LISTEN_FAIL         ("Failed to set server socket to passive (listen).\n")
 #define LOG_SYS_ERR_SERVER_SOCK_OPT_FAIL            ("Failed to set server socket option.\n")
 #define LOG_SYS_ERR_THREAD_MEAS_CREAT_FAIL          ("Failed to create measure thread.\n")
+#define LOG_SYS_ERR_THREAD_EVENT_CREAT_FAIL         ("Failed to create event thread.\n")
 #define LOG_SYS_ERR_THREAD_SERV_CREAT_FAIL          ("Failed to create service thread.\n")
+#define LOG_SYS_ERR_THREAD_LOG_CREAT_FAIL           ("Failed to create log thread.\n")
+#define LOG_SYS_ERR_THREAD_EXPORT_CREAT_FAIL        ("Failed to create metrics export thread.\n")
 #define LOG_SYS_INFO_CLIENT_AUTH_FAIL               ("Client authentication failed: invalid username or password. (Thread: %d)\n")
 #define LOG_SYS_INFO_CLIENT_AUTH_SUCCESS            ("Client authentication succeeded. (Thread: %d Client: %s)\n")
 #define LOG_SYS_INFO_CLIENT_AUTH_FAIL_NOTIF_FAIL    ("Failed to notify client of unsuccessful authentication. (Thread: %d)\n")
 #define LOG_SYS_INFO_CLIENT_AUTH_SUCCESS_NOTIF_FAIL ("Failed to notify client of successful authentication. (Thread: %d)\n")
 #define LOG_SYS_INFO_CLIENT_CONN                    ("Client assigned to thread %d. IP: %s PORT: %s\n")
+#define LOG_SYS_INFO_CLIENT_CONN_UNIX               ("Client assigned to thread %d. Unix socket PID: %d UID: %u\n")
+#define LOG_SYS_INFO_CLIENT_AUTH_PEER               ("Client authenticated by peer credentials. (Thread: %d UID: %u)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_AGG                 ("Client requested to aggregate measurement data. (%s)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_AGG_SUCCESS         ("Aggregating %u buckets of measurement data for client succeeded. (Client: %s)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_DSMP                ("Client requested to downsample measurement data. (%s)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_DSMP_SUCCESS        ("Downsampling measurement data to %u points for client succeeded. (Client: %s)\n")
 #define LOG_SYS_INFO_CLIENT_REQ_DISCONN             ("Client requested to disconnect. (%s)\n")
 #define LOG_SYS_INFO_CLIENT_REQ_GET_CONF            ("Client requested to get sensor configuration. (%s)\n")
 #define LOG_SYS_INFO_CLIENT_REQ_GET_DATA            ("Client requested to get measurement data. (%s)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_GDATP              ("Client requested to get measurement data columns. (%s)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_GDATP_SUCCESS       ("Transferring %u records of measurement data columns to client succeeded. (Client: %s)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_HIST                ("Client requested %u samples of sensor %u from %llu. (%s)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_WAIT               ("Client requested to wait for a sample newer than %llu. (%s)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_STATS               ("Client requested server statistics. (%s)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_TRACE               ("Client requested trace of recorded spans. (%s)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_SUB                 ("Client subscribed to samples. (%s)\n")
+#define LOG_SYS_INFO_CLIENT_UNSUB                   ("Client unsubscribed, %u samples dropped. (Client: %s)\n")
 #define LOG_SYS_INFO_CLIENT_REQ_GET_DATA_SUCCESS    ("Transferring measurement data to client succeeded. (Client: %s)\n")
 #define LOG_SYS_INFO_CLIENT_REQ_RMV_DATA            ("Client requested to remove measurement data. (%s)\n")
 #define LOG_SYS_INFO_CLIENT_REQ_RMV_DATA_SUCCESS    ("Removing measurement data requested by client succeeded. (Client: %s)\n")
 #define LOG_SYS_INFO_CLIENT_REQ_SET_CONF            ("Client requested to set sensor configuration. (%s)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_MULTI_CONF          ("Client requested to set %d sensor configuration fields. (%s)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_LIST_SENS           ("Client requested to list sensors. (%s)\n")
+#define LOG_SYS_INFO_CLIENT_REQ_SEL_SENS            ("Client selected sensor %d. (%s)\n")
 #define LOG_SYS_INFO_CLIENT_REQ_GET_CONF_SUCCESS    ("Sensor configuration data requested by client successfully transmitted. (Client: %s)\n")
 #define LOG_SYS_INFO_CLIENT_REQ_SET_CONF_SUCCESS    ("Sensor configuration requested by client succeeded. (Client: %s)\n")
 #define LOG_SYS_INFO_CLIENT_REQ_NO_PERM             ("Client does not have permission for request. (%s --> %x)\n")
 #define LOG_SYS_INFO_SENS_MEAS_SUCCESS              ("BME280 sensor measurement completed.\n")
+#define LOG_SYS_INFO_SENS_START                     ("Sensor %d: %s %s 0x%02x\n")
+#define LOG_SYS_INFO_SERVER_FEED                    ("Publishing samples to shared memory feed %s.\n")
+#define LOG_SYS_INFO_SERVER_MCAST                   ("Publishing samples to multicast group %s port %u.\n")
+#define LOG_SYS_INFO_SERVER_EXPORT                  ("Serving metrics on http://%s:%u%s.\n")
+#define LOG_SYS_INFO_SERVER_TRACE                   ("Recording request and sample spans, send signal %d to dump them to %s.\n")
+#define LOG_SYS_INFO_SERVER_TRACE_DUMP              ("Trace of recorded spans dumped to %s.\n")
+#define LOG_SYS_INFO_SERVER_LOCK_PROFILE            ("Profiling lock wait and hold times per call site.\n")
+#define LOG_SYS_INFO_LOCK_SITE                      ("Lock site %d: %s mutex at %s:%d.\n")
+#define LOG_SYS_INFO_SERVER_UNIX                    ("Listening on Unix socket %s.\n")
 #define LOG_SYS_INFO_SERVER_START                   ("Starting daemon server...\n")
+#define LOG_SYS_INFO_SERVER_STOP                    ("Stopping daemon server...\n")
 #define LOG_SYS_INFO_THREAD_SERVICE_END             ("Client service on thread %d ended.\n")
 #define LOG_SYS_WARN_CLIENT_DISCONN_UNEX            ("Client disconnected unexpectedly on thread %d.\n")
+#define LOG_SYS_WARN_CLIENT_DISCONN_PARKED          ("Waiting client disconnected. (Client: %s)\n")
+#define LOG_SYS_WARN_CLIENT_SUB_SLOW                ("Slow subscriber disconnected. (Client: %s)\n")
 #define LOG_SYS_WARN_CLIENT_NAME_RESOLVE_FAIL       ("Failed to resolve client host name. (Thread: %d)\n")
+#define LOG_SYS_WARN_SERVER_FEED_FAIL               ("Failed to create shared memory feed %s, feed disabled.\n")
+#define LOG_SYS_WARN_SERVER_MCAST_FAIL              ("Failed to open multicast feed %s, feed disabled.\n")
+#define LOG_SYS_WARN_SERVER_EXPORT_FAIL             ("Failed to open metrics listener %s, metrics exposition disabled.\n")
+#define LOG_SYS_WARN_SERVER_UNIX_FAIL               ("Failed to listen on Unix socket %s, TCP only.\n")
+#define LOG_SYS_WARN_SENS_PERIOD_CLAMP              ("Sensor %d: period of %llu usec is shorter than a conversion, using %llu usec.\n")
+#define LOG_SYS_WARN_LOG_DROPPED                    ("%llu log events dropped on full rings (%llu in total).\n")
+#define LOG_SYS_WARN_LOG_SUPPRESSED                 ("%u similar messages suppressed: %s")
 #define LOG_SYS_WARN_SOCK_SET_OPT_FAIL              ("Failed to set socket option. (Thread: %d)\n")
 
 /* Sensor and measurement related macros */
 #define MEAS_PERIOD_INIT_SEC                        (15)                // Initial measurement period
+#define MEAS_PERIOD_IDLE_US                         (2000000ULL)        // Wake-up period while measurement is off [usec]
+#define MEAS_PERIOD_HIGH_RATE_US                    (1000000ULL)        // Periods below this are high-rate (no per-sample syslog) [usec]
+#define USEC_PER_SEC                                (1000000ULL)
+#define USEC_PER_MSEC                               (1000ULL)
+#define NSEC_PER_USEC                               (1000ULL)
+#define NSEC_PER_SEC                                (1000000000ULL)
+#define NSEC_PER_MSEC                               (1000000ULL)
+#define SAVED_DATA_BATCH_SIZE                       (64)                // Max. number of records buffered before writing them out
+#define SAVED_DATA_FLUSH_PERIOD_US                  (1000000ULL)        // Max. age of buffered records before writing them out [usec]
 #define SAVED_DATA_FD_INVALID                       (-1)                // Invalid saved data file descriptor
 #define SAVED_DATA_FILE_NAME                        ("meas_data")   // Saved data file name
 #define SAVED_DATA_FILE_NAME_LEN                    (14)                // Saved data file name length
 #define SAVED_DATA_FILE_PATH_LEN                    (PATH_MAX + 1 + SAVED_DATA_FILE_NAME_LEN)
 #define SAVED_DATA_FILE_PATH_PI                     ("/home/pi/meas_data")
+#define SAVED_DATA_FILE_SUFFIX_LEN                  (4)                 // Sensor ID suffix of the saved data file name (".N")
+#define SAVED_DATA_INVALID_VALUE                    (-1.0f)     // [SHARED] Value of disabled channels in saved records
+#define SAVED_DATA_CHANNELS                         (3)                 // Measured channels per record (TMP, HUM, PRS)
+#define SAVED_DATA_SCAN_RECORDS                     (256)               // Records read at once when scanning saved data
+#define SAVED_DATA_COLUMNS                          (4)                 // Column files next to the saved data file (TMP, HUM, PRS, TIME)
+#define SAVED_DATA_COLUMN_TIME                      (3)                 // Index of the time column (channels come first)
+#define SAMPLE_HISTORY_SIZE                         (256)               // Recent samples kept in memory per sensor (power of 2)
+#define SAVED_DATA_COLUMN_SUFFIX_LEN                (6)                 // Column suffix of the saved data file name (".time")
+
+/* Multi-sensor related macros */
+#define SENSOR_ARRAY_SIZE                           (8)         // [SHARED] Max. number of sensors
+#define SENSOR_SEL_DEFAULT                          (0)                 // Sensor selected by clients after login
+#define SENSOR_CONF_LINE_LEN                        (512)               // Max. line length of the sensor config file
+#define SENSOR_CONF_COMMENT                         ('#')               // Comment character of the sensor config file
+#define SENSOR_NAME_LEN                             (16)                // Max. transport name length
+#define SENSOR_DESC_LEN                             (64)        // [SHARED] Sensor description length (list sensors)
+
+/* Shared memory sample feed related macros (see createSampleFeed) */
+#define SAMPLE_FEED_NAME                            ("/myserver_feed")  // [SHARED] Default POSIX shared memory object name
+#define SAMPLE_FEED_MAGIC                           (0x44454546)        // [SHARED] Segment ready ("FEED"), 0 once removed
+#define SAMPLE_FEED_VERSION                         (1)                 // [SHARED] Segment layout version
+#define SAMPLE_FEED_HISTORY_SIZE                    (64)                // [SHARED] Recent samples per sensor (power of 2)
+#define SAMPLE_FEED_MODE                            (0644)              // Readable by every local user
+
+/* UDP multicast sample feed related macros (see openSampleMulticast) */
+#define SAMPLE_MCAST_PORT                           (2234)              // [SHARED] Default UDP port of the multicast feed
+#define SAMPLE_MCAST_VERSION                        (1)                 // [SHARED] Datagram layout version
+#define SAMPLE_MCAST_DGRAM_LEN                      (40)                // [SHARED] Datagram: version <1>, sensor ID <1>, reserved <2>, stream ID <4>, sample <RES_LATEST_LEN>
+#define SAMPLE_MCAST_TTL                            (1)                 // Datagrams stay on the LAN
+
+/* Asynchronous logging related macros (see logger.c) */
+#define LOG_RING_SIZE                               (256)               // Events per thread ring (power of 2)
+#define LOG_RING_MAX                                (32)                // Max. number of logging threads
+#define LOG_EVENT_ARGS_MAX                          (6)                 // Max. arguments per event
+#define LOG_EVENT_STR_LEN                           (96)                // String arguments per event (truncated)
+#define LOG_LINE_MAX_LEN                            (512)               // Max. formatted message length
+#define LOG_SPEC_MAX_LEN                            (32)                // Max. conversion specification length
+#define LOG_RATE_WINDOW_MS                          (1000ULL)           // Rate limit window [msec]
+#define LOG_RATE_BURST                              (20)                // Events forwarded per format and window
+#define LOG_RATE_SAMPLE                             (100)               // Beyond the burst only every n-th event is forwarded
+#define LOG_RATE_TABLE_SIZE                         (256)               // Rate limited formats (power of 2)
+#define LOG_THREAD_IDLE_MS                          (50ULL)             // Log thread sleep while the rings are empty [msec]
+
+/* Metrics registry related macros (see metrics.c) */
+#define METRIC_SHARD_MAX                            (32)                // Max. number of recording threads
+#define METRIC_READ_RETRIES                         (100)               // Shard copies retried while its thread writes
+#define METRIC_HIST_SUB_BITS                        (4)                 // Histogram precision: 2^-4 (6.25%)
+#define METRIC_HIST_SUB_COUNT                       (1 << METRIC_HIST_SUB_BITS)
+#define METRIC_HIST_VALUE_BITS                      (36)                // Larger values are recorded as the max. (68 sec in nsec)
+#define METRIC_HIST_VALUE_MAX                       ((1ULL << METRIC_HIST_VALUE_BITS) - 1)
+#define METRIC_HIST_BUCKETS                         ((METRIC_HIST_VALUE_BITS - METRIC_HIST_SUB_BITS + 1) * METRIC_HIST_SUB_COUNT)
+
+#define METRIC_CNT_REQ_INVALID                      (STATS_CNT_SAMPLE_FAIL + 1)     // Unknown request codes (counters up to here: STATS_CNT_...)
+#define METRIC_CNT_REQ_CODE_FAIL                    (METRIC_CNT_REQ_INVALID + 1)    // Failed requests (+ index in requestArray)
+#define METRIC_CNT_REQ_CODE_DENIED                  (METRIC_CNT_REQ_CODE_FAIL + REQ_ARRAY_SIZE)     // Requests without permission (+ index)
+#define METRIC_CNT_COUNT                            (METRIC_CNT_REQ_CODE_DENIED + REQ_ARRAY_SIZE)
+
+#define METRIC_HIST_ACCEPT_AUTH                     (0)                 // Accept to authentication [nsec]
+#define METRIC_HIST_GDAT_BYTES                      (1)                 // Bytes sent per GDAT request
+#define METRIC_HIST_SENS_BUS                        (2)                 // Sensor bus transactions per sample [nsec]
+#define METRIC_HIST_SENS_CONV                       (3)                 // Sensor conversion (trigger to completion) [nsec]
+#define METRIC_HIST_SAVE_APPEND                     (4)                 // Saved data batch append [nsec]
+#define METRIC_HIST_SAMPLE_JITTER                   (5)                 // Measure thread wake-up past schedule [nsec]
+#define METRIC_HIST_REQUEST                         (6)                 // Request handler latency [nsec] (+ index in requestArray)
+#define METRIC_HIST_LOCK_WAIT                       (METRIC_HIST_REQUEST + REQ_ARRAY_SIZE)  // Lock wait [nsec] (+ lock site ID)
+#define METRIC_HIST_LOCK_HOLD                       (METRIC_HIST_LOCK_WAIT + LOCK_SITE_MAX) // Lock hold [nsec] (+ lock site ID)
+#define METRIC_HIST_COUNT                           (METRIC_HIST_LOCK_HOLD + LOCK_SITE_MAX)
+
+/* Metrics exposition related macros (see exporter.c) */
+#define EXPORT_DEFAULT_ADDRESS                      ("127.0.0.1")       // Listener address without one given (this host only)
+#define EXPORT_PATH                                 ("/metrics")
+#define EXPORT_CONTENT_TYPE                         ("text/plain; version=0.0.4; charset=utf-8")
+#define EXPORT_CONN_MAX                             (8)                 // Max. number of scraper connections
+#define EXPORT_EPOLL_EVENTS                         (16)                // Events taken at once by the export thread
+#define EXPORT_IDLE_TIMEOUT_MS                      (5000)              // Scraper connections idle longer are closed [msec]
+#define EXPORT_REQ_MAX_LEN                          (4096)              // Max. request head length
+#define EXPORT_BODY_INIT_LEN                        (16384)             // Initial response buffer (grown as needed)
+#define EXPORT_LABEL_MAX_LEN                        (64)                // Max. label pairs length of a histogram
+#define EXPORT_STATUS_OK                            (200)
+#define EXPORT_STATUS_BAD_REQUEST                   (400)
+#define EXPORT_STATUS_NOT_FOUND                     (404)
+#define EXPORT_STATUS_NOT_ALLOWED                   (405)
+#define EXPORT_STATUS_ERROR                         (500)
+
+/* Request and sample tracing related macros (see tracer.c) */
+#define TRACE_RING_SIZE                             (4096)              // Spans kept per thread (power of 2)
+#define TRACE_RING_MAX                              (32)                // Max. number of recording threads
+#define TRACE_THREAD_NAME_LEN                       (32)
+#define TRACE_TEXT_INIT_LEN                         (65536)             // Initial trace buffer (grown as needed)
+#define TRACE_DUMP_SIGNAL                           (SIGUSR1)
+#define TRACE_DUMP_FILE_NAME                        ("myserver_trace.json") // Written next to the saved data file
+#define TRACE_DUMP_TMP_SUFFIX                       (".tmp")
+#define TRACE_CONTENT_TYPE                          ("application/json")
+#define EXPORT_TRACE_PATH                           ("/trace")
+
+#define TRACE_SPAN_ACCEPT                           (0)                 // Poll wake-up to connection set up
+#define TRACE_SPAN_AUTH                             (1)                 // Credentials to authentication response
+#define TRACE_SPAN_REQUEST                          (2)                 // Request code received to response sent (arg: request code)
+#define TRACE_SPAN_HANDLER                          (3)                 // Request handler (arg: request code)
+#define TRACE_SPAN_LOCK_WAIT                        (4)                 // Waiting for the saved data mutex (arg: sensor ID)
+#define TRACE_SPAN_SEND                             (5)                 // Saved data sendfile (arg: sensor ID)
+#define TRACE_SPAN_SAMPLE                           (6)                 // Sample, trigger to persisted (arg: sensor ID)
+#define TRACE_SPAN_TRIGGER                          (7)                 // Forced conversion started or normal mode set (arg: sensor ID)
+#define TRACE_SPAN_CONV_WAIT                        (8)                 // Conversion polled until complete (arg: sensor ID)
+#define TRACE_SPAN_READ                             (9)                 // Data registers read (arg: sensor ID)
+#define TRACE_SPAN_COMPENSATE                       (10)                // Raw data compensated (arg: sensor ID)
+#define TRACE_SPAN_PERSIST                          (11)                // Sample saved and published (arg: sensor ID)
+#define TRACE_SPAN_APPEND                           (12)                // Saved data batch append (arg: sensor ID)
+#define TRACE_SPAN_COUNT                            (13)
+
+/*
+ * Static probes (USDT, provider "myserver") for bpftrace / SystemTap on live servers, e.g.
+ * 
+ *   bpftrace -e 'usdt:./myserver:myserver:handler__return { @[arg0] = hist(arg2); }'
+ * 
+ * A probe is a single nop (plus an ELF note) while nothing is attached, its arguments are
+ * values at hand anyway (no clock read for a probe only). Build with -DSERVER_NO_USDT to
+ * leave them out. Probes and their arguments:
+ * 
+ *   request__start              request code
+ *   request__done               request code, result (0: served)
+ *   handler__entry              request code, sensor selected by the session
+ *   handler__return             request code, handler result, handler time [nsec]
+ *   lock__acquire               lock ID (LOCK_ID_...), sensor ID (0 for serviceMutex), mutex address
+ *   lock__acquired              lock ID, sensor ID, mutex address
+ *   lock__release               lock ID, sensor ID, mutex address
+ *   read__sensor__regs__start   sensor ID (conversion complete, data registers about to be read)
+ *   read__sensor__regs__done    sensor ID, result (registers read and compensated)
+ *   storage__append__start      sensor ID, buffered records
+ *   storage__append__done       sensor ID, records, result, append time [nsec]
+ */
+#ifdef SERVER_USDT
+#define SERVER_PROBE1(name, a1)                     DTRACE_PROBE1(myserver, name, a1)
+#define SERVER_PROBE2(name, a1, a2)                 DTRACE_PROBE2(myserver, name, a1, a2)
+#define SERVER_PROBE3(name, a1, a2, a3)             DTRACE_PROBE3(myserver, name, a1, a2, a3)
+#define SERVER_PROBE4(name, a1, a2, a3, a4)         DTRACE_PROBE4(myserver, name, a1, a2, a3, a4)
+#else
+#define SERVER_PROBE1(name, a1)                     do { } while(0)
+#define SERVER_PROBE2(name, a1, a2)                 do { } while(0)
+#define SERVER_PROBE3(name, a1, a2, a3)             do { } while(0)
+#define SERVER_PROBE4(name, a1, a2, a3, a4)         do { } while(0)
+#endif
+
+#define LOCK_ID_SENSOR                              (0)                 // sensorMutex of a sensor
+#define LOCK_ID_SAVED_DATA                          (1)                 // savedDataMutex of a sensor
+#define LOCK_ID_SERVICE                             (2)                 // serviceMutex (held by the leader while polling)
+#define LOCK_ID_COUNT                               (3)
+
+/* Lock contention profiler (see lockprof.c) */
+#define LOCK_SITE_MAX                               (40)                // Profiled lock call sites
+#define LOCK_SITE_UNKNOWN                           (-1)                // Site not registered yet
+#define LOCK_SITE_NONE                              (-2)                // Site beyond LOCK_SITE_MAX (not recorded)
+
+/* Mutex lock and unlock firing the lock probes, profiled per call site if lockProfileEnabled */
+#define PROBED_MUTEX_LOCK(mutex, lockId, sensorId)  do { \
+                                                        static int lockSiteId = LOCK_SITE_UNKNOWN; \
+                                                        SERVER_PROBE3(lock__acquire, lockId, sensorId, mutex); \
+                                                        if(0 != lockProfileEnabled) { \
+                                                            lockProfiledMutex(mutex, lockId, &lockSiteId, __FILE__, __LINE__); \
+                                                        } \
+                                                        else { \
+                                                            pthread_mutex_lock(mutex); \
+                                                        } \
+                                                        SERVER_PROBE3(lock__acquired, lockId, sensorId, mutex); \
+                                                    } while(0)
+#define PROBED_MUTEX_UNLOCK(mutex, lockId, sensorId) do { \
+                                                        SERVER_PROBE3(lock__release, lockId, sensorId, mutex); \
+                                                        if(0 != lockProfileEnabled) { \
+                                                            unlockProfiledMutex(mutex, lockId); \
+                                                        } \
+                                                        else { \
+                                                            pthread_mutex_unlock(mutex); \
+                                                        } \
+                                                    } while(0)
+
+#define SENSOR_MUTEX_LOCK(sensor)                   PROBED_MUTEX_LOCK(&((sensor)->sensorMutex), LOCK_ID_SENSOR, (int)((sensor) - sensorArray))
+#define SENSOR_MUTEX_UNLOCK(sensor)                 PROBED_MUTEX_UNLOCK(&((sensor)->sensorMutex), LOCK_ID_SENSOR, (int)((sensor) - sensorArray))
+#define SAVED_DATA_MUTEX_LOCK(sensor)               PROBED_MUTEX_LOCK(&((sensor)->savedDataMutex), LOCK_ID_SAVED_DATA, (int)((sensor) - sensorArray))
+#define SAVED_DATA_MUTEX_UNLOCK(sensor)             PROBED_MUTEX_UNLOCK(&((sensor)->savedDataMutex), LOCK_ID_SAVED_DATA, (int)((sensor) - sensorArray))
+#define SERVICE_MUTEX_LOCK()                        PROBED_MUTEX_LOCK(&serviceMutex, LOCK_ID_SERVICE, 0)
+#define SERVICE_MUTEX_UNLOCK()                      PROBED_MUTEX_UNLOCK(&serviceMutex, LOCK_ID_SERVICE, 0)
 
 /* Pollset entries */
 #define POLL_ARRAY_SIZE                             (1)
@@ -106,12 +381,28 @@
 #define REQ_CODE_GCONF                              (0x02)      // [SHARED] Request to get sensor configuration
 #define REQ_CODE_RMDAT                              (0x04)      // [SHARED] Request to remove sensor data
 #define REQ_CODE_GDAT                               (0x08)      // [SHARED] Request to get sensor data
+#define REQ_CODE_SSEL                               (0x10)      // [SHARED] Request to select sensor
+#define REQ_CODE_SLIST                              (0x11)      // [SHARED] Request to list sensors
+#define REQ_CODE_MCONF                              (0x12)      // [SHARED] Request to set several sensor configurations at once
+#define REQ_CODE_GCONFB                             (0x13)      // [SHARED] Request to get sensor configuration (binary)
+#define REQ_CODE_AGG                                (0x14)      // [SHARED] Request to aggregate sensor data
+#define REQ_CODE_DSMP                               (0x15)      // [SHARED] Request to get downsampled sensor data
+#define REQ_CODE_GDATP                              (0x16)      // [SHARED] Request to get selected columns of sensor data
+#define REQ_CODE_LATEST                             (0x17)      // [SHARED] Request to get latest sample
+#define REQ_CODE_WAIT                               (0x18)      // [SHARED] Request to wait for a new sample
+#define REQ_CODE_SUB                                (0x19)      // [SHARED] Request to subscribe to new samples
+#define REQ_CODE_UNSUB                              (0x1A)      // [SHARED] End of subscription (sent while subscribed)
+#define REQ_CODE_HIST                               (0x1B)      // [SHARED] Request to get recent samples by sequence number
+#define REQ_CODE_STATS                              (0x1C)      // [SHARED] Request to get server statistics
+#define REQ_CODE_TRACE                              (0x1D)      // [SHARED] Request to get recorded spans (Chrome trace JSON)
 
 #define REQ_CONF_PRD                                (0x01)      // [SHARED] Request to config period
 #define REQ_CONF_IIR                                (0x02)      // [SHARED] Request to config IIR filter
 #define REQ_CONF_HUM                                (0x03)      // [SHARED] Request to config humidity
 #define REQ_CONF_PRS                                (0x04)      // [SHARED] Request to config pressure
 #define REQ_CONF_TMP                                (0x05)      // [SHARED] Request to config temperature
+#define REQ_CONF_PRD_US                             (0x06)      // [SHARED] Request to config period in microseconds
+#define REQ_CONF_MODE                               (0x07)      // [SHARED] Request to config acquisition mode (ON: normal, OFF: forced)
 
 #define REQ_CONF_TYPE_MASK                          (0x07)      // [SHARED] Config type mask
 
@@ -135,9 +426,42 @@
 
 #define REQ_CONF_VALUE_MASK                         (0xF0)      // [SHARED] Config value mask
 
+#define REQ_MCONF_FIELDS_MAX                        (8)         // [SHARED] Max. number of config fields per multi-config request
+#define REQ_MCONF_FIELD_LEN                         (5)         // [SHARED] Config field: parameters <1 byte>, value <4 bytes>
+
+#define REQ_AGG_CH_TMP                              (0x01)      // [SHARED] Aggregate temperature
+#define REQ_AGG_CH_HUM                              (0x02)      // [SHARED] Aggregate humidity
+#define REQ_AGG_CH_PRS                              (0x04)      // [SHARED] Aggregate pressure
+#define REQ_AGG_CH_MASK                             (0x07)      // [SHARED] Aggregated channel mask
+#define REQ_AGG_LEN                                 (25)        // [SHARED] Query: from <8>, to <8>, bucket width <8> (usec), channels <1>
+#define REQ_AGG_BUCKETS_MAX                         (1024)      // [SHARED] Max. number of buckets per query
+
+#define REQ_DSMP_MODE_LTTB                          (0x01)      // [SHARED] Largest-Triangle-Three-Buckets (parameter: number of points)
+#define REQ_DSMP_MODE_RESAMPLE                      (0x02)      // [SHARED] Linear interpolation to a fixed interval (parameter: interval [usec])
+#define REQ_DSMP_LEN                                (26)        // [SHARED] Query: from <8>, to <8>, parameter <8>, mode <1>, channels <1>
+#define REQ_DSMP_POINTS_MIN                         (3)         // [SHARED] Min. number of points per channel (LTTB)
+#define REQ_DSMP_POINTS_MAX                         (10000)     // [SHARED] Max. number of points per channel
+
+#define REQ_GDATP_CH_TIME                           (0x08)      // [SHARED] Sample time column (channels use REQ_AGG_CH_...)
+#define REQ_GDATP_CH_MASK                           (0x0F)      // [SHARED] Column mask
+
+#define REQ_WAIT_LEN                                (12)        // [SHARED] Query: sequence number <8>, timeout <4> (msec)
+#define REQ_WAIT_TIMEOUT_MAX_MS                     (300000)    // [SHARED] Max. wait timeout [msec]
+
+#define REQ_SUB_POLICY_DROP_OLDEST                  (0x01)      // [SHARED] Slow subscriber: drop oldest queued samples
+#define REQ_SUB_POLICY_COALESCE                     (0x02)      // [SHARED] Slow subscriber: replace newest queued sample
+#define REQ_SUB_POLICY_DISCONNECT                   (0x03)      // [SHARED] Slow subscriber: disconnect
+#define REQ_SUB_LEN                                 (6)         // [SHARED] Query: channels <1>, decimation <4>, policy <1>
+#define REQ_SUB_DECIMATION_MAX                      (1000000)   // [SHARED] Max. decimation (push every n-th sample)
+#define SUB_RING_FRAMES                             (64)        // Frames queued per subscriber
+#define SUB_RING_SLOTS                              (SUB_RING_FRAMES + 1)   // Ring slots, one spare for the end frame
+
+#define REQ_HIST_LEN                                (10)        // [SHARED] Query: sensor ID <1>, first sequence number <8>, count <1>
+#define REQ_HIST_COUNT_MAX                          (64)        // [SHARED] Max. samples per query
+
 #define REQ_HANDLE_ARRAY_SIZE                       (4)
 
-#define REQ_ARRAY_SIZE                              (5)
+#define REQ_ARRAY_SIZE                              (18)
 
 /* Server response related macros */
 #define RES_CODE_AUTH_FAIL                          (0x00)      // [SHARED] Client authentication failed
@@ -147,6 +471,9 @@
 #define RES_CODE_REQ_INVALID                        (0x04)      // [SHARED] Client request invalid
 #define RES_CODE_REQ_NO_PERM                        (0x05)      // [SHARED] Client does not have permission for request
 #define RES_CODE_REQ_SUCCESS                        (0x06)      // [SHARED] Client request succeeded
+#define RES_CODE_REQ_TIMEOUT                        (0x07)      // [SHARED] Client request timed out
+#define RES_CODE_PUSH_SAMPLE                        (0x08)      // [SHARED] Pushed sample frame
+#define RES_CODE_PUSH_END                           (0x09)      // [SHARED] End of pushed samples
 
 #define RES_STR_SCONF_OVERSAMPLING_OFF              ("OS_OFF")  // [SHARED UNDER STR_CMD_SCONF_OVERS...]
 #define RES_STR_SCONF_OVERSAMPLING_1X               ("OS_1X")   // [SHARED UNDER STR_CMD_SCONF_OVERS...]
@@ -161,12 +488,60 @@
 #define RES_STR_SCONF_IIR_COEFF_8                   ("COEFF_8")     // [SHARED UNDER STR_CMD_SCONF_IIR_CO...]
 #define RES_STR_SCONF_IIR_COEFF_16                  ("COEFF_16")    // [SHARED UNDER STR_CMD_SCONF_IIR_CO...]
 
+#define RES_STR_SCONF_MODE_FORCED                   ("FORCED")  // [SHARED]
+#define RES_STR_SCONF_MODE_NORMAL                   ("NORMAL")  // [SHARED]
+
+#define RES_STR_SCONF_LEN                           (8)         // Length of TMP/HUM/PRS and mode config strings
+#define RES_STR_SCONF_IIR_LEN                       (16)        // Length of IIR filter config string
+
+#define RES_GCONFB_LEN                              (17)        // [SHARED] Binary config: version <4>, period <8>, TMP, HUM, PRS, IIR, MOD <1 each>
+#define RES_AGG_BUCKET_LEN                          (8)         // [SHARED] Aggregate bucket: start time <8> (usec), then stats per channel
+#define RES_AGG_STATS_LEN                           (20)        // [SHARED] Channel stats: count <4>, min, max, mean, stddev <4 each, float>
+#define RES_DSMP_POINT_LEN                          (12)        // [SHARED] Point: time <8> (usec), value <4, float>
+#define RES_GDATP_TIME_LEN                          (8)         // [SHARED] Time column entry: time <8> (usec)
+#define RES_GDATP_VALUE_LEN                         (4)         // [SHARED] Channel column entry: value <4, float>
+#define RES_LATEST_LEN                              (32)        // [SHARED] Latest sample: seq <8>, time <8> (usec), TMP, HUM, PRS <4 each, float>, config version <4>
+#define RES_PUSH_HEADER_LEN                         (17)        // [SHARED] Sample frame: code <1>, seq <8>, time <8> (usec), then subscribed channels <4 each, float>
+#define RES_PUSH_FRAME_MAX_LEN                      (29)        // [SHARED] Sample frame with all channels
+#define RES_PUSH_END_LEN                            (5)         // [SHARED] End frame: code <1>, dropped samples <4>
+#define RES_STATS_HEADER_LEN                        (10)        // [SHARED] Statistics: uptime <8> (usec), number of counters <1>, number of histograms <1>
+#define RES_STATS_COUNTER_LEN                       (9)         // [SHARED] Counter: ID <1>, value <8>
+#define RES_STATS_HIST_LEN                          (66)        // [SHARED] Histogram: ID <1>, key <1>, count, mean, min, p50, p90, p99, p99.9, max <8 each>
+#define RES_TRACE_HEADER_LEN                        (5)         // [SHARED] Trace: code <1>, JSON length <4>, then JSON
+#define RES_STATS_MAX_LEN                           (1 + RES_STATS_HEADER_LEN + STATS_CNT_COUNT * RES_STATS_COUNTER_LEN + METRIC_HIST_COUNT * RES_STATS_HIST_LEN)
+
+#define STATS_CNT_CONN                              (0x00)      // [SHARED] Connections accepted
+#define STATS_CNT_AUTH_FAIL                         (0x01)      // [SHARED] Authentications failed
+#define STATS_CNT_REQ                               (0x02)      // [SHARED] Requests served
+#define STATS_CNT_REQ_FAIL                          (0x03)      // [SHARED] Requests failed
+#define STATS_CNT_GDAT_BYTES                        (0x04)      // [SHARED] Bytes sent by GDAT requests
+#define STATS_CNT_SAMPLE                            (0x05)      // [SHARED] Samples measured
+#define STATS_CNT_SAMPLE_FAIL                       (0x06)      // [SHARED] Measurements failed
+#define STATS_CNT_LOG_FORWARDED                     (0x07)      // [SHARED] Log events forwarded to syslog
+#define STATS_CNT_LOG_DROPPED                       (0x08)      // [SHARED] Log events dropped
+#define STATS_CNT_LOG_SUPPRESSED                    (0x09)      // [SHARED] Log events suppressed by rate limiting
+#define STATS_CNT_COUNT                             (10)        // [SHARED] Number of counters
+
+#define STATS_HIST_ACCEPT_AUTH                      (0x00)      // [SHARED] Accept to authentication [nsec]
+#define STATS_HIST_REQUEST                          (0x01)      // [SHARED] Request handler latency [nsec] (key: request code)
+#define STATS_HIST_GDAT_BYTES                       (0x02)      // [SHARED] Bytes sent per GDAT request
+#define STATS_HIST_SENS_BUS                         (0x03)      // [SHARED] Sensor bus transactions per sample [nsec]
+#define STATS_HIST_SENS_CONV                        (0x04)      // [SHARED] Sensor conversion, trigger to completion [nsec]
+#define STATS_HIST_SAVE_APPEND                      (0x05)      // [SHARED] Saved data batch append [nsec]
+#define STATS_HIST_SAMPLE_JITTER                    (0x06)      // [SHARED] Measure thread wake-up past schedule [nsec]
+#define STATS_HIST_LOCK_WAIT                        (0x07)      // [SHARED] Lock wait [nsec] (key: lock site ID, see server log)
+#define STATS_HIST_LOCK_HOLD                        (0x08)      // [SHARED] Lock hold [nsec] (key: lock site ID, see server log)
+
 #define RES_STR_SCONF_ERR                           ("ERROR")
 #define RES_STR_SCONF_OFF                           ("X")
 
 /* Conditions */
 #define COND_SERVICE_STOP_FALSE                     ((uint8_t)0)
 #define COND_SERVICE_STOP_TRUE                      ((uint8_t)1)
+#define COND_SERVICE_STOP_PARKED                    ((uint8_t)2)    // Session handed over to the event thread (socket stays open)
+
+#define EVENT_THREAD_EPOLL_EVENTS                   (64)            // Events taken at once by the event thread
+#define EVENT_THREAD_FD_TABLE_SIZE                  (64)            // Initial size of the parked socket table
 
 /* Type definitions */
 
@@ -184,6 +559,267 @@ struct UserData {
     int groupe;
 };
 
+/* Saved measurement data record (file layout, appended in time order) */
+struct SavedDataRecord {
+    
+    uint32_t timeSec;                   // Sample time (UNIX time) [sec]
+    uint32_t timeUsec;                  // Sample time fraction [usec]
+    float temp;
+    float hum;
+    float press;
+};
+
+/* Aggregation query over the saved measurement data */
+struct AggQuery {
+    
+    uint64_t fromUs;                    // Start of time range (UNIX time, inclusive) [usec]
+    uint64_t toUs;                      // End of time range (UNIX time, exclusive) [usec]
+    uint64_t bucketUs;                  // Bucket width [usec]
+    uint32_t bucketCount;               // Number of buckets
+    uint8_t channels;                   // Aggregated channels (REQ_AGG_CH_...)
+};
+
+/* Running aggregates of a channel (sums are shifted by the first valid value for precision) */
+struct AggStats {
+    
+    uint32_t count;                     // Number of valid values
+    float min;
+    float max;
+    float ref;                          // Shift of the sums
+    double sum;                         // Sum of (value - ref)
+    double sumSq;                       // Sum of (value - ref)^2
+};
+
+/* Aggregates of a bucket */
+struct AggBucket {
+    
+    struct AggStats stats[SAVED_DATA_CHANNELS];
+};
+
+/* Downsampling query over the saved measurement data */
+struct DownsampleQuery {
+    
+    uint64_t fromUs;                    // Start of time range (UNIX time, inclusive) [usec]
+    uint64_t toUs;                      // End of time range (UNIX time, exclusive) [usec]
+    uint64_t param;                     // Number of points (LTTB) or interval [usec] (resample)
+    uint8_t mode;                       // REQ_DSMP_MODE_...
+    uint8_t channels;                   // Downsampled channels (REQ_AGG_CH_...)
+};
+
+/* Point of a downsampled channel */
+struct SamplePoint {
+    
+    uint64_t timeUs;                    // UNIX time [usec]
+    float value;
+};
+
+/* Immutable copy of the sensor configuration (see publishConfigSnapshot) */
+struct ConfigSnapshot {
+    
+    uint32_t version;                   // Config version (incremented on every update)
+    uint64_t measPeriodUs;              // Measurement period [usec]
+    uint8_t settingSel;                 // Sensor setting selection
+    uint8_t modeSel;                    // Acquisition mode
+    uint8_t osrT;                       // Temperature oversampling
+    uint8_t osrP;                       // Pressure oversampling
+    uint8_t osrH;                       // Humidity oversampling
+    uint8_t filter;                     // IIR filter coefficient
+};
+
+/* Counters of the asynchronous logging */
+struct LogCounters {
+    
+    uint64_t forwarded;                 // Events forwarded to syslog
+    uint64_t dropped;                   // Events dropped on full rings
+    uint64_t suppressed;                // Events suppressed by rate limiting
+};
+
+/* Latency (or size) histogram of the metrics registry */
+struct MetricHist {
+    
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint64_t bucket[METRIC_HIST_BUCKETS];
+};
+
+/* Snapshot of the metrics registry (summed over the threads) */
+struct MetricSnapshot {
+    
+    uint64_t uptimeNs;                  // Time since initMetrics [nsec]
+    uint64_t counter[METRIC_CNT_COUNT]; // Index: STATS_CNT_..., METRIC_CNT_...
+    struct MetricHist hist[METRIC_HIST_COUNT];                  // Index: METRIC_HIST_...
+};
+
+/* Call site of a profiled lock */
+struct LockSite {
+    
+    const char *file;
+    int line;
+    int lockId;                         // LOCK_ID_...
+};
+
+/* Text being built (metrics exposition, trace JSON) */
+struct ExportText {
+    
+    char *data;
+    size_t len;
+    size_t size;
+    int error;                          // Out of memory, text is incomplete
+};
+
+/* Latest sample of a sensor (published by its measure thread) */
+struct LatestSample {
+    
+    uint64_t seq;                       // Sample sequence number (0: no sample yet)
+    uint64_t timeUs;                    // Sample time (UNIX time) [usec]
+    float temp;                         // Disabled channels hold SAVED_DATA_INVALID_VALUE
+    float hum;
+    float press;
+    uint32_t configVersion;             // Config version the sample was taken with
+};
+
+/* Sample of the shared memory feed [SHARED] */
+struct FeedSample {
+    
+    uint64_t seq;                       // Sample sequence number (0: no sample yet)
+    uint64_t timeUs;                    // Sample time (UNIX time) [usec]
+    float temp;                         // Disabled channels hold SAVED_DATA_INVALID_VALUE
+    float hum;
+    float press;
+    uint32_t configVersion;
+};
+
+/* Feed of a sensor (seqlock: written by the measure thread, read by other processes) [SHARED] */
+struct FeedSensor {
+    
+    uint32_t lock;                      // Odd while a new sample is being written
+    uint32_t reserved;
+    struct FeedSample latest;
+    struct FeedSample history[SAMPLE_FEED_HISTORY_SIZE];        // Recent samples (slot: seq % size)
+} __attribute__((aligned(64)));
+
+/* Shared memory feed segment [SHARED] */
+struct FeedSegment {
+    
+    uint32_t magic;                     // Written last on creation (SAMPLE_FEED_MAGIC)
+    uint32_t version;                   // SAMPLE_FEED_VERSION
+    uint32_t sensorCount;
+    uint32_t historySize;               // SAMPLE_FEED_HISTORY_SIZE
+    struct FeedSensor sensor[SENSOR_ARRAY_SIZE];                // Index: sensor ID
+};
+
+/* Measurement context of a sensor (one measure thread each) */
+struct SensorContext {
+    
+    int sensorIndex;                    // Sensor ID (position in sensorArray)
+    pthread_t measureThread;            // Measure thread of the sensor
+    
+    /* Transport configuration (referenced by sensorId) */
+    char transportName[SENSOR_NAME_LEN];
+    char busPath[PATH_MAX];
+    char tracePath[PATH_MAX];
+    
+    /* Sensor and measurement settings (sensorMutex) */
+    pthread_mutex_t sensorMutex;
+    pthread_cond_t measPeriodCond;      // Signalled on measurement period change (CLOCK_MONOTONIC)
+    struct identifier sensorId;         // Sensor interface identifier
+    struct bme280_dev sensorDev;        // Sensor device and settings
+    uint8_t sensorSettingSel;           // Sensor setting selection
+    uint8_t sensorModeSel;              // Acquisition mode (BME280_FORCED_MODE or BME280_NORMAL_MODE)
+    uint8_t sensorModeReload;           // Normal mode must be (re)entered before the next read
+    uint8_t sensorConversionActive;     // Conversion in progress (sensorMutex released while waiting)
+    uint8_t sensorSettingsPending;      // Settings update queued until the running conversion is read
+    uint32_t minDelay;                  // Minimal delay after requesting a measurement
+    uint64_t measPeriodUs;              // Measurement period [usec]
+    uint8_t measPeriodChanged;          // Measurement period changed since last scheduling
+    
+    /* Config snapshot (seqlock: published under sensorMutex, read without locking) */
+    uint32_t configSeq;                 // Odd while a new snapshot is being written
+    struct ConfigSnapshot configSnapshot;
+    
+    /* Latest sample (seqlock: published by the measure thread, read without locking) */
+    uint32_t latestSeq;                 // Odd while a new sample is being written
+    struct LatestSample latestSample;
+    struct LatestSample sampleHistory[SAMPLE_HISTORY_SIZE];     // Recent samples (slot: seq % size, seq 0 while written)
+    int sampleEventFd;                  // eventfd signalled on new samples while clients wait on the sensor
+    uint32_t waiterCount;               // Clients waiting on or subscribed to the sensor (atomic)
+    struct FeedSensor *feed;            // Shared memory feed of the sensor (NULL: no feed)
+    
+    /* Saved data (savedDataMutex) */
+    pthread_mutex_t savedDataMutex;
+    int savedDataFd;
+    char savedDataFilePath[SAVED_DATA_FILE_PATH_LEN + SAVED_DATA_FILE_SUFFIX_LEN];
+    int savedColumnFd[SAVED_DATA_COLUMNS];                          // Column files (all invalid if out of sync with records)
+    struct SavedDataRecord savedDataBuf[SAVED_DATA_BATCH_SIZE];     // Records not yet written to file
+    int savedDataBufCount;                                          // Number of records in buffer
+};
+
+/* Validated sensor configuration update (applied at once by applyConfigUpdate) */
+struct ConfigUpdate {
+    
+    uint8_t settingSelSet;              // Sensor setting selection bits to set
+    uint8_t settingSelClear;            // Sensor setting selection bits to clear
+    uint8_t settingsChanged;            // Sensor register settings touched (write register image)
+    uint8_t osrValid;                   // Oversampling / filter fields given (BME280_OSR_*_SEL, BME280_FILTER_SEL)
+    uint8_t osrT;                       // Temperature oversampling
+    uint8_t osrP;                       // Pressure oversampling
+    uint8_t osrH;                       // Humidity oversampling
+    uint8_t filter;                     // IIR filter coefficient
+    uint8_t modeValid;                  // Acquisition mode given
+    uint8_t modeSel;                    // Acquisition mode (BME280_FORCED_MODE or BME280_NORMAL_MODE)
+    uint8_t periodValid;                // Measurement period given
+    uint64_t periodUs;                  // Measurement period [usec]
+};
+
+/* Client session state (passed to the request handlers) */
+struct ClientSession {
+    
+    int serviceStopCondition;           // Service of the client ends
+    int sensorSel;                      // Sensor the requests refer to
+};
+
+/* Push subscription of a parked client session */
+struct Subscription {
+    
+    uint8_t channels;                   // Pushed channels (REQ_AGG_CH_...)
+    uint8_t policy;                     // Slow subscriber policy (REQ_SUB_POLICY_...)
+    uint8_t ending;                     // Unsubscribed, end frame queued
+    uint32_t decimation;                // Push every n-th sample
+    uint32_t decimationCount;           // Samples since the last pushed one
+    uint32_t dropCount;                 // Samples dropped or coalesced
+    uint8_t ring[SUB_RING_SLOTS][RES_PUSH_FRAME_MAX_LEN];   // Frames not written yet
+    uint8_t ringLen[SUB_RING_SLOTS];
+    uint32_t ringHead;                  // Oldest frame
+    uint32_t ringCount;
+    uint32_t headOffset;                // Bytes of the oldest frame written already
+};
+
+/* Client session parked until a new sample or a timeout, or while subscribed (see eventThreadFunction) */
+struct ParkedSession {
+    
+    int serviceSocket;
+    const struct UserData *user;
+    struct ClientSession session;
+    uint64_t afterSeq;                  // Wake up on a sample newer than this
+    uint64_t deadlineNs;                // Timeout (CLOCK_MONOTONIC) [nsec]
+    struct Subscription *subscription;  // NULL: waiting for a single sample
+    struct ParkedSession *prev;         // Subscriber list only
+    struct ParkedSession *next;
+};
+
+/* State of the event thread (accessed by the event thread only) */
+struct EventContext {
+    
+    int epollFd;
+    struct ParkedSession *waitList[SENSOR_ARRAY_SIZE];         // Waiting sessions per sensor
+    struct ParkedSession *subscriberList[SENSOR_ARRAY_SIZE];   // Subscribed sessions per sensor
+    uint64_t pushedSeq[SENSOR_ARRAY_SIZE];                      // Last sample pushed to the subscribers
+    struct ParkedSession **fdTable;                             // Parked sessions by socket
+    int fdTableSize;
+};
+
 /* Request groupe permissions */
 struct Request {
     
@@ -195,22 +831,28 @@ struct Request {
 /* Global variable declarations */
 
 extern int serverSocket;
-extern int savedDataFd;
+extern int unixServerSocket;                                    // Local clients (-1: TCP only)
+extern uint8_t peerCredAuth;                                    // Local clients may authenticate by peer credentials
 
-extern char savedDataFilePath[SAVED_DATA_FILE_PATH_LEN];
-
-extern pthread_mutex_t sensorMutex;
 extern pthread_mutex_t serviceMutex;
-extern pthread_mutex_t savedDataMutex;
 
 extern const struct UserData userDataArray[USR_DATA_ARRAY_SIZE];
 extern const struct Request requestArray[REQ_ARRAY_SIZE];
 
-extern struct identifier sensorId;     // Sensor interface identifier
-extern struct bme280_dev sensorDev;    // Sensor device and settings
-extern uint8_t sensorSettingSel;       // Sensor setting selection
-extern uint32_t minDelay;              // Minimal delay after requesting a measurement
-extern int measPeriod;                 // Measurement period [sec]
+extern struct SensorContext sensorArray[SENSOR_ARRAY_SIZE];    // Sensors (index: sensor ID)
+extern int sensorCount;                                         // Number of sensors in use
+
+extern pthread_mutex_t parkMutex;
+extern struct ParkedSession *parkQueue;                         // Parked by service threads, taken by the event thread
+extern struct ParkedSession *resumeQueue;                       // Completed by the event thread, taken by service threads
+extern int parkEventFd;                                         // Signalled on parkQueue push
+extern int resumeEventFd;                                       // Signalled on resumeQueue push (semaphore)
+
+extern struct FeedSegment *sampleFeed;                          // Shared memory sample feed (NULL: disabled)
+extern int sampleMcastSocket;                                   // UDP multicast sample feed (-1: disabled)
+extern uint32_t sampleMcastStreamId;                            // Tells receivers the server restarted
+extern uint8_t traceEnabled;                                    // Request and sample spans are recorded (see tracer.c)
+extern uint8_t lockProfileEnabled;                              // Lock wait and hold times are recorded (see lockprof.c)
 
 /* Function declarations */
 
@@ -219,6 +861,16 @@ extern int measPeriod;                 // Measurement period [sec]
  */
 void* serviceThreadFunction(void *arg);
 
+/*
+ * Function 'eventThreadFunction': wakes up parked client sessions.
+ */
+void* eventThreadFunction(void *arg);
+
+/*
+ * Function 'parkClientSession': hands a client session over to the event thread.
+ */
+int parkClientSession(struct ParkedSession *parked);
+
 /*
  * Function 'measureThreadFunction': conducts consecutive measurements.
  */
@@ -229,15 +881,143 @@ void* measureThreadFunction(void *arg);
  */
 int authClient(const char *username, const char *password, const struct UserData* *userRef);
 
+/*
+ * Function 'authPeerClient': authenticates a local client by its peer credentials.
+ */
+int authPeerClient(const char *username, uid_t peerUid, const struct UserData* *userRef);
+
 /*
  * Function 'initSavedDataFilePath': initializes file path for file containing saved data.
  */
 int initSavedDataFilePath(char filePathBuf[]);
 
+/*
+ * Function 'loadSensorConfig': loads the sensor list from a sensor configuration file.
+ */
+int loadSensorConfig(const char *configPath);
+
+/*
+ * Function 'openSavedDataScan': returns a descriptor to scan the saved data of a sensor.
+ */
+int openSavedDataScan(struct SensorContext *sensor, uint64_t *recordCount);
+
+/*
+ * Function 'addSensor': appends a sensor to the sensor array.
+ */
+int addSensor(const char *transportName, const char *busPath, uint8_t devAddr, const char *tracePath);
+
+/*
+ * Function 'initSensor': initializes a sensor and its measurement context.
+ */
+int initSensor(struct SensorContext *sensor);
+
+/*
+ * Function 'flushSavedData': writes buffered measurement records to the saved data file.
+ *                            Caller must hold savedDataMutex.
+ */
+int flushSavedData(struct SensorContext *sensor);
+
+/*
+ * Function 'openSavedColumns': opens (truncates) the column files of the saved data.
+ *                              Caller must hold savedDataMutex.
+ */
+int openSavedColumns(struct SensorContext *sensor);
+
+/*
+ * Function 'closeSavedColumns': closes the column files of the saved data.
+ *                               Caller must hold savedDataMutex.
+ */
+void closeSavedColumns(struct SensorContext *sensor);
+
+/*
+ * Function 'parseConfigField': validates a config field and adds it to a config update.
+ */
+int parseConfigField(uint8_t config, uint32_t value, const struct UserData *user, struct ConfigUpdate *update);
+
+/*
+ * Function 'applyConfigUpdate': applies a validated config update to a sensor at once.
+ */
+int applyConfigUpdate(struct SensorContext *sensor, const struct ConfigUpdate *update);
+
+/*
+ * Function 'getRecordTimeUs': returns the sample time of a saved record [usec].
+ */
+uint64_t getRecordTimeUs(const struct SavedDataRecord *record);
+
+/*
+ * Function 'readSavedRecord': reads a record of the saved data file.
+ */
+int readSavedRecord(int fd, uint64_t index, struct SavedDataRecord *record);
+
+/*
+ * Function 'findSavedRecord': returns the index of the first saved record not older than a given time.
+ */
+int findSavedRecord(int fd, uint64_t recordCount, uint64_t timeUs, uint64_t *index);
+
+/*
+ * Function 'resolveSavedRange': resolves the open ends of a time range and locates its records.
+ */
+int resolveSavedRange(int fd, uint64_t recordCount, uint64_t *fromUs, uint64_t *toUs, uint64_t *firstIndex,
+                      uint64_t *endIndex);
+
+/*
+ * Function 'aggregateSavedData': aggregates the saved records of a time range into buckets.
+ */
+int aggregateSavedData(int fd, uint64_t firstIndex, uint64_t endIndex, const struct AggQuery *query,
+                       struct AggBucket *buckets);
+
+/*
+ * Function 'getSavedColumnWidth': returns the size of a column entry [byte].
+ */
+size_t getSavedColumnWidth(int column);
+
+/*
+ * Function 'appendSavedColumns': appends records to the column files of the saved data.
+ */
+int appendSavedColumns(const int columnFd[SAVED_DATA_COLUMNS], const struct SavedDataRecord records[], int count);
+
+/*
+ * Function 'projectSavedColumn': extracts a column from a block of saved records.
+ */
+int projectSavedColumn(int fd, uint64_t firstIndex, uint32_t count, int column, uint8_t buf[]);
+
+/*
+ * Function 'downsampleSavedData': downsamples the channels of the saved records of a time range.
+ */
+int downsampleSavedData(int fd, uint64_t firstIndex, uint64_t endIndex, const struct DownsampleQuery *query,
+                        struct SamplePoint *points[SAVED_DATA_CHANNELS], uint32_t pointCount[SAVED_DATA_CHANNELS],
+                        uint32_t maxPoints);
+
+/*
+ * Function 'publishConfigSnapshot': publishes the current configuration of a sensor.
+ *                                   Caller must hold sensorMutex of the sensor.
+ */
+void publishConfigSnapshot(struct SensorContext *sensor);
+
+/*
+ * Function 'readConfigSnapshot': copies the latest configuration of a sensor without locking.
+ */
+void readConfigSnapshot(struct SensorContext *sensor, struct ConfigSnapshot *snapshot);
+
+/*
+ * Function 'publishLatestSample': publishes the latest sample of a sensor.
+ */
+void publishLatestSample(struct SensorContext *sensor, const struct SavedDataRecord *record, uint32_t configVersion);
+
+/*
+ * Function 'readLatestSample': copies the latest sample of a sensor without locking.
+ */
+void readLatestSample(struct SensorContext *sensor, struct LatestSample *sample);
+
+/*
+ * Function 'readSampleHistory': copies a recent sample of a sensor without locking.
+ */
+int readSampleHistory(struct SensorContext *sensor, uint64_t seq, struct LatestSample *sample);
+
 /*
  * Function 'clientHandler': interprets and forwards client requests.
  */
-int clientHandler(int serviceSocket, const struct UserData *user, int *serviceStopCondition);
+int clientHandler(int serviceSocket, const struct UserData *user, struct ClientSession *session);
 
 /*
  * Function 'disconnectHandler': handles disconnection requested by client.
@@ -263,3 +1043,203 @@ int removeDataHandler(int clientSocket, const struct UserData *user, void *custo
  * Function 'getDataHandler': returns measurement data requested by client.
  */
 int getDataHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'selectSensorHandler': selects the sensor subsequent requests of the client refer to.
+ */
+int selectSensorHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'listSensorsHandler': returns the list of sensors requested by client.
+ */
+int listSensorsHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'multiConfigHandler': sets several sensor configurations requested by client at once.
+ */
+int multiConfigHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'getConfigBinHandler': returns current sensor configuration in binary form requested by client.
+ */
+int getConfigBinHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'aggregateDataHandler': returns aggregates of the measurement data requested by client.
+ */
+int aggregateDataHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'downsampleDataHandler': returns downsampled measurement data requested by client.
+ */
+int downsampleDataHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'getColumnsHandler': transfers selected columns of measurement data to client.
+ */
+int getColumnsHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'latestDataHandler': transfers the latest sample to client.
+ */
+int latestDataHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'waitSampleHandler': transfers the first sample newer than the one requested by client.
+ */
+int waitSampleHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'subscribeHandler': subscribes client to new samples pushed by the server.
+ */
+int subscribeHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'historyDataHandler': transfers recent samples selected by sequence number to client.
+ */
+int historyDataHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'statsHandler': transfers a snapshot of the server statistics to client.
+ */
+int statsHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'traceHandler': transfers the recorded request and sample spans to client (Chrome trace JSON).
+ */
+int traceHandler(int clientSocket, const struct UserData *user, void *customArg);
+
+/*
+ * Function 'createSampleFeed': creates the shared memory feed of the latest samples.
+ */
+int createSampleFeed(const char *feedName);
+
+/*
+ * Function 'removeSampleFeed': removes the shared memory feed of the latest samples.
+ */
+void removeSampleFeed(const char *feedName);
+
+/*
+ * Function 'openUnixServerSocket': listens for local clients on a Unix domain socket.
+ */
+int openUnixServerSocket(const char *socketPath);
+
+/*
+ * Function 'openSampleMulticast': opens the UDP multicast feed of the latest samples.
+ */
+int openSampleMulticast(const char *groupAddress, const char *interfaceAddress);
+
+/*
+ * Function 'logEvent': logs a message of the server without blocking.
+ */
+void logEvent(int priority, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/*
+ * Function 'getLogCounters': returns the counters of the asynchronous logging.
+ */
+void getLogCounters(struct LogCounters *counters);
+
+/*
+ * Function 'startLogThread': starts the thread forwarding the logged events.
+ */
+int startLogThread(void);
+
+/*
+ * Function 'stopLogThread': forwards the remaining events and stops the log thread.
+ */
+void stopLogThread(void);
+
+/*
+ * Function 'getMetricTimeNs': returns the monotonic time [nsec] (vDSO, no syscall).
+ */
+uint64_t getMetricTimeNs(void);
+
+/*
+ * Function 'initMetrics': starts the uptime of the metrics registry.
+ */
+void initMetrics(void);
+
+/*
+ * Function 'addMetricCounter': adds a value to a counter of the calling thread.
+ */
+void addMetricCounter(int counter, uint64_t value);
+
+/*
+ * Function 'recordMetricValue': records a value (e.g. latency [nsec]) in a histogram of the calling thread.
+ */
+void recordMetricValue(int histogram, uint64_t value);
+
+/*
+ * Function 'getMetricSnapshot': sums the shards of all threads.
+ */
+int getMetricSnapshot(struct MetricSnapshot *snapshot);
+
+/*
+ * Function 'getMetricPercentile': returns a percentile of a histogram (quantile: 0.0 - 1.0).
+ */
+uint64_t getMetricPercentile(const struct MetricHist *hist, double quantile);
+
+/*
+ * Function 'getMetricCountBelow': returns the number of values not above a limit (e.g. Prometheus 'le' bucket).
+ */
+uint64_t getMetricCountBelow(const struct MetricHist *hist, uint64_t limit);
+
+/*
+ * Function 'startMetricsExport': opens the metrics listener and starts its thread.
+ */
+int startMetricsExport(const char *address);
+
+/*
+ * Function 'appendExportText': appends formatted text to the response text.
+ */
+void appendExportText(struct ExportText *text, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/*
+ * Function 'traceSpan': records a span of the calling thread.
+ */
+void traceSpan(int span, uint32_t arg, uint64_t startNs, uint64_t endNs);
+
+/*
+ * Function 'setTraceThreadName': names the calling thread in the trace (e.g. "service %d").
+ */
+void setTraceThreadName(const char *format, int index);
+
+/*
+ * Function 'buildTraceJson': builds the Chrome trace-event JSON of the recorded spans.
+ */
+int buildTraceJson(struct ExportText *text);
+
+/*
+ * Function 'dumpTraceFile': writes the Chrome trace-event JSON of the recorded spans to a file.
+ */
+int dumpTraceFile(const char *path);
+
+/*
+ * Function 'lockProfiledMutex': locks a mutex, records the time waited for it at the call site.
+ */
+void lockProfiledMutex(pthread_mutex_t *mutex, int lockId, int *siteId, const char *file, int line);
+
+/*
+ * Function 'unlockProfiledMutex': unlocks a mutex, records the time it was held.
+ */
+void unlockProfiledMutex(pthread_mutex_t *mutex, int lockId);
+
+/*
+ * Function 'waitProbedCond': waits for a condition with a profiled mutex (pthread_cond_timedwait).
+ */
+int waitProbedCond(pthread_cond_t *cond, pthread_mutex_t *mutex, int lockId, int sensorId, const struct timespec *deadline);
+
+/*
+ * Function 'getLockSiteCount': returns the number of registered lock call sites.
+ */
+int getLockSiteCount(void);
+
+/*
+ * Function 'getLockSite': returns a registered lock call site (NULL: invalid site ID).
+ */
+const struct LockSite* getLockSite(int siteId);
+
+/*
+ * Function 'getLockName': returns the name of a profiled lock.
+ */
+const char* getLockName(int lockId);
@@ -8,14 +8,22 @@
  *              and other utilities.
  */
 
+#include <arpa/inet.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <math.h>
+#include <netinet/in.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <syslog.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
 #include <sys/sendfile.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "bme280_qt_interf_v2.h"
@@ -38,11 +46,112 @@ const struct Request requestArray[REQ_ARRAY_SIZE] = {
     {REQ_CODE_SCONF, setConfigHandler, USR_GRP_CONF},
     {REQ_CODE_GCONF, getConfigHandler, USR_GRP_GUEST},
     {REQ_CODE_RMDAT, removeDataHandler, USR_GRP_CONF},
-    {REQ_CODE_GDAT, getDataHandler, USR_GRP_GUEST}
+    {REQ_CODE_GDAT, getDataHandler, USR_GRP_GUEST},
+    {REQ_CODE_SSEL, selectSensorHandler, USR_GRP_GUEST},
+    {REQ_CODE_SLIST, listSensorsHandler, USR_GRP_GUEST},
+    {REQ_CODE_MCONF, multiConfigHandler, USR_GRP_CONF},
+    {REQ_CODE_GCONFB, getConfigBinHandler, USR_GRP_GUEST},
+    {REQ_CODE_AGG, aggregateDataHandler, USR_GRP_GUEST},
+    {REQ_CODE_DSMP, downsampleDataHandler, USR_GRP_GUEST},
+    {REQ_CODE_GDATP, getColumnsHandler, USR_GRP_GUEST},
+    {REQ_CODE_LATEST, latestDataHandler, USR_GRP_GUEST},
+    {REQ_CODE_WAIT, waitSampleHandler, USR_GRP_GUEST},
+    {REQ_CODE_SUB, subscribeHandler, USR_GRP_GUEST},
+    {REQ_CODE_HIST, historyDataHandler, USR_GRP_GUEST},
+    {REQ_CODE_STATS, statsHandler, USR_GRP_GUEST},
+    {REQ_CODE_TRACE, traceHandler, USR_GRP_CONF}
+};
+
+/* Statistics IDs of the histograms indexed like them (METRIC_HIST_..., request latencies follow) */
+static const uint8_t statsHistIdTable[METRIC_HIST_REQUEST] = {
+    
+    STATS_HIST_ACCEPT_AUTH,
+    STATS_HIST_GDAT_BYTES,
+    STATS_HIST_SENS_BUS,
+    STATS_HIST_SENS_CONV,
+    STATS_HIST_SAVE_APPEND,
+    STATS_HIST_SAMPLE_JITTER
+};
+
+/* Column file name suffixes indexed like the columns (REQ_AGG_CH_... bits, then time) */
+static const char *savedColumnSuffixTable[SAVED_DATA_COLUMNS] = {
+    
+    ".tmp",
+    ".hum",
+    ".prs",
+    ".time"
+};
+
+/* Oversampling settings indexed by config value (REQ_CONF_OS_...) */
+static const uint8_t confOversamplingTable[] = {
+    
+    BME280_NO_OVERSAMPLING,
+    BME280_OVERSAMPLING_1X,
+    BME280_OVERSAMPLING_2X,
+    BME280_OVERSAMPLING_4X,
+    BME280_OVERSAMPLING_8X,
+    BME280_OVERSAMPLING_16X
+};
+
+/* IIR filter settings indexed by config value (REQ_CONF_COEFF_...) */
+static const uint8_t confFilterTable[] = {
+    
+    BME280_FILTER_COEFF_OFF,
+    BME280_FILTER_COEFF_2,
+    BME280_FILTER_COEFF_4,
+    BME280_FILTER_COEFF_8,
+    BME280_FILTER_COEFF_16
+};
+
+/* Oversampling config strings indexed by oversampling setting */
+static const char *confOversamplingStrTable[] = {
+    
+    RES_STR_SCONF_OVERSAMPLING_OFF,
+    RES_STR_SCONF_OVERSAMPLING_1X,
+    RES_STR_SCONF_OVERSAMPLING_2X,
+    RES_STR_SCONF_OVERSAMPLING_4X,
+    RES_STR_SCONF_OVERSAMPLING_8X,
+    RES_STR_SCONF_OVERSAMPLING_16X
+};
+
+/* IIR filter config strings indexed by IIR filter setting */
+static const char *confFilterStrTable[] = {
+    
+    RES_STR_SCONF_IIR_COEFF_OFF,
+    RES_STR_SCONF_IIR_COEFF_2,
+    RES_STR_SCONF_IIR_COEFF_4,
+    RES_STR_SCONF_IIR_COEFF_8,
+    RES_STR_SCONF_IIR_COEFF_16
 };
 
 /* Function definitions */
 
+/*
+ * Function 'getConfigString': returns the config string of a sensor setting.
+ */
+static const char* getConfigString(uint8_t selected, uint8_t setting, const char **strTable, size_t strTableSize) {
+    
+    if(!selected) {
+        
+        return RES_STR_SCONF_OFF;
+    }
+    
+    return (setting < strTableSize) ? strTable[setting] : RES_STR_SCONF_ERR;
+}
+
+/*
+ * Function 'getConfigParam': encodes a sensor setting like a set config request (REQ_CONF_...).
+ */
+static uint8_t getConfigParam(uint8_t configType, uint8_t selected, uint8_t setting) {
+    
+    if(!selected) {
+        
+        return configType | REQ_CONF_OFF;
+    }
+    
+    return configType | REQ_CONF_ON | ((setting << 4) & REQ_CONF_VALUE_MASK);
+}
+
 /*
  * Function 'authClient': authenticates client before connetion.
  */
@@ -79,7 +188,42 @@ int authClient(const char *username, const char *password, const struct UserData
 }
 
 /*
- * Function 'initSavedDataFilePath': initializes file path for file containing saved data.
+ * Function 'authPeerClient': authenticates a local client by its peer credentials.
+ * 
+ * Note:    Only if enabled (-p) and the client of the Unix socket runs as root or as
+ *          the user of the server: such a process could read the user data anyway.
+ *          The client still sends a username selecting its permissions, the password
+ *          is not checked. Other clients fall back to authClient.
+ */
+int authPeerClient(const char *username, uid_t peerUid, const struct UserData* *userRef) {
+    
+    int error = 0;
+    int i;
+    
+    *userRef = NULL;
+    
+    if((0 == peerCredAuth) || ((0 != peerUid) && (geteuid() != peerUid))) {
+        
+        error = -1;
+        return error;
+    }
+    
+    for(i = 0; i < USR_DATA_ARRAY_SIZE; i++) {
+        
+        if(0 == strcmp(userDataArray[i].name, username)) {
+            
+            /* Authentication succeeded */
+            *userRef = &(userDataArray[i]);
+            return error;
+        }
+    }
+    
+    error = -1;
+    return error;
+}
+
+/*
+ * Function 'initSavedDataFilePath'': initializes file path for file containing saved data.
  */
 int initSavedDataFilePath(char filePathBuf[]) {
     
@@ -93,10 +237,9 @@ int initSavedDataFilePath(char filePathBuf[]) {
         /* Failed to get current working directory */
 #ifdef SERVER_DEBUG
         perror("getcwd");
-        fprintf(stderr, LOG_SYS_ERR_SERVER_SAVE_PATH_INIT_FAIL);
         fflush(stderr);
 #endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_PATH_INIT_FAIL);
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_PATH_INIT_FAIL);
         
         error = -1;
         return error;
@@ -110,1201 +253,3319 @@ int initSavedDataFilePath(char filePathBuf[]) {
 }
 
 /*
- * Function 'clientHandler': interprets and forwards client requests.
+ * Function 'createSavedFile': creates an empty saved data (or column) file in place of the old one.
  * 
- * Note:    The clientHandler will notify client in case of: 
- *          granted permission, denied permission, invalid permission and
- *          failure in request handling.
- *          
- *          The handler functions should not notify clients in case of
- *          failure in request handling (server side error). Instead signal
- *          the errors with their return value and let the main clientHandler
- *          deal with it. Handler functions may notify clients of successful
- *          request handlings (protocol defined).
+ * Note:    The old file is unlinked rather than truncated: descriptors duplicated by
+ *          transfers and scans without savedDataMutex (GDAT, GDATP, aggregation) keep
+ *          reading the records they were promised from the old inode. If the old file
+ *          cannot be removed, nothing is created (truncating it in place would cut
+ *          those transfers short): returns -1 like open.
  */
-int clientHandler(int serviceSocket, const struct UserData *user, int *serviceStopCondition) {
-    
-    uint8_t requestCode;
-    uint8_t response;
-    int iReq;
-    int len;
-    int error = 0;
+static int createSavedFile(const char *filePath, int flags) {
     
-    /* Check user and stop condition argument */
-    if((NULL == user) || (NULL == serviceStopCondition)) {
+    if((unlink(filePath) < 0) && (ENOENT != errno)) {
         
-        /* Invalid user or stop service argument */
 #ifdef SERVER_DEBUG
-        fprintf(stdout, LOG_SYS_ERR_INVALID_ARGS);
-        fflush(stdout);
+        perror("unlink");
+        fflush(stderr);
 #endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_INVALID_ARGS);
-        error = -1;
-        return error;
-    }
-    
-    /* Check client socket argument */
-    if(serviceSocket < 0) {
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_UNLINK_FAIL, filePath);
         
-        /* Invalid client socket argument */
-#ifdef SERVER_DEBUG
-        fprintf(stdout, LOG_SYS_ERR_INVALID_SOCK);
-        fflush(stdout);
-#endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_INVALID_SOCK);
-        error = -1;
-        return error;
+        return -1;
     }
     
-    /* Receive client request */
-    len = recv(serviceSocket, &requestCode, sizeof(requestCode), MSG_WAITALL);
-    if(len < 0) {
-        
-        /* Failed to receive client request */
-#ifdef SERVER_DEBUG
-        perror("recv");
-        fflush(stderr);
-        fprintf(stdout, LOG_SYS_ERR_CLIENT_REQ_RECV_FAIL);
-        fflush(stdout);
-#endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_RECV_FAIL);
+    /* Exclusive: a file created meanwhile by someone else is not taken over */
+    return open(filePath, O_CREAT | O_EXCL | flags, 0644);
+}
+
+/*
+ * Function 'flushSavedData': writes buffered measurement records to the saved data file.
+ * 
+ * Note:    Caller must hold savedDataMutex of the sensor. Opens (creates) the saved data file
+ *          if it is not open yet. Records are written with a single system call.
+ *          The buffer is emptied even on failure to keep the measure thread going.
+ */
+int flushSavedData(struct SensorContext *sensor) {
+    
+    int error = 0;
+    ssize_t size;
+    uint64_t startNs;
+    uint64_t endNs;
+    
+    /* Nothing to do */
+    if(0 == sensor->savedDataBufCount) {
         
-        error = -1;
         return error;
     }
-  
-    /* Identify client request */
-    for(iReq = 0; iReq < REQ_ARRAY_SIZE; iReq++) {
-         
-        if(requestArray[iReq].requestCode == requestCode) {
-                
-            /* Client request code identified */
-                
-            /* Check user permission */
-            if(requestArray[iReq].lowestGroupe <= user->groupe) {
-                    
-                /* Permission granted */
-                    
-                /* Notify client (permission granted) */
-                response = RES_CODE_REQ_ACCEPT;
-                len = send(serviceSocket, &response, sizeof(response), MSG_NOSIGNAL);
-                if(len < 0) {
-                        
-                    /* Failed to send server response to client */
-#ifdef SERVER_DEBUG
-                    perror("send");
-                    fflush(stderr);
-                    fprintf(stdout, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
-                    fflush(stdout);
-#endif
-                    syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
-                    error = -1;
-                }
-                    
-                /* Invoke request handler */
-                error = requestArray[iReq].requestHandler(serviceSocket, user, serviceStopCondition);
-                if(error != 0) {
-                        
-                    /* Failed to accomplish client request */
-#ifdef SERVER_DEBUG
-                    fprintf(stdout, LOG_SYS_ERR_CLIENT_REQ_FAIL, user->name, requestCode);
-                    fflush(stdout);
-#endif
-                    syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_FAIL, user->name, requestCode);
-                        
-                    /* Notify client (failed to accomplish request) */
-                    response = RES_CODE_REQ_FAIL;
-                    len = send(serviceSocket, &response, sizeof(response), MSG_NOSIGNAL);
-                    if(len < 0) {
-                        
-                        /* Failed to send server response to client */
-#ifdef SERVER_DEBUG
-                        perror("send");
-                        fflush(stderr);
-                        fprintf(stdout, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
-                        fflush(stdout);
-#endif
-                        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
-                        error = -1;
-                        return error;
-                    }
-                }
-                    
-                // Q: Shall we notify the client here about the success ? (RES_CODE_REQ_SUCCESS)
-                // A: No. Success shall be notified inside handler.
-            }
-            else {
-                    
-                /* Permission denied */
-#ifdef SERVER_DEBUG
-                fprintf(stdout, LOG_SYS_INFO_CLIENT_REQ_NO_PERM, user->name, requestCode);
-                fflush(stdout);
-#endif
-                syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_NO_PERM, user->name, requestCode);
+    
+    /* Open saved data file if not yet open */
+    if(sensor->savedDataFd < 0) {
+                 
+        /* File needs to be opened */
+        sensor->savedDataFd = createSavedFile(sensor->savedDataFilePath, O_RDWR);
+        if(sensor->savedDataFd < 0) {
                     
-                /* Notify client (no permission) */
-                response = RES_CODE_REQ_NO_PERM;
-                len = send(serviceSocket, &response, sizeof(response), MSG_NOSIGNAL);
-                if(len < 0) {
-                        
-                    /* Failed to send server response to client */
 #ifdef SERVER_DEBUG
-                    perror("send");
-                    fflush(stderr);
-                    fprintf(stdout, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
-                    fflush(stdout);
+            perror("open");
+            fflush(stderr);
 #endif
-                    syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
-                    error = -1;
-                }
-            }
-                
-            /* No need to keep looking for other request codes */
+            logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_OPEN_FAIL);
+            
+            sensor->savedDataBufCount = 0;
+            error = -1;
             return error;
         }
+        
+        /* Column files start empty together with the saved data file */
+        openSavedColumns(sensor);
     }
     
-    /* Could not identify client request code */
+    startNs = getMetricTimeNs();
+    SERVER_PROBE2(storage__append__start, (int)(sensor - sensorArray), sensor->savedDataBufCount);
     
-    /* Notify client (invalid request code) */
-    response = RES_CODE_REQ_INVALID;
-    len = send(serviceSocket, &response, sizeof(response), MSG_NOSIGNAL);
-    if(len < 0) {
-                        
-        /* Failed to send server response to client */
+    /* Set file offset to end of file */
+    lseek(sensor->savedDataFd, 0, SEEK_END);
+    
+    /* Write buffered records */
+    size = (ssize_t)(sensor->savedDataBufCount * sizeof(struct SavedDataRecord));
+    if(size != write(sensor->savedDataFd, sensor->savedDataBuf, size)) {
+        
 #ifdef SERVER_DEBUG
-        perror("send");
+        perror("write");
         fflush(stderr);
-        fprintf(stdout, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
-        fflush(stdout);
 #endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_BATCH_FAIL, sensor->savedDataBufCount);
         error = -1;
     }
     
+    /* Append the batch to the column files, give them up once out of sync */
+    if((sensor->savedColumnFd[0] >= 0) &&
+       ((0 != error) || (0 != appendSavedColumns(sensor->savedColumnFd, sensor->savedDataBuf, sensor->savedDataBufCount)))) {
+        
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_COL_FAIL);
+        closeSavedColumns(sensor);
+    }
+    
+    endNs = getMetricTimeNs();
+    recordMetricValue(METRIC_HIST_SAVE_APPEND, endNs - startNs);
+    traceSpan(TRACE_SPAN_APPEND, (uint32_t)(sensor - sensorArray), startNs, endNs);
+    SERVER_PROBE4(storage__append__done, (int)(sensor - sensorArray), sensor->savedDataBufCount, error, endNs - startNs);
+    sensor->savedDataBufCount = 0;
+    
     return error;
 }
 
 /*
- * Function 'disconnectHandler': handles disconnection requested by client.
+ * Function 'openSavedColumns': opens (recreates) the column files of the saved data.
  * 
- * Protocol:    Client --> Server: disconnect request code <1 byte>
+ * Note:    Caller must hold savedDataMutex. Called whenever the saved data file is
+ *          (re)created, so the column files hold the same records. If any of them
+ *          fails to open, none is used.
  */
-int disconnectHandler(int clientSocket, const struct UserData *user, void *customArg) {
+int openSavedColumns(struct SensorContext *sensor) {
     
+    char filePath[SAVED_DATA_FILE_PATH_LEN + SAVED_DATA_FILE_SUFFIX_LEN + SAVED_DATA_COLUMN_SUFFIX_LEN];
+    int column;
     int error = 0;
-    int *serviceStopCondition = (int*)customArg;
-    
-    *serviceStopCondition = COND_SERVICE_STOP_TRUE;
     
-    /* Let the main service thread (serviceThreadFunction) close the socket */
+    closeSavedColumns(sensor);
     
-    /* Syslog client requested disconnection */
+    for(column = 0; column < SAVED_DATA_COLUMNS; column++) {
+        
+        snprintf(filePath, sizeof(filePath), "%s%s", sensor->savedDataFilePath, savedColumnSuffixTable[column]);
+        sensor->savedColumnFd[column] = createSavedFile(filePath, O_RDWR | O_APPEND);
+        if(sensor->savedColumnFd[column] < 0) {
+            
 #ifdef SERVER_DEBUG
-    fprintf(stdout, LOG_SYS_INFO_CLIENT_REQ_DISCONN, user->name);
-    fflush(stdout);
+            perror("open");
+            fflush(stderr);
 #endif
-    syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_DISCONN, user->name);
+            logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_COL_FAIL);
+            
+            closeSavedColumns(sensor);
+            error = -1;
+            return error;
+        }
+    }
     
     return error;
 }
 
 /*
- * Function 'setConfigHandler': sets new sensor configuration requested by client.
- * 
- * Note:        Notify the client in case of successful request handling.
+ * Function 'closeSavedColumns': closes the column files of the saved data.
  * 
- * Protocol:    Client --> Server: set configuration request code <1 byte>
- *              Client <-- Server: result of request code validation <1 byte>
+ * Note:    Caller must hold savedDataMutex.
+ */
+void closeSavedColumns(struct SensorContext *sensor) {
+    
+    int column;
+    
+    for(column = 0; column < SAVED_DATA_COLUMNS; column++) {
+        
+        if(sensor->savedColumnFd[column] >= 0) {
+            
+            close(sensor->savedColumnFd[column]);
+        }
+        sensor->savedColumnFd[column] = SAVED_DATA_FD_INVALID;
+    }
+}
+
+/*
+ * Function 'openSavedDataScan': returns a descriptor to scan the saved data of a sensor.
  * 
- *              ++ In case of successful request validation ++
+ * Note:    The buffered records are written out and the file is scanned on a duplicate
+ *          of its descriptor, so savedDataMutex is held only while the file size is
+ *          taken: the measure thread keeps appending during the scan. Returns -1 if
+ *          there is no saved data file. The caller closes the returned descriptor.
+ */
+int openSavedDataScan(struct SensorContext *sensor, uint64_t *recordCount) {
+    
+    int scanFd = -1;
+    struct stat fileStat;
+    
+    *recordCount = 0;
+    
+    SAVED_DATA_MUTEX_LOCK(sensor);
+    
+    flushSavedData(sensor);
+    if((sensor->savedDataFd >= 0) && (0 == fstat(sensor->savedDataFd, &fileStat))) {
+        
+        scanFd = dup(sensor->savedDataFd);
+        *recordCount = (uint64_t)fileStat.st_size / sizeof(struct SavedDataRecord);
+    }
+    
+    SAVED_DATA_MUTEX_UNLOCK(sensor);
+    
+    if(scanFd < 0) {
+        
+        *recordCount = 0;
+    }
+    
+    return scanFd;
+}
+
+/*
+ * Function 'addSensor': appends a sensor to the sensor array.
  * 
- *              Client --> Server: configuration parameters <1 byte>
- *              Client --> Server: period value <4 bytes> (only for period config)
- *              Client <-- Server: result of request processing <1 byte>
+ * Note:    Only the transport configuration is stored here, the sensor
+ *          is initialized by initSensor. NULL arguments select the defaults
+ *          of the sensor interface (see init_dev_weather).
  */
-int setConfigHandler(int clientSocket, const struct UserData *user, void *customArg) {
+int addSensor(const char *transportName, const char *busPath, uint8_t devAddr, const char *tracePath) {
     
-    uint8_t config = 0;             // Sensor configuration
-    uint8_t response = 0;           // Server response
     int error = 0;
-    int len;
-    int period = 0;                 // Sampling period
-    
-    /* Syslog client requested to set sensor configuration */
-#ifdef SERVER_DEBUG
-    fprintf(stdout, LOG_SYS_INFO_CLIENT_REQ_SET_CONF, user->name);
-    fflush(stdout);
-#endif
-    syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_SET_CONF, user->name);
+    struct SensorContext *sensor = NULL;
     
-    /* Get sensor config from client */
-    len = recv(clientSocket, &config, sizeof(config), MSG_WAITALL);
-    if(len < 0) {
+    /* Check free slot */
+    if(sensorCount >= SENSOR_ARRAY_SIZE) {
         
-        /* Failed to receive client config request */
-#ifdef SERVER_DEBUG
-        perror("recv");
-        fflush(stderr);
-        fprintf(stdout, LOG_SYS_ERR_CLIENT_REQ_CONF_FAIL, user->name);
-        fflush(stdout);
-#endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_CONF_FAIL, user->name);
+        logEvent(LOG_ERR, LOG_SYS_ERR_SENS_CONF_TOO_MANY, SENSOR_ARRAY_SIZE);
         
         error = -1;
         return error;
     }
     
-    /* Receive period value from client based on config */
+    sensor = &(sensorArray[sensorCount]);
+    memset(sensor, 0, sizeof(*sensor));
+    sensor->sensorIndex = sensorCount;
+    
+    /* Copy transport configuration (the identifier keeps referring to it) */
+    if(NULL != transportName) {
+        
+        strncpy(sensor->transportName, transportName, sizeof(sensor->transportName) - 1);
+        sensor->sensorId.transport_name = sensor->transportName;
+    }
+    if(NULL != busPath) {
+        
+        strncpy(sensor->busPath, busPath, sizeof(sensor->busPath) - 1);
+        sensor->sensorId.bus_path = sensor->busPath;
+    }
+    if(NULL != tracePath) {
+        
+        strncpy(sensor->tracePath, tracePath, sizeof(sensor->tracePath) - 1);
+        sensor->sensorId.trace_path = sensor->tracePath;
+    }
+    sensor->sensorId.dev_addr = devAddr;
+    
+    sensorCount++;
+    
+    return error;
+}
+
+/*
+ * Function 'loadSensorConfig': loads the sensor list from a sensor configuration file.
+ * 
+ * Note:    One sensor per line, the line number of the sensor (comments and empty
+ *          lines excluded) is its sensor ID:
+ * 
+ *          <i2c|sim|replay> <I2C device or trace file> <I2C address> [trace file to record]
+ * 
+ *          e.g.    i2c /dev/i2c-1 0x76
+ *                  i2c /dev/i2c-1 0x77
+ *                  i2c /dev/i2c-3 0x76
+ * 
+ *          Text following the comment character is ignored.
+ */
+int loadSensorConfig(const char *configPath) {
+    
+    int error = 0;
+    int lineNumber = 0;
+    int fields;
+    int devAddr;
+    char line[SENSOR_CONF_LINE_LEN];
+    char transportName[SENSOR_NAME_LEN];
+    char busPath[SENSOR_CONF_LINE_LEN];
+    char tracePath[SENSOR_CONF_LINE_LEN];
+    char *comment = NULL;
+    FILE *configFile = NULL;
+    
+    configFile = fopen(configPath, "r");
+    if(NULL == configFile) {
+        
+#ifdef SERVER_DEBUG
+        perror("fopen");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SENS_CONF_OPEN_FAIL);
+        
+        error = -1;
+        return error;
+    }
+    
+    while((0 == error) && (NULL != fgets(line, sizeof(line), configFile))) {
+        
+        lineNumber++;
+        
+        /* Strip comment */
+        if(NULL != (comment = strchr(line, SENSOR_CONF_COMMENT))) {
+            
+            *comment = '\0';
+        }
+        
+        /* Parse sensor entry (skip empty lines) */
+        fields = sscanf(line, "%15s %511s %i %511s", transportName, busPath, &devAddr, tracePath);
+        if(fields <= 0) {
+            
+            continue;
+        }
+        
+        if((fields < 3) || (devAddr < 0) || (devAddr > 0x7F)) {
+            
+            /* Invalid sensor entry */
+            logEvent(LOG_ERR, LOG_SYS_ERR_SENS_CONF_LINE_INVAL, lineNumber);
+            
+            error = -1;
+        }
+        else {
+            
+            error = addSensor(transportName, busPath, (uint8_t)devAddr, (fields > 3) ? tracePath : NULL);
+        }
+    }
+    
+    fclose(configFile);
+    
+    if((0 == error) && (0 == sensorCount)) {
+        
+        /* Empty configuration */
+        logEvent(LOG_ERR, LOG_SYS_ERR_SENS_CONF_EMPTY);
+        
+        error = -1;
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'initSensor': initializes a sensor and its measurement context.
+ * 
+ * Note:    Sensors other than sensor 0 save their data to the saved data file
+ *          suffixed with their sensor ID (e.g. meas_data.1).
+ */
+int initSensor(struct SensorContext *sensor) {
+    
+    int error = 0;
+    int i;
+    pthread_condattr_t measPeriodCondAttr;
+    
+    /* Initialize BME280 sensor for weather monitoring */
+    if(init_dev_weather(&(sensor->sensorId), &(sensor->sensorDev)) < 0) {
+        
+        /* Failed to initialize BME280 sensor */
+        logEvent(LOG_ERR, LOG_SYS_ERR_SENS_INIT_ID_FAIL, sensor->sensorIndex);
+        
+        error = -1;
+        return error;
+    }
+    
+    syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_SENS_START, sensor->sensorIndex, sensor->sensorId.transport_name,
+           sensor->sensorId.bus_path, sensor->sensorId.dev_addr);
+    
+    /* Initialize saved data file path */
+    memset(sensor->savedDataFilePath, 0, sizeof(sensor->savedDataFilePath));
+#ifdef SERVER_DEBUG
+    
+    /* Use actual directory for debugging mode */
+    if(0 != initSavedDataFilePath(sensor->savedDataFilePath)) {
+        
+        close_dev_connection(&(sensor->sensorId), &(sensor->sensorDev));
+        
+        error = -1;
+        return error;
+    }
+#else
+    
+    /* Use /home/pi/ directory for daemon mode */
+    strcpy(sensor->savedDataFilePath, SAVED_DATA_FILE_PATH_PI);
+#endif
+    
+    if(0 != sensor->sensorIndex) {
+        
+        snprintf(sensor->savedDataFilePath + strlen(sensor->savedDataFilePath), SAVED_DATA_FILE_SUFFIX_LEN, ".%d",
+                 sensor->sensorIndex);
+    }
+    
+    sensor->savedDataFd = SAVED_DATA_FD_INVALID;
+    sensor->savedDataBufCount = 0;
+    for(i = 0; i < SAVED_DATA_COLUMNS; i++) {
+        
+        sensor->savedColumnFd[i] = SAVED_DATA_FD_INVALID;
+    }
+    pthread_mutex_init(&(sensor->savedDataMutex), NULL);
+    
+    /* Calculate minimal delay */
+    sensor->minDelay = get_min_delay(&(sensor->sensorId), &(sensor->sensorDev));
+    
+    /* Initialize measurement period */
+    sensor->measPeriodUs = MEAS_PERIOD_INIT_SEC * USEC_PER_SEC;
+    sensor->measPeriodChanged = 0;
+    
+    /* Initialize period change condition on the monotonic clock (immune to wall clock jumps) */
+    pthread_mutex_init(&(sensor->sensorMutex), NULL);
+    pthread_condattr_init(&measPeriodCondAttr);
+    pthread_condattr_setclock(&measPeriodCondAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&(sensor->measPeriodCond), &measPeriodCondAttr);
+    pthread_condattr_destroy(&measPeriodCondAttr);
+    
+    /* Initialize acquisition mode (one conversion per sample) */
+    sensor->sensorModeSel = BME280_FORCED_MODE;
+    sensor->sensorModeReload = 0;
+    sensor->sensorConversionActive = 0;
+    sensor->sensorSettingsPending = 0;
+    
+    /* Initialize sensor setting selection */
+    sensor->sensorSettingSel = BME280_OSR_PRESS_SEL | BME280_OSR_TEMP_SEL | BME280_OSR_HUM_SEL | BME280_FILTER_SEL;
+    
+    /* Publish initial configuration (no other thread runs on this sensor yet) */
+    sensor->configSeq = 0;
+    memset(&(sensor->configSnapshot), 0, sizeof(sensor->configSnapshot));
+    publishConfigSnapshot(sensor);
+    
+    /* No sample yet */
+    sensor->latestSeq = 0;
+    memset(&(sensor->latestSample), 0, sizeof(sensor->latestSample));
+    
+    /* New sample notification of waiting clients (see eventThreadFunction) */
+    sensor->waiterCount = 0;
+    sensor->sampleEventFd = eventfd(0, EFD_NONBLOCK);
+    if(sensor->sampleEventFd < 0) {
+        
+#ifdef SERVER_DEBUG
+        perror("eventfd");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_EVENT_INIT_FAIL);
+        
+        error = -1;
+        return error;
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'parseConfigField': validates a config field and adds it to a config update.
+ * 
+ * Note:    Nothing is applied to the sensor here, so a request carrying several
+ *          fields can be validated completely before any of them takes effect.
+ *          The value is the period for period configs (seconds for REQ_CONF_PRD,
+ *          microseconds for REQ_CONF_PRD_US) and ignored otherwise.
+ */
+int parseConfigField(uint8_t config, uint32_t value, const struct UserData *user, struct ConfigUpdate *update) {
+    
+    uint8_t type = config & REQ_CONF_TYPE_MASK;                 // Config type
+    uint8_t index = (config & REQ_CONF_VALUE_MASK) >> 4;        // Config value (table index)
+    uint8_t settingSel = 0;                                     // Sensor setting selection bit of the field
+    int error = 0;
+    
+    if((REQ_CONF_PRD == type) || (REQ_CONF_PRD_US == type)) {
+        
+        /* Config period (seconds are sent as a signed integer) */
+        if((REQ_CONF_PRD == type) && ((int32_t)value < 0)) {
+            
+            /* Invalid config value */
+            logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_CONF_VAL_INVAL, user->name);
+            
+            error = -1;
+            return error;
+        }
+        
+        update->periodValid = 1;
+        update->periodUs = (REQ_CONF_PRD == type) ? ((uint64_t)value * USEC_PER_SEC) : value;
+        
+        return error;
+    }
+    
+    if(REQ_CONF_MODE == type) {
+        
+        /* Config acquisition mode (ON: normal mode, OFF: forced mode) */
+        update->modeValid = 1;
+        update->modeSel = (REQ_CONF_ON == (config & REQ_CONF_STATUS_MASK)) ? BME280_NORMAL_MODE : BME280_FORCED_MODE;
+        
+        return error;
+    }
+    
+    /* Identify sensor setting of the config type */
+    if(REQ_CONF_IIR == type) {
+        
+        settingSel = BME280_FILTER_SEL;
+    }
+    else if(REQ_CONF_TMP == type) {
+        
+        settingSel = BME280_OSR_TEMP_SEL;
+    }
+    else if(REQ_CONF_PRS == type) {
+        
+        settingSel = BME280_OSR_PRESS_SEL;
+    }
+    else if(REQ_CONF_HUM == type) {
+        
+        settingSel = BME280_OSR_HUM_SEL;
+    }
+    else {
+        
+        /* Invalid config type */
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_CONF_TYP_INVAL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    update->settingsChanged = 1;
+    
+    if(REQ_CONF_OFF == (config & REQ_CONF_STATUS_MASK)) {
+        
+        /* Config status off: stop reporting the channel (register value kept) */
+        update->settingSelSet &= ~settingSel;
+        update->settingSelClear |= settingSel;
+        
+        return error;
+    }
+    
+    /* Config status on: check config value */
+    if(((BME280_FILTER_SEL == settingSel) && (index >= sizeof(confFilterTable))) ||
+       ((BME280_FILTER_SEL != settingSel) && (index >= sizeof(confOversamplingTable)))) {
+        
+        /* Invalid config value */
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_CONF_VAL_INVAL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    update->settingSelSet |= settingSel;
+    update->settingSelClear &= ~settingSel;
+    update->osrValid |= settingSel;
+    
+    if(BME280_FILTER_SEL == settingSel) {
+        
+        update->filter = confFilterTable[index];
+    }
+    else if(BME280_OSR_TEMP_SEL == settingSel) {
+        
+        update->osrT = confOversamplingTable[index];
+    }
+    else if(BME280_OSR_PRESS_SEL == settingSel) {
+        
+        update->osrP = confOversamplingTable[index];
+    }
+    else {
+        
+        update->osrH = confOversamplingTable[index];
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'applyConfigUpdate': applies a validated config update to a sensor at once.
+ * 
+ * Note:    sensorMutex is taken once for the whole update and the sensor registers
+ *          are written with a single burst (write_sensor_settings), so the sensor
+ *          never runs with half-applied settings. While a conversion is in progress
+ *          the register write is queued for the measure thread (sensorSettingsPending).
+ *          Periods shorter than a conversion with the new settings are raised to it.
+ */
+int applyConfigUpdate(struct SensorContext *sensor, const struct ConfigUpdate *update) {
+    
+    uint64_t periodUs;              // Period to apply [usec]
+    uint64_t minPeriodUs;           // Conversion time of the settings [usec]
+    int error = 0;
+    
+    SENSOR_MUTEX_LOCK(sensor);
+    
+    /* Update sensor register settings */
+    if(update->settingsChanged) {
+        
+        if(update->osrValid & BME280_OSR_TEMP_SEL) {
+            
+            sensor->sensorDev.settings.osr_t = update->osrT;
+        }
+        if(update->osrValid & BME280_OSR_PRESS_SEL) {
+            
+            sensor->sensorDev.settings.osr_p = update->osrP;
+        }
+        if(update->osrValid & BME280_OSR_HUM_SEL) {
+            
+            sensor->sensorDev.settings.osr_h = update->osrH;
+        }
+        if(update->osrValid & BME280_FILTER_SEL) {
+            
+            sensor->sensorDev.settings.filter = update->filter;
+        }
+        sensor->sensorSettingSel = (sensor->sensorSettingSel | update->settingSelSet) & ~(update->settingSelClear);
+        
+        if(sensor->sensorConversionActive) {
+            
+            /* Conversion in progress: the measure thread applies the update once its data is read */
+            sensor->sensorSettingsPending = 1;
+        }
+        else {
+            
+            error = write_sensor_settings(&(sensor->sensorId), &(sensor->sensorDev));
+            sensor->sensorModeReload = 1;       // Settings update puts the sensor to sleep
+        }
+    }
+    
+    /* Update acquisition mode */
+    if(update->modeValid) {
+        
+        sensor->sensorModeSel = update->modeSel;
+        if(BME280_NORMAL_MODE == update->modeSel) {
+            
+            sensor->sensorModeReload = 1;
+        }
+    }
+    
+    /* Update period and wake up measure thread to apply it right away */
+    if(update->periodValid || update->settingsChanged) {
+        
+        periodUs = update->periodValid ? update->periodUs : sensor->measPeriodUs;
+        
+        /* Shorter periods would sample back to back (and reread one conversion in normal mode) */
+        minPeriodUs = (uint64_t)get_min_delay(&(sensor->sensorId), &(sensor->sensorDev)) * USEC_PER_MSEC;
+        if((0 != periodUs) && (periodUs < minPeriodUs)) {
+            
+            logEvent(LOG_WARNING, LOG_SYS_WARN_SENS_PERIOD_CLAMP, sensor->sensorIndex,
+                     (unsigned long long)periodUs, (unsigned long long)minPeriodUs);
+            periodUs = minPeriodUs;
+        }
+        
+        if(update->periodValid || (periodUs != sensor->measPeriodUs)) {
+            
+            sensor->measPeriodUs = periodUs;
+            sensor->measPeriodChanged = 1;
+            sensor->sensorModeReload = 1;       // Standby time depends on the period in normal mode
+            pthread_cond_signal(&(sensor->measPeriodCond));
+        }
+    }
+    
+    publishConfigSnapshot(sensor);
+    
+    SENSOR_MUTEX_UNLOCK(sensor);
+    
+    if(0 != error) {
+        
+        /* Failed to update sensor settings */
+        logEvent(LOG_ERR, LOG_SYS_ERR_SENS_STGS_SET_FAIL);
+        
+        error = -1;
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'publishConfigSnapshot': publishes the current configuration of a sensor.
+ * 
+ * Note:    Writer side of the config seqlock. Writers are serialized by sensorMutex,
+ *          so configSeq is odd only while one writer copies the new snapshot.
+ */
+void publishConfigSnapshot(struct SensorContext *sensor) {
+    
+    uint32_t seq = __atomic_load_n(&(sensor->configSeq), __ATOMIC_RELAXED);
+    
+    /* Mark snapshot as being written */
+    __atomic_store_n(&(sensor->configSeq), seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    sensor->configSnapshot.version++;
+    sensor->configSnapshot.measPeriodUs = sensor->measPeriodUs;
+    sensor->configSnapshot.settingSel = sensor->sensorSettingSel;
+    sensor->configSnapshot.modeSel = sensor->sensorModeSel;
+    sensor->configSnapshot.osrT = sensor->sensorDev.settings.osr_t;
+    sensor->configSnapshot.osrP = sensor->sensorDev.settings.osr_p;
+    sensor->configSnapshot.osrH = sensor->sensorDev.settings.osr_h;
+    sensor->configSnapshot.filter = sensor->sensorDev.settings.filter;
+    
+    /* Mark snapshot as complete */
+    __atomic_store_n(&(sensor->configSeq), seq + 2, __ATOMIC_RELEASE);
+}
+
+/*
+ * Function 'readConfigSnapshot': copies the latest configuration of a sensor without locking.
+ * 
+ * Note:    Reader side of the config seqlock. The copy is retried if a writer published
+ *          a new snapshot meanwhile, so readers never wait for sensorMutex (which the
+ *          measure thread holds during bus transfers).
+ */
+void readConfigSnapshot(struct SensorContext *sensor, struct ConfigSnapshot *snapshot) {
+    
+    uint32_t seqBegin;
+    uint32_t seqEnd;
+    
+    do {
+        
+        seqBegin = __atomic_load_n(&(sensor->configSeq), __ATOMIC_ACQUIRE);
+        if(seqBegin & 1) {
+            
+            /* Writer in progress */
+            seqEnd = seqBegin + 1;
+            continue;
+        }
+        
+        *snapshot = sensor->configSnapshot;
+        
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seqEnd = __atomic_load_n(&(sensor->configSeq), __ATOMIC_RELAXED);
+        
+    } while(seqBegin != seqEnd);
+}
+
+/*
+ * Function 'publishFeedSample': publishes the latest sample of a sensor to the shared memory feed.
+ * 
+ * Note:    Writer side of the feed seqlock (the measure thread of the sensor is the
+ *          only writer). Readers in other processes retry while the lock is odd or
+ *          has changed during their copy (see the reader library in Feed/).
+ */
+static void publishFeedSample(struct FeedSensor *feed, const struct LatestSample *sample) {
+    
+    uint32_t lock = __atomic_load_n(&(feed->lock), __ATOMIC_RELAXED);
+    
+    /* Mark feed as being written */
+    __atomic_store_n(&(feed->lock), lock + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    feed->latest.seq = sample->seq;
+    feed->latest.timeUs = sample->timeUs;
+    feed->latest.temp = sample->temp;
+    feed->latest.hum = sample->hum;
+    feed->latest.press = sample->press;
+    feed->latest.configVersion = sample->configVersion;
+    feed->history[sample->seq & (SAMPLE_FEED_HISTORY_SIZE - 1)] = feed->latest;
+    
+    /* Mark feed as complete */
+    __atomic_store_n(&(feed->lock), lock + 2, __ATOMIC_RELEASE);
+}
+
+/*
+ * Function 'publishMulticastSample': publishes the latest sample of a sensor to the multicast feed.
+ * 
+ * Note:    One datagram per sample, whatever the number of receivers. Sent without
+ *          blocking and best effort: receivers detect the lost ones by their sequence
+ *          numbers and fetch them over TCP (see historyDataHandler).
+ */
+static void publishMulticastSample(int sensorId, const struct LatestSample *sample) {
+    
+    uint8_t dgram[SAMPLE_MCAST_DGRAM_LEN];
+    
+    dgram[0] = SAMPLE_MCAST_VERSION;
+    dgram[1] = (uint8_t)sensorId;
+    dgram[2] = 0;
+    dgram[3] = 0;
+    memcpy(&dgram[4], &sampleMcastStreamId, sizeof(sampleMcastStreamId));
+    memcpy(&dgram[8], &(sample->seq), sizeof(sample->seq));
+    memcpy(&dgram[16], &(sample->timeUs), sizeof(sample->timeUs));
+    memcpy(&dgram[24], &(sample->temp), sizeof(sample->temp));
+    memcpy(&dgram[28], &(sample->hum), sizeof(sample->hum));
+    memcpy(&dgram[32], &(sample->press), sizeof(sample->press));
+    memcpy(&dgram[36], &(sample->configVersion), sizeof(sample->configVersion));
+    
+    send(sampleMcastSocket, dgram, sizeof(dgram), MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+/*
+ * Function 'publishLatestSample': publishes the latest sample of a sensor.
+ * 
+ * Note:    Writer side of the latest sample seqlock. The measure thread of the sensor
+ *          is the only writer. Each sample gets the next sequence number.
+ */
+void publishLatestSample(struct SensorContext *sensor, const struct SavedDataRecord *record, uint32_t configVersion) {
+    
+    uint32_t seq = __atomic_load_n(&(sensor->latestSeq), __ATOMIC_RELAXED);
+    
+    /* Mark sample as being written */
+    __atomic_store_n(&(sensor->latestSeq), seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    sensor->latestSample.seq++;
+    sensor->latestSample.timeUs = getRecordTimeUs(record);
+    sensor->latestSample.temp = record->temp;
+    sensor->latestSample.hum = record->hum;
+    sensor->latestSample.press = record->press;
+    sensor->latestSample.configVersion = configVersion;
+    
+    /* Mark sample as complete */
+    __atomic_store_n(&(sensor->latestSeq), seq + 2, __ATOMIC_RELEASE);
+    
+    /* Keep sample in history, slots are validated by their own seq */
+    struct LatestSample *slot = &(sensor->sampleHistory[sensor->latestSample.seq & (SAMPLE_HISTORY_SIZE - 1)]);
+    
+    __atomic_store_n(&(slot->seq), 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    slot->timeUs = sensor->latestSample.timeUs;
+    slot->temp = sensor->latestSample.temp;
+    slot->hum = sensor->latestSample.hum;
+    slot->press = sensor->latestSample.press;
+    slot->configVersion = configVersion;
+    
+    __atomic_store_n(&(slot->seq), sensor->latestSample.seq, __ATOMIC_RELEASE);
+    
+    /* Publish sample to local processes */
+    if(NULL != sensor->feed) {
+        
+        publishFeedSample(sensor->feed, &(sensor->latestSample));
+    }
+    
+    /* Publish sample to the LAN */
+    if(sampleMcastSocket >= 0) {
+        
+        publishMulticastSample((int)(sensor - sensorArray), &(sensor->latestSample));
+    }
+}
+
+/*
+ * Function 'readLatestSample': copies the latest sample of a sensor without locking.
+ * 
+ * Note:    Reader side of the latest sample seqlock, see readConfigSnapshot.
+ */
+void readLatestSample(struct SensorContext *sensor, struct LatestSample *sample) {
+    
+    uint32_t seqBegin;
+    uint32_t seqEnd;
+    
+    do {
+        
+        seqBegin = __atomic_load_n(&(sensor->latestSeq), __ATOMIC_ACQUIRE);
+        if(seqBegin & 1) {
+            
+            /* Writer in progress */
+            seqEnd = seqBegin + 1;
+            continue;
+        }
+        
+        *sample = sensor->latestSample;
+        
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seqEnd = __atomic_load_n(&(sensor->latestSeq), __ATOMIC_RELAXED);
+        
+    } while(seqBegin != seqEnd);
+}
+
+/*
+ * Function 'readSampleHistory': copies a recent sample of a sensor without locking.
+ * 
+ * Note:    Fails if the sample is not published yet or has been overwritten
+ *          by a newer one (more than SAMPLE_HISTORY_SIZE samples behind).
+ */
+int readSampleHistory(struct SensorContext *sensor, uint64_t seq, struct LatestSample *sample) {
+    
+    int error = 0;
+    struct LatestSample *slot = &(sensor->sampleHistory[seq & (SAMPLE_HISTORY_SIZE - 1)]);
+    
+    if((seq == 0) || (__atomic_load_n(&(slot->seq), __ATOMIC_ACQUIRE) != seq)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    sample->timeUs = slot->timeUs;
+    sample->temp = slot->temp;
+    sample->hum = slot->hum;
+    sample->press = slot->press;
+    sample->configVersion = slot->configVersion;
+    
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if(__atomic_load_n(&(slot->seq), __ATOMIC_RELAXED) != seq) {
+        
+        error = -1;
+        return error;
+    }
+    
+    sample->seq = seq;
+    
+    return error;
+}
+
+/*
+ * Function 'createSampleFeed': creates the shared memory feed of the latest samples.
+ * 
+ * Note:    Local processes (e.g. a display or a fan controller) map the POSIX shared
+ *          memory object read-only and read the latest sample and a short history
+ *          of every sensor without syscalls, authentication or server CPU time.
+ *          Call before the measure threads are started. The magic number is written
+ *          last, so readers never see a partly initialized segment.
+ */
+int createSampleFeed(const char *feedName) {
+    
+    struct FeedSegment *segment = MAP_FAILED;
+    int feedFd;
+    int error = 0;
+    int i;
+    
+    /* Start from a fresh object (left over if the server was killed) */
+    shm_unlink(feedName);
+    
+    feedFd = shm_open(feedName, O_CREAT | O_EXCL | O_RDWR, SAMPLE_FEED_MODE);
+    if(feedFd >= 0) {
+        
+        /* Mode independent of umask, zero filled segment */
+        if((0 == fchmod(feedFd, SAMPLE_FEED_MODE)) && (0 == ftruncate(feedFd, sizeof(struct FeedSegment)))) {
+            
+            segment = mmap(NULL, sizeof(struct FeedSegment), PROT_READ | PROT_WRITE, MAP_SHARED, feedFd, 0);
+        }
+        
+        close(feedFd);
+    }
+    
+    if(MAP_FAILED == segment) {
+        
+        /* Failed to create shared memory feed */
+#ifdef SERVER_DEBUG
+        perror("shm_open");
+        fflush(stderr);
+#endif
+        logEvent(LOG_WARNING, LOG_SYS_WARN_SERVER_FEED_FAIL, feedName);
+        
+        shm_unlink(feedName);
+        
+        error = -1;
+        return error;
+    }
+    
+    segment->version = SAMPLE_FEED_VERSION;
+    segment->sensorCount = sensorCount;
+    segment->historySize = SAMPLE_FEED_HISTORY_SIZE;
+    for(i = 0; i < sensorCount; i++) {
+        
+        sensorArray[i].feed = &(segment->sensor[i]);
+    }
+    
+    __atomic_store_n(&(segment->magic), SAMPLE_FEED_MAGIC, __ATOMIC_RELEASE);
+    sampleFeed = segment;
+    
+    logEvent(LOG_INFO, LOG_SYS_INFO_SERVER_FEED, feedName);
+    
+    return error;
+}
+
+/*
+ * Function 'removeSampleFeed': removes the shared memory feed of the latest samples.
+ * 
+ * Note:    Readers still mapping the segment see the cleared magic number. The
+ *          segment stays mapped as measure threads may still publish into it.
+ */
+void removeSampleFeed(const char *feedName) {
+    
+    if(NULL == sampleFeed) {
+        
+        return;
+    }
+    
+    __atomic_store_n(&(sampleFeed->magic), 0, __ATOMIC_RELEASE);
+    shm_unlink(feedName);
+}
+
+/*
+ * Function 'openUnixServerSocket': listens for local clients on a Unix domain socket.
+ * 
+ * Note:    Local clients speak the same protocol as TCP ones without the TCP/IP
+ *          stack. A socket file left by a previous run is replaced, other files
+ *          are not. Failure is not fatal: the server keeps serving TCP clients
+ *          (unixServerSocket stays -1).
+ */
+int openUnixServerSocket(const char *socketPath) {
+    
+    struct sockaddr_un unixAddress;
+    struct stat pathStat;
+    int unixSocket;
+    int error = 0;
+    
+    if(strlen(socketPath) >= sizeof(unixAddress.sun_path)) {
+        
+        logEvent(LOG_WARNING, LOG_SYS_WARN_SERVER_UNIX_FAIL, socketPath);
+        
+        error = -1;
+        return error;
+    }
+    
+    memset(&unixAddress, 0, sizeof(unixAddress));
+    unixAddress.sun_family = AF_UNIX;
+    strcpy(unixAddress.sun_path, socketPath);
+    
+    /* Remove stale socket of a previous run */
+    if((0 == lstat(socketPath, &pathStat)) && S_ISSOCK(pathStat.st_mode)) {
+        
+        unlink(socketPath);
+    }
+    
+    unixSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(unixSocket < 0) {
+        
+#ifdef SERVER_DEBUG
+        perror("socket");
+        fflush(stderr);
+#endif
+        logEvent(LOG_WARNING, LOG_SYS_WARN_SERVER_UNIX_FAIL, socketPath);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Any local user may connect, clients authenticate as on TCP */
+    if((bind(unixSocket, (struct sockaddr*)&unixAddress, sizeof(unixAddress)) < 0) ||
+       (chmod(socketPath, SERVER_UNIX_MODE) < 0) ||
+       (listen(unixSocket, SERVER_PENDING_QUEUE_LIMIT) < 0)) {
+        
+#ifdef SERVER_DEBUG
+        perror("bind");
+        fflush(stderr);
+#endif
+        logEvent(LOG_WARNING, LOG_SYS_WARN_SERVER_UNIX_FAIL, socketPath);
+        close(unixSocket);
+        
+        error = -1;
+        return error;
+    }
+    
+    unixServerSocket = unixSocket;
+    
+    logEvent(LOG_INFO, LOG_SYS_INFO_SERVER_UNIX, socketPath);
+    
+    return error;
+}
+
+/*
+ * Function 'openSampleMulticast': opens the UDP multicast feed of the latest samples.
+ * 
+ * Note:    Each new sample is sent once to an IPv4 multicast group (default port
+ *          SAMPLE_MCAST_PORT) instead of once per client session. The interface
+ *          address selects the outgoing interface, e.g. 127.0.0.1 keeps the feed on
+ *          this host. Call before the measure threads are started. Failure is not
+ *          fatal: the server runs without the feed (sampleMcastSocket stays -1).
+ */
+int openSampleMulticast(const char *groupAddress, const char *interfaceAddress) {
+    
+    char groupName[INET_ADDRSTRLEN];
+    const char *portName = strchr(groupAddress, ':');
+    unsigned long port = SAMPLE_MCAST_PORT;
+    char *end = NULL;
+    int mcastSocket;
+    int ttl = SAMPLE_MCAST_TTL;
+    int loop = 1;
+    int error = 0;
+    
+    struct sockaddr_in groupSockAddr;
+    struct in_addr interfaceAddr;
+    
+    memset(&groupSockAddr, 0, sizeof(groupSockAddr));
+    groupSockAddr.sin_family = AF_INET;
+    
+    /* Split group address and port */
+    memset(groupName, 0, sizeof(groupName));
+    strncpy(groupName, groupAddress, sizeof(groupName) - 1);
+    if(NULL != portName) {
+        
+        if((size_t)(portName - groupAddress) < sizeof(groupName)) {
+            
+            groupName[portName - groupAddress] = '\0';
+        }
+        
+        port = strtoul(portName + 1, &end, 10);
+    }
+    
+    if(((NULL != end) && (('\0' != *end) || (end == portName + 1))) || (0 == port) || (port > UINT16_MAX) ||
+       (1 != inet_pton(AF_INET, groupName, &(groupSockAddr.sin_addr))) ||
+       !IN_MULTICAST(ntohl(groupSockAddr.sin_addr.s_addr)) ||
+       ((NULL != interfaceAddress) && (1 != inet_pton(AF_INET, interfaceAddress, &interfaceAddr)))) {
+        
+        /* Invalid multicast group or interface */
+        logEvent(LOG_WARNING, LOG_SYS_WARN_SERVER_MCAST_FAIL, groupAddress);
+        
+        error = -1;
+        return error;
+    }
+    
+    groupSockAddr.sin_port = htons((uint16_t)port);
+    
+    mcastSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    if(mcastSocket < 0) {
+        
+#ifdef SERVER_DEBUG
+        perror("socket");
+        fflush(stderr);
+#endif
+        logEvent(LOG_WARNING, LOG_SYS_WARN_SERVER_MCAST_FAIL, groupAddress);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receivers on this host get the datagrams as well */
+    if((setsockopt(mcastSocket, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0) ||
+       (setsockopt(mcastSocket, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0) ||
+       ((NULL != interfaceAddress) &&
+        (setsockopt(mcastSocket, IPPROTO_IP, IP_MULTICAST_IF, &interfaceAddr, sizeof(interfaceAddr)) < 0)) ||
+       (connect(mcastSocket, (struct sockaddr*)&groupSockAddr, sizeof(groupSockAddr)) < 0)) {
+        
+#ifdef SERVER_DEBUG
+        perror("setsockopt");
+        fflush(stderr);
+#endif
+        logEvent(LOG_WARNING, LOG_SYS_WARN_SERVER_MCAST_FAIL, groupAddress);
+        close(mcastSocket);
+        
+        error = -1;
+        return error;
+    }
+    
+    sampleMcastStreamId = (uint32_t)time(NULL);
+    sampleMcastSocket = mcastSocket;
+    
+    logEvent(LOG_INFO, LOG_SYS_INFO_SERVER_MCAST, groupName, (unsigned int)port);
+    
+    return error;
+}
+
+/*
+ * Function 'clientHandler': interprets and forwards client requests.
+ * 
+ * Note:    The clientHandler will notify client in case of: 
+ *          granted permission, denied permission, invalid permission and
+ *          failure in request handling.
+ *          
+ *          The handler functions should not notify clients in case of
+ *          failure in request handling (server side error). Instead signal
+ *          the errors with their return value and let the main clientHandler
+ *          deal with it. Handler functions may notify clients of successful
+ *          request handlings (protocol defined).
+ */
+int clientHandler(int serviceSocket, const struct UserData *user, struct ClientSession *session) {
+    
+    uint8_t requestCode;
+    uint8_t response;
+    uint64_t dispatchNs;            // Request code received [nsec]
+    uint64_t startNs;               // Start of request handling [nsec]
+    uint64_t endNs;
+    int iReq;
+    int len;
+    int error = 0;
+    
+    /* Check user and session argument */
+    if((NULL == user) || (NULL == session)) {
+        
+        /* Invalid user or session argument */
+        logEvent(LOG_ERR, LOG_SYS_ERR_INVALID_ARGS);
+        error = -1;
+        return error;
+    }
+    
+    /* Check client socket argument */
+    if(serviceSocket < 0) {
+        
+        /* Invalid client socket argument */
+        logEvent(LOG_ERR, LOG_SYS_ERR_INVALID_SOCK);
+        error = -1;
+        return error;
+    }
+    
+    /* Receive client request */
+    len = recv(serviceSocket, &requestCode, sizeof(requestCode), MSG_WAITALL);
+    if(len < 0) {
+        
+        /* Failed to receive client request */
+#ifdef SERVER_DEBUG
+        perror("recv");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_RECV_FAIL);
+        
+        error = -1;
+        return error;
+    }
+    
+    dispatchNs = getMetricTimeNs();
+    SERVER_PROBE1(request__start, requestCode);
+  
+    /* Identify client request */
+    for(iReq = 0; iReq < REQ_ARRAY_SIZE; iReq++) {
+         
+        if(requestArray[iReq].requestCode == requestCode) {
+                
+            /* Client request code identified */
+                
+            /* Check user permission */
+            if(requestArray[iReq].lowestGroupe <= user->groupe) {
+                    
+                /* Permission granted */
+                    
+                /* Notify client (permission granted) */
+                response = RES_CODE_REQ_ACCEPT;
+                len = send(serviceSocket, &response, sizeof(response), MSG_NOSIGNAL);
+                if(len < 0) {
+                        
+                    /* Failed to send server response to client */
+#ifdef SERVER_DEBUG
+                    perror("send");
+                    fflush(stderr);
+#endif
+                    logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
+                    error = -1;
+                }
+                    
+                /* Invoke request handler */
+                startNs = getMetricTimeNs();
+                SERVER_PROBE2(handler__entry, requestCode, session->sensorSel);
+                error = requestArray[iReq].requestHandler(serviceSocket, user, session);
+                endNs = getMetricTimeNs();
+                SERVER_PROBE3(handler__return, requestCode, error, endNs - startNs);
+                recordMetricValue(METRIC_HIST_REQUEST + iReq, endNs - startNs);
+                traceSpan(TRACE_SPAN_HANDLER, requestCode, startNs, endNs);
+                traceSpan(TRACE_SPAN_REQUEST, requestCode, dispatchNs, endNs);
+                addMetricCounter(STATS_CNT_REQ, 1);
+                if(error != 0) {
+                    
+                    addMetricCounter(STATS_CNT_REQ_FAIL, 1);
+                    addMetricCounter(METRIC_CNT_REQ_CODE_FAIL + iReq, 1);
+                        
+                    /* Failed to accomplish client request */
+                    logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_FAIL, user->name, requestCode);
+                        
+                    /* Notify client (failed to accomplish request) */
+                    response = RES_CODE_REQ_FAIL;
+                    len = send(serviceSocket, &response, sizeof(response), MSG_NOSIGNAL);
+                    if(len < 0) {
+                        
+                        /* Failed to send server response to client */
+#ifdef SERVER_DEBUG
+                        perror("send");
+                        fflush(stderr);
+#endif
+                        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
+                        error = -1;
+                        return error;
+                    }
+                }
+                    
+                // Q: Shall we notify the client here about the success ? (RES_CODE_REQ_SUCCESS)
+                // A: No. Success shall be notified inside handler.
+            }
+            else {
+                    
+                /* Permission denied */
+                addMetricCounter(METRIC_CNT_REQ_CODE_DENIED + iReq, 1);
+                logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_NO_PERM, user->name, requestCode);
+                    
+                /* Notify client (no permission) */
+                response = RES_CODE_REQ_NO_PERM;
+                len = send(serviceSocket, &response, sizeof(response), MSG_NOSIGNAL);
+                if(len < 0) {
+                        
+                    /* Failed to send server response to client */
+#ifdef SERVER_DEBUG
+                    perror("send");
+                    fflush(stderr);
+#endif
+                    logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
+                    error = -1;
+                }
+            }
+                
+            SERVER_PROBE2(request__done, requestCode, error);
+            
+            /* No need to keep looking for other request codes */
+            return error;
+        }
+    }
+    
+    /* Could not identify client request code */
+    addMetricCounter(METRIC_CNT_REQ_INVALID, 1);
+    
+    /* Notify client (invalid request code) */
+    response = RES_CODE_REQ_INVALID;
+    len = send(serviceSocket, &response, sizeof(response), MSG_NOSIGNAL);
+    if(len < 0) {
+                        
+        /* Failed to send server response to client */
+#ifdef SERVER_DEBUG
+        perror("send");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
+        error = -1;
+    }
+    
+    SERVER_PROBE2(request__done, requestCode, error);
+    
+    return error;
+}
+
+/*
+ * Function 'disconnectHandler': handles disconnection requested by client.
+ * 
+ * Protocol:    Client --> Server: disconnect request code <1 byte>
+ */
+int disconnectHandler(int clientSocket, const struct UserData *user, void *customArg) {
+    
+    int error = 0;
+    struct ClientSession *session = (struct ClientSession*)customArg;
+    
+    session->serviceStopCondition = COND_SERVICE_STOP_TRUE;
+    
+    /* Let the main service thread (serviceThreadFunction) close the socket */
+    
+    /* Syslog client requested disconnection */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_DISCONN, user->name);
+    
+    return error;
+}
+
+/*
+ * Function 'setConfigHandler': sets new sensor configuration requested by client.
+ * 
+ * Note:        Notify the client in case of successful request handling.
+ * 
+ * Protocol:    Client --> Server: set configuration request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: configuration parameters <1 byte>
+ *              Client --> Server: period value <4 bytes> (only for period config, seconds)
+ *              Client --> Server: period value <4 bytes> (only for microsecond period config)
+ *              Client <-- Server: result of request processing <1 byte>
+ */
+int setConfigHandler(int clientSocket, const struct UserData *user, void *customArg) {
+    
+    uint8_t config = 0;             // Sensor configuration
+    uint8_t response = 0;           // Server response
+    int error = 0;
+    int len;
+    int period = 0;                 // Sampling period [sec]
+    uint32_t periodUs = 0;          // Sampling period [usec]
+    uint32_t value = 0;             // Config value
+    
+    struct ConfigUpdate update;     // Validated config
+    
+    struct SensorContext *sensor = &(sensorArray[((struct ClientSession*)customArg)->sensorSel]);   // Selected sensor
+    
+    /* Syslog client requested to set sensor configuration */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_SET_CONF, user->name);
+    
+    /* Get sensor config from client */
+    len = recv(clientSocket, &config, sizeof(config), MSG_WAITALL);
+    if(len < 0) {
+        
+        /* Failed to receive client config request */
+#ifdef SERVER_DEBUG
+        perror("recv");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_CONF_FAIL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Receive period value from client based on config */
     if(REQ_CONF_PRD == (config & REQ_CONF_TYPE_MASK)) {
         
-        /* Get sensor config from client */
-        len = recv(clientSocket, &period, sizeof(period), MSG_WAITALL);
-        if(len < 0) {
+        /* Get sensor config from client */
+        len = recv(clientSocket, &period, sizeof(period), MSG_WAITALL);
+        if(len < 0) {
+        
+            /* Failed to receive period value from client */
+#ifdef SERVER_DEBUG
+            perror("recv");
+            fflush(stderr);
+#endif
+            logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_RECV_FAIL);
+        
+            error = -1;
+            return error;
+        }
+    }
+    else if(REQ_CONF_PRD_US == (config & REQ_CONF_TYPE_MASK)) {
+        
+        /* Get microsecond period value from client */
+        len = recv(clientSocket, &periodUs, sizeof(periodUs), MSG_WAITALL);
+        if(len < 0) {
+        
+            /* Failed to receive period value from client */
+#ifdef SERVER_DEBUG
+            perror("recv");
+            fflush(stderr);
+#endif
+            logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_RECV_FAIL);
+        
+            error = -1;
+            return error;
+        }
+    }
+    
+    /* Validate client config data */
+    memset(&update, 0, sizeof(update));
+    value = (REQ_CONF_PRD == (config & REQ_CONF_TYPE_MASK)) ? (uint32_t)period : periodUs;
+    if(0 != parseConfigField(config, value, user, &update)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Apply config (single lock and register write) */
+    if(0 != applyConfigUpdate(sensor, &update)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    if(0 == error) {
+     
+        /* Notify client of success */
+        response = RES_CODE_REQ_SUCCESS;
+        len = send(clientSocket, &response, sizeof(response), MSG_NOSIGNAL);
+        if(len < 0) {
+                        
+            /* Failed to send server response to client */
+#ifdef SERVER_DEBUG
+            perror("send");
+            fflush(stderr);
+#endif
+            logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
+            error = -1;
+            return error;
+        }
+        
+    }
+    
+    /* Syslog successful configuration */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_SET_CONF_SUCCESS, user->name);
+    
+    return error;
+}
+
+/*
+ * Function 'getConfigHandler': returns current sensor configuration requested by client.
+ * 
+ * Protocol:    Client --> Server: get configuration request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client <-- Server: period value <8 bytes> (microseconds)
+ *              Client <-- Server: temperature configuration <8 bytes>
+ *              Client <-- Server: humidity configuration <8 bytes>
+ *              Client <-- Server: pressure configuration <8 bytes>
+ *              Client <-- Server: IIR filter configuration <16 bytes>
+ *              Client <-- Server: acquisition mode configuration <8 bytes>
+ * 
+ * Note:    String form of the configuration, kept beside the binary form (getConfigBinHandler).
+ *          Its wire format is not the original one: the period grew to 8 bytes (usec)
+ *          and the acquisition mode was appended, so clients predating sub-second
+ *          periods cannot parse it. The configuration is read from the config
+ *          snapshot and sent at once.
+ */
+int getConfigHandler(int clientSocket, const struct UserData *user, void *customArg) {
+    
+    uint8_t response = 0;                       // Not used
+    int error = 0;
+    int len;
+    
+    struct ConfigSnapshot snapshot;             // Copy of sensor configuration
+    
+    /* Config message: period, TMP, HUM, PRS, IIR and mode configs */
+    struct {
+        
+        uint64_t measPeriodUs;
+        char tmpConfMsg[RES_STR_SCONF_LEN];
+        char humConfMsg[RES_STR_SCONF_LEN];
+        char prsConfMsg[RES_STR_SCONF_LEN];
+        char iirFltrConfMsg[RES_STR_SCONF_IIR_LEN];
+        char modeConfMsg[RES_STR_SCONF_LEN];
+    } __attribute__((packed)) confMsg;
+    
+    struct SensorContext *sensor = &(sensorArray[((struct ClientSession*)customArg)->sensorSel]);   // Selected sensor
+    
+    /* Initialize local variables */
+    memset(&confMsg, 0, sizeof(confMsg));
+    
+    /* Syslog client requested to get sensor configuration */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_GET_CONF, user->name);
+    
+    /* Copy config settings values */
+    readConfigSnapshot(sensor, &snapshot);
+    
+    // PERIOD   <VAL>
+    // TEMP     <X|OS_OFF|OS_1X|OS_2X|OS_4X|OS_8X|OS_16X>
+    // HUM                      -,,-
+    // PRESS                    -,,-
+    // IIR      <X|COEFF_OFF|COEFF_2|COEFF_4|COEFF_8|COEFF_16>
+    // MODE     <FORCED|NORMAL>
+    
+    confMsg.measPeriodUs = snapshot.measPeriodUs;
+    strcpy(confMsg.tmpConfMsg, getConfigString(snapshot.settingSel & BME280_OSR_TEMP_SEL, snapshot.osrT,
+           confOversamplingStrTable, sizeof(confOversamplingStrTable) / sizeof(confOversamplingStrTable[0])));
+    strcpy(confMsg.humConfMsg, getConfigString(snapshot.settingSel & BME280_OSR_HUM_SEL, snapshot.osrH,
+           confOversamplingStrTable, sizeof(confOversamplingStrTable) / sizeof(confOversamplingStrTable[0])));
+    strcpy(confMsg.prsConfMsg, getConfigString(snapshot.settingSel & BME280_OSR_PRESS_SEL, snapshot.osrP,
+           confOversamplingStrTable, sizeof(confOversamplingStrTable) / sizeof(confOversamplingStrTable[0])));
+    strcpy(confMsg.iirFltrConfMsg, getConfigString(snapshot.settingSel & BME280_FILTER_SEL, snapshot.filter,
+           confFilterStrTable, sizeof(confFilterStrTable) / sizeof(confFilterStrTable[0])));
+    strcpy(confMsg.modeConfMsg, (BME280_NORMAL_MODE == snapshot.modeSel) ? RES_STR_SCONF_MODE_NORMAL : RES_STR_SCONF_MODE_FORCED);
+    
+    /* Send config message */
+    len = send(clientSocket, &confMsg, sizeof(confMsg), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send config to client */
+#ifdef SERVER_DEBUG
+        perror("send");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_CONF_SEND_FAIL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Syslog successful config data transmission */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_GET_CONF_SUCCESS, user->name);
+    
+    return error;
+}
+
+/*
+ * Function 'getConfigBinHandler': returns current sensor configuration in binary form requested by client.
+ * 
+ * Protocol:    Client --> Server: get binary configuration request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client <-- Server: config version <4 bytes>
+ *              Client <-- Server: period value <8 bytes> (microseconds)
+ *              Client <-- Server: temperature configuration <1 byte>
+ *              Client <-- Server: humidity configuration <1 byte>
+ *              Client <-- Server: pressure configuration <1 byte>
+ *              Client <-- Server: IIR filter configuration <1 byte>
+ *              Client <-- Server: acquisition mode configuration <1 byte>
+ * 
+ * Note:    Configurations are encoded like the set configuration requests (type,
+ *          status and value, see REQ_CONF_...), the client renders them. The config
+ *          version changes on every configuration update.
+ */
+int getConfigBinHandler(int clientSocket, const struct UserData *user, void *customArg) {
+    
+    int error = 0;
+    int len;
+    
+    struct ConfigSnapshot snapshot;             // Copy of sensor configuration
+    uint8_t confMsg[RES_GCONFB_LEN];            // Binary config message
+    uint8_t *pConf = confMsg;
+    
+    struct SensorContext *sensor = &(sensorArray[((struct ClientSession*)customArg)->sensorSel]);   // Selected sensor
+    
+    /* Syslog client requested to get sensor configuration */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_GET_CONF, user->name);
+    
+    /* Copy config settings values */
+    readConfigSnapshot(sensor, &snapshot);
+    
+    /* Encode config message */
+    memcpy(pConf, &(snapshot.version), sizeof(snapshot.version));
+    pConf += sizeof(snapshot.version);
+    memcpy(pConf, &(snapshot.measPeriodUs), sizeof(snapshot.measPeriodUs));
+    pConf += sizeof(snapshot.measPeriodUs);
+    *pConf++ = getConfigParam(REQ_CONF_TMP, snapshot.settingSel & BME280_OSR_TEMP_SEL, snapshot.osrT);
+    *pConf++ = getConfigParam(REQ_CONF_HUM, snapshot.settingSel & BME280_OSR_HUM_SEL, snapshot.osrH);
+    *pConf++ = getConfigParam(REQ_CONF_PRS, snapshot.settingSel & BME280_OSR_PRESS_SEL, snapshot.osrP);
+    *pConf++ = getConfigParam(REQ_CONF_IIR, snapshot.settingSel & BME280_FILTER_SEL, snapshot.filter);
+    *pConf++ = getConfigParam(REQ_CONF_MODE, BME280_NORMAL_MODE == snapshot.modeSel, 0);
+    
+    /* Send config message */
+    len = send(clientSocket, confMsg, sizeof(confMsg), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send config to client */
+#ifdef SERVER_DEBUG
+        perror("send");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_CONF_SEND_FAIL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Syslog successful config data transmission */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_GET_CONF_SUCCESS, user->name);
+    
+    return error;
+}
+
+/*
+ * Function 'removeDataHandler': removes measurement data requested by client.
+ * 
+ * Protocol:    Client --> Server: remove measurement data request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client <-- Server: result of request processing <1 byte>
+ */
+int removeDataHandler(int clientSocket, const struct UserData *user, void *customArg) {
+    
+    uint8_t response = 0;
+    int error = 0;
+    int len;
+    
+    struct SensorContext *sensor = &(sensorArray[((struct ClientSession*)customArg)->sensorSel]);   // Selected sensor
+    
+    /* Syslog client requested to remove measurement data */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_RMV_DATA, user->name);
+    
+    /* Check if file is open (= has content) */
+    
+    SAVED_DATA_MUTEX_LOCK(sensor);
+    
+    /* Drop records not yet written to file */
+    sensor->savedDataBufCount = 0;
+    
+    if(sensor->savedDataFd < 0) {
+        
+        /* File is closed (does not have content) */
+        
+        /* Nothing to do */
+        SAVED_DATA_MUTEX_UNLOCK(sensor);
+    }
+    else {
+        
+        /* File is open (does have content) */
+        
+        /* Remove content of file by recreating it (transfers in progress finish on the old one) */
+    
+        /* Close file */
+        if(close(sensor->savedDataFd) < 0) {
+            
+#ifdef SERVER_DEBUG
+            perror("close");
+            fprintf(stderr, LOG_SYS_ERR_SERVER_RMV_DATA_FAIL, user->name);
+            fflush(stderr);
+#endif
+            logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_CLOSE_FAIL);
+            logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_RMV_DATA_FAIL, user->name);
+            
+            SAVED_DATA_MUTEX_UNLOCK(sensor);
+            error = -1;
+            return error;
+        }
+        
+        sensor->savedDataFd = SAVED_DATA_FD_INVALID;
+        
+        /* Open file */
+        sensor->savedDataFd = createSavedFile(sensor->savedDataFilePath, O_RDWR);
+        if(sensor->savedDataFd < 0) {
+                    
+#ifdef SERVER_DEBUG
+            perror("open");
+            fprintf(stderr, LOG_SYS_ERR_SERVER_RMV_DATA_FAIL, user->name);
+            fflush(stderr);
+#endif
+            logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_OPEN_FAIL);
+            logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_RMV_DATA_FAIL, user->name);
+            
+            SAVED_DATA_MUTEX_UNLOCK(sensor);
+            error = -1;
+            return error;
+        }
+        
+        /* Empty the column files as well (also resyncs them after a failure) */
+        openSavedColumns(sensor);
+        
+        /* At this point the content of the file is removed */
+        
+        SAVED_DATA_MUTEX_UNLOCK(sensor);
+    }
+    
+    /* Syslog success */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_RMV_DATA_SUCCESS, user->name);
+    
+    /* Notify client on success */
+    response = RES_CODE_REQ_SUCCESS;
+    len = send(clientSocket, &response, sizeof(response), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send server response to client */
+#ifdef SERVER_DEBUG
+        perror("send");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
+        error = -1;
+    }
+
+    return error;
+}
+
+/*
+ * Function 'getDataHandler': returns measurement data requested by client.
+ * 
+ * Note:        savedDataMutex is held only while the buffered records are written out
+ *              and the file size is taken, the file is sent from a duplicate of its
+ *              descriptor (see createSavedFile), so sampling goes on meanwhile.
+ * 
+ * Protocol:    Client --> Server: transfer measurement data request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client <-- Server: file size <4 bytes>
+ *              Client <-- Server: file content <<file size> bytes>  (if not empty)
+ */
+int getDataHandler(int clientSocket, const struct UserData *user, void *customArg) {
+    
+    uint8_t response = 0;           // Not used
+    int error = 0;                  // Error indicator
+    int len;
+    int fileSize = 0;               // Measurement data file size
+    
+    int sendFd = -1;                // Duplicate of the saved data file descriptor
+    
+    off_t fileOffset = 0;
+    struct stat fileStat;
+    uint64_t startNs;
+    
+    int sensorSel = ((struct ClientSession*)customArg)->sensorSel;
+    struct SensorContext *sensor = &(sensorArray[sensorSel]);       // Selected sensor
+    
+    /* Syslog client requested to get measurement data */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_GET_DATA, user->name);
+    
+    /* Take the records measured so far and a descriptor to send them from */
+    
+    startNs = getMetricTimeNs();
+    SAVED_DATA_MUTEX_LOCK(sensor);
+    traceSpan(TRACE_SPAN_LOCK_WAIT, sensorSel, startNs, getMetricTimeNs());
+    
+    /* Write out buffered records so the client gets every sample measured so far */
+    flushSavedData(sensor);
+    
+    if(sensor->savedDataFd < 0) {
+     
+        /* Saved data file is closed */
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_FCONT_ACCESS_FAIL, user->name);
+        
+        // TODO Enhance security by sending client an invalid size
+        
+        SAVED_DATA_MUTEX_UNLOCK(sensor);
+        error = -1;
+        return error;
+    }
+    
+    /* Get file stat including file size */
+    if(0 > fstat(sensor->savedDataFd, &fileStat)) {
+        
+        /* Failed to get file stat */
+#ifdef SERVER_DEBUG
+        perror("fstat");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_FSTAT_GET_FAIL);
+        
+        // TODO Enhance security by sending client an invalid size
+        
+        SAVED_DATA_MUTEX_UNLOCK(sensor);
+        error = -1;
+        return error;
+    }
+    
+    /* Send from a duplicate: the measure thread keeps appending during the transfer */
+    sendFd = dup(sensor->savedDataFd);
+    
+    SAVED_DATA_MUTEX_UNLOCK(sensor);
+    
+    if(sendFd < 0) {
+        
+        /* Failed to duplicate saved data file descriptor */
+#ifdef SERVER_DEBUG
+        perror("dup");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_FCONT_ACCESS_FAIL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    fileSize = fileStat.st_size;
+    
+    /* Send file size to client */
+    len = send(clientSocket, &fileSize, sizeof(fileSize), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send file size to client */
+#ifdef SERVER_DEBUG
+        perror("send");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_FSIZE_SEND_FAIL, user->name);
+        
+        close(sendFd);
+        error = -1;
+        return error;
+    }
+    
+    /* If file size is 0 kB do not send anything */
+    /* Client will receive size and do so */
+    
+    /* Send file content to client (records appended meanwhile are left for the next request) */
+    startNs = getMetricTimeNs();
+    while((0 == error) && (fileOffset < fileSize)) {
+        
+        len = sendfile(clientSocket, sendFd, &fileOffset, fileSize - fileOffset);
+        if(len <= 0) {
+         
+            /* Failed to send file content to client */
+#ifdef SERVER_DEBUG
+            perror("sendfile");
+            fflush(stderr);
+#endif
+            logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_FCONT_SEND_FAIL, user->name);
+            
+            /* Client expects the rest of the file: end the session instead of a result code in the stream */
+            shutdown(clientSocket, SHUT_RDWR);
+            error = -1;
+        }
+    }
+    traceSpan(TRACE_SPAN_SEND, sensorSel, startNs, getMetricTimeNs());
+    
+    close(sendFd);
+    
+    /* Syslog successful data transfer */
+    if(0 == error) {
+        
+        recordMetricValue(METRIC_HIST_GDAT_BYTES, sizeof(fileSize) + (uint64_t)fileOffset);
+        addMetricCounter(STATS_CNT_GDAT_BYTES, sizeof(fileSize) + (uint64_t)fileOffset);
+        logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_GET_DATA_SUCCESS, user->name);
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'selectSensorHandler': selects the sensor subsequent requests of the client refer to.
+ * 
+ * Note:        Notify the client in case of successful request handling.
+ *              Configuration and data requests (SCONF, GCONF, RMDAT, GDAT)
+ *              refer to the selected sensor (SENSOR_SEL_DEFAULT after login).
+ * 
+ * Protocol:    Client --> Server: select sensor request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: sensor ID <1 byte>
+ *              Client <-- Server: result of request processing <1 byte>
+ */
+int selectSensorHandler(int clientSocket, const struct UserData *user, void *customArg) {
+    
+    uint8_t sensorSel = 0;          // Requested sensor ID
+    uint8_t response = 0;           // Server response
+    int error = 0;
+    int len;
+    
+    struct ClientSession *session = (struct ClientSession*)customArg;
+    
+    /* Get sensor ID from client */
+    len = recv(clientSocket, &sensorSel, sizeof(sensorSel), MSG_WAITALL);
+    if(len < (int)sizeof(sensorSel)) {
+        
+        /* Failed to receive sensor ID */
+#ifdef SERVER_DEBUG
+        perror("recv");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_RECV_FAIL);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Check sensor ID */
+    if(sensorSel >= sensorCount) {
+        
+        /* Sensor not configured */
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_SENS_INVAL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    session->sensorSel = sensorSel;
+    
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_SEL_SENS, session->sensorSel, user->name);
+    
+    /* Notify client (request succeeded) */
+    response = RES_CODE_REQ_SUCCESS;
+    len = send(clientSocket, &response, sizeof(response), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send server response to client */
+#ifdef SERVER_DEBUG
+        perror("send");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
+        error = -1;
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'listSensorsHandler': returns the list of sensors requested by client.
+ * 
+ * Protocol:    Client --> Server: list sensors request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client <-- Server: number of sensors <1 byte>
+ *              Client <-- Server: sensor descriptions <<number of sensors> * 64 bytes>
+ *                                 ("<ID>: <transport> <I2C device or trace file> <I2C address>")
+ */
+int listSensorsHandler(int clientSocket, const struct UserData *user, void *customArg) {
+    
+    uint8_t count = (uint8_t)sensorCount;      // Number of sensors
+    int error = 0;
+    int i;
+    int len;
+    
+    char sensorDesc[SENSOR_ARRAY_SIZE][SENSOR_DESC_LEN];
+    struct SensorContext *sensor = NULL;
+    
+    /* Syslog client requested to list sensors */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_LIST_SENS, user->name);
+    
+    /* Describe sensors (transport configuration is constant after startup) */
+    memset(sensorDesc, 0, sizeof(sensorDesc));
+    for(i = 0; i < sensorCount; i++) {
+        
+        sensor = &(sensorArray[i]);
+        snprintf(sensorDesc[i], SENSOR_DESC_LEN, "%d: %s %s 0x%02x", i, sensor->sensorId.transport_name,
+                 sensor->sensorId.bus_path, sensor->sensorId.dev_addr);
+    }
+    
+    /* Send sensor list */
+    len = send(clientSocket, &count, sizeof(count), MSG_NOSIGNAL);
+    if(len >= 0) {
+        
+        len = send(clientSocket, sensorDesc, count * SENSOR_DESC_LEN, MSG_NOSIGNAL);
+    }
+    if(len < 0) {
+        
+        /* Failed to send sensor list */
+#ifdef SERVER_DEBUG
+        perror("send");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_SENS_LIST_SEND_FAIL, user->name);
+        
+        error = -1;
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'multiConfigHandler': sets several sensor configurations requested by client at once.
+ * 
+ * Note:        Notify the client in case of successful request handling.
+ *              All fields are validated before any of them is applied: either
+ *              the whole request takes effect or none of it. The sensor registers
+ *              are written with a single burst and one response is sent.
+ * 
+ * Protocol:    Client --> Server: multi-config request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: number of config fields <1 byte> (1 .. REQ_MCONF_FIELDS_MAX)
+ *              Client --> Server: config fields <<number of config fields> * 5 bytes>
+ *                                 (configuration parameters <1 byte>, value <4 bytes> as in SCONF,
+ *                                 value is ignored for configs other than the period)
+ *              Client <-- Server: result of request processing <1 byte>
+ */
+int multiConfigHandler(int clientSocket, const struct UserData *user, void *customArg) {
+    
+    uint8_t count = 0;              // Number of config fields
+    uint8_t response = 0;           // Server response
+    uint8_t fieldBuf[REQ_MCONF_FIELDS_MAX * REQ_MCONF_FIELD_LEN];
+    uint32_t value = 0;             // Config value
+    int error = 0;
+    int i;
+    int len;
+    
+    struct ConfigUpdate update;     // Validated config
+    struct SensorContext *sensor = &(sensorArray[((struct ClientSession*)customArg)->sensorSel]);   // Selected sensor
+    
+    /* Get number of config fields from client */
+    len = recv(clientSocket, &count, sizeof(count), MSG_WAITALL);
+    if((len < (int)sizeof(count)) || (0 == count) || (count > REQ_MCONF_FIELDS_MAX)) {
+        
+        /* Failed to receive client config request */
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_CONF_FAIL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Syslog client requested to set sensor configuration */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_MULTI_CONF, count, user->name);
+    
+    /* Get config fields from client */
+    len = recv(clientSocket, fieldBuf, count * REQ_MCONF_FIELD_LEN, MSG_WAITALL);
+    if(len < (int)(count * REQ_MCONF_FIELD_LEN)) {
+        
+        /* Failed to receive client config request */
+#ifdef SERVER_DEBUG
+        perror("recv");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_CONF_FAIL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Validate every field before applying any (later fields override earlier ones) */
+    memset(&update, 0, sizeof(update));
+    for(i = 0; i < count; i++) {
+        
+        memcpy(&value, &(fieldBuf[i * REQ_MCONF_FIELD_LEN + 1]), sizeof(value));
+        if(0 != parseConfigField(fieldBuf[i * REQ_MCONF_FIELD_LEN], value, user, &update)) {
+            
+            error = -1;
+            return error;
+        }
+    }
+    
+    /* Apply config (single lock and register write) */
+    if(0 != applyConfigUpdate(sensor, &update)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Notify client of success */
+    response = RES_CODE_REQ_SUCCESS;
+    len = send(clientSocket, &response, sizeof(response), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send server response to client */
+#ifdef SERVER_DEBUG
+        perror("send");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Syslog successful configuration */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_SET_CONF_SUCCESS, user->name);
+    
+    return error;
+}
+
+/*
+ * Function 'aggregateDataHandler': returns aggregates of the measurement data requested by client.
+ * 
+ * Note:        The saved data file is scanned without holding savedDataMutex
+ *              (see openSavedDataScan). Disabled channels (SAVED_DATA_INVALID_VALUE) are not aggregated.
+ * 
+ * Protocol:    Client --> Server: aggregate data request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: start of time range <8 bytes> (UNIX time [usec], 0: first record)
+ *              Client --> Server: end of time range <8 bytes> (UNIX time [usec], exclusive, 0: last record)
+ *              Client --> Server: bucket width <8 bytes> ([usec], 0: whole range in one bucket)
+ *              Client --> Server: channels <1 byte> (REQ_AGG_CH_...)
+ *              Client <-- Server: result of request processing <1 byte>
+ * 
+ *              ++ In case of successful request processing ++
+ * 
+ *              Client <-- Server: number of buckets <4 bytes> (0: no data in range)
+ *              Client <-- Server: buckets <<number of buckets> * (8 + <number of channels> * 20) bytes>
+ *                                 (bucket start time <8 bytes> [usec], then for each requested channel
+ *                                 in TMP, HUM, PRS order: count <4 bytes>, min, max, mean, stddev <4 bytes each>)
+ */
+int aggregateDataHandler(int clientSocket, const struct UserData *user, void *customArg) {
+    
+    uint8_t queryBuf[REQ_AGG_LEN];  // Aggregation query
+    uint8_t response = 0;           // Server response
+    uint8_t *resBuf = NULL;         // Aggregates message
+    uint8_t *pRes = NULL;
+    uint64_t recordCount = 0;       // Number of saved records
+    uint64_t firstIndex = 0;        // First record of the time range
+    uint64_t endIndex = 0;          // Record following the time range
+    uint32_t bucketCount = 0;
+    uint32_t channelCount = 0;
+    uint32_t iBucket;
+    uint64_t bucketStartUs;
+    float value;
+    double mean;
+    double var;
+    int scanFd = -1;                // Duplicate of the saved data file descriptor
+    int error = 0;
+    int channel;
+    int len;
+    size_t resLen;
+    
+    struct AggQuery query;
+    struct AggBucket *buckets = NULL;
+    struct AggStats *stats = NULL;
+    struct SensorContext *sensor = &(sensorArray[((struct ClientSession*)customArg)->sensorSel]);   // Selected sensor
+    
+    /* Syslog client requested to aggregate measurement data */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_AGG, user->name);
+    
+    /* Get query from client */
+    len = recv(clientSocket, queryBuf, sizeof(queryBuf), MSG_WAITALL);
+    if(len < (int)sizeof(queryBuf)) {
+        
+        /* Failed to receive client aggregation query */
+#ifdef SERVER_DEBUG
+        perror("recv");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_AGG_FAIL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    memset(&query, 0, sizeof(query));
+    memcpy(&(query.fromUs), &(queryBuf[0]), sizeof(query.fromUs));
+    memcpy(&(query.toUs), &(queryBuf[8]), sizeof(query.toUs));
+    memcpy(&(query.bucketUs), &(queryBuf[16]), sizeof(query.bucketUs));
+    query.channels = queryBuf[24];
+    
+    /* Check channels and time range */
+    if((0 == query.channels) || (query.channels & ~REQ_AGG_CH_MASK) ||
+       ((0 != query.toUs) && (query.toUs <= query.fromUs))) {
+        
+        /* Invalid aggregation query */
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_AGG_INVAL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Take the saved records measured so far and locate the time range */
+    scanFd = openSavedDataScan(sensor, &recordCount);
+    if(scanFd >= 0) {
+        
+        /* Range left empty on failure */
+        resolveSavedRange(scanFd, recordCount, &(query.fromUs), &(query.toUs), &firstIndex, &endIndex);
+    }
+    
+    /* Number of buckets (none if the range holds no records) */
+    if(firstIndex < endIndex) {
+        
+        if(0 == query.bucketUs) {
+            
+            bucketCount = 1;
+        }
+        else if(((query.toUs - query.fromUs + query.bucketUs - 1) / query.bucketUs) <= REQ_AGG_BUCKETS_MAX) {
+            
+            bucketCount = (uint32_t)((query.toUs - query.fromUs + query.bucketUs - 1) / query.bucketUs);
+        }
+        else {
+            
+            /* Too many buckets */
+            logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_AGG_INVAL, user->name);
+            
+            close(scanFd);
+            error = -1;
+            return error;
+        }
+    }
+    query.bucketCount = bucketCount;
+    
+    for(channel = 0; channel < SAVED_DATA_CHANNELS; channel++) {
+        
+        channelCount += (query.channels >> channel) & 1;
+    }
+    
+    /* Aggregate and encode buckets */
+    resLen = sizeof(bucketCount) + bucketCount * (RES_AGG_BUCKET_LEN + channelCount * RES_AGG_STATS_LEN);
+    resBuf = malloc(resLen);
+    buckets = calloc((0 != bucketCount) ? bucketCount : 1, sizeof(struct AggBucket));
+    if((NULL == resBuf) || (NULL == buckets) ||
+       ((0 != bucketCount) && (0 != aggregateSavedData(scanFd, firstIndex, endIndex, &query, buckets)))) {
+        
+        /* Failed to scan saved data */
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_AGG_SCAN_FAIL, user->name);
+        
+        free(resBuf);
+        free(buckets);
+        if(scanFd >= 0) {
+            
+            close(scanFd);
+        }
+        error = -1;
+        return error;
+    }
+    
+    if(scanFd >= 0) {
+        
+        close(scanFd);
+    }
+    
+    pRes = resBuf;
+    memcpy(pRes, &bucketCount, sizeof(bucketCount));
+    pRes += sizeof(bucketCount);
+    for(iBucket = 0; iBucket < bucketCount; iBucket++) {
+        
+        bucketStartUs = query.fromUs + iBucket * query.bucketUs;
+        memcpy(pRes, &bucketStartUs, sizeof(bucketStartUs));
+        pRes += sizeof(bucketStartUs);
+        
+        for(channel = 0; channel < SAVED_DATA_CHANNELS; channel++) {
+            
+            if(0 == (query.channels & (1 << channel))) {
+                
+                continue;
+            }
+            
+            /* count, min, max, mean, stddev (mean and variance from the shifted sums) */
+            stats = &(buckets[iBucket].stats[channel]);
+            memcpy(pRes, &(stats->count), sizeof(stats->count));
+            mean = (0 != stats->count) ? stats->sum / stats->count : 0.0;
+            var = (0 != stats->count) ? (stats->sumSq / stats->count) - (mean * mean) : 0.0;
+            
+            value = (0 != stats->count) ? stats->min : SAVED_DATA_INVALID_VALUE;
+            memcpy(pRes + 4, &value, sizeof(value));
+            value = (0 != stats->count) ? stats->max : SAVED_DATA_INVALID_VALUE;
+            memcpy(pRes + 8, &value, sizeof(value));
+            value = (0 != stats->count) ? (float)(stats->ref + mean) : SAVED_DATA_INVALID_VALUE;
+            memcpy(pRes + 12, &value, sizeof(value));
+            value = (0 != stats->count) ? (float)sqrt((var > 0.0) ? var : 0.0) : SAVED_DATA_INVALID_VALUE;
+            memcpy(pRes + 16, &value, sizeof(value));
+            pRes += RES_AGG_STATS_LEN;
+        }
+    }
+    free(buckets);
+    
+    /* Notify client of success */
+    response = RES_CODE_REQ_SUCCESS;
+    len = send(clientSocket, &response, sizeof(response), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send server response to client */
+#ifdef SERVER_DEBUG
+        perror("send");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
+        
+        free(resBuf);
+        error = -1;
+        return error;
+    }
+    
+    /* Send aggregates */
+    len = send(clientSocket, resBuf, resLen, MSG_NOSIGNAL);
+    free(resBuf);
+    if(len < 0) {
+        
+        /* Failed to send aggregates to client */
+#ifdef SERVER_DEBUG
+        perror("send");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_AGG_SEND_FAIL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Syslog successful aggregation */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_AGG_SUCCESS, bucketCount, user->name);
+    
+    return error;
+}
+
+/*
+ * Function 'downsampleDataHandler': returns downsampled measurement data requested by client.
+ * 
+ * Note:        Points are computed in a single pass over the time range without
+ *              holding savedDataMutex (see openSavedDataScan). LTTB keeps the shape
+ *              of the series with the requested number of points, the resampler
+ *              interpolates the series linearly to a fixed interval. Disabled
+ *              channel values (SAVED_DATA_INVALID_VALUE) are left out.
+ * 
+ * Protocol:    Client --> Server: downsample data request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: start of time range <8 bytes> (UNIX time [usec], 0: first record)
+ *              Client --> Server: end of time range <8 bytes> (UNIX time [usec], exclusive, 0: last record)
+ *              Client --> Server: parameter <8 bytes> (LTTB: number of points, resample: interval [usec])
+ *              Client --> Server: mode <1 byte> (REQ_DSMP_MODE_...)
+ *              Client --> Server: channels <1 byte> (REQ_AGG_CH_...)
+ *              Client <-- Server: result of request processing <1 byte>
+ * 
+ *              ++ In case of successful request processing ++
+ * 
+ *              For each requested channel in TMP, HUM, PRS order:
+ *              Client <-- Server: number of points <4 bytes>
+ *              Client <-- Server: points <<number of points> * 12 bytes>
+ *                                 (time <8 bytes> (UNIX time [usec]), value <4 bytes, float>)
+ */
+int downsampleDataHandler(int clientSocket, const struct UserData *user, void *customArg) {
+    
+    uint8_t queryBuf[REQ_DSMP_LEN]; // Downsampling query
+    uint8_t response = 0;           // Server response
+    uint8_t *resBuf = NULL;         // Downsampled data message
+    uint8_t *pRes = NULL;
+    uint64_t recordCount = 0;       // Number of saved records
+    uint64_t firstIndex = 0;        // First record of the time range
+    uint64_t endIndex = 0;          // Record following the time range
+    uint32_t maxPoints = 0;         // Max. number of points per channel
+    uint32_t pointCount[SAVED_DATA_CHANNELS];
+    uint32_t totalCount = 0;
+    uint32_t iPoint;
+    int scanFd = -1;                // Duplicate of the saved data file descriptor
+    int error = 0;
+    int channel;
+    int len;
+    size_t resLen = 0;
+    
+    struct DownsampleQuery query;
+    struct SamplePoint *points[SAVED_DATA_CHANNELS];
+    struct SensorContext *sensor = &(sensorArray[((struct ClientSession*)customArg)->sensorSel]);   // Selected sensor
+    
+    memset(pointCount, 0, sizeof(pointCount));
+    memset(points, 0, sizeof(points));
+    
+    /* Syslog client requested to downsample measurement data */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_DSMP, user->name);
+    
+    /* Get query from client */
+    len = recv(clientSocket, queryBuf, sizeof(queryBuf), MSG_WAITALL);
+    if(len < (int)sizeof(queryBuf)) {
+        
+        /* Failed to receive client downsampling query */
+#ifdef SERVER_DEBUG
+        perror("recv");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_DSMP_FAIL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    memset(&query, 0, sizeof(query));
+    memcpy(&(query.fromUs), &(queryBuf[0]), sizeof(query.fromUs));
+    memcpy(&(query.toUs), &(queryBuf[8]), sizeof(query.toUs));
+    memcpy(&(query.param), &(queryBuf[16]), sizeof(query.param));
+    query.mode = queryBuf[24];
+    query.channels = queryBuf[25];
+    
+    /* Take the saved records measured so far and locate the time range */
+    if((0 != query.channels) && (0 == (query.channels & ~REQ_AGG_CH_MASK)) &&
+       ((0 == query.toUs) || (query.toUs > query.fromUs))) {
+        
+        scanFd = openSavedDataScan(sensor, &recordCount);
+        if(scanFd >= 0) {
+            
+            /* Range left empty on failure */
+            resolveSavedRange(scanFd, recordCount, &(query.fromUs), &(query.toUs), &firstIndex, &endIndex);
+        }
+    }
+    
+    /* Check channels, mode and parameter */
+    if((REQ_DSMP_MODE_LTTB == query.mode) && (query.param >= REQ_DSMP_POINTS_MIN) && (query.param <= REQ_DSMP_POINTS_MAX)) {
+        
+        maxPoints = (uint32_t)query.param;
+    }
+    else if((REQ_DSMP_MODE_RESAMPLE == query.mode) && (0 != query.param) &&
+            ((firstIndex == endIndex) || (((query.toUs - query.fromUs) / query.param) < REQ_DSMP_POINTS_MAX))) {
+        
+        maxPoints = (firstIndex == endIndex) ? 0 : (uint32_t)((query.toUs - query.fromUs) / query.param) + 1;
+    }
+    else {
+        
+        query.channels = 0;
+    }
+    
+    if((0 == query.channels) || (query.channels & ~REQ_AGG_CH_MASK)) {
+        
+        /* Invalid downsampling query */
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_DSMP_INVAL, user->name);
+        
+        if(scanFd >= 0) {
+            
+            close(scanFd);
+        }
+        error = -1;
+        return error;
+    }
+    
+    /* Downsample channels */
+    if(firstIndex < endIndex) {
+        
+        for(channel = 0; channel < SAVED_DATA_CHANNELS; channel++) {
+            
+            if(query.channels & (1 << channel)) {
+                
+                points[channel] = malloc(maxPoints * sizeof(struct SamplePoint));
+                error |= (NULL == points[channel]) ? -1 : 0;
+            }
+        }
+        
+        if(0 == error) {
+            
+            error = downsampleSavedData(scanFd, firstIndex, endIndex, &query, points, pointCount, maxPoints);
+        }
+    }
+    
+    if(scanFd >= 0) {
+        
+        close(scanFd);
+    }
+    
+    /* Encode points */
+    for(channel = 0; channel < SAVED_DATA_CHANNELS; channel++) {
+        
+        if(query.channels & (1 << channel)) {
+            
+            resLen += sizeof(pointCount[channel]) + pointCount[channel] * RES_DSMP_POINT_LEN;
+            totalCount += pointCount[channel];
+        }
+    }
+    
+    resBuf = (0 == error) ? malloc(resLen) : NULL;
+    if(NULL == resBuf) {
+        
+        /* Failed to scan saved data */
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_AGG_SCAN_FAIL, user->name);
+        
+        for(channel = 0; channel < SAVED_DATA_CHANNELS; channel++) {
+            
+            free(points[channel]);
+        }
+        error = -1;
+        return error;
+    }
+    
+    pRes = resBuf;
+    for(channel = 0; channel < SAVED_DATA_CHANNELS; channel++) {
+        
+        if(0 == (query.channels & (1 << channel))) {
+            
+            continue;
+        }
+        
+        memcpy(pRes, &(pointCount[channel]), sizeof(pointCount[channel]));
+        pRes += sizeof(pointCount[channel]);
+        for(iPoint = 0; iPoint < pointCount[channel]; iPoint++) {
+            
+            memcpy(pRes, &(points[channel][iPoint].timeUs), sizeof(points[channel][iPoint].timeUs));
+            memcpy(pRes + 8, &(points[channel][iPoint].value), sizeof(points[channel][iPoint].value));
+            pRes += RES_DSMP_POINT_LEN;
+        }
+        free(points[channel]);
+    }
+    
+    /* Notify client of success */
+    response = RES_CODE_REQ_SUCCESS;
+    len = send(clientSocket, &response, sizeof(response), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send server response to client */
+#ifdef SERVER_DEBUG
+        perror("send");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
+        
+        free(resBuf);
+        error = -1;
+        return error;
+    }
+    
+    /* Send points */
+    len = send(clientSocket, resBuf, resLen, MSG_NOSIGNAL);
+    free(resBuf);
+    if(len < 0) {
+        
+        /* Failed to send points to client */
+#ifdef SERVER_DEBUG
+        perror("send");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_DSMP_SEND_FAIL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Syslog successful downsampling */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_DSMP_SUCCESS, totalCount, user->name);
+    
+    return error;
+}
+
+/*
+ * Function 'getColumnsHandler': transfers selected columns of measurement data to client.
+ * 
+ * Note:        Columns are streamed from the column files kept next to the saved data
+ *              file, so only the selected columns are read from disk. While the column
+ *              files are out of sync, the columns are extracted from the saved records.
+ *              Neither holds savedDataMutex during the transfer.
+ * 
+ * Protocol:    Client --> Server: get data columns request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: columns <1 byte> (REQ_AGG_CH_..., REQ_GDATP_CH_TIME)
+ *              Client <-- Server: result of request processing <1 byte>
+ * 
+ *              ++ In case of successful request processing ++
+ * 
+ *              Client <-- Server: number of records <4 bytes>
+ *              For each requested column in TMP, HUM, PRS, TIME order:
+ *              Client <-- Server: column <<number of records> * 4 bytes> (value, float)
+ *                                 or <<number of records> * 8 bytes> (time, UNIX time [usec])
+ */
+int getColumnsHandler(int clientSocket, const struct UserData *user, void *customArg) {
+    
+    uint8_t columns = 0;            // Requested columns
+    uint8_t resBuf[1 + sizeof(uint32_t)];                       // Response and number of records
+    uint8_t buf[SAVED_DATA_SCAN_RECORDS * RES_GDATP_TIME_LEN];  // Column extracted from saved records
+    uint64_t recordCount = 0;       // Number of saved records
+    uint32_t count;                 // Number of transferred records
+    uint32_t index;
+    uint32_t blockCount;
+    size_t width;
+    size_t remaining;
+    ssize_t size;
+    off_t fileOffset;
+    int columnFd[SAVED_DATA_COLUMNS];   // Duplicates of the column file descriptors
+    int scanFd = -1;                    // Duplicate of the saved data file descriptor
+    int headerSent = 0;                 // Client waits for the columns
+    int column;
+    int error = 0;
+    int len;
+    
+    struct stat fileStat;
+    struct SensorContext *sensor = &(sensorArray[((struct ClientSession*)customArg)->sensorSel]);   // Selected sensor
+    
+    /* Syslog client requested to get measurement data columns */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_GDATP, user->name);
+    
+    /* Get column selection from client */
+    len = recv(clientSocket, &columns, sizeof(columns), MSG_WAITALL);
+    if(len < (int)sizeof(columns)) {
         
-            /* Failed to receive period value from client */
+        /* Failed to receive client column selection */
 #ifdef SERVER_DEBUG
-            perror("recv");
-            fflush(stderr);
-            fprintf(stdout, LOG_SYS_ERR_CLIENT_REQ_RECV_FAIL);
-            fflush(stdout);
+        perror("recv");
+        fflush(stderr);
 #endif
-            syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_RECV_FAIL);
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_GDATP_FAIL, user->name);
         
-            error = -1;
-            return error;
-        }
+        error = -1;
+        return error;
     }
     
-    /* Process client config data */
-    if(REQ_CONF_PRD == (config & REQ_CONF_TYPE_MASK)) {
+    if((0 == columns) || (columns & ~REQ_GDATP_CH_MASK)) {
         
-        /* Config period */
-
-        pthread_mutex_lock(&sensorMutex);
-        measPeriod = period;
-        pthread_mutex_unlock(&sensorMutex);
+        /* Invalid column selection */
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_GDATP_INVAL, user->name);
+        
+        error = -1;
+        return error;
     }
-    else if(REQ_CONF_IIR == (config & REQ_CONF_TYPE_MASK)) {
+    
+    /* Take the records measured so far and the files to read them from */
+    for(column = 0; column < SAVED_DATA_COLUMNS; column++) {
         
-        /* Config IIR filter */
+        columnFd[column] = SAVED_DATA_FD_INVALID;
+    }
+    
+    SAVED_DATA_MUTEX_LOCK(sensor);
+    
+    flushSavedData(sensor);
+    if((sensor->savedDataFd >= 0) && (0 == fstat(sensor->savedDataFd, &fileStat))) {
         
-        /* Process config status */
-        if(REQ_CONF_ON == (config & REQ_CONF_STATUS_MASK)) {
+        recordCount = (uint64_t)fileStat.st_size / sizeof(struct SavedDataRecord);
+        for(column = 0; column < SAVED_DATA_COLUMNS; column++) {
             
-            /* Config status on */
-            
-            /* Turn on IIR filter */
-            pthread_mutex_lock(&sensorMutex);
-            sensorSettingSel |= BME280_FILTER_SEL;
-            pthread_mutex_unlock(&sensorMutex);
-            
-            /* Process config value */
-            if(REQ_CONF_COEFF_OFF == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config IIR filter COEFF_OFF */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.filter = BME280_FILTER_COEFF_OFF;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_COEFF_2 == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config IIR filter COEFF_2 */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.filter = BME280_FILTER_COEFF_2;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_COEFF_4 == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config IIR filter COEFF_4 */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.filter = BME280_FILTER_COEFF_4;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_COEFF_8 == (config & REQ_CONF_VALUE_MASK)) {
+            if(0 == (columns & (1 << column))) {
                 
-                /* Config IIR filter COEFF_8 */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.filter = BME280_FILTER_COEFF_8;
-                pthread_mutex_unlock(&sensorMutex);
+                continue;
             }
-            else if(REQ_CONF_COEFF_16 == (config & REQ_CONF_VALUE_MASK)) {
+            
+            if(sensor->savedColumnFd[column] >= 0) {
                 
-                /* Config IIR filter COEFF_16 */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.filter = BME280_FILTER_COEFF_16;
-                pthread_mutex_unlock(&sensorMutex);
+                columnFd[column] = dup(sensor->savedColumnFd[column]);
             }
-            else {
-                
-                /* Invalid config value */
-#ifdef SERVER_DEBUG
-                fprintf(stdout, LOG_SYS_ERR_CLIENT_REQ_CONF_VAL_INVAL, user->name);
-                fflush(stdout);
-#endif
-                syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_CONF_VAL_INVAL, user->name);
+            if((columnFd[column] < 0) && (scanFd < 0)) {
                 
-                error = -1;
-                return error;
+                scanFd = dup(sensor->savedDataFd);
+                error = (scanFd < 0) ? -1 : 0;
             }
         }
-        else {
-            
-            /* Config status off */
-            
-            /* Turn off IIR filter */
-            pthread_mutex_lock(&sensorMutex);
-            sensorSettingSel &= ~(BME280_FILTER_SEL);
-            pthread_mutex_unlock(&sensorMutex);
-        }
     }
-    else if(REQ_CONF_TMP == (config & REQ_CONF_TYPE_MASK)) {
+    
+    SAVED_DATA_MUTEX_UNLOCK(sensor);
+    
+    count = (recordCount > UINT32_MAX) ? UINT32_MAX : (uint32_t)recordCount;
+    
+    /* Notify client on success and send number of records */
+    if(0 == error) {
         
-        /* Config temperature */
+        resBuf[0] = RES_CODE_REQ_SUCCESS;
+        memcpy(&resBuf[1], &count, sizeof(count));
+        len = send(clientSocket, resBuf, sizeof(resBuf), MSG_NOSIGNAL);
+        error = (len < (int)sizeof(resBuf)) ? -1 : 0;
+        headerSent = (len > 0);
+    }
+    
+    /* Send columns */
+    for(column = 0; (0 == error) && (column < SAVED_DATA_COLUMNS); column++) {
         
-        /* Process config status */
-        if(REQ_CONF_ON == (config & REQ_CONF_STATUS_MASK)) {
-            
-            /* Config status on */
+        if(0 == (columns & (1 << column))) {
             
-            /* Turn on temperature measurement */
-            pthread_mutex_lock(&sensorMutex);
-            sensorSettingSel |= BME280_OSR_TEMP_SEL;
-            pthread_mutex_unlock(&sensorMutex);
+            continue;
+        }
+        
+        width = getSavedColumnWidth(column);
+        if(columnFd[column] >= 0) {
             
-            /* Process config value */
-            if(REQ_CONF_OS_OFF == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config temperature OS_OFF */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_t = BME280_NO_OVERSAMPLING;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_1X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config temperature OS_1X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_t = BME280_OVERSAMPLING_1X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_2X == (config & REQ_CONF_VALUE_MASK)) {
+            /* Column file straight to the socket */
+            fileOffset = 0;
+            remaining = (size_t)count * width;
+            while((0 == error) && (remaining > 0)) {
                 
-                /* Config temperature OS_2X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_t = BME280_OVERSAMPLING_2X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_4X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config temperature OS_4X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_t = BME280_OVERSAMPLING_4X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_8X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config temperature OS_8X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_t = BME280_OVERSAMPLING_8X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_16X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config temperature OS_16X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_t = BME280_OVERSAMPLING_16X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else {
-                
-                /* Invalid config value */
-#ifdef SERVER_DEBUG
-                fprintf(stdout, LOG_SYS_ERR_CLIENT_REQ_CONF_VAL_INVAL, user->name);
-                fflush(stdout);
-#endif
-                syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_CONF_VAL_INVAL, user->name);
-                
-                error = -1;
-                return error;
+                size = sendfile(clientSocket, columnFd[column], &fileOffset, remaining);
+                if(size <= 0) {
+                    
+                    /* Failed to send */
+                    error = -1;
+                }
+                else {
+                    
+                    remaining -= (size_t)size;
+                }
             }
         }
         else {
             
-            /* Config status off */
-            
-            /* Turn on temperature measurement */
-            pthread_mutex_lock(&sensorMutex);
-            sensorSettingSel &= ~(BME280_OSR_TEMP_SEL);
-            pthread_mutex_unlock(&sensorMutex);
-        }
-    }
-    else if(REQ_CONF_HUM == (config & REQ_CONF_TYPE_MASK)) {
-        
-        /* Config humidity */
-        
-        /* Process config status */
-        if(REQ_CONF_ON == (config & REQ_CONF_STATUS_MASK)) {
-            
-            /* Config status on */
-            
-            /* Turn on humidity measurement */
-            pthread_mutex_lock(&sensorMutex);
-            sensorSettingSel |= BME280_OSR_HUM_SEL;
-            pthread_mutex_unlock(&sensorMutex);
-            
-            /* Process config value */
-            if(REQ_CONF_OS_OFF == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config humidity OS_OFF */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_h = BME280_NO_OVERSAMPLING;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_1X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config humidity OS_1X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_h = BME280_OVERSAMPLING_1X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_2X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config humidity OS_2X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_h = BME280_OVERSAMPLING_2X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_4X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config humidity OS_4X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_h = BME280_OVERSAMPLING_4X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_8X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config humidity OS_8X using mutex */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_h = BME280_OVERSAMPLING_8X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_16X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config humidity OS_16X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_h = BME280_OVERSAMPLING_16X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else {
+            /* Extract column from the saved records block by block */
+            for(index = 0; (0 == error) && (index < count); index += blockCount) {
                 
-                /* Invalid config value */
-#ifdef SERVER_DEBUG
-                fprintf(stdout, LOG_SYS_ERR_CLIENT_REQ_CONF_VAL_INVAL, user->name);
-                fflush(stdout);
-#endif
-                syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_CONF_VAL_INVAL, user->name);
-                
-                error = -1;
-                return error;
+                blockCount = ((count - index) < SAVED_DATA_SCAN_RECORDS) ? (count - index) : SAVED_DATA_SCAN_RECORDS;
+                if((0 != projectSavedColumn(scanFd, index, blockCount, column, buf)) ||
+                   ((ssize_t)(blockCount * width) != send(clientSocket, buf, blockCount * width, MSG_NOSIGNAL))) {
+                    
+                    error = -1;
+                }
             }
         }
-        else {
-            
-            /* Config status off */
+    }
+    
+    for(column = 0; column < SAVED_DATA_COLUMNS; column++) {
+        
+        if(columnFd[column] >= 0) {
             
-            /* Turn off humidity measurement */
-            pthread_mutex_lock(&sensorMutex);
-            sensorSettingSel &= ~(BME280_OSR_HUM_SEL);
-            pthread_mutex_unlock(&sensorMutex);
+            close(columnFd[column]);
         }
     }
-    else if(REQ_CONF_PRS == (config & REQ_CONF_TYPE_MASK)) {
+    if(scanFd >= 0) {
         
-        /* Config pressure */
+        close(scanFd);
+    }
+    
+    if(0 != error) {
         
-        /* Process config status */
-        if(REQ_CONF_ON == (config & REQ_CONF_STATUS_MASK)) {
-            
-            /* Config status on */
-            
-            /* Turn on pressure measurement */
-            pthread_mutex_lock(&sensorMutex);
-            sensorSettingSel |= BME280_OSR_PRESS_SEL;
-            pthread_mutex_unlock(&sensorMutex);
-            
-            /* Process config value */
-            if(REQ_CONF_OS_OFF == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config pressure OS_OFF */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_p = BME280_NO_OVERSAMPLING;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_1X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config pressure OS_1X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_p = BME280_OVERSAMPLING_1X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_2X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config pressure OS_2X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_p = BME280_OVERSAMPLING_2X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_4X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config pressure OS_4X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_p = BME280_OVERSAMPLING_4X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_8X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config pressure OS_8X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_p = BME280_OVERSAMPLING_8X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else if(REQ_CONF_OS_16X == (config & REQ_CONF_VALUE_MASK)) {
-                
-                /* Config pressure OS_16X */
-                pthread_mutex_lock(&sensorMutex);
-                sensorDev.settings.osr_p = BME280_OVERSAMPLING_16X;
-                pthread_mutex_unlock(&sensorMutex);
-            }
-            else {
-                
-                /* Invalid config value */
-#ifdef SERVER_DEBUG
-                fprintf(stdout, LOG_SYS_ERR_CLIENT_REQ_CONF_VAL_INVAL, user->name);
-                fflush(stdout);
-#endif
-                syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_CONF_VAL_INVAL, user->name);
-                
-                error = -1;
-                return error;
-            }
-        }
-        else {
-            
-            /* Config status off */
+        /* Failed to send columns to client */
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_GDATP_SEND_FAIL, user->name);
+        
+        /* Client expects the rest of the columns: end the session instead of a result code in the stream */
+        if(headerSent) {
             
-            /* Turn off pressure measurement */
-            pthread_mutex_lock(&sensorMutex);
-            sensorSettingSel &= ~(BME280_OSR_PRESS_SEL);
-            pthread_mutex_unlock(&sensorMutex);
+            shutdown(clientSocket, SHUT_RDWR);
         }
-    }
-    else {
         
-        /* Invalid config type */
-#ifdef SERVER_DEBUG
-        fprintf(stdout, LOG_SYS_ERR_CLIENT_REQ_CONF_TYP_INVAL, user->name);
-        fflush(stdout);
-#endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_CONF_TYP_INVAL, user->name);
-                
-        error = -1;
         return error;
     }
     
-    /* Update sensor settings */
-    pthread_mutex_lock(&sensorMutex);
-    error = bme280_set_sensor_settings(sensorSettingSel, &sensorDev); // Prevent concurrent sensor and config access
-    pthread_mutex_unlock(&sensorMutex);
-    if (BME280_OK != error) {
+    /* Syslog successful data transfer */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_GDATP_SUCCESS, count, user->name);
+    
+    return error;
+}
+
+/*
+ * Function 'latestDataHandler': transfers the latest sample to client.
+ * 
+ * Note:        Served from the latest sample seqlock in constant time, without touching
+ *              the saved data or any mutex. Meant for frequent polling, so only the
+ *              failures are syslogged (requests are counted by the metrics registry, see
+ *              STATS). Disabled channels hold -1.0 (SAVED_DATA_INVALID_VALUE), a zero
+ *              sequence number means no sample has been taken yet.
+ * 
+ * Protocol:    Client --> Server: get latest sample request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client <-- Server: sample sequence number <8 bytes>
+ *              Client <-- Server: sample time <8 bytes> (UNIX time [usec])
+ *              Client <-- Server: temperature, humidity, pressure <4 bytes each, float>
+ *              Client <-- Server: config version of the sample <4 bytes>
+ */
+int latestDataHandler(int clientSocket, const struct UserData *user, void *customArg) {
+    
+    uint8_t sampleMsg[RES_LATEST_LEN];          // Latest sample message
+    int error = 0;
+    int len;
+    
+    struct LatestSample sample;                 // Copy of latest sample
+    struct SensorContext *sensor = &(sensorArray[((struct ClientSession*)customArg)->sensorSel]);   // Selected sensor
+    
+    /* Copy latest sample */
+    readLatestSample(sensor, &sample);
+    
+    /* Encode sample message */
+    memcpy(&sampleMsg[0], &(sample.seq), sizeof(sample.seq));
+    memcpy(&sampleMsg[8], &(sample.timeUs), sizeof(sample.timeUs));
+    memcpy(&sampleMsg[16], &(sample.temp), sizeof(sample.temp));
+    memcpy(&sampleMsg[20], &(sample.hum), sizeof(sample.hum));
+    memcpy(&sampleMsg[24], &(sample.press), sizeof(sample.press));
+    memcpy(&sampleMsg[28], &(sample.configVersion), sizeof(sample.configVersion));
+    
+    /* Send sample message */
+    len = send(clientSocket, sampleMsg, sizeof(sampleMsg), MSG_NOSIGNAL);
+    if(len < 0) {
         
-        /* Failed to update sensor settings */
+        /* Failed to send latest sample to client */
 #ifdef SERVER_DEBUG
-        fprintf(stderr, "Failed to set sensor settings (code %+d).", error);
+        perror("send");
         fflush(stderr);
 #endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SENS_STGS_SET_FAIL);
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_LATEST_SEND_FAIL, user->name);
         
         error = -1;
         return error;
     }
     
-    if(0 == error) {
-     
-        /* Notify client of success */
-        response = RES_CODE_REQ_SUCCESS;
-        len = send(clientSocket, &response, sizeof(response), MSG_NOSIGNAL);
-        if(len < 0) {
-                        
-            /* Failed to send server response to client */
-#ifdef SERVER_DEBUG
-            perror("send");
-            fflush(stderr);
-            fprintf(stdout, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
-            fflush(stdout);
-#endif
-            syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
-            error = -1;
-            return error;
-        }
-        
-    }
-    
-    /* Syslog successful configuration */
-#ifdef SERVER_DEBUG
-    fprintf(stdout, LOG_SYS_INFO_CLIENT_REQ_SET_CONF_SUCCESS, user->name);
-    fflush(stdout);
-#endif
-    syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_SET_CONF_SUCCESS, user->name);
-    
     return error;
 }
 
 /*
- * Function 'getConfigHandler': returns current sensor configuration requested by client.
+ * Function 'waitSampleHandler': transfers the first sample newer than the one requested by client.
  * 
- * Protocol:    Client --> Server: get configuration request code <1 byte>
+ * Note:        If there is no newer sample yet, the client session is parked: the service
+ *              thread returns to serve other clients and the event thread answers the
+ *              session as soon as the measure thread publishes a newer sample or the
+ *              timeout expires, then hands it back to the service threads.
+ *              The latest sample is sent on timeout as well.
+ * 
+ * Protocol:    Client --> Server: wait for sample request code <1 byte>
  *              Client <-- Server: result of request code validation <1 byte>
  * 
  *              ++ In case of successful request validation ++
  * 
- *              Client <-- Server: period value <4 bytes>
- *              Client <-- Server: temperature configuration <8 bytes>
- *              Client <-- Server: humidity configuration <8 bytes>
- *              Client <-- Server: pressure configuration <8 bytes>
- *              Client <-- Server: IIR filter configuration <16 bytes>
+ *              Client --> Server: sequence number of the last known sample <8 bytes>
+ *              Client --> Server: timeout <4 bytes> (msec, max. REQ_WAIT_TIMEOUT_MAX_MS)
+ *              Client <-- Server: result of request processing <1 byte>
+ *                                 (RES_CODE_REQ_SUCCESS: newer sample, RES_CODE_REQ_TIMEOUT: timed out)
+ *              Client <-- Server: latest sample <32 bytes> (see latestDataHandler)
  */
-int getConfigHandler(int clientSocket, const struct UserData *user, void *customArg) {
+int waitSampleHandler(int clientSocket, const struct UserData *user, void *customArg) {
     
-    uint8_t response = 0;                       // Not used
+    uint8_t queryBuf[REQ_WAIT_LEN];             // Wait query
+    uint8_t resBuf[1 + RES_LATEST_LEN];         // Response and latest sample
+    uint64_t afterSeq = 0;                      // Sequence number of the last known sample
+    uint32_t timeoutMs = 0;                     // Timeout [msec]
     int error = 0;
     int len;
     
-    char envVarConfMsg[8];                      // String message of TMP/HUM/PRS configs (collective)
-    char iirFltrConfMsg[16];                    // String message of IIR filter config
+    struct timespec now;
+    struct LatestSample sample;
+    struct ParkedSession *parked = NULL;
+    struct ClientSession *session = (struct ClientSession*)customArg;
+    struct SensorContext *sensor = &(sensorArray[session->sensorSel]);     // Selected sensor
     
-    struct bme280_dev copy_of_sensorDev;        // Copy of sensor device and settings
-    uint8_t copy_of_sensorSettingSel = 0;       // Copy of sensor setting selection
-    int copy_of_measPeriod = 0;                 // Copy of measurement period [sec]
-    
-    /* Initialize local variables */
-    memset(envVarConfMsg, 0, sizeof(envVarConfMsg));
-    memset(iirFltrConfMsg, 0, sizeof(iirFltrConfMsg));
-    memset(&copy_of_sensorDev, 0, sizeof(copy_of_sensorDev));
-    
-    /* Syslog client requested to get sensor configuration */
+    /* Get query from client */
+    len = recv(clientSocket, queryBuf, sizeof(queryBuf), MSG_WAITALL);
+    if(len < (int)sizeof(queryBuf)) {
+        
+        /* Failed to receive client wait query */
 #ifdef SERVER_DEBUG
-    fprintf(stdout, LOG_SYS_INFO_CLIENT_REQ_GET_CONF, user->name);
-    fflush(stdout);
+        perror("recv");
+        fflush(stderr);
 #endif
-    syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_GET_CONF, user->name);
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_WAIT_FAIL, user->name);
+        
+        error = -1;
+        return error;
+    }
     
-    /* Copy config settings values */
+    memcpy(&afterSeq, &queryBuf[0], sizeof(afterSeq));
+    memcpy(&timeoutMs, &queryBuf[8], sizeof(timeoutMs));
+    
+    /* Syslog client requested to wait for a sample */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_WAIT, (unsigned long long)afterSeq, user->name);
+    
+    if(timeoutMs > REQ_WAIT_TIMEOUT_MAX_MS) {
+        
+        /* Invalid wait query */
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_WAIT_INVAL, user->name);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Park session unless a newer sample is available or no waiting is requested */
+    readLatestSample(sensor, &sample);
+    if((sample.seq <= afterSeq) && (0 != timeoutMs)) {
+        
+        parked = malloc(sizeof(struct ParkedSession));
+        if(NULL != parked) {
+            
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            parked->serviceSocket = clientSocket;
+            parked->user = user;
+            parked->session = *session;
+            parked->afterSeq = afterSeq;
+            parked->deadlineNs = (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec + timeoutMs * NSEC_PER_MSEC;
+            parked->subscription = NULL;
+            
+            /* The service thread must not touch the socket once it is parked */
+            session->serviceStopCondition = COND_SERVICE_STOP_PARKED;
+            if(0 == parkClientSession(parked)) {
+                
+                return error;
+            }
+            
+            session->serviceStopCondition = COND_SERVICE_STOP_FALSE;
+            free(parked);
+        }
+        
+        /* Failed to park client session: answer as timed out */
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_PARK_FAIL, user->name);
+    }
     
-    /* Start of critical section */
-    pthread_mutex_lock(&sensorMutex);
+    /* Answer right away */
+    resBuf[0] = (sample.seq > afterSeq) ? RES_CODE_REQ_SUCCESS : RES_CODE_REQ_TIMEOUT;
+    memcpy(&resBuf[1], &(sample.seq), sizeof(sample.seq));
+    memcpy(&resBuf[9], &(sample.timeUs), sizeof(sample.timeUs));
+    memcpy(&resBuf[17], &(sample.temp), sizeof(sample.temp));
+    memcpy(&resBuf[21], &(sample.hum), sizeof(sample.hum));
+    memcpy(&resBuf[25], &(sample.press), sizeof(sample.press));
+    memcpy(&resBuf[29], &(sample.configVersion), sizeof(sample.configVersion));
     
-    /* Copy sensor device settings */
-    copy_of_sensorDev = sensorDev;
+    len = send(clientSocket, resBuf, sizeof(resBuf), MSG_NOSIGNAL);
+    if(len < 0) {
+        
+        /* Failed to send sample to client */
+#ifdef SERVER_DEBUG
+        perror("send");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_WAIT_SEND_FAIL, user->name);
+        
+        error = -1;
+        return error;
+    }
     
-    /* Copy sensor setting selection */
-    copy_of_sensorSettingSel = sensorSettingSel;
+    return error;
+}
+
+/*
+ * Function 'subscribeHandler': subscribes client to new samples pushed by the server.
+ * 
+ * Note:        The client session is parked in the event thread, which encodes every new
+ *              sample once per channel selection and writes it to all subscribers without
+ *              blocking. Frames a subscriber can not take right away are queued in its
+ *              bounded ring; a full ring is handled by the requested policy.
+ *              The subscription ends when the client sends the unsubscribe code: the queued
+ *              frames and the end frame are written, then the session continues as usual.
+ * 
+ * Protocol:    Client --> Server: subscribe request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: channels <1 byte> (REQ_AGG_CH_...)
+ *              Client --> Server: decimation <4 bytes> (push every n-th sample)
+ *              Client --> Server: slow subscriber policy <1 byte> (REQ_SUB_POLICY_...)
+ *              Client <-- Server: result of request processing <1 byte>
+ * 
+ *              ++ In case of successful request processing ++
+ * 
+ *              Client <-- Server: sample frames <RES_PUSH_HEADER_LEN + 4 bytes per channel>
+ *              Client --> Server: unsubscribe code <1 byte> (any time)
+ *              Client <-- Server: remaining sample frames, end frame <RES_PUSH_END_LEN bytes>
+ */
+int subscribeHandler(int clientSocket, const struct UserData *user, void *customArg) {
     
-    /* Copy measurement period */
-    copy_of_measPeriod = measPeriod;
+    uint8_t queryBuf[REQ_SUB_LEN];              // Subscription query
+    uint8_t resBuf[RES_PUSH_END_LEN];           // Response
+    uint32_t decimation = 0;                    // Push every n-th sample
+    int error = 0;
+    int len;
     
-    /* End of critical section */
-    pthread_mutex_unlock(&sensorMutex);
+    struct ParkedSession *parked = NULL;
+    struct Subscription *subscription = NULL;
+    struct ClientSession *session = (struct ClientSession*)customArg;
     
-    /* Send measurement period config */
-    len = send(clientSocket, &copy_of_measPeriod, sizeof(copy_of_measPeriod), MSG_NOSIGNAL);
-    if(len < 0) {
+    /* Get query from client */
+    len = recv(clientSocket, queryBuf, sizeof(queryBuf), MSG_WAITALL);
+    if(len < (int)sizeof(queryBuf)) {
         
-        /* Failed to send measurement period config to client */
+        /* Failed to receive client subscription */
 #ifdef SERVER_DEBUG
-        perror("send");
-        fprintf(stderr, LOG_SYS_ERR_SERVER_CONF_PRD_SEND_FAIL, user->name);
+        perror("recv");
         fflush(stderr);
 #endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_CONF_PRD_SEND_FAIL, user->name);
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_SUB_FAIL, user->name);
         
         error = -1;
         return error;
     }
     
-    /* Parse and send temperature config */
+    memcpy(&decimation, &queryBuf[1], sizeof(decimation));
     
-    /* Parse temperature config */
-    if(copy_of_sensorSettingSel & BME280_OSR_TEMP_SEL) {
-        
-        /* Temperature config status on */
-        
-        if(BME280_NO_OVERSAMPLING == copy_of_sensorDev.settings.osr_t) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_OFF);
-        }
-        else if(BME280_OVERSAMPLING_1X == copy_of_sensorDev.settings.osr_t) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_1X);
-        }
-        else if(BME280_OVERSAMPLING_2X == copy_of_sensorDev.settings.osr_t) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_2X);
-        }
-        else if(BME280_OVERSAMPLING_4X == copy_of_sensorDev.settings.osr_t) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_4X);
-        }
-        else if(BME280_OVERSAMPLING_8X == copy_of_sensorDev.settings.osr_t) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_8X);
-        }
-        else if(BME280_OVERSAMPLING_16X == copy_of_sensorDev.settings.osr_t) {
+    if((0 == (queryBuf[0] & REQ_AGG_CH_MASK)) || (0 != (queryBuf[0] & ~REQ_AGG_CH_MASK)) ||
+       (0 == decimation) || (decimation > REQ_SUB_DECIMATION_MAX) ||
+       (queryBuf[5] < REQ_SUB_POLICY_DROP_OLDEST) || (queryBuf[5] > REQ_SUB_POLICY_DISCONNECT)) {
         
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_16X);
-        }
-        else {
-         
-            strcpy(envVarConfMsg, RES_STR_SCONF_ERR);
-        }
-    }
-    else {
+        /* Invalid subscription */
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_SUB_INVAL, user->name);
         
-        /* Temperature config status off */
-        strcpy(envVarConfMsg, RES_STR_SCONF_OFF);
+        error = -1;
+        return error;
     }
     
-    /* Send temperature config */
-    len = send(clientSocket, &envVarConfMsg, sizeof(envVarConfMsg), MSG_NOSIGNAL);
+    /* Accept subscription before any frame may be pushed */
+    resBuf[0] = RES_CODE_REQ_SUCCESS;
+    len = send(clientSocket, resBuf, 1, MSG_NOSIGNAL);
     if(len < 0) {
         
-        /* Failed to send temperature config to client */
+        /* Failed to send response to client */
 #ifdef SERVER_DEBUG
         perror("send");
-        fprintf(stderr, LOG_SYS_ERR_SERVER_CONF_TMP_SEND_FAIL, user->name);
         fflush(stderr);
 #endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_CONF_TMP_SEND_FAIL, user->name);
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_SUB_SEND_FAIL, user->name);
         
         error = -1;
         return error;
     }
     
-    /* Parse and send humidity config */
-    
-    memset(envVarConfMsg, 0, sizeof(envVarConfMsg)); // Reset shared variable
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_SUB, user->name);
     
-    /* Parse humidity config */
-    if(copy_of_sensorSettingSel & BME280_OSR_HUM_SEL) {
+    parked = malloc(sizeof(struct ParkedSession));
+    subscription = calloc(1, sizeof(struct Subscription));
+    if((NULL != parked) && (NULL != subscription)) {
         
-        /* Humidity config status on */
+        subscription->channels = queryBuf[0];
+        subscription->decimation = decimation;
+        subscription->policy = queryBuf[5];
         
-        if(BME280_NO_OVERSAMPLING == copy_of_sensorDev.settings.osr_h) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_OFF);
-        }
-        else if(BME280_OVERSAMPLING_1X == copy_of_sensorDev.settings.osr_h) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_1X);
-        }
-        else if(BME280_OVERSAMPLING_2X == copy_of_sensorDev.settings.osr_h) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_2X);
-        }
-        else if(BME280_OVERSAMPLING_4X == copy_of_sensorDev.settings.osr_h) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_4X);
-        }
-        else if(BME280_OVERSAMPLING_8X == copy_of_sensorDev.settings.osr_h) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_8X);
-        }    
-        else if(BME280_OVERSAMPLING_16X == copy_of_sensorDev.settings.osr_h) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_16X);
-        }
-        else {
+        parked->serviceSocket = clientSocket;
+        parked->user = user;
+        parked->session = *session;
+        parked->afterSeq = 0;
+        parked->deadlineNs = UINT64_MAX;
+        parked->subscription = subscription;
+        
+        /* The service thread must not touch the socket once it is parked */
+        session->serviceStopCondition = COND_SERVICE_STOP_PARKED;
+        if(0 == parkClientSession(parked)) {
             
-            strcpy(envVarConfMsg, RES_STR_SCONF_ERR);
+            return error;
         }
-    }
-    else {
         
-        /* Humidity config status off */
-        strcpy(envVarConfMsg, RES_STR_SCONF_OFF);
+        session->serviceStopCondition = COND_SERVICE_STOP_FALSE;
     }
     
-    /* Send humidity config */
-    len = send(clientSocket, &envVarConfMsg, sizeof(envVarConfMsg), MSG_NOSIGNAL);
+    free(subscription);
+    free(parked);
+    
+    /* Failed to park client session: end subscription right away */
+    logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_PARK_FAIL, user->name);
+    
+    resBuf[0] = RES_CODE_PUSH_END;
+    memset(&resBuf[1], 0, RES_PUSH_END_LEN - 1);
+    
+    len = send(clientSocket, resBuf, sizeof(resBuf), MSG_NOSIGNAL);
     if(len < 0) {
         
-        /* Failed to send temperature config to client */
+        /* Failed to send end frame to client */
 #ifdef SERVER_DEBUG
         perror("send");
-        fprintf(stderr, LOG_SYS_ERR_SERVER_CONF_HUM_SEND_FAIL, user->name);
         fflush(stderr);
 #endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_CONF_HUM_SEND_FAIL, user->name);
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_SUB_SEND_FAIL, user->name);
         
         error = -1;
         return error;
     }
     
-    /* Parse and send pressure config */
+    return error;
+}
+
+/*
+ * Function 'historyDataHandler': transfers recent samples selected by sequence number to client.
+ * 
+ * Note:        Served from the in-memory sample history of the sensor (SAMPLE_HISTORY_SIZE
+ *              samples) without locking, e.g. to repair the gaps of the multicast feed.
+ *              The sensor is part of the query as multicast receivers see all sensors.
+ *              Samples overwritten already or not taken yet are left out, each sample
+ *              carries its sequence number.
+ * 
+ * Protocol:    Client --> Server: get recent samples request code <1 byte>
+ *              Client <-- Server: result of request code validation <1 byte>
+ * 
+ *              ++ In case of successful request validation ++
+ * 
+ *              Client --> Server: sensor ID <1 byte>
+ *              Client --> Server: sequence number of the first sample <8 bytes>
+ *              Client --> Server: number of samples <1 byte> (max. REQ_HIST_COUNT_MAX)
+ *              Client <-- Server: result of request processing <1 byte>
+ * 
+ *              ++ In case of successful request processing ++
+ * 
+ *              Client <-- Server: number of samples sent <1 byte>
+ *              Client <-- Server: samples <32 bytes each> (see latestDataHandler)
+ */
+int historyDataHandler(int clientSocket, const struct UserData *user, void *customArg) {
     
-    memset(envVarConfMsg, 0, sizeof(envVarConfMsg)); // Reset shared variable
+    uint8_t queryBuf[REQ_HIST_LEN];                             // History query
+    uint8_t resBuf[2 + REQ_HIST_COUNT_MAX * RES_LATEST_LEN];    // Response, count and samples
+    uint8_t *sampleMsg = NULL;
+    uint64_t firstSeq = 0;                      // Sequence number of the first sample
+    int count = 0;                              // Number of samples sent
+    int error = 0;
+    int len;
+    int i;
     
-    /* Parse pressure config */
-    if(copy_of_sensorSettingSel & BME280_OSR_PRESS_SEL) {
-        
-        /* Pressure config status on */
-        
-        if(BME280_NO_OVERSAMPLING == copy_of_sensorDev.settings.osr_p) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_OFF);
-        }
-        else if(BME280_OVERSAMPLING_1X == copy_of_sensorDev.settings.osr_p) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_1X);
-        }
-        else if(BME280_OVERSAMPLING_2X == copy_of_sensorDev.settings.osr_p) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_2X);
-        }
-        else if(BME280_OVERSAMPLING_4X == copy_of_sensorDev.settings.osr_p) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_4X);
-        }
-        else if(BME280_OVERSAMPLING_8X == copy_of_sensorDev.settings.osr_p) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_8X);
-        }   
-        else if(BME280_OVERSAMPLING_16X == copy_of_sensorDev.settings.osr_p) {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_OVERSAMPLING_16X);
-        }
-        else {
-            
-            strcpy(envVarConfMsg, RES_STR_SCONF_ERR);
-        }
-    }
-    else {
-        
-        /* Pressure config status off */
-        strcpy(envVarConfMsg, RES_STR_SCONF_OFF);
-    }
+    struct LatestSample sample;
     
-    /* Send pressure config */
-    len = send(clientSocket, &envVarConfMsg, sizeof(envVarConfMsg), MSG_NOSIGNAL);
-    if(len < 0) {
+    /* Get query from client */
+    len = recv(clientSocket, queryBuf, sizeof(queryBuf), MSG_WAITALL);
+    if(len < (int)sizeof(queryBuf)) {
         
-        /* Failed to send pressure config to client */
+        /* Failed to receive client history query */
 #ifdef SERVER_DEBUG
-        perror("send");
-        fprintf(stderr, LOG_SYS_ERR_SERVER_CONF_PRS_SEND_FAIL, user->name);
+        perror("recv");
         fflush(stderr);
 #endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_CONF_PRS_SEND_FAIL, user->name);
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_HIST_FAIL, user->name);
         
         error = -1;
         return error;
     }
     
-    /* Parse and send IIR filter config */
+    memcpy(&firstSeq, &queryBuf[1], sizeof(firstSeq));
+    
+    /* Syslog client requested sample history */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_HIST, (unsigned)queryBuf[9], (unsigned)queryBuf[0],
+             (unsigned long long)firstSeq, user->name);
     
-    /* Parse IIR filter config */
-    if(copy_of_sensorSettingSel & BME280_FILTER_SEL) {
+    if((queryBuf[0] >= sensorCount) || (0 == firstSeq) || (0 == queryBuf[9]) || (queryBuf[9] > REQ_HIST_COUNT_MAX)) {
         
-        /* IIR filter config status on */
+        /* Invalid history query */
+        logEvent(LOG_ERR, LOG_SYS_ERR_CLIENT_REQ_HIST_INVAL, user->name);
         
-        if(BME280_FILTER_COEFF_OFF == copy_of_sensorDev.settings.filter) {
-            
-            strcpy(iirFltrConfMsg, RES_STR_SCONF_IIR_COEFF_OFF);
-        }
-        else if(BME280_FILTER_COEFF_2 == copy_of_sensorDev.settings.filter) {
-            
-            strcpy(iirFltrConfMsg, RES_STR_SCONF_IIR_COEFF_2);
-        }
-        else if(BME280_FILTER_COEFF_4 == copy_of_sensorDev.settings.filter) {
-            
-            strcpy(iirFltrConfMsg, RES_STR_SCONF_IIR_COEFF_4);
-        }
-        else if(BME280_FILTER_COEFF_8 == copy_of_sensorDev.settings.filter) {
-            
-            strcpy(iirFltrConfMsg, RES_STR_SCONF_IIR_COEFF_8);
-        }
-        else if(BME280_FILTER_COEFF_16 == copy_of_sensorDev.settings.filter) {
-            
-            strcpy(iirFltrConfMsg, RES_STR_SCONF_IIR_COEFF_16);
-        }
-        else {
-            
-            strcpy(iirFltrConfMsg, RES_STR_SCONF_ERR);
-        }
+        error = -1;
+        return error;
     }
-    else {
+    
+    /* Copy the samples still kept in memory */
+    for(i = 0; i < queryBuf[9]; i++) {
         
-        /* IIR fitter config status off */
-        strcpy(iirFltrConfMsg, RES_STR_SCONF_OFF);
+        if(0 == readSampleHistory(&(sensorArray[queryBuf[0]]), firstSeq + i, &sample)) {
+            
+            sampleMsg = &resBuf[2 + count * RES_LATEST_LEN];
+            memcpy(&sampleMsg[0], &(sample.seq), sizeof(sample.seq));
+            memcpy(&sampleMsg[8], &(sample.timeUs), sizeof(sample.timeUs));
+            memcpy(&sampleMsg[16], &(sample.temp), sizeof(sample.temp));
+            memcpy(&sampleMsg[20], &(sample.hum), sizeof(sample.hum));
+            memcpy(&sampleMsg[24], &(sample.press), sizeof(sample.press));
+            memcpy(&sampleMsg[28], &(sample.configVersion), sizeof(sample.configVersion));
+            count++;
+        }
     }
     
-    /* Send IIR filter config */
-    len = send(clientSocket, &iirFltrConfMsg, sizeof(iirFltrConfMsg), MSG_NOSIGNAL);
+    resBuf[0] = RES_CODE_REQ_SUCCESS;
+    resBuf[1] = (uint8_t)count;
+    
+    len = send(clientSocket, resBuf, 2 + count * RES_LATEST_LEN, MSG_NOSIGNAL);
     if(len < 0) {
         
-        /* Failed to send IIR filter config to client */
+        /* Failed to send samples to client */
 #ifdef SERVER_DEBUG
         perror("send");
-        fprintf(stderr, LOG_SYS_ERR_SERVER_CONF_IIR_SEND_FAIL, user->name);
         fflush(stderr);
 #endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_CONF_IIR_SEND_FAIL, user->name);
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_HIST_SEND_FAIL, user->name);
         
         error = -1;
         return error;
     }
     
-    // PERIOD   <VAL>
-    // TEMP     <X|OS_OFF|OS_1X|OS_2X|OS_4X|OS_8X|OS_16X>
-    // HUM                      -,,-
-    // PRESS                    -,,-
-    // IIR      <X|COEFF_OFF|COEFF_2|COEFF_4|COEFF_8|COEFF_16>
-    
-    /* Syslog successful config data transmission */
-#ifdef SERVER_DEBUG
-    fprintf(stdout, LOG_SYS_INFO_CLIENT_REQ_GET_CONF_SUCCESS, user->name);
-    fflush(stdout);
-#endif
-    syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_GET_CONF_SUCCESS, user->name);
-    
     return error;
 }
 
 /*
- * Function 'removeDataHandler': removes measurement data requested by client.
+ * Function 'statsHandler': transfers a snapshot of the server statistics to client.
  * 
- * Protocol:    Client --> Server: remove measurement data request code <1 byte>
+ * Note:        Counters are summed over the threads, histograms are summarized by
+ *              the server (percentiles within the histogram precision, see metrics.c).
+ *              Histograms without values are left out.
+ * 
+ * Protocol:    Client --> Server: statistics request code <1 byte>
  *              Client <-- Server: result of request code validation <1 byte>
  * 
  *              ++ In case of successful request validation ++
  * 
  *              Client <-- Server: result of request processing <1 byte>
+ *              Client <-- Server: uptime <8 bytes> (usec)
+ *              Client <-- Server: number of counters <1 byte>
+ *              Client <-- Server: number of histograms <1 byte>
+ *              Client <-- Server: counters <<number of counters> * 9 bytes> (ID <1>, value <8>)
+ *              Client <-- Server: histograms <<number of histograms> * 66 bytes>
+ *                                 (ID <1>, key <1>, count, mean, min, p50, p90, p99, p99.9, max <8 each>)
  */
-int removeDataHandler(int clientSocket, const struct UserData *user, void *customArg) {
+int statsHandler(int clientSocket, const struct UserData *user, void *customArg) {
     
-    uint8_t response = 0;
+    const double quantileTable[] = {0.5, 0.9, 0.99, 0.999};
+    
+    uint8_t resBuf[RES_STATS_MAX_LEN];          // Response and statistics
+    uint8_t *entry = NULL;
+    uint64_t value = 0;
+    int counterCount = 0;
+    int histCount = 0;
     int error = 0;
     int len;
+    int i;
+    int j;
     
-    /* Syslog client requested to remove measurement data */
-#ifdef SERVER_DEBUG
-    fprintf(stdout, LOG_SYS_INFO_CLIENT_REQ_RMV_DATA, user->name);
-    fflush(stdout);
-#endif
-    syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_RMV_DATA, user->name);
-    
-    /* Check if file is open (= has content) */
+    struct LogCounters logCounters;
+    struct MetricSnapshot *snapshot = NULL;
+    struct MetricHist *hist = NULL;
     
-    pthread_mutex_lock(&savedDataMutex);
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_STATS, user->name);
     
-    if(savedDataFd < 0) {
+    /* Snapshot is too large for the stack of the service thread */
+    snapshot = malloc(sizeof(struct MetricSnapshot));
+    if((NULL == snapshot) || (0 != getMetricSnapshot(snapshot))) {
         
-        /* File is closed (does not have content) */
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_STATS_FAIL, user->name);
+        free(snapshot);
         
-        /* Nothing to do */
-        pthread_mutex_unlock(&savedDataMutex);
+        error = -1;
+        return error;
     }
-    else {
-        
-        /* File is open (does have content) */
-        
-        /* Remove content of file by reopening it */
     
-        /* Close file */
-        if(close(savedDataFd) < 0) {
+    getLogCounters(&logCounters);
+    
+    /* Counters */
+    entry = &resBuf[1 + RES_STATS_HEADER_LEN];
+    for(i = 0; i < STATS_CNT_COUNT; i++) {
+        
+        if(i < METRIC_CNT_REQ_INVALID) {
             
-#ifdef SERVER_DEBUG
-            perror("close");
-            fprintf(stderr, LOG_SYS_ERR_SERVER_SAVE_CLOSE_FAIL);
-            fprintf(stderr, LOG_SYS_ERR_SERVER_RMV_DATA_FAIL, user->name);
-            fflush(stderr);
-#endif
-            syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_CLOSE_FAIL);
-            syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_RMV_DATA_FAIL, user->name);
+            value = snapshot->counter[i];
+        }
+        else {
             
-            pthread_mutex_unlock(&savedDataMutex);
-            error = -1;
-            return error;
+            value = (STATS_CNT_LOG_FORWARDED == i) ? logCounters.forwarded :
+                    (STATS_CNT_LOG_DROPPED == i) ? logCounters.dropped : logCounters.suppressed;
         }
         
-        savedDataFd = SAVED_DATA_FD_INVALID;
+        entry[0] = (uint8_t)i;
+        memcpy(&entry[1], &value, sizeof(value));
+        entry += RES_STATS_COUNTER_LEN;
+        counterCount++;
+    }
+    
+    /* Histogram summaries */
+    for(i = 0; i < METRIC_HIST_COUNT; i++) {
         
-        /* Open file */
-        savedDataFd = open(savedDataFilePath, O_CREAT | O_TRUNC | O_RDWR, 0644);
-        if(savedDataFd < 0) {
-                    
-#ifdef SERVER_DEBUG
-            perror("open");
-            fprintf(stderr, LOG_SYS_ERR_SERVER_SAVE_OPEN_FAIL);
-            fprintf(stderr, LOG_SYS_ERR_SERVER_RMV_DATA_FAIL, user->name);
-            fflush(stderr);
-#endif
-            syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_OPEN_FAIL);
-            syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_RMV_DATA_FAIL, user->name);
+        hist = &(snapshot->hist[i]);
+        if(0 == hist->count) {
             
-            pthread_mutex_unlock(&savedDataMutex);
-            error = -1;
-            return error;
+            continue;
         }
         
-        /* At this point the content of the file is removed */
+        if(i < METRIC_HIST_REQUEST) {
+            
+            entry[0] = statsHistIdTable[i];
+            entry[1] = 0;
+        }
+        else if(i < METRIC_HIST_LOCK_WAIT) {
+            
+            entry[0] = STATS_HIST_REQUEST;
+            entry[1] = requestArray[i - METRIC_HIST_REQUEST].requestCode;
+        }
+        else if(i < METRIC_HIST_LOCK_HOLD) {
+            
+            entry[0] = STATS_HIST_LOCK_WAIT;
+            entry[1] = (uint8_t)(i - METRIC_HIST_LOCK_WAIT);
+        }
+        else {
+            
+            entry[0] = STATS_HIST_LOCK_HOLD;
+            entry[1] = (uint8_t)(i - METRIC_HIST_LOCK_HOLD);
+        }
+        
+        memcpy(&entry[2], &(hist->count), sizeof(hist->count));
+        value = hist->sum / hist->count;
+        memcpy(&entry[10], &value, sizeof(value));
+        memcpy(&entry[18], &(hist->min), sizeof(hist->min));
+        for(j = 0; j < (int)(sizeof(quantileTable) / sizeof(quantileTable[0])); j++) {
+            
+            value = getMetricPercentile(hist, quantileTable[j]);
+            memcpy(&entry[26 + j * 8], &value, sizeof(value));
+        }
+        memcpy(&entry[58], &(hist->max), sizeof(hist->max));
         
-        pthread_mutex_unlock(&savedDataMutex);
+        entry += RES_STATS_HIST_LEN;
+        histCount++;
     }
     
-    /* Syslog success */
-#ifdef SERVER_DEBUG
-    fprintf(stdout, LOG_SYS_INFO_CLIENT_REQ_RMV_DATA_SUCCESS, user->name);
-    fflush(stdout);
-#endif
-    syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_RMV_DATA_SUCCESS, user->name);
+    resBuf[0] = RES_CODE_REQ_SUCCESS;
+    value = snapshot->uptimeNs / NSEC_PER_USEC;
+    memcpy(&resBuf[1], &value, sizeof(value));
+    resBuf[9] = (uint8_t)counterCount;
+    resBuf[10] = (uint8_t)histCount;
     
-    /* Notify client on success */
-    response = RES_CODE_REQ_SUCCESS;
-    len = send(clientSocket, &response, sizeof(response), MSG_NOSIGNAL);
+    free(snapshot);
+    
+    len = send(clientSocket, resBuf, entry - resBuf, MSG_NOSIGNAL);
     if(len < 0) {
         
-        /* Failed to send server response to client */
+        /* Failed to send statistics to client */
 #ifdef SERVER_DEBUG
         perror("send");
-        fprintf(stderr, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
         fflush(stderr);
 #endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_RES_FAIL, user->name, response);
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_STATS_SEND_FAIL, user->name);
+        
         error = -1;
+        return error;
     }
-
+    
     return error;
 }
 
 /*
- * Function 'getDataHandler': returns measurement data requested by client.
+ * Function 'traceHandler': transfers the recorded request and sample spans to client (Chrome trace JSON).
  * 
- * Protocol:    Client --> Server: transfer measurement data request code <1 byte>
+ * Note:        Spans of every thread still in its ring are sent (see tracer.c), the
+ *              JSON can be opened by chrome://tracing or Perfetto as it is. Empty if
+ *              the server runs without tracing (-T).
+ * 
+ * Protocol:    Client --> Server: trace request code <1 byte>
  *              Client <-- Server: result of request code validation <1 byte>
  * 
  *              ++ In case of successful request validation ++
  * 
- *              Client <-- Server: file size <4 bytes>
- *              Client <-- Server: file content <<file size> bytes>  (if not empty)
+ *              Client <-- Server: result of request processing <1 byte>
+ *              Client <-- Server: JSON length <4 bytes>
+ *              Client <-- Server: JSON <<JSON length> bytes>
  */
-int getDataHandler(int clientSocket, const struct UserData *user, void *customArg) {
-    
-    uint8_t response = 0;           // Not used
-    int error = 0;                  // Error indicator
-    int len;
-    int fileSize = 0;               // Measurement data file size
-    
-    off_t fileOffset = 0;
-    struct stat fileStat;
+int traceHandler(int clientSocket, const struct UserData *user, void *customArg) {
     
-    /* Syslog client requested to get measurement data */
-#ifdef SERVER_DEBUG
-    fprintf(stdout, LOG_SYS_INFO_CLIENT_REQ_GET_DATA, user->name);
-    fflush(stdout);
-#endif
-    syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_GET_DATA, user->name);
+    struct ExportText text;
+    uint32_t jsonLen;
+    ssize_t len;
+    int error = 0;
     
-    /* Check if saved data file is open */
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_TRACE, user->name);
     
-    pthread_mutex_lock(&savedDataMutex);
+    memset(&text, 0, sizeof(text));
+    text.size = TRACE_TEXT_INIT_LEN;
+    text.data = (char*)malloc(text.size);
     
-    if(savedDataFd < 0) {
-     
-        /* Saved data file is closed */
-#ifdef SERVER_DEBUG
-        fprintf(stderr, LOG_SYS_ERR_SERVER_FCONT_ACCESS_FAIL, user->name);
-        fflush(stderr);
-#endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_FCONT_ACCESS_FAIL, user->name);
+    /* JSON follows the header */
+    text.len = RES_TRACE_HEADER_LEN;
+    if((NULL == text.data) || (0 != buildTraceJson(&text))) {
         
-        // TODO Enhance security by sending client an invalid size
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_TRACE_FAIL, user->name);
+        free(text.data);
         
-        pthread_mutex_unlock(&savedDataMutex);
         error = -1;
         return error;
     }
     
-    /* Get file stat including file size */
-    if(0 > fstat(savedDataFd, &fileStat)) {
-        
-        /* Failed to get file stat */
-#ifdef SERVER_DEBUG
-        perror("fstat");
-        fprintf(stderr, LOG_SYS_ERR_SERVER_FSTAT_GET_FAIL);
-        fflush(stderr);
-#endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_FSTAT_GET_FAIL);
-        
-        // TODO Enhance security by sending client an invalid size
-        
-        pthread_mutex_unlock(&savedDataMutex);
-        error = -1;
-        return error;
-    }
+    text.data[0] = RES_CODE_REQ_SUCCESS;
+    jsonLen = (uint32_t)(text.len - RES_TRACE_HEADER_LEN);
+    memcpy(&(text.data[1]), &jsonLen, sizeof(jsonLen));
     
-    fileSize = fileStat.st_size;
+    len = send(clientSocket, text.data, text.len, MSG_NOSIGNAL);
+    free(text.data);
     
-    /* Send file size to client */
-    len = send(clientSocket, &fileSize, sizeof(fileSize), MSG_NOSIGNAL);
     if(len < 0) {
         
-        /* Failed to send file size to client */
+        /* Failed to send trace to client */
 #ifdef SERVER_DEBUG
         perror("send");
-        fprintf(stderr, LOG_SYS_ERR_SERVER_FSIZE_SEND_FAIL, user->name);
         fflush(stderr);
 #endif
-        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_FSIZE_SEND_FAIL, user->name);
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_TRACE_SEND_FAIL, user->name);
         
-        pthread_mutex_unlock(&savedDataMutex);
         error = -1;
         return error;
     }
     
-    /* If file size is 0 kB do not send anything */
-    /* Client will receive size and do so */
-    
-    if(0 != fileSize) {
-        
-        /* Send file content to client */
-        len = sendfile(clientSocket, savedDataFd, &fileOffset, fileSize);
-        if(len < 0) {
-         
-            /* Failed to send file content to client */
-#ifdef SERVER_DEBUG
-            perror("sendfile");
-            fprintf(stderr, LOG_SYS_ERR_SERVER_FCONT_SEND_FAIL, user->name);
-            fflush(stderr);
-#endif
-            syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_FCONT_SEND_FAIL, user->name);
-            
-            pthread_mutex_unlock(&savedDataMutex);
-            error = len;
-            return error;
-        }
-    }
-    
-    pthread_mutex_unlock(&savedDataMutex);
-    
-    /* Syslog successful data transfer */
-    if(0 == error) {
-        
-#ifdef SERVER_DEBUG
-        fprintf(stdout, LOG_SYS_INFO_CLIENT_REQ_GET_DATA_SUCCESS, user->name);
-        fflush(stdout);
-#endif
-        syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_CLIENT_REQ_GET_DATA_SUCCESS, user->name);
-    }
-    
     return error;
 }
@@ -0,0 +1,759 @@
+/*
+ * FileName:    storage.c
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ *
+ * Desc.:       Source file containing the queries of the saved measurement data:
+ *              record lookup by time, aggregation and downsampling scans.
+ *
+ *              The scans read the saved data file in blocks, transpose the channels
+ *              of a block into columns and run vectorized kernels (GCC vector
+ *              extensions: NEON on the Pi, SSE on x86) over the columns.
+ *
+ *              Downsampling (Largest-Triangle-Three-Buckets, fixed interval linear
+ *              resampling) streams the records once, keeping two LTTB buckets or the
+ *              previous point per channel.
+ *
+ *              The channels and sample times are also appended to column files next
+ *              to the saved data file, so a fetch of some columns reads only those.
+ */
+
+#include <float.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bme280_qt_interf_v2.h"
+#include "myserver.h"
+
+/* Vector types of the scan kernels */
+#define AGG_VECTOR_LANES                            (4)
+
+typedef float AggVector __attribute__((vector_size(AGG_VECTOR_LANES * sizeof(float))));
+typedef int32_t AggMask __attribute__((vector_size(AGG_VECTOR_LANES * sizeof(int32_t))));
+
+/* Offsets of the channels in a saved record (indexed like REQ_AGG_CH_... bits) */
+static const size_t savedRecordChannelOffset[SAVED_DATA_CHANNELS] = {
+    
+    offsetof(struct SavedDataRecord, temp),
+    offsetof(struct SavedDataRecord, hum),
+    offsetof(struct SavedDataRecord, press)
+};
+
+/* Streaming state of a channel downsampled with LTTB */
+struct LttbState {
+    
+    uint64_t recordCount;               // Records in the time range
+    uint32_t threshold;                 // Number of points to keep
+    uint32_t bucket;                    // Bucket being filled (next bucket)
+    struct SamplePoint selected;        // Point selected from the previous bucket
+    int selectedValid;
+    struct SamplePoint last;            // Latest valid point
+    struct SamplePoint *cur;            // Points of the current bucket
+    uint32_t curCount;
+    struct SamplePoint *next;           // Points of the next bucket
+    uint32_t nextCount;
+    struct SamplePoint *out;            // Downsampled points
+    uint32_t outCount;
+};
+
+/* Streaming state of a channel resampled to a fixed interval */
+struct ResampleState {
+    
+    uint64_t gridUs;                    // Next output time [usec]
+    uint64_t fromUs;                    // Grid origin [usec]
+    uint64_t toUs;                      // End of time range [usec]
+    uint64_t intervalUs;                // Grid interval [usec]
+    struct SamplePoint prev;            // Previous valid point
+    int prevValid;
+    struct SamplePoint *out;            // Resampled points
+    uint32_t outCount;
+    uint32_t maxPoints;
+};
+
+/* Function definitions */
+
+/*
+ * Function 'aggScanColumn': adds the valid values of a column to the running aggregates.
+ *
+ * Note:    Values equal to SAVED_DATA_INVALID_VALUE (disabled channel) are masked out.
+ *          Sums are accumulated in float lanes relative to the reference value and
+ *          folded into the double sums once per call (columns are short).
+ */
+static void aggScanColumn(const float *column, uint32_t count, struct AggStats *stats) {
+    
+    const AggVector vInvalid = {SAVED_DATA_INVALID_VALUE, SAVED_DATA_INVALID_VALUE,
+                                SAVED_DATA_INVALID_VALUE, SAVED_DATA_INVALID_VALUE};
+    AggVector vRef;
+    AggVector vMin = {FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX};
+    AggVector vMax = {-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX};
+    AggVector vSum = {0.0f, 0.0f, 0.0f, 0.0f};
+    AggVector vSumSq = {0.0f, 0.0f, 0.0f, 0.0f};
+    AggVector x;
+    AggVector d;
+    AggMask vCount = {0, 0, 0, 0};
+    AggMask valid;
+    AggMask sel;
+    uint32_t i = 0;
+    int lane;
+    
+    /* Take the first valid value as reference */
+    if(0 == stats->count) {
+        
+        while((i < count) && (SAVED_DATA_INVALID_VALUE == column[i])) {
+            
+            i++;
+        }
+        if(i == count) {
+            
+            return;
+        }
+        
+        stats->ref = column[i];
+        stats->min = column[i];
+        stats->max = column[i];
+    }
+    vRef = (AggVector){stats->ref, stats->ref, stats->ref, stats->ref};
+    
+    /* Vector part */
+    for(; (i + AGG_VECTOR_LANES) <= count; i += AGG_VECTOR_LANES) {
+        
+        memcpy(&x, &column[i], sizeof(x));
+        valid = (x != vInvalid);
+        
+        d = (AggVector)((AggMask)(x - vRef) & valid);
+        vSum += d;
+        vSumSq += d * d;
+        vCount -= valid;                // Lanes of valid values are -1
+        
+        sel = (x < vMin) & valid;
+        vMin = (AggVector)(((AggMask)x & sel) | ((AggMask)vMin & ~sel));
+        sel = (x > vMax) & valid;
+        vMax = (AggVector)(((AggMask)x & sel) | ((AggMask)vMax & ~sel));
+    }
+    
+    /* Fold lanes */
+    for(lane = 0; lane < AGG_VECTOR_LANES; lane++) {
+        
+        stats->count += vCount[lane];
+        stats->sum += vSum[lane];
+        stats->sumSq += vSumSq[lane];
+        stats->min = (vMin[lane] < stats->min) ? vMin[lane] : stats->min;
+        stats->max = (vMax[lane] > stats->max) ? vMax[lane] : stats->max;
+    }
+    
+    /* Scalar tail */
+    for(; i < count; i++) {
+        
+        if(SAVED_DATA_INVALID_VALUE != column[i]) {
+            
+            stats->count++;
+            stats->sum += column[i] - stats->ref;
+            stats->sumSq += (double)(column[i] - stats->ref) * (column[i] - stats->ref);
+            stats->min = (column[i] < stats->min) ? column[i] : stats->min;
+            stats->max = (column[i] > stats->max) ? column[i] : stats->max;
+        }
+    }
+}
+
+/*
+ * Function 'getRecordTimeUs': returns the sample time of a saved record [usec].
+ */
+uint64_t getRecordTimeUs(const struct SavedDataRecord *record) {
+    
+    return (uint64_t)record->timeSec * USEC_PER_SEC + record->timeUsec;
+}
+
+/*
+ * Function 'readSavedRecord': reads a record of the saved data file.
+ */
+int readSavedRecord(int fd, uint64_t index, struct SavedDataRecord *record) {
+    
+    int error = 0;
+    
+    if(sizeof(*record) != pread(fd, record, sizeof(*record), (off_t)(index * sizeof(*record)))) {
+        
+        error = -1;
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'findSavedRecord': returns the index of the first saved record not older than a given time.
+ *
+ * Note:    Binary search, records are appended in time order. The index equals
+ *          recordCount if every record is older.
+ */
+int findSavedRecord(int fd, uint64_t recordCount, uint64_t timeUs, uint64_t *index) {
+    
+    struct SavedDataRecord record;
+    uint64_t low = 0;
+    uint64_t high = recordCount;
+    uint64_t mid;
+    int error = 0;
+    
+    while(low < high) {
+        
+        mid = low + (high - low) / 2;
+        if(0 != readSavedRecord(fd, mid, &record)) {
+            
+            error = -1;
+            return error;
+        }
+        
+        if(getRecordTimeUs(&record) < timeUs) {
+            
+            low = mid + 1;
+        }
+        else {
+            
+            high = mid;
+        }
+    }
+    
+    *index = low;
+    
+    return error;
+}
+
+/*
+ * Function 'resolveSavedRange': resolves the open ends of a time range and locates its records.
+ * 
+ * Note:    A zero start (end) selects the first (last) saved record. On return the
+ *          records of the range are [firstIndex, endIndex), empty if the range is.
+ */
+int resolveSavedRange(int fd, uint64_t recordCount, uint64_t *fromUs, uint64_t *toUs, uint64_t *firstIndex,
+                      uint64_t *endIndex) {
+    
+    struct SavedDataRecord record;
+    int error = 0;
+    
+    *firstIndex = 0;
+    *endIndex = 0;
+    
+    if(0 == recordCount) {
+        
+        return error;
+    }
+    
+    if(0 == *fromUs) {
+        
+        if(0 != readSavedRecord(fd, 0, &record)) {
+            
+            error = -1;
+            return error;
+        }
+        *fromUs = getRecordTimeUs(&record);
+    }
+    if(0 == *toUs) {
+        
+        if(0 != readSavedRecord(fd, recordCount - 1, &record)) {
+            
+            error = -1;
+            return error;
+        }
+        *toUs = getRecordTimeUs(&record) + 1;
+    }
+    
+    if(*toUs <= *fromUs) {
+        
+        return error;
+    }
+    
+    if((0 != findSavedRecord(fd, recordCount, *fromUs, firstIndex)) ||
+       (0 != findSavedRecord(fd, recordCount, *toUs, endIndex))) {
+        
+        *firstIndex = 0;
+        *endIndex = 0;
+        error = -1;
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'aggregateSavedData': aggregates the saved records of a time range into buckets.
+ *
+ * Note:    Scans the records [firstIndex, endIndex) in a single pass. Consecutive records of the same bucket are handed to the kernel
+ *          together. The buckets array holds query->bucketCount zeroed items.
+ */
+int aggregateSavedData(int fd, uint64_t firstIndex, uint64_t endIndex, const struct AggQuery *query,
+                       struct AggBucket *buckets) {
+    
+    struct SavedDataRecord block[SAVED_DATA_SCAN_RECORDS];     // Records read at once
+    float column[SAVED_DATA_SCAN_RECORDS];                      // A channel of the records
+    int32_t bucketSel[SAVED_DATA_SCAN_RECORDS];                 // Bucket of the records (-1: out of range)
+    uint64_t index = firstIndex;
+    uint64_t timeUs;
+    uint32_t count;
+    uint32_t i;
+    uint32_t j;
+    ssize_t size;
+    int channel;
+    int done = 0;
+    int error = 0;
+    
+    while((!done) && (index < endIndex)) {
+        
+        /* Read block of records */
+        count = ((endIndex - index) < SAVED_DATA_SCAN_RECORDS) ? (uint32_t)(endIndex - index) : SAVED_DATA_SCAN_RECORDS;
+        size = pread(fd, block, count * sizeof(block[0]), (off_t)(index * sizeof(block[0])));
+        if(size < 0) {
+            
+            error = -1;
+            return error;
+        }
+        
+        count = (uint32_t)(size / sizeof(block[0]));
+        if(0 == count) {
+            
+            /* File truncated meanwhile */
+            break;
+        }
+        index += count;
+        
+        /* Assign records to buckets, stop at the end of the time range */
+        for(i = 0; i < count; i++) {
+            
+            timeUs = getRecordTimeUs(&block[i]);
+            if(timeUs >= query->toUs) {
+                
+                count = i;
+                done = 1;
+                break;
+            }
+            
+            if(timeUs < query->fromUs) {
+                
+                bucketSel[i] = -1;
+            }
+            else if(0 == query->bucketUs) {
+                
+                bucketSel[i] = 0;
+            }
+            else {
+                
+                bucketSel[i] = (int32_t)((timeUs - query->fromUs) / query->bucketUs);
+                if(bucketSel[i] >= (int32_t)query->bucketCount) {
+                    
+                    bucketSel[i] = query->bucketCount - 1;
+                }
+            }
+        }
+        
+        /* Scan selected channels column by column */
+        for(channel = 0; channel < SAVED_DATA_CHANNELS; channel++) {
+            
+            if(0 == (query->channels & (1 << channel))) {
+                
+                continue;
+            }
+            
+            for(i = 0; i < count; i++) {
+                
+                memcpy(&column[i], (const uint8_t*)&block[i] + savedRecordChannelOffset[channel], sizeof(column[i]));
+            }
+            
+            for(i = 0; i < count; i = j) {
+                
+                for(j = i + 1; (j < count) && (bucketSel[j] == bucketSel[i]); j++);
+                
+                if(bucketSel[i] >= 0) {
+                    
+                    aggScanColumn(&column[i], j - i, &(buckets[bucketSel[i]].stats[channel]));
+                }
+            }
+        }
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'lttbSelect': selects the point of a bucket forming the largest triangle
+ *                        with the previously selected point and a third point.
+ */
+static const struct SamplePoint* lttbSelect(const struct SamplePoint *bucket, uint32_t count,
+                                            const struct SamplePoint *a, double cTime, double cValue) {
+    
+    const struct SamplePoint *best = &bucket[0];
+    double bestArea = -1.0;
+    double area;
+    double bTime;
+    uint32_t i;
+    
+    /* Times relative to the selected point (twice the area is compared) */
+    cTime -= (double)a->timeUs;
+    for(i = 0; i < count; i++) {
+        
+        bTime = (double)(bucket[i].timeUs - a->timeUs);
+        area = (bTime * (cValue - a->value)) - (cTime * (bucket[i].value - a->value));
+        area = (area < 0.0) ? -area : area;
+        if(area > bestArea) {
+            
+            bestArea = area;
+            best = &bucket[i];
+        }
+    }
+    
+    return best;
+}
+
+/*
+ * Function 'lttbCloseBucket': selects a point of the current bucket once the next bucket is complete.
+ * 
+ * Note:    Empty buckets are skipped: an empty next bucket keeps the current one
+ *          pending, an empty current bucket is replaced by the next one.
+ */
+static void lttbCloseBucket(struct LttbState *state) {
+    
+    struct SamplePoint *swap;
+    double avgTime = 0.0;
+    double avgValue = 0.0;
+    uint32_t i;
+    
+    if(0 == state->nextCount) {
+        
+        return;
+    }
+    
+    if(0 != state->curCount) {
+        
+        /* Third point: average of the next bucket */
+        for(i = 0; i < state->nextCount; i++) {
+            
+            avgTime += (double)state->next[i].timeUs;
+            avgValue += state->next[i].value;
+        }
+        avgTime /= state->nextCount;
+        avgValue /= state->nextCount;
+        
+        state->selected = *lttbSelect(state->cur, state->curCount, &(state->selected), avgTime, avgValue);
+        state->out[state->outCount++] = state->selected;
+    }
+    
+    swap = state->cur;
+    state->cur = state->next;
+    state->curCount = state->nextCount;
+    state->next = swap;
+    state->nextCount = 0;
+}
+
+/*
+ * Function 'lttbPush': feeds the next valid point of a channel to LTTB.
+ * 
+ * Note:    The first point of the range is always kept. Records 1 .. n-2 are split
+ *          into threshold-2 buckets by their index; the last point is kept by lttbFinish.
+ */
+static void lttbPush(struct LttbState *state, uint64_t recordIndex, const struct SamplePoint *point) {
+    
+    uint32_t bucket;
+    
+    state->last = *point;
+    
+    if(!state->selectedValid) {
+        
+        state->selected = *point;
+        state->selectedValid = 1;
+        state->out[state->outCount++] = *point;
+        return;
+    }
+    
+    if(recordIndex >= (state->recordCount - 1)) {
+        
+        /* Last record of the range */
+        return;
+    }
+    
+    bucket = (uint32_t)(((recordIndex - 1) * (state->threshold - 2)) / (state->recordCount - 2));
+    if(bucket != state->bucket) {
+        
+        lttbCloseBucket(state);
+        state->bucket = bucket;
+    }
+    
+    state->next[state->nextCount++] = *point;
+}
+
+/*
+ * Function 'lttbFinish': selects the point of the last bucket and keeps the last point.
+ */
+static void lttbFinish(struct LttbState *state) {
+    
+    lttbCloseBucket(state);
+    
+    if(0 != state->curCount) {
+        
+        state->selected = *lttbSelect(state->cur, state->curCount, &(state->selected),
+                                      (double)state->last.timeUs, state->last.value);
+        state->out[state->outCount++] = state->selected;
+    }
+    
+    if((state->selectedValid) && (state->last.timeUs != state->selected.timeUs)) {
+        
+        state->out[state->outCount++] = state->last;
+    }
+}
+
+/*
+ * Function 'resamplePush': feeds the next valid point of a channel to the resampler.
+ * 
+ * Note:    Grid times between two valid points are linearly interpolated. No value
+ *          is extrapolated before the first or after the last valid point.
+ */
+static void resamplePush(struct ResampleState *state, const struct SamplePoint *point) {
+    
+    if(!state->prevValid) {
+        
+        /* First grid time not before the first point */
+        state->gridUs = state->fromUs +
+                        ((point->timeUs - state->fromUs + state->intervalUs - 1) / state->intervalUs) * state->intervalUs;
+        if((state->gridUs == point->timeUs) && (state->outCount < state->maxPoints)) {
+            
+            state->out[state->outCount++] = *point;
+            state->gridUs += state->intervalUs;
+        }
+        
+        state->prev = *point;
+        state->prevValid = 1;
+        return;
+    }
+    
+    while((state->gridUs <= point->timeUs) && (state->gridUs < state->toUs) && (state->outCount < state->maxPoints)) {
+        
+        state->out[state->outCount].timeUs = state->gridUs;
+        state->out[state->outCount].value = state->prev.value + (float)((double)(point->value - state->prev.value) *
+                                            (double)(state->gridUs - state->prev.timeUs) /
+                                            (double)(point->timeUs - state->prev.timeUs));
+        state->outCount++;
+        state->gridUs += state->intervalUs;
+    }
+    
+    state->prev = *point;
+}
+
+/*
+ * Function 'downsampleSavedData': downsamples the channels of the saved records of a time range.
+ * 
+ * Note:    Scans the records [firstIndex, endIndex) in a single pass and feeds the
+ *          valid values of the selected channels to LTTB or to the resampler. The
+ *          points arrays of the selected channels hold maxPoints items each.
+ */
+int downsampleSavedData(int fd, uint64_t firstIndex, uint64_t endIndex, const struct DownsampleQuery *query,
+                        struct SamplePoint *points[SAVED_DATA_CHANNELS], uint32_t pointCount[SAVED_DATA_CHANNELS],
+                        uint32_t maxPoints) {
+    
+    struct SavedDataRecord block[SAVED_DATA_SCAN_RECORDS];     // Records read at once
+    struct LttbState lttb[SAVED_DATA_CHANNELS];
+    struct ResampleState resample[SAVED_DATA_CHANNELS];
+    struct SamplePoint point;
+    struct SamplePoint *bucketBuf = NULL;                       // Bucket buffers of LTTB
+    uint64_t recordCount = endIndex - firstIndex;
+    uint64_t index = firstIndex;
+    uint32_t bucketLen = 0;                                     // Max. points per LTTB bucket
+    uint32_t count;
+    uint32_t i;
+    ssize_t size;
+    int useLttb;
+    int channel;
+    int error = 0;
+    
+    memset(lttb, 0, sizeof(lttb));
+    memset(resample, 0, sizeof(resample));
+    
+    /* Keep every point if there are not more records than requested points */
+    useLttb = (REQ_DSMP_MODE_LTTB == query->mode) && (recordCount > query->param);
+    if(useLttb) {
+        
+        bucketLen = (uint32_t)((recordCount - 2 + (query->param - 2) - 1) / (query->param - 2)) + 1;
+        bucketBuf = malloc(SAVED_DATA_CHANNELS * 2 * bucketLen * sizeof(struct SamplePoint));
+        if(NULL == bucketBuf) {
+            
+            error = -1;
+            return error;
+        }
+    }
+    
+    for(channel = 0; channel < SAVED_DATA_CHANNELS; channel++) {
+        
+        lttb[channel].recordCount = recordCount;
+        lttb[channel].threshold = (uint32_t)query->param;
+        lttb[channel].out = points[channel];
+        if(useLttb) {
+            
+            lttb[channel].cur = &bucketBuf[(2 * channel) * bucketLen];
+            lttb[channel].next = &bucketBuf[(2 * channel + 1) * bucketLen];
+        }
+        
+        resample[channel].fromUs = query->fromUs;
+        resample[channel].toUs = query->toUs;
+        resample[channel].intervalUs = query->param;
+        resample[channel].out = points[channel];
+        resample[channel].maxPoints = maxPoints;
+    }
+    
+    while(index < endIndex) {
+        
+        /* Read block of records */
+        count = ((endIndex - index) < SAVED_DATA_SCAN_RECORDS) ? (uint32_t)(endIndex - index) : SAVED_DATA_SCAN_RECORDS;
+        size = pread(fd, block, count * sizeof(block[0]), (off_t)(index * sizeof(block[0])));
+        if(size < 0) {
+            
+            error = -1;
+            break;
+        }
+        
+        count = (uint32_t)(size / sizeof(block[0]));
+        if(0 == count) {
+            
+            /* File truncated meanwhile */
+            break;
+        }
+        
+        /* Feed valid values of the selected channels */
+        for(i = 0; i < count; i++) {
+            
+            point.timeUs = getRecordTimeUs(&block[i]);
+            for(channel = 0; channel < SAVED_DATA_CHANNELS; channel++) {
+                
+                if(0 == (query->channels & (1 << channel))) {
+                    
+                    continue;
+                }
+                
+                memcpy(&(point.value), (const uint8_t*)&block[i] + savedRecordChannelOffset[channel], sizeof(point.value));
+                if(SAVED_DATA_INVALID_VALUE == point.value) {
+                    
+                    continue;
+                }
+                
+                if(REQ_DSMP_MODE_RESAMPLE == query->mode) {
+                    
+                    resamplePush(&resample[channel], &point);
+                }
+                else if(useLttb) {
+                    
+                    lttbPush(&lttb[channel], index + i - firstIndex, &point);
+                }
+                else if(lttb[channel].outCount < maxPoints) {
+                    
+                    lttb[channel].out[lttb[channel].outCount++] = point;
+                }
+            }
+        }
+        index += count;
+    }
+    
+    for(channel = 0; channel < SAVED_DATA_CHANNELS; channel++) {
+        
+        if(useLttb && (query->channels & (1 << channel))) {
+            
+            lttbFinish(&lttb[channel]);
+        }
+        pointCount[channel] = (REQ_DSMP_MODE_RESAMPLE == query->mode) ? resample[channel].outCount : lttb[channel].outCount;
+    }
+    
+    free(bucketBuf);
+    
+    return error;
+}
+
+/*
+ * Function 'getSavedColumnWidth': returns the size of a column entry [byte].
+ */
+size_t getSavedColumnWidth(int column) {
+    
+    return (SAVED_DATA_COLUMN_TIME == column) ? RES_GDATP_TIME_LEN : RES_GDATP_VALUE_LEN;
+}
+
+/*
+ * Function 'extractColumn': copies a column of records into a packed buffer.
+ */
+static void extractColumn(const struct SavedDataRecord records[], uint32_t count, int column, uint8_t buf[]) {
+    
+    uint64_t timeUs;
+    uint32_t i;
+    
+    if(SAVED_DATA_COLUMN_TIME == column) {
+        
+        for(i = 0; i < count; i++) {
+            
+            timeUs = getRecordTimeUs(&records[i]);
+            memcpy(&buf[i * RES_GDATP_TIME_LEN], &timeUs, RES_GDATP_TIME_LEN);
+        }
+    }
+    else {
+        
+        for(i = 0; i < count; i++) {
+            
+            memcpy(&buf[i * RES_GDATP_VALUE_LEN], (const uint8_t*)&records[i] + savedRecordChannelOffset[column],
+                   RES_GDATP_VALUE_LEN);
+        }
+    }
+}
+
+/*
+ * Function 'appendSavedColumns': appends records to the column files of the saved data.
+ *
+ * Note:    One write per column file (opened with O_APPEND). At most SAVED_DATA_BATCH_SIZE
+ *          records. On failure the column files are out of sync with the records.
+ */
+int appendSavedColumns(const int columnFd[SAVED_DATA_COLUMNS], const struct SavedDataRecord records[], int count) {
+    
+    uint8_t buf[SAVED_DATA_BATCH_SIZE * RES_GDATP_TIME_LEN];
+    ssize_t size;
+    int column;
+    int error = 0;
+    
+    if((count < 0) || (count > SAVED_DATA_BATCH_SIZE)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    for(column = 0; column < SAVED_DATA_COLUMNS; column++) {
+        
+        extractColumn(records, (uint32_t)count, column, buf);
+        size = (ssize_t)(count * getSavedColumnWidth(column));
+        if(size != write(columnFd[column], buf, size)) {
+            
+            error = -1;
+            return error;
+        }
+    }
+    
+    return error;
+}
+
+/*
+ * Function 'projectSavedColumn': extracts a column from a block of saved records.
+ *
+ * Note:    Fallback while the column files are not usable. Reads at most
+ *          SAVED_DATA_SCAN_RECORDS records, buf holds count column entries.
+ */
+int projectSavedColumn(int fd, uint64_t firstIndex, uint32_t count, int column, uint8_t buf[]) {
+    
+    struct SavedDataRecord block[SAVED_DATA_SCAN_RECORDS];
+    ssize_t size;
+    int error = 0;
+    
+    if((count > SAVED_DATA_SCAN_RECORDS) || (column < 0) || (column >= SAVED_DATA_COLUMNS)) {
+        
+        error = -1;
+        return error;
+    }
+    
+    size = pread(fd, block, count * sizeof(block[0]), (off_t)(firstIndex * sizeof(block[0])));
+    if(size != (ssize_t)(count * sizeof(block[0]))) {
+        
+        /* Read failed or file truncated meanwhile */
+        error = -1;
+        return error;
+    }
+    
+    extractColumn(block, count, column, buf);
+    
+    return error;
+}
@@ -7,6 +7,8 @@
  *              measurement and client service threads.
  */
 
+#define _GNU_SOURCE                     // struct ucred (SO_PEERCRED)
+
 #include <errno.h>
 #include <fcntl.h>
 #include <netdb.h>
@@ -17,7 +19,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <syslog.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "bme280_qt_interf_v2.h"
@@ -25,17 +29,104 @@
 
 /* Function definitions */
 
+/*
+ * Function 'takeResumedSession': takes a client session completed by the event thread.
+ * 
+ * Note:    Call with serviceMutex locked once resumeEventFd is readable. Returns NULL
+ *          if another service thread took the session meanwhile.
+ */
+static struct ParkedSession* takeResumedSession(void) {
+    
+    uint64_t count;
+    struct ParkedSession *resumed = NULL;
+    
+    /* Semaphore eventfd: one read per queued session */
+    if(sizeof(count) != read(resumeEventFd, &count, sizeof(count))) {
+        
+        return resumed;
+    }
+    
+    pthread_mutex_lock(&parkMutex);
+    resumed = resumeQueue;
+    if(NULL != resumed) {
+        
+        resumeQueue = resumed->next;
+    }
+    pthread_mutex_unlock(&parkMutex);
+    
+    return resumed;
+}
+
+/*
+ * Function 'serveClientSession': serves the requests of an authenticated client.
+ * 
+ * Note:    Returns when the client disconnects or when a request parks the session
+ *          (COND_SERVICE_STOP_PARKED). The service socket is closed in the former
+ *          case only, a parked session is resumed later by a service thread.
+ */
+static void serveClientSession(int threadId, int serviceSocket, const struct UserData *userRef,
+                               struct ClientSession *session) {
+    
+    struct pollfd pollArray[POLL_ARRAY_SIZE];
+    uint8_t pending;
+    
+    /* Initialize poll client */
+    pollArray[POLL_ARRAY_SOCKET].fd = serviceSocket;
+    pollArray[POLL_ARRAY_SOCKET].events = POLLIN;
+    
+    session->serviceStopCondition = COND_SERVICE_STOP_FALSE;
+    
+    while(!session->serviceStopCondition) {
+    
+        /* Polling... */
+        if(poll(pollArray, POLL_ARRAY_SIZE, -1) > 0) {
+        
+            /* Unix socket clients hang up with their last request (e.g. disconnect) still unread */
+            if((pollArray[POLL_ARRAY_SOCKET].revents & (POLLERR | POLLHUP)) &&
+               (recv(serviceSocket, &pending, sizeof(pending), MSG_PEEK | MSG_DONTWAIT) <= 0)) {
+            
+                /* Client closed connection */
+                logEvent(LOG_WARNING, LOG_SYS_WARN_CLIENT_DISCONN_UNEX, threadId);
+                session->serviceStopCondition = COND_SERVICE_STOP_TRUE;
+            }
+            else if (pollArray[POLL_ARRAY_SOCKET].revents & (POLLIN)) {
+            
+                /* Message received from client */
+                clientHandler(pollArray[POLL_ARRAY_SOCKET].fd, userRef, session);
+            }
+        }
+    }
+    
+    if(COND_SERVICE_STOP_PARKED == session->serviceStopCondition) {
+        
+        /* Socket owned by the event thread now */
+        return;
+    }
+    
+    /* Close service socket */
+    close(serviceSocket);
+    
+    /* Syslog end of current service */
+    logEvent(LOG_INFO, LOG_SYS_INFO_THREAD_SERVICE_END, threadId);
+}
+
 /*
  * Function 'serviceThreadFunction': serves client connections.
+ * 
+ * Note:    Besides new connections (TCP and Unix socket), the service threads pick up
+ *          the client sessions resumed by the event thread (see waitSampleHandler).
  */
 void* serviceThreadFunction(void *arg) {
     
     int errorCode;
     int keepAliveState = 1;
     int len;
-    int serviceStopCondition = COND_SERVICE_STOP_FALSE;
     int serviceSocket;
     int threadId;
+    int unixClient = 0;                         // Accepted on the Unix socket
+    uint64_t wakeNs = 0;                        // Time of the poll wake-up [nsec]
+    uint64_t acceptNs = 0;                      // Time of accepting the connection [nsec]
+    uint64_t authNs = 0;                        // Start of authentication [nsec]
     
     uint8_t response;
     
@@ -47,15 +138,23 @@ void* serviceThreadFunction(void *arg) {
     
     const struct UserData *userRef = NULL;
     
-    struct pollfd pollArray[POLL_ARRAY_SIZE];
+    struct ClientSession session;
+    struct ParkedSession *resumed = NULL;
+    
+    struct pollfd acceptPollArray[3];
     
     struct sockaddr_in6 clientAddress;
     socklen_t clientAddressLength;
     
+    struct ucred peerCred;                      // Process of a Unix socket client
+    socklen_t peerCredLength;
+    
     /* Set thread id for log purposes */
     threadId = *((int*)arg);
     free(arg);
     
+    setTraceThreadName("service %d", threadId);
+    
     /* Initialize local variables */
     memset(username, 0, sizeof(username));
     memset(password, 0, sizeof(password));
@@ -64,29 +163,88 @@ void* serviceThreadFunction(void *arg) {
     
     while(1) {
         
-        /* Try to lock service mutex and wait for client connection */
-        pthread_mutex_lock(&serviceMutex);
-        serviceSocket = accept(serverSocket, (struct sockaddr*)(&clientAddress), &clientAddressLength);
-        pthread_mutex_unlock(&serviceMutex);
+        /* Try to lock service mutex and wait for client connection or resumed client session */
+        SERVICE_MUTEX_LOCK();
+        
+        acceptPollArray[0].fd = serverSocket;
+        acceptPollArray[0].events = POLLIN;
+        acceptPollArray[1].fd = unixServerSocket;   // Ignored by poll if negative
+        acceptPollArray[1].events = POLLIN;
+        acceptPollArray[2].fd = resumeEventFd;
+        acceptPollArray[2].events = POLLIN;
+        if(poll(acceptPollArray, 3, -1) <= 0) {
+            
+            SERVICE_MUTEX_UNLOCK();
+            continue;
+        }
+        
+        wakeNs = getMetricTimeNs();
+        
+        resumed = (acceptPollArray[2].revents & POLLIN) ? takeResumedSession() : NULL;
+        if((NULL == resumed) && !(acceptPollArray[0].revents & POLLIN) && !(acceptPollArray[1].revents & POLLIN)) {
+            
+            /* Session taken by another service thread */
+            SERVICE_MUTEX_UNLOCK();
+            continue;
+        }
+        
+        if(NULL == resumed) {
+            
+            unixClient = !(acceptPollArray[0].revents & POLLIN);
+            if(unixClient) {
+                
+                serviceSocket = accept(unixServerSocket, NULL, NULL);
+            }
+            else {
+                
+                clientAddressLength = sizeof(clientAddress);
+                serviceSocket = accept(serverSocket, (struct sockaddr*)(&clientAddress), &clientAddressLength);
+            }
+        }
+        SERVICE_MUTEX_UNLOCK();
         
+        if(NULL != resumed) {
+            
+            /* Continue client session parked by a request */
+            serviceSocket = resumed->serviceSocket;
+            userRef = resumed->user;
+            session = resumed->session;
+            free(resumed);
+            
+            serveClientSession(threadId, serviceSocket, userRef, &session);
+        }
         /* Check success of accepting new connection */
-        if(serviceSocket < 0) {
+        else if(serviceSocket < 0) {
             
             /* Failed to accept incoming connection */
 #ifdef SERVER_DEBUG
             perror("accept");
             fflush(stderr);
-            fprintf(stdout, LOG_SYS_ERR_SERVER_SOCK_ACCEPT_FAIL, threadId);
-            fflush(stdout);
 #endif
-            syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SOCK_ACCEPT_FAIL, threadId);
+            logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_SOCK_ACCEPT_FAIL, threadId);
         }
         else {
             
             /* Succeeded to accept client connection */
+            acceptNs = getMetricTimeNs();
+            addMetricCounter(STATS_CNT_CONN, 1);
             
+            if(unixClient) {
+                
+                /* Local client: identify its process instead of resolving an address */
+                peerCredLength = sizeof(peerCred);
+                if(getsockopt(serviceSocket, SOL_SOCKET, SO_PEERCRED, &peerCred, &peerCredLength) < 0) {
+                    
+                    /* Unknown process is not authenticated by peer credentials */
+                    peerCred.pid = 0;
+                    peerCred.uid = (uid_t)-1;
+                    peerCred.gid = (gid_t)-1;
+                }
+                
+                logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_CONN_UNIX, threadId, (int)peerCred.pid, (unsigned int)peerCred.uid);
+            }
             /* Try to resolve client name by address */
-            if(0 == (errorCode = getnameinfo(
+            else if(0 == (errorCode = getnameinfo(
                 
                 (struct sockaddr*)(&clientAddress),
                 clientAddressLength,
@@ -101,48 +259,51 @@ void* serviceThreadFunction(void *arg) {
                 
                 /* Resolved client host name */
                 
-#ifdef SERVER_DEBUG
-                fprintf(stdout, LOG_SYS_INFO_CLIENT_CONN, threadId, clientHostName, clientServiceName);
-                fflush(stdout);
-#endif
-                syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_CLIENT_CONN, threadId, clientHostName, clientServiceName);
+                logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_CONN, threadId, clientHostName, clientServiceName);
             }
             else {
                 
                 /* Failed to resolve client host name */
 #ifdef SERVER_DEBUG
-                fprintf(stderr, LOG_SYS_WARN_CLIENT_NAME_RESOLVE_FAIL, threadId);
                 fprintf(stderr, "%s \n", gai_strerror(errorCode));
                 fflush(stderr);
 #endif
-                syslog(LOG_DAEMON | LOG_WARNING, LOG_SYS_WARN_CLIENT_NAME_RESOLVE_FAIL, threadId);
+                logEvent(LOG_WARNING, LOG_SYS_WARN_CLIENT_NAME_RESOLVE_FAIL, threadId);
             }
             
-            /* Set service socket option SO_KEEPALIVE for enhanced safety */
-            if(setsockopt(serviceSocket, SOL_SOCKET, SO_KEEPALIVE, &keepAliveState, sizeof(keepAliveState)) < 0) {
+            /* Set service socket option SO_KEEPALIVE for enhanced safety (TCP only) */
+            if(!unixClient && setsockopt(serviceSocket, SOL_SOCKET, SO_KEEPALIVE, &keepAliveState, sizeof(keepAliveState)) < 0) {
                 
                 /* Failed to set socket option SO_KEEPALIVE */
 #ifdef SERVER_DEBUG
                 perror("setsockopt");
                 fflush(stderr);
-                fprintf(stderr, LOG_SYS_WARN_SOCK_SET_OPT_FAIL, threadId);
-                fflush(stderr);
 #endif
-                syslog(LOG_DAEMON | LOG_WARNING, LOG_SYS_WARN_SOCK_SET_OPT_FAIL, threadId);
+                logEvent(LOG_WARNING, LOG_SYS_WARN_SOCK_SET_OPT_FAIL, threadId);
             }
             
+            authNs = getMetricTimeNs();
+            traceSpan(TRACE_SPAN_ACCEPT, 0, wakeNs, authNs);
+            
             /* Authenticate client */
             len = recv(serviceSocket, username, sizeof(username), MSG_WAITALL);
             len = recv(serviceSocket, password, sizeof(password), MSG_WAITALL);
             
-            if(0 != authClient(username, password, &userRef)) {
+            if(unixClient && (0 == authPeerClient(username, peerCred.uid, &userRef))) {
+                
+                logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_AUTH_PEER, threadId, (unsigned int)peerCred.uid);
+                errorCode = 0;
+            }
+            else {
+                
+                errorCode = authClient(username, password, &userRef);
+            }
+            
+            if(0 != errorCode) {
                 
                 /* Client authentication failed */
-#ifdef SERVER_DEBUG
-                fprintf(stdout, LOG_SYS_INFO_CLIENT_AUTH_FAIL, threadId);
-                fflush(stdout);
-#endif
-                syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_CLIENT_AUTH_FAIL, threadId);
+                addMetricCounter(STATS_CNT_AUTH_FAIL, 1);
+                logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_AUTH_FAIL, threadId);
                 response = RES_CODE_AUTH_FAIL;
                 len = send(serviceSocket, &response, sizeof(response), MSG_NOSIGNAL);
                 if(len < 0) {
@@ -151,20 +312,22 @@ void* serviceThreadFunction(void *arg) {
 #ifdef SERVER_DEBUG
                     perror("send");
                     fflush(stderr);
-                    fprintf(stderr, LOG_SYS_INFO_CLIENT_AUTH_FAIL_NOTIF_FAIL, threadId);
-                    fflush(stderr);
 #endif
-                    syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_INFO_CLIENT_AUTH_FAIL_NOTIF_FAIL, threadId);
+                    logEvent(LOG_ERR, LOG_SYS_INFO_CLIENT_AUTH_FAIL_NOTIF_FAIL, threadId);
                 }
+                
+                traceSpan(TRACE_SPAN_AUTH, 0, authNs, getMetricTimeNs());
+                
+                /* Close service socket */
+                close(serviceSocket);
+                
+                /* Syslog end of current service */
+                logEvent(LOG_INFO, LOG_SYS_INFO_THREAD_SERVICE_END, threadId);
             }
             else {
                 
                 /* Client authentication succeded */
-#ifdef SERVER_DEBUG
-                fprintf(stdout, LOG_SYS_INFO_CLIENT_AUTH_SUCCESS, threadId, userRef->name);
-                fflush(stdout);
-#endif
-                syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_CLIENT_AUTH_SUCCESS, threadId, userRef->name);
+                logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_AUTH_SUCCESS, threadId, userRef->name);
                 response = RES_CODE_AUTH_SUCCESS;
                 len = send(serviceSocket, &response, sizeof(response), MSG_NOSIGNAL);
                 if(len < 0) {
@@ -173,251 +336,1089 @@ void* serviceThreadFunction(void *arg) {
 #ifdef SERVER_DEBUG
                     perror("send");
                     fflush(stderr);
-                    fprintf(stderr, LOG_SYS_INFO_CLIENT_AUTH_SUCCESS_NOTIF_FAIL, threadId);
-                    fflush(stderr);
 #endif
-                    syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_INFO_CLIENT_AUTH_SUCCESS_NOTIF_FAIL, threadId);
+                    logEvent(LOG_ERR, LOG_SYS_INFO_CLIENT_AUTH_SUCCESS_NOTIF_FAIL, threadId);
                 }
                 
-                /* Initialize poll client */
-                pollArray[POLL_ARRAY_SOCKET].fd = serviceSocket;
-                pollArray[POLL_ARRAY_SOCKET].events = POLLIN;
-            
-                serviceStopCondition = COND_SERVICE_STOP_FALSE;
+                traceSpan(TRACE_SPAN_AUTH, 0, authNs, getMetricTimeNs());
+                recordMetricValue(METRIC_HIST_ACCEPT_AUTH, getMetricTimeNs() - acceptNs);
                 
-                while(!serviceStopCondition) {
+                /* Initialize client session */
+                session.sensorSel = SENSOR_SEL_DEFAULT;
                 
-                    /* Polling... */
-                    if(poll(pollArray, POLL_ARRAY_SIZE, -1) > 0) {
-                    
-                        if(pollArray[POLL_ARRAY_SOCKET].revents & (POLLERR | POLLHUP)) {
-                        
-                            /* Client closed connection */
+                serveClientSession(threadId, serviceSocket, userRef, &session);
+            }
+        }
+    }
+    
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Function 'parkClientSession': hands a client session over to the event thread.
+ * 
+ * Note:    The event thread owns the service socket until it resumes the session.
+ */
+int parkClientSession(struct ParkedSession *parked) {
+    
+    const uint64_t eventCount = 1;
+    int error = 0;
+    
+    if(parkEventFd < 0) {
+        
+        /* No event thread */
+        error = -1;
+        return error;
+    }
+    
+    pthread_mutex_lock(&parkMutex);
+    parked->next = parkQueue;
+    parkQueue = parked;
+    pthread_mutex_unlock(&parkMutex);
+    
+    write(parkEventFd, &eventCount, sizeof(eventCount));
+    
+    return error;
+}
+
+/*
+ * Function 'resumeClientSession': hands a parked client session back to the service threads.
+ */
+static void resumeClientSession(struct ParkedSession *parked) {
+    
+    const uint64_t eventCount = 1;
+    
+    pthread_mutex_lock(&parkMutex);
+    parked->next = resumeQueue;
+    resumeQueue = parked;
+    pthread_mutex_unlock(&parkMutex);
+    
+    write(resumeEventFd, &eventCount, sizeof(eventCount));
+}
+
+/*
+ * Function 'completeParkedSession': answers a parked client session and resumes it.
+ * 
+ * Note:    The answer fits into the socket buffer of an idle session, so it is sent
+ *          without blocking; the session is dropped if it does not.
+ */
+static void completeParkedSession(struct ParkedSession *parked, uint8_t response, const struct LatestSample *sample) {
+    
+    uint8_t resBuf[1 + RES_LATEST_LEN];
+    
+    resBuf[0] = response;
+    memcpy(&resBuf[1], &(sample->seq), sizeof(sample->seq));
+    memcpy(&resBuf[9], &(sample->timeUs), sizeof(sample->timeUs));
+    memcpy(&resBuf[17], &(sample->temp), sizeof(sample->temp));
+    memcpy(&resBuf[21], &(sample->hum), sizeof(sample->hum));
+    memcpy(&resBuf[25], &(sample->press), sizeof(sample->press));
+    memcpy(&resBuf[29], &(sample->configVersion), sizeof(sample->configVersion));
+    
+    if(sizeof(resBuf) == send(parked->serviceSocket, resBuf, sizeof(resBuf), MSG_NOSIGNAL | MSG_DONTWAIT)) {
+        
+        resumeClientSession(parked);
+    }
+    else {
+        
+        /* Failed to send sample to client */
 #ifdef SERVER_DEBUG
-                            fprintf(stdout, LOG_SYS_WARN_CLIENT_DISCONN_UNEX, threadId);
-                            fflush(stdout);
+        perror("send");
+        fflush(stderr);
 #endif
-                            syslog(LOG_DAEMON | LOG_WARNING, LOG_SYS_WARN_CLIENT_DISCONN_UNEX, threadId);
-                            serviceStopCondition = COND_SERVICE_STOP_TRUE;
-                        }
-                        else if (pollArray[POLL_ARRAY_SOCKET].revents & (POLLIN)) {
-                        
-                            /* Message received from client */
-                            clientHandler(pollArray[POLL_ARRAY_SOCKET].fd, userRef, &serviceStopCondition);
-                        }
-                    }
-                }
-            }
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_WAIT_SEND_FAIL, parked->user->name);
+        
+        close(parked->serviceSocket);
+        free(parked);
+    }
+}
+
+/*
+ * Function 'trackParkedSocket': registers the socket of a parked session in the event thread.
+ */
+static int trackParkedSocket(struct EventContext *context, struct ParkedSession *parked) {
+    
+    struct epoll_event event;
+    struct ParkedSession **fdTable = NULL;
+    int size;
+    int error = 0;
+    
+    /* Grow socket table if needed */
+    if(parked->serviceSocket >= context->fdTableSize) {
+        
+        size = (context->fdTableSize > 0) ? context->fdTableSize : EVENT_THREAD_FD_TABLE_SIZE;
+        while(size <= parked->serviceSocket) {
             
-            /* Close service socket */
-            close(serviceSocket);
-            pollArray[POLL_ARRAY_SOCKET].fd = -1;
+            size *= 2;
+        }
+        
+        fdTable = realloc(context->fdTable, size * sizeof(struct ParkedSession*));
+        if(NULL == fdTable) {
             
-            /* Syslog end of current service */
-#ifdef SERVER_DEBUG
-            fprintf(stdout, LOG_SYS_INFO_THREAD_SERVICE_END, threadId);
-            fflush(stdout);
-#endif
-            syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_THREAD_SERVICE_END, threadId);
+            error = -1;
+            return error;
         }
+        
+        memset(&fdTable[context->fdTableSize], 0, (size - context->fdTableSize) * sizeof(struct ParkedSession*));
+        context->fdTable = fdTable;
+        context->fdTableSize = size;
     }
     
-    return EXIT_SUCCESS;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.fd = parked->serviceSocket;
+    if(epoll_ctl(context->epollFd, EPOLL_CTL_ADD, parked->serviceSocket, &event) < 0) {
+        
+        error = -1;
+        return error;
+    }
+    
+    context->fdTable[parked->serviceSocket] = parked;
+    
+    return error;
 }
 
 /*
- * Function 'measureThreadFunction': conducts consecutive measurements.
+ * Function 'untrackParkedSocket': removes the socket of a parked session from the event thread.
  */
-void* measureThreadFunction(void *arg) {
+static void untrackParkedSocket(struct EventContext *context, struct ParkedSession *parked) {
     
-    const float invalidValue = -1.0;            // Invalid measurement value 
+    epoll_ctl(context->epollFd, EPOLL_CTL_DEL, parked->serviceSocket, NULL);
+    context->fdTable[parked->serviceSocket] = NULL;
+}
+
+/*
+ * Function 'setSubscriberEvents': selects the socket events watched for a subscriber.
+ */
+static void setSubscriberEvents(struct EventContext *context, struct ParkedSession *parked, uint32_t events) {
     
-    uint8_t copy_of_sensorSettingSel = 0;       // Copy of sensor setting selection
-    int copy_of_measPeriod = 0;                 // Copy of measurement period [sec]
-    int error = 0;
-    int measFlag = 1;                           // Measurement flag
-    int threadId;
-    struct sensor_data measData;                // Measured sensor data
+    struct epoll_event event;
     
-    /* Set thread id for log purposes */
-    threadId = *((int*)arg);
-    free(arg);
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.fd = parked->serviceSocket;
+    epoll_ctl(context->epollFd, EPOLL_CTL_MOD, parked->serviceSocket, &event);
+}
+
+/*
+ * Function 'unlinkSubscriber': removes a subscriber from the event thread.
+ */
+static void unlinkSubscriber(struct EventContext *context, struct ParkedSession *parked) {
     
-    /* Loop */
-    while(1) {
+    uint8_t sensorIndex = parked->session.sensorSel;
+    
+    if(NULL != parked->prev) {
         
-        if(measFlag) {
+        parked->prev->next = parked->next;
+    }
+    else {
         
-            /* Start of critical section */
-            pthread_mutex_lock(&sensorMutex);
+        context->subscriberList[sensorIndex] = parked->next;
+    }
+    
+    if(NULL != parked->next) {
         
-            /* Update minimal delay */
-            minDelay = get_min_delay(&sensorId, &sensorDev);
+        parked->next->prev = parked->prev;
+    }
+    
+    __atomic_sub_fetch(&(sensorArray[sensorIndex].waiterCount), 1, __ATOMIC_SEQ_CST);
+    untrackParkedSocket(context, parked);
+}
+
+/*
+ * Function 'dropSubscriber': disconnects a subscriber.
+ */
+static void dropSubscriber(struct EventContext *context, struct ParkedSession *parked, const char *logFormat) {
+    
+    unlinkSubscriber(context, parked);
+    
+    logEvent(LOG_WARNING, logFormat, parked->user->name);
+    
+    close(parked->serviceSocket);
+    free(parked->subscription);
+    free(parked);
+}
+
+/*
+ * Function 'endSubscription': resumes the session of a subscriber once its end frame is written.
+ */
+static void endSubscription(struct EventContext *context, struct ParkedSession *parked) {
+    
+    unlinkSubscriber(context, parked);
+    
+    logEvent(LOG_INFO, LOG_SYS_INFO_CLIENT_UNSUB, parked->subscription->dropCount, parked->user->name);
+    
+    free(parked->subscription);
+    parked->subscription = NULL;
+    resumeClientSession(parked);
+}
+
+/*
+ * Function 'queueSubscriberFrame': queues a frame in the ring of a subscriber.
+ * 
+ * Note:    A full ring is handled by the policy of the subscriber: the oldest frame not
+ *          written partly is dropped, the newest frame is replaced or -1 is returned to
+ *          disconnect the subscriber. The end frame is queued directly into the spare slot.
+ */
+static int queueSubscriberFrame(struct Subscription *subscription, const uint8_t *frame, size_t frameLen) {
+    
+    uint32_t slot;
+    int error = 0;
+    
+    if(subscription->ringCount >= SUB_RING_FRAMES) {
         
-            /* Conduct measurement */
-            error = get_sensor_data(&sensorId, &sensorDev, minDelay, &measData);
+        if(REQ_SUB_POLICY_DISCONNECT == subscription->policy) {
+            
+            error = -1;
+            return error;
+        }
         
-            /* Copy sensor setting selection */
-            copy_of_sensorSettingSel = sensorSettingSel;
+        subscription->dropCount++;
         
-            /* Copy measurement period */
-            copy_of_measPeriod = measPeriod;
+        if(REQ_SUB_POLICY_COALESCE == subscription->policy) {
+            
+            /* Replace newest frame (never the partly written one, the ring holds more) */
+            slot = (subscription->ringHead + subscription->ringCount - 1) % SUB_RING_SLOTS;
+            memcpy(subscription->ring[slot], frame, frameLen);
+            subscription->ringLen[slot] = frameLen;
+            
+            return error;
+        }
         
-            /* End of critical section */
-            pthread_mutex_unlock(&sensorMutex);
+        /* Drop oldest frame, keeping a partly written one in front */
+        slot = (subscription->ringHead + 1) % SUB_RING_SLOTS;
+        if(0 != subscription->headOffset) {
+            
+            memcpy(subscription->ring[slot], subscription->ring[subscription->ringHead], subscription->ringLen[subscription->ringHead]);
+            subscription->ringLen[slot] = subscription->ringLen[subscription->ringHead];
+        }
         
-            /* Flush potential sensor interface logs */
-#ifdef SERVER_DEBUG
-            fflush(stderr);
-            fflush(stdout);
-#endif
-            if(0 != error) {
+        subscription->ringHead = slot;
+        subscription->ringCount--;
+    }
+    
+    slot = (subscription->ringHead + subscription->ringCount) % SUB_RING_SLOTS;
+    memcpy(subscription->ring[slot], frame, frameLen);
+    subscription->ringLen[slot] = frameLen;
+    subscription->ringCount++;
+    
+    return error;
+}
+
+/*
+ * Function 'writeSubscriber': writes the queued frames of a subscriber without blocking.
+ * 
+ * Note:    Returns the number of frames still queued or -1 on socket error.
+ */
+static int writeSubscriber(struct ParkedSession *parked) {
+    
+    struct Subscription *subscription = parked->subscription;
+    ssize_t len;
+    
+    while(subscription->ringCount > 0) {
+        
+        len = send(parked->serviceSocket, &(subscription->ring[subscription->ringHead][subscription->headOffset]),
+                   subscription->ringLen[subscription->ringHead] - subscription->headOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if(len < 0) {
+            
+            if((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno)) {
                 
-                /* Failed to get BME280 sensor data */
-#ifdef SERVER_DEBUG
-                fprintf(stderr, LOG_SYS_ERR_SENS_MEAS_FAIL);
-                fflush(stderr);
-#endif
-                syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SENS_MEAS_FAIL);
+                break;
             }
-            else {
-                
-                /* Got BME280 sensor data */
-#ifdef SERVER_DEBUG
-                //fprintf(stdout, LOG_SYS_INFO_SENS_MEAS_SUCCESS);
-                //fflush(stdout);
-#endif
-                syslog(LOG_DAEMON | LOG_INFO, LOG_SYS_INFO_SENS_MEAS_SUCCESS);
+            
+            return -1;
+        }
         
-                /* Save measurement data */
-                
-                pthread_mutex_lock(&savedDataMutex);
-                
-                /* Open saved data file if not yet open */
-                if(savedDataFd < 0) {
-                 
-                    /* File needs to be opened */
-                    savedDataFd = open(savedDataFilePath, O_CREAT | O_TRUNC | O_RDWR, 0644);
-                    if(savedDataFd < 0) {
-                    
-#ifdef SERVER_DEBUG
-                        perror("open");
-                        fprintf(stderr, LOG_SYS_ERR_SERVER_SAVE_OPEN_FAIL);
-                        fflush(stderr);
-#endif
-                        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_OPEN_FAIL);
-                    }
-                }
-                
-                /* Set file offset to end of file */
-                lseek(savedDataFd, 0, SEEK_END);
-                
-                /* Save temperature data */
-                if(BME280_OSR_TEMP_SEL & copy_of_sensorSettingSel) {
-                    
-                    /* Temperature measurement selected */
-                    if(sizeof(measData.temp) != write(savedDataFd, &(measData.temp), sizeof(measData.temp))) {
-                        
-#ifdef SERVER_DEBUG
-                        perror("write");
-                        fprintf(stderr, LOG_SYS_ERR_SERVER_SAVE_TEMP_FAIL);
-                        fflush(stderr);
-#endif
-                        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_TEMP_FAIL);
-                    }
-                }
-                else {
-                    
-                    /* Temperature measurement not selected */
-                    if(sizeof(invalidValue) != write(savedDataFd, &invalidValue, sizeof(invalidValue))) {
-                        
-#ifdef SERVER_DEBUG
-                        perror("write");
-                        fprintf(stderr, LOG_SYS_ERR_SERVER_SAVE_TEMP_FAIL);
-                        fflush(stderr);
-#endif
-                        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_TEMP_FAIL);
-                    }
-                }
+        subscription->headOffset += len;
+        if(subscription->headOffset < subscription->ringLen[subscription->ringHead]) {
+            
+            /* Socket buffer full */
+            break;
+        }
+        
+        subscription->headOffset = 0;
+        subscription->ringHead = (subscription->ringHead + 1) % SUB_RING_SLOTS;
+        subscription->ringCount--;
+    }
+    
+    return subscription->ringCount;
+}
+
+/*
+ * Function 'pushSubscriberFrame': pushes a sample frame to a subscriber.
+ * 
+ * Note:    The shared frame is written directly while nothing is queued for the
+ *          subscriber, it is copied into the ring of the subscriber only if the
+ *          socket can not take it (whole) right away.
+ */
+static void pushSubscriberFrame(struct EventContext *context, struct ParkedSession *parked, const uint8_t *frame, size_t frameLen) {
+    
+    struct Subscription *subscription = parked->subscription;
+    ssize_t len;
+    
+    if(subscription->ringCount > 0) {
+        
+        /* Keep frame order: queue behind pending frames */
+        if(queueSubscriberFrame(subscription, frame, frameLen) < 0) {
+            
+            dropSubscriber(context, parked, LOG_SYS_WARN_CLIENT_SUB_SLOW);
+        }
+        
+        return;
+    }
+    
+    len = send(parked->serviceSocket, frame, frameLen, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if((size_t)len == frameLen) {
+        
+        return;
+    }
+    
+    if((len < 0) && (EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno)) {
+        
+        dropSubscriber(context, parked, LOG_SYS_WARN_CLIENT_DISCONN_PARKED);
+        return;
+    }
+    
+    queueSubscriberFrame(subscription, frame, frameLen);
+    subscription->headOffset = (len > 0) ? len : 0;
+    setSubscriberEvents(context, parked, EPOLLIN | EPOLLRDHUP | EPOLLOUT);
+}
+
+/*
+ * Function 'encodeSampleFrame': encodes a sample frame holding the selected channels.
+ */
+static size_t encodeSampleFrame(const struct LatestSample *sample, uint8_t channels, uint8_t *frame) {
+    
+    size_t len = RES_PUSH_HEADER_LEN;
+    
+    frame[0] = RES_CODE_PUSH_SAMPLE;
+    memcpy(&frame[1], &(sample->seq), sizeof(sample->seq));
+    memcpy(&frame[9], &(sample->timeUs), sizeof(sample->timeUs));
+    
+    if(channels & REQ_AGG_CH_TMP) {
+        
+        memcpy(&frame[len], &(sample->temp), sizeof(sample->temp));
+        len += sizeof(sample->temp);
+    }
+    
+    if(channels & REQ_AGG_CH_HUM) {
+        
+        memcpy(&frame[len], &(sample->hum), sizeof(sample->hum));
+        len += sizeof(sample->hum);
+    }
+    
+    if(channels & REQ_AGG_CH_PRS) {
+        
+        memcpy(&frame[len], &(sample->press), sizeof(sample->press));
+        len += sizeof(sample->press);
+    }
+    
+    return len;
+}
+
+/*
+ * Function 'pushSamples': pushes the samples published since the last call to the subscribers of a sensor.
+ * 
+ * Note:    Samples are taken from the sample history, so none is missed when sample
+ *          events coalesce. Each sample is encoded once per distinct channel selection.
+ */
+static void pushSamples(struct EventContext *context, int sensorIndex) {
+    
+    uint8_t frameBuf[REQ_AGG_CH_MASK + 1][RES_PUSH_FRAME_MAX_LEN];    // Encoded frames per channel selection
+    size_t frameLen[REQ_AGG_CH_MASK + 1];
+    struct SensorContext *sensor = &(sensorArray[sensorIndex]);
+    struct ParkedSession *parked = NULL;
+    struct ParkedSession *next = NULL;
+    struct Subscription *subscription = NULL;
+    struct LatestSample latest;
+    struct LatestSample sample;
+    uint64_t seq;
+    
+    readLatestSample(sensor, &latest);
+    
+    seq = context->pushedSeq[sensorIndex] + 1;
+    if((latest.seq >= SAMPLE_HISTORY_SIZE) && (seq <= latest.seq - SAMPLE_HISTORY_SIZE)) {
+        
+        /* Older samples are overwritten already */
+        seq = latest.seq - SAMPLE_HISTORY_SIZE + 1;
+    }
+    
+    for(; seq <= latest.seq; seq++) {
+        
+        if(0 != readSampleHistory(sensor, seq, &sample)) {
+            
+            continue;
+        }
+        
+        memset(frameLen, 0, sizeof(frameLen));
+        for(parked = context->subscriberList[sensorIndex]; NULL != parked; parked = next) {
+            
+            next = parked->next;
+            subscription = parked->subscription;
+            
+            if(subscription->ending || (++(subscription->decimationCount) < subscription->decimation)) {
                 
-                /* Save humidity data */
-                if(BME280_OSR_HUM_SEL & copy_of_sensorSettingSel) {
-                    
-                    /* Humidity measurement selected */
-                    if(sizeof(measData.hum) != write(savedDataFd, &(measData.hum), sizeof(measData.hum))) {
-                        
+                continue;
+            }
+            
+            subscription->decimationCount = 0;
+            
+            if(0 == frameLen[subscription->channels]) {
+                
+                frameLen[subscription->channels] = encodeSampleFrame(&sample, subscription->channels, frameBuf[subscription->channels]);
+            }
+            
+            pushSubscriberFrame(context, parked, frameBuf[subscription->channels], frameLen[subscription->channels]);
+        }
+    }
+    
+    context->pushedSeq[sensorIndex] = latest.seq;
+}
+
+/*
+ * Function 'handleSubscriberEvent': handles socket events of a subscriber.
+ * 
+ * Note:    The only data a subscriber may send is the unsubscribe code. Once it is
+ *          received the end frame is queued and the socket is watched for writing
+ *          only, so a request sent right after stays for the resumed session.
+ */
+static void handleSubscriberEvent(struct EventContext *context, struct ParkedSession *parked, uint32_t events) {
+    
+    uint8_t reqCode;
+    uint32_t slot;
+    struct Subscription *subscription = parked->subscription;
+    ssize_t len;
+    
+    if(events & (EPOLLERR | EPOLLHUP)) {
+        
+        dropSubscriber(context, parked, LOG_SYS_WARN_CLIENT_DISCONN_PARKED);
+        return;
+    }
+    
+    if((events & (EPOLLIN | EPOLLRDHUP)) && !(subscription->ending)) {
+        
+        len = recv(parked->serviceSocket, &reqCode, sizeof(reqCode), MSG_DONTWAIT);
+        if((len < 0) && ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno))) {
+            
+            return;
+        }
+        
+        if((len != sizeof(reqCode)) || (REQ_CODE_UNSUB != reqCode)) {
+            
+            /* Subscriber hung up or broke protocol */
+            dropSubscriber(context, parked, LOG_SYS_WARN_CLIENT_DISCONN_PARKED);
+            return;
+        }
+        
+        subscription->ending = 1;
+        
+        /* End frame takes the spare slot of a full ring */
+        slot = (subscription->ringHead + subscription->ringCount) % SUB_RING_SLOTS;
+        subscription->ring[slot][0] = RES_CODE_PUSH_END;
+        memcpy(&(subscription->ring[slot][1]), &(subscription->dropCount), sizeof(subscription->dropCount));
+        subscription->ringLen[slot] = RES_PUSH_END_LEN;
+        subscription->ringCount++;
+        
+        events |= EPOLLOUT;
+    }
+    
+    if(events & EPOLLOUT) {
+        
+        len = writeSubscriber(parked);
+        if(len < 0) {
+            
+            dropSubscriber(context, parked, LOG_SYS_WARN_CLIENT_DISCONN_PARKED);
+        }
+        else if(0 == len) {
+            
+            if(subscription->ending) {
+                
+                endSubscription(context, parked);
+            }
+            else {
+                
+                setSubscriberEvents(context, parked, EPOLLIN | EPOLLRDHUP);
+            }
+        }
+        else {
+            
+            setSubscriberEvents(context, parked, subscription->ending ? EPOLLOUT : (EPOLLIN | EPOLLRDHUP | EPOLLOUT));
+        }
+    }
+}
+
+/*
+ * Function 'eventThreadFunction': wakes up parked client sessions and pushes samples to subscribers.
+ * 
+ * Note:    A single thread holds every client session waiting for a new sample or
+ *          subscribed to samples, so these clients do not occupy service threads. It
+ *          sleeps in epoll_wait on parkEventFd, on the sampleEventFd of the sensors
+ *          (signalled by their measure threads only while clients wait or subscribe)
+ *          and on the parked sockets, with the nearest wait deadline as timeout.
+ *          A waiting client sending anything or hanging up is dropped. Answered
+ *          sessions and ended subscriptions go to resumeQueue.
+ */
+void* eventThreadFunction(void *arg) {
+    
+    struct epoll_event event;
+    struct epoll_event events[EVENT_THREAD_EPOLL_EVENTS];
+    struct EventContext context;
+    struct ParkedSession *parked = NULL;
+    struct ParkedSession *next = NULL;
+    struct ParkedSession **link = NULL;
+    struct LatestSample sample;
+    struct timespec now;
+    uint64_t nowNs;
+    uint64_t nextDeadlineNs;
+    uint64_t count;
+    int timeoutMs;
+    int eventNum;
+    int iEvent;
+    int fd;
+    int i;
+    
+    memset(&context, 0, sizeof(context));
+    
+    context.epollFd = epoll_create1(0);
+    if(context.epollFd < 0) {
+        
 #ifdef SERVER_DEBUG
-                        perror("write");
-                        fprintf(stderr, LOG_SYS_ERR_SERVER_SAVE_HUMID_FAIL);
-                        fflush(stderr);
+        perror("epoll_create1");
+        fflush(stderr);
 #endif
-                        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_HUMID_FAIL);
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_EVENT_INIT_FAIL);
+        
+        return NULL;
+    }
+    
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = parkEventFd;
+    epoll_ctl(context.epollFd, EPOLL_CTL_ADD, parkEventFd, &event);
+    for(i = 0; i < sensorCount; i++) {
+        
+        event.data.fd = sensorArray[i].sampleEventFd;
+        epoll_ctl(context.epollFd, EPOLL_CTL_ADD, sensorArray[i].sampleEventFd, &event);
+    }
+    
+    /* Loop */
+    while(1) {
+        
+        /* Sleep until the nearest deadline */
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        nowNs = (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+        nextDeadlineNs = UINT64_MAX;
+        for(i = 0; i < sensorCount; i++) {
+            
+            for(parked = context.waitList[i]; NULL != parked; parked = parked->next) {
+                
+                nextDeadlineNs = (parked->deadlineNs < nextDeadlineNs) ? parked->deadlineNs : nextDeadlineNs;
+            }
+        }
+        
+        if(UINT64_MAX == nextDeadlineNs) {
+            
+            timeoutMs = -1;
+        }
+        else {
+            
+            /* Round up so the deadline has passed on wake-up */
+            timeoutMs = (nextDeadlineNs <= nowNs) ? 0 : (int)((nextDeadlineNs - nowNs + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC);
+        }
+        
+        eventNum = epoll_wait(context.epollFd, events, EVENT_THREAD_EPOLL_EVENTS, timeoutMs);
+        for(iEvent = 0; iEvent < eventNum; iEvent++) {
+            
+            fd = events[iEvent].data.fd;
+            if(parkEventFd == fd) {
+                
+                /* Take newly parked sessions */
+                read(parkEventFd, &count, sizeof(count));
+                
+                pthread_mutex_lock(&parkMutex);
+                parked = parkQueue;
+                parkQueue = NULL;
+                pthread_mutex_unlock(&parkMutex);
+                
+                for(; NULL != parked; parked = next) {
+                    
+                    next = parked->next;
+                    i = parked->session.sensorSel;
+                    
+                    if(0 != trackParkedSocket(&context, parked)) {
+                        
+                        /* Failed to watch parked socket */
+                        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_PARK_FAIL, parked->user->name);
+                        
+                        close(parked->serviceSocket);
+                        free(parked->subscription);
+                        free(parked);
+                        continue;
                     }
-                }
-                else {
                     
-                    /* Humidity measurement not selected */
-                    if(sizeof(invalidValue) != write(savedDataFd, &invalidValue, sizeof(invalidValue))) {
+                    if(NULL != parked->subscription) {
                         
-#ifdef SERVER_DEBUG
-                        perror("write");
-                        fprintf(stderr, LOG_SYS_ERR_SERVER_SAVE_HUMID_FAIL);
-                        fflush(stderr);
-#endif
-                        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_HUMID_FAIL);
+                        if(NULL == context.subscriberList[i]) {
+                            
+                            /* First subscriber: push samples published from now on */
+                            readLatestSample(&(sensorArray[i]), &sample);
+                            context.pushedSeq[i] = sample.seq;
+                        }
+                        
+                        parked->prev = NULL;
+                        parked->next = context.subscriberList[i];
+                        if(NULL != parked->next) {
+                            
+                            parked->next->prev = parked;
+                        }
+                        context.subscriberList[i] = parked;
+                    }
+                    else {
+                        
+                        parked->next = context.waitList[i];
+                        context.waitList[i] = parked;
                     }
+                    
+                    /* Samples published from now on are signalled (older ones are checked below) */
+                    __atomic_add_fetch(&(sensorArray[i].waiterCount), 1, __ATOMIC_SEQ_CST);
                 }
                 
-                /* Save pressure data */
-                if(BME280_OSR_PRESS_SEL & copy_of_sensorSettingSel) {
+                continue;
+            }
+            
+            /* Sample events are consumed here, handled below */
+            for(i = 0; i < sensorCount; i++) {
+                
+                if(sensorArray[i].sampleEventFd == fd) {
                     
-                    /* Pressure measurement selected */
-                    if(sizeof(measData.press) != write(savedDataFd, &(measData.press), sizeof(measData.press))) {
-                        
+                    read(sensorArray[i].sampleEventFd, &count, sizeof(count));
+                    break;
+                }
+            }
+            
+            if(i < sensorCount) {
+                
+                continue;
+            }
+            
+            /* Parked socket event (the session may be gone since) */
+            parked = (fd < context.fdTableSize) ? context.fdTable[fd] : NULL;
+            if(NULL == parked) {
+                
+                continue;
+            }
+            
+            if(NULL != parked->subscription) {
+                
+                handleSubscriberEvent(&context, parked, events[iEvent].events);
+                continue;
+            }
+            
+            /* Waiting client sent data or hung up: drop it */
+            for(link = &(context.waitList[parked->session.sensorSel]); *link != parked; link = &((*link)->next));
+            *link = parked->next;
+            __atomic_sub_fetch(&(sensorArray[parked->session.sensorSel].waiterCount), 1, __ATOMIC_SEQ_CST);
+            
+            untrackParkedSocket(&context, parked);
+            logEvent(LOG_WARNING, LOG_SYS_WARN_CLIENT_DISCONN_PARKED, parked->user->name);
+            close(parked->serviceSocket);
+            free(parked);
+        }
+        
+        /* Answer the sessions with a newer sample or an expired deadline */
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        nowNs = (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+        for(i = 0; i < sensorCount; i++) {
+            
+            if(NULL == context.waitList[i]) {
+                
+                continue;
+            }
+            
+            readLatestSample(&(sensorArray[i]), &sample);
+            
+            link = &(context.waitList[i]);
+            while(NULL != *link) {
+                
+                parked = *link;
+                if((sample.seq > parked->afterSeq) || (nowNs >= parked->deadlineNs)) {
+                    
+                    *link = parked->next;
+                    __atomic_sub_fetch(&(sensorArray[i].waiterCount), 1, __ATOMIC_SEQ_CST);
+                    
+                    untrackParkedSocket(&context, parked);
+                    completeParkedSession(parked, (sample.seq > parked->afterSeq) ? RES_CODE_REQ_SUCCESS : RES_CODE_REQ_TIMEOUT,
+                                          &sample);
+                }
+                else {
+                    
+                    link = &(parked->next);
+                }
+            }
+        }
+        
+        /* Push new samples to the subscribers */
+        for(i = 0; i < sensorCount; i++) {
+            
+            if(NULL != context.subscriberList[i]) {
+                
+                pushSamples(&context, i);
+            }
+        }
+    }
+    
+    return NULL;
+}
+
+/*
+ * Function 'applyPendingSettings': writes sensor settings queued during a conversion.
+ * 
+ * Note:    Call with sensorMutex of the sensor locked and no conversion in progress.
+ */
+static void applyPendingSettings(struct SensorContext *sensor) {
+    
+    int error;
+    
+    if(!sensor->sensorSettingsPending) {
+        
+        return;
+    }
+    
+    sensor->sensorSettingsPending = 0;
+    sensor->sensorModeReload = 1;       // Settings update puts the sensor to sleep
+    
+    error = write_sensor_settings(&(sensor->sensorId), &(sensor->sensorDev));
+    if(BME280_OK != error) {
+        
+        /* Failed to update sensor settings */
 #ifdef SERVER_DEBUG
-                        perror("write");
-                        fprintf(stderr, LOG_SYS_ERR_SERVER_SAVE_PRESS_FAIL);
-                        fflush(stderr);
+        fprintf(stderr, "Failed to set sensor settings (code %+d).", error);
+        fflush(stderr);
 #endif
-                        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_PRESS_FAIL);
+        logEvent(LOG_ERR, LOG_SYS_ERR_SENS_STGS_SET_FAIL);
+    }
+}
+
+/*
+ * Function 'measureThreadFunction': conducts consecutive measurements.
+ * 
+ * Note:    Each sensor has its own measure thread (arg: SensorContext of the
+ *          sensor) with its own locks, schedule and saved data file, so
+ *          sensors on different buses are sampled concurrently.
+ * 
+ *          Measurements are scheduled on absolute CLOCK_MONOTONIC deadlines so the
+ *          sampling rate does not drift with the time spent measuring and saving.
+ *          Period changes wake the thread up right away (see measPeriodCond).
+ *          Records are buffered and written to the saved data file in batches,
+ *          and per-sample logging is skipped for high-rate (sub-second) periods.
+ * 
+ *          In forced mode each sample triggers a conversion and polls the status
+ *          register until it completes (minDelay only bounds the wait).
+ *          sensorMutex is held for the register accesses only, never while
+ *          waiting for a conversion; settings updates that arrive meanwhile
+ *          are queued (sensorSettingsPending) and applied once the data is read.
+ *          In normal mode the sensor converts continuously and each sample is a
+ *          single read of the data registers.
+ */
+void* measureThreadFunction(void *arg) {
+    
+    const float invalidValue = SAVED_DATA_INVALID_VALUE;   // Invalid measurement value 
+    const uint64_t eventCount = 1;                          // New sample event
+    
+    uint8_t copy_of_sensorSettingSel = 0;       // Copy of sensor setting selection
+    uint64_t copy_of_measPeriodUs = 0;          // Copy of measurement period [usec]
+    uint32_t copy_of_configVersion = 0;         // Copy of config version
+    uint32_t waitUs = 0;                        // Time until next conversion check [usec]
+    int converting = 0;                         // Conversion triggered but not read yet
+    int pollStatus = 0;                         // Completion is signalled by the status register
+    int done = 0;                               // Result of the last completion check
+    uint64_t waitPeriodUs = 0;                  // Time until next wake-up [usec]
+    uint64_t nowNs = 0;                         // Current time [nsec]
+    uint64_t nextWakeupNs = 0;                  // Next scheduled wake-up [nsec]
+    uint64_t flushDueNs = 0;                    // Buffered records are due to be written out [nsec] (0: none buffered)
+    uint64_t busStartNs = 0;                    // Start of the current sensor bus transaction [nsec]
+    uint64_t busNs = 0;                         // Sensor bus time of the current sample [nsec]
+    uint64_t convStartNs = 0;                   // Conversion trigger time [nsec]
+    uint64_t sampleStartNs = 0;                 // Start of the current sample [nsec]
+    uint64_t spanStartNs = 0;                   // Start of the current traced phase [nsec]
+    int error = 0;
+    struct SensorContext *sensor = (struct SensorContext*)arg;     // Sensor of the thread
+    uint32_t sensorIndex = (uint32_t)(sensor - sensorArray);       // Sensor ID (trace spans)
+    struct sensor_data measData;                // Measured sensor data
+    struct bme280_uncomp_data uncompData;       // Raw data registers of the sample
+    struct SavedDataRecord *record = NULL;      // Record slot in saved data buffer
+    struct timespec deadline;
+    struct timespec sampleTime;                 // Wall clock time of the sample
+    
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    nextWakeupNs = (uint64_t)deadline.tv_sec * NSEC_PER_SEC + (uint64_t)deadline.tv_nsec;
+    
+    setTraceThreadName("measure %d", (int)sensorIndex);
+    
+    /* Loop */
+    while(1) {
+        
+        sampleStartNs = getMetricTimeNs();
+        
+        /* Start of critical section */
+        SENSOR_MUTEX_LOCK(sensor);
+        
+        /* Copy measurement period */
+        copy_of_measPeriodUs = sensor->measPeriodUs;
+        
+        error = 0;
+        converting = 0;
+        busNs = 0;
+        if(0 != copy_of_measPeriodUs) {
+        
+            /* Update minimal delay */
+            sensor->minDelay = get_min_delay(&(sensor->sensorId), &(sensor->sensorDev));
+            
+            /* Copy sensor setting selection (channels of this sample) */
+            copy_of_sensorSettingSel = sensor->sensorSettingSel;
+            copy_of_configVersion = sensor->configSnapshot.version;
+        
+            /* Start measurement */
+            if(BME280_NORMAL_MODE == sensor->sensorModeSel) {
+                
+                /* Sensor converts continuously: (re)enter normal mode after settings changes only */
+                if(sensor->sensorModeReload) {
+                    
+                    busStartNs = getMetricTimeNs();
+                    error = set_normal_mode(&(sensor->sensorId), &(sensor->sensorDev), copy_of_measPeriodUs);
+                    convStartNs = getMetricTimeNs();
+                    busNs += convStartNs - busStartNs;
+                    traceSpan(TRACE_SPAN_TRIGGER, sensorIndex, busStartNs, convStartNs);
+                    if(0 != error) {
+                        
+                        logEvent(LOG_ERR, LOG_SYS_ERR_SENS_MODE_SET_FAIL);
+                    }
+                    else {
+                        
+                        /* Data registers are valid after the first conversion */
+                        sensor->sensorModeReload = 0;
+                        converting = 1;
+                        pollStatus = 0;
+                        waitUs = sensor->minDelay * 1000;
                     }
                 }
                 else {
-                    
-                    /* Pressure measurement not selected */
-                    if(sizeof(invalidValue) != write(savedDataFd, &invalidValue, sizeof(invalidValue))) {
+                
+                    /* Read the data registers only (they hold the latest completed conversion) */
+                    busStartNs = getMetricTimeNs();
+                    SERVER_PROBE1(read__sensor__regs__start, sensorIndex);
+                    error = read_sensor_regs(&(sensor->sensorId), &(sensor->sensorDev), &uncompData);
+                    spanStartNs = getMetricTimeNs();
+                    busNs += spanStartNs - busStartNs;
+                    traceSpan(TRACE_SPAN_READ, sensorIndex, busStartNs, spanStartNs);
+                    if(0 == error) {
                         
+                        error = compensate_sensor_data(&(sensor->sensorDev), &uncompData, &measData);
+                        traceSpan(TRACE_SPAN_COMPENSATE, sensorIndex, spanStartNs, getMetricTimeNs());
+                    }
+                    SERVER_PROBE2(read__sensor__regs__done, sensorIndex, error);
+                }
+            }
+            else {
+                
+                /* Trigger a single conversion (forced mode) */
+                busStartNs = getMetricTimeNs();
+                error = start_conversion(&(sensor->sensorId), &(sensor->sensorDev), sensor->minDelay, &waitUs);
+                convStartNs = getMetricTimeNs();
+                busNs += convStartNs - busStartNs;
+                traceSpan(TRACE_SPAN_TRIGGER, sensorIndex, busStartNs, convStartNs);
+                if(0 == error) {
+                    
+                    converting = 1;
+                    pollStatus = 1;
+                }
+            }
+            sensor->sensorConversionActive = converting;
+        }
+        
+        /* End of critical section */
+        SENSOR_MUTEX_UNLOCK(sensor);
+        
+        /* Wait for the conversion without holding sensorMutex (config requests are served meanwhile) */
+        while(converting) {
+            
+            user_delay_us(waitUs, &(sensor->sensorId));
+            
+            SENSOR_MUTEX_LOCK(sensor);
+            
+            /* Check completion, then read the data registers */
+            busStartNs = getMetricTimeNs();
+            done = pollStatus ? poll_conversion(&(sensor->sensorId), &(sensor->sensorDev), &waitUs) : 1;
+            if(done > 0) {
+                
+                spanStartNs = getMetricTimeNs();
+                traceSpan(TRACE_SPAN_CONV_WAIT, sensorIndex, convStartNs, spanStartNs);
+                if(pollStatus) {
+                    
+                    recordMetricValue(METRIC_HIST_SENS_CONV, spanStartNs - convStartNs);
+                }
+                
+                SERVER_PROBE1(read__sensor__regs__start, sensorIndex);
+                error = read_sensor_regs(&(sensor->sensorId), &(sensor->sensorDev), &uncompData);
+                nowNs = getMetricTimeNs();
+                traceSpan(TRACE_SPAN_READ, sensorIndex, spanStartNs, nowNs);
+                if(0 == error) {
+                    
+                    error = compensate_sensor_data(&(sensor->sensorDev), &uncompData, &measData);
+                    traceSpan(TRACE_SPAN_COMPENSATE, sensorIndex, nowNs, getMetricTimeNs());
+                }
+                SERVER_PROBE2(read__sensor__regs__done, sensorIndex, error);
+            }
+            else if(done < 0) {
+                
+                error = -1;
+            }
+            busNs += getMetricTimeNs() - busStartNs;
+            
+            if(0 != done) {
+                
+                /* Conversion over: safe point for queued config updates */
+                converting = 0;
+                sensor->sensorConversionActive = 0;
+                applyPendingSettings(sensor);
+            }
+            
+            SENSOR_MUTEX_UNLOCK(sensor);
+        }
+        
+        if(0 != copy_of_measPeriodUs) {
+        
+            /* Flush potential sensor interface logs */
 #ifdef SERVER_DEBUG
-                        perror("write");
-                        fprintf(stderr, LOG_SYS_ERR_SERVER_SAVE_PRESS_FAIL);
-                        fflush(stderr);
+            fflush(stderr);
+            fflush(stdout);
 #endif
-                        syslog(LOG_DAEMON | LOG_ERR, LOG_SYS_ERR_SERVER_SAVE_PRESS_FAIL);
-                    }
+            if(0 != error) {
+                
+                /* Failed to get BME280 sensor data */
+                addMetricCounter(STATS_CNT_SAMPLE_FAIL, 1);
+                logEvent(LOG_ERR, LOG_SYS_ERR_SENS_MEAS_FAIL);
+            }
+            else {
+                
+                /* Got BME280 sensor data */
+                addMetricCounter(STATS_CNT_SAMPLE, 1);
+                recordMetricValue(METRIC_HIST_SENS_BUS, busNs);
+                
+                if(copy_of_measPeriodUs >= MEAS_PERIOD_HIGH_RATE_US) {
+                    
+                    /* Low-rate sampling only: high-rate samples would flood the log (see LOG_RATE_BURST) */
+                    logEvent(LOG_INFO, LOG_SYS_INFO_SENS_MEAS_SUCCESS);
+                }
+        
+                /* Save measurement data (stamped with the wall clock time of the readout) */
+                clock_gettime(CLOCK_REALTIME, &sampleTime);
+                
+                spanStartNs = getMetricTimeNs();
+                SAVED_DATA_MUTEX_LOCK(sensor);
+                traceSpan(TRACE_SPAN_LOCK_WAIT, sensorIndex, spanStartNs, getMetricTimeNs());
+                
+                /* Append record to saved data buffer (disabled channels hold the invalid value) */
+                record = &(sensor->savedDataBuf[sensor->savedDataBufCount++]);
+                record->timeSec = (uint32_t)sampleTime.tv_sec;
+                record->timeUsec = (uint32_t)(sampleTime.tv_nsec / NSEC_PER_USEC);
+                record->temp = (BME280_OSR_TEMP_SEL & copy_of_sensorSettingSel) ? measData.temp : invalidValue;
+                record->hum = (BME280_OSR_HUM_SEL & copy_of_sensorSettingSel) ? measData.hum : invalidValue;
+                record->press = (BME280_OSR_PRESS_SEL & copy_of_sensorSettingSel) ? measData.press : invalidValue;
+                
+                /* Publish record as the latest sample and wake up clients waiting for it */
+                publishLatestSample(sensor, record, copy_of_configVersion);
+                __atomic_thread_fence(__ATOMIC_SEQ_CST);
+                if(0 != __atomic_load_n(&(sensor->waiterCount), __ATOMIC_RELAXED)) {
+                    
+                    write(sensor->sampleEventFd, &eventCount, sizeof(eventCount));
+                }
+                
+                /* Write out buffer if full or if the oldest record is due */
+                clock_gettime(CLOCK_MONOTONIC, &deadline);
+                nowNs = (uint64_t)deadline.tv_sec * NSEC_PER_SEC + (uint64_t)deadline.tv_nsec;
+                
+                if(0 == flushDueNs) {
+                    
+                    flushDueNs = nowNs + SAVED_DATA_FLUSH_PERIOD_US * NSEC_PER_USEC;
+                }
+                
+                if((SAVED_DATA_BATCH_SIZE == sensor->savedDataBufCount) || (nowNs >= flushDueNs)) {
+                    
+                    flushSavedData(sensor);
+                    flushDueNs = 0;
                 }
                 
-                pthread_mutex_unlock(&savedDataMutex);
+                SAVED_DATA_MUTEX_UNLOCK(sensor);
                 
-                // TODO Fix bug: if period is changed from 1h to 1sec it will only be updated after the 1 hour elapsed
-                // TODO Fix bug: something like a condition change listener or signalling.
-                // Period updated -> Measurement thread notified -> Measurement conducted right away -> sleep for new period
+                nowNs = getMetricTimeNs();
+                traceSpan(TRACE_SPAN_PERSIST, sensorIndex, spanStartNs, nowNs);
+                traceSpan(TRACE_SPAN_SAMPLE, sensorIndex, sampleStartNs, nowNs);
             }
+        }
         
+        /* Measurement off: write out the records still buffered right away */
+        if((0 == copy_of_measPeriodUs) && (0 != flushDueNs)) {
+            
+            SAVED_DATA_MUTEX_LOCK(sensor);
+            flushSavedData(sensor);
+            SAVED_DATA_MUTEX_UNLOCK(sensor);
+            flushDueNs = 0;
         }
         
-        /* Check value of period */
-        if(0 == copy_of_measPeriod) {
+        /* Wait for the next scheduled measurement or for a period change */
+        
+        SENSOR_MUTEX_LOCK(sensor);
+        
+        waitPeriodUs = (0 == copy_of_measPeriodUs) ? MEAS_PERIOD_IDLE_US : copy_of_measPeriodUs;
+        nextWakeupNs += waitPeriodUs * NSEC_PER_USEC;
+        
+        /* Resynchronize schedule if we fell behind (e.g. period shorter than conversion time) */
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        nowNs = (uint64_t)deadline.tv_sec * NSEC_PER_SEC + (uint64_t)deadline.tv_nsec;
+        if(nextWakeupNs < nowNs) {
             
-            /* Default 2 sec */
-            sleep(2);
-            measFlag = 0;
+            nextWakeupNs = nowNs;
         }
-        else {
+        
+        while(!sensor->measPeriodChanged) {
+            
+            /* Records buffered: wake up in time to write them out as well (long periods) */
+            nowNs = ((0 != flushDueNs) && (flushDueNs < nextWakeupNs)) ? flushDueNs : nextWakeupNs;
+            deadline.tv_sec = nowNs / NSEC_PER_SEC;
+            deadline.tv_nsec = nowNs % NSEC_PER_SEC;
             
-            /* Sleep for the given period */
-            sleep(copy_of_measPeriod);
-            measFlag = 1;
+            if(ETIMEDOUT == waitProbedCond(&(sensor->measPeriodCond), &(sensor->sensorMutex), LOCK_ID_SENSOR, (int)(sensor - sensorArray), &deadline)) {
+                
+                if(nowNs == nextWakeupNs) {
+                    
+                    break;
+                }
+                
+                /* Flush due before the next measurement (sensorMutex is not held across it) */
+                SENSOR_MUTEX_UNLOCK(sensor);
+                SAVED_DATA_MUTEX_LOCK(sensor);
+                flushSavedData(sensor);
+                SAVED_DATA_MUTEX_UNLOCK(sensor);
+                flushDueNs = 0;
+                SENSOR_MUTEX_LOCK(sensor);
+            }
         }
+        
+        if(sensor->measPeriodChanged) {
+            
+            /* Period updated: measure right away and restart schedule from now */
+            sensor->measPeriodChanged = 0;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            nextWakeupNs = (uint64_t)deadline.tv_sec * NSEC_PER_SEC + (uint64_t)deadline.tv_nsec;
+        }
+        else if(0 != copy_of_measPeriodUs) {
+            
+            /* Scheduled wake-up: record how late it came */
+            nowNs = getMetricTimeNs();
+            recordMetricValue(METRIC_HIST_SAMPLE_JITTER, (nowNs > nextWakeupNs) ? (nowNs - nextWakeupNs) : 0);
+        }
+        
+        SENSOR_MUTEX_UNLOCK(sensor);
     }
     
     return EXIT_SUCCESS;
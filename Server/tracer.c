@@ -0,0 +1,376 @@
+/*
+ * FileName:    tracer.c
+ * Author:      Adam Csizy
+ * Neptun Code: ******
+ * 
+ * Desc.:       Source file containing the request and sample tracing of the server.
+ * 
+ *              Service and measure threads record spans (start and duration of a phase,
+ *              e.g. accept, auth, lock wait, handler, sendfile, trigger, conversion wait,
+ *              read, compensate, persist) into a ring of their own, overwriting the
+ *              oldest ones. Recording takes two reads of the vDSO clock and a store to
+ *              the ring, no lock and no system call, so tracing is left on by default.
+ * 
+ *              The rings are dumped in the Chrome trace-event JSON format (chrome://tracing,
+ *              Perfetto) on TRACE_DUMP_SIGNAL (to TRACE_DUMP_FILE_NAME next to the saved data),
+ *              on the TRACE request and by the metrics listener (EXPORT_TRACE_PATH). Spans
+ *              of a thread nest by time, so a request shows its lock wait and sendfile
+ *              within its handler.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include "bme280_qt_interf_v2.h"
+#include "myserver.h"
+
+/* Recorded span */
+struct TraceSpan {
+    
+    uint64_t startNs;                   // Monotonic time [nsec]
+    uint64_t durationNs;
+    uint16_t span;                      // TRACE_SPAN_...
+    uint16_t arg;                       // Request code or sensor ID (see traceSpanTable)
+};
+
+/* Span ring of a thread (written by its thread only) */
+struct TraceRing {
+    
+    uint64_t head __attribute__((aligned(64)));     // Spans recorded so far (next slot: head % TRACE_RING_SIZE)
+    char name[TRACE_THREAD_NAME_LEN];
+    struct TraceSpan slot[TRACE_RING_SIZE];
+};
+
+/* Span type */
+struct TraceSpanType {
+    
+    const char *name;
+    const char *category;
+    const char *argName;                // "code": request code, shown in the name as well
+};
+
+/* Span types indexed by TRACE_SPAN_... */
+static const struct TraceSpanType traceSpanTable[TRACE_SPAN_COUNT] = {
+    
+    {"accept", "request", NULL},
+    {"auth", "request", NULL},
+    {"request", "request", "code"},
+    {"handler", "request", "code"},
+    {"lock wait", "lock", "sensor"},
+    {"sendfile", "request", "sensor"},
+    {"sample", "sample", "sensor"},
+    {"trigger", "sample", "sensor"},
+    {"conversion wait", "sample", "sensor"},
+    {"read", "sample", "sensor"},
+    {"compensate", "sample", "sensor"},
+    {"persist", "sample", "sensor"},
+    {"append", "storage", "sensor"}
+};
+
+uint8_t traceEnabled = 1;                           // Spans are recorded (see -T)
+
+/* Rings of the recording threads (registered on their first record) */
+static struct TraceRing *traceRingTable[TRACE_RING_MAX];
+static uint32_t traceRingCount = 0;
+static __thread struct TraceRing *threadTraceRing = NULL;
+
+/*
+ * Function 'getThreadTraceRing': returns the ring of the calling thread, registers it on first use.
+ */
+static struct TraceRing* getThreadTraceRing(void) {
+    
+    uint32_t index;
+    struct TraceRing *ring = NULL;
+    
+    if(NULL != threadTraceRing) {
+        
+        return threadTraceRing;
+    }
+    
+    if(__atomic_load_n(&traceRingCount, __ATOMIC_RELAXED) >= TRACE_RING_MAX) {
+        
+        return NULL;
+    }
+    
+    if(0 != posix_memalign((void**)&ring, 64, sizeof(struct TraceRing))) {
+        
+        return NULL;
+    }
+    
+    memset(ring, 0, sizeof(struct TraceRing));
+    
+    index = __atomic_fetch_add(&traceRingCount, 1, __ATOMIC_RELAXED);
+    if(index >= TRACE_RING_MAX) {
+        
+        free(ring);
+        return NULL;
+    }
+    
+    snprintf(ring->name, sizeof(ring->name), "thread %u", index + 1);
+    
+    __atomic_store_n(&(traceRingTable[index]), ring, __ATOMIC_RELEASE);
+    threadTraceRing = ring;
+    
+    return ring;
+}
+
+/*
+ * Function 'setTraceThreadName': names the calling thread in the trace (e.g. "service %d").
+ */
+void setTraceThreadName(const char *format, int index) {
+    
+    struct TraceRing *ring = NULL;
+    char name[TRACE_THREAD_NAME_LEN];
+    
+    if(0 == traceEnabled) {
+        
+        return;
+    }
+    
+    ring = getThreadTraceRing();
+    if(NULL == ring) {
+        
+        return;
+    }
+    
+    /* Readers may copy the name meanwhile, keep it terminated */
+    snprintf(name, sizeof(name), format, index);
+    memcpy(ring->name, name, sizeof(name));
+}
+
+/*
+ * Function 'traceSpan': records a span of the calling thread.
+ * 
+ * Note:    Times are taken by getMetricTimeNs. The slot is written before the head
+ *          is published, readers drop the slots the thread may have overwritten
+ *          while they were copying (see buildTraceJson).
+ */
+void traceSpan(int span, uint32_t arg, uint64_t startNs, uint64_t endNs) {
+    
+    struct TraceRing *ring = NULL;
+    struct TraceSpan *slot = NULL;
+    uint64_t head;
+    
+    if(0 == traceEnabled) {
+        
+        return;
+    }
+    
+    ring = getThreadTraceRing();
+    if(NULL == ring) {
+        
+        return;
+    }
+    
+    head = ring->head;
+    slot = &(ring->slot[head & (TRACE_RING_SIZE - 1)]);
+    
+    /* Readers copying this slot meanwhile see the head at least at its span (see buildTraceJson) */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    slot->startNs = startNs;
+    slot->durationNs = (endNs > startNs) ? (endNs - startNs) : 0;
+    slot->span = (uint16_t)span;
+    slot->arg = (uint16_t)arg;
+    
+    __atomic_store_n(&(ring->head), head + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Function 'appendTraceSpan': appends a span as a complete event ("ph":"X") of the trace.
+ */
+static void appendTraceSpan(struct ExportText *text, const struct TraceSpan *span, int tid, int *first) {
+    
+    const struct TraceSpanType *type = &(traceSpanTable[span->span]);
+    
+    appendExportText(text, "%s\n{\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%llu.%03llu,\"dur\":%llu.%03llu,\"cat\":\"%s\",",
+                     *first ? "" : ",", (int)getpid(), tid,
+                     (unsigned long long)(span->startNs / NSEC_PER_USEC), (unsigned long long)(span->startNs % NSEC_PER_USEC),
+                     (unsigned long long)(span->durationNs / NSEC_PER_USEC), (unsigned long long)(span->durationNs % NSEC_PER_USEC),
+                     type->category);
+    
+    if(NULL == type->argName) {
+        
+        appendExportText(text, "\"name\":\"%s\"}", type->name);
+    }
+    else if(0 == strcmp(type->argName, "code")) {
+        
+        appendExportText(text, "\"name\":\"%s 0x%02X\",\"args\":{\"code\":\"0x%02X\"}}", type->name, span->arg, span->arg);
+    }
+    else {
+        
+        appendExportText(text, "\"name\":\"%s\",\"args\":{\"%s\":%u}}", type->name, type->argName, span->arg);
+    }
+    
+    *first = 0;
+}
+
+/*
+ * Function 'buildTraceJson': builds the Chrome trace-event JSON of the recorded spans.
+ * 
+ * Note:    Reader side of the rings: the slots are copied, then the slots the thread
+ *          may have overwritten meanwhile (head moved on) are dropped. Timestamps are
+ *          the monotonic clock [usec], thread IDs the ring indices.
+ */
+int buildTraceJson(struct ExportText *text) {
+    
+    struct TraceRing *ring = NULL;
+    struct TraceSpan *copy = NULL;
+    char name[TRACE_THREAD_NAME_LEN];
+    uint32_t count = __atomic_load_n(&traceRingCount, __ATOMIC_RELAXED);
+    uint64_t headBegin;
+    uint64_t headEnd;
+    uint64_t first;
+    uint64_t i;
+    uint32_t iRing;
+    int firstEvent = 1;
+    int error = 0;
+    
+    copy = (struct TraceSpan*)malloc(sizeof(struct TraceSpan) * TRACE_RING_SIZE);
+    if(NULL == copy) {
+        
+        error = -1;
+        return error;
+    }
+    
+    appendExportText(text, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    
+    for(iRing = 0; (iRing < count) && (iRing < TRACE_RING_MAX); iRing++) {
+        
+        ring = __atomic_load_n(&(traceRingTable[iRing]), __ATOMIC_ACQUIRE);
+        if(NULL == ring) {
+            
+            continue;
+        }
+        
+        memcpy(name, ring->name, sizeof(name));
+        name[sizeof(name) - 1] = '\0';
+        appendExportText(text, "%s\n{\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+                         firstEvent ? "" : ",", (int)getpid(), iRing + 1, name);
+        firstEvent = 0;
+        
+        headBegin = __atomic_load_n(&(ring->head), __ATOMIC_ACQUIRE);
+        memcpy(copy, ring->slot, sizeof(struct TraceSpan) * TRACE_RING_SIZE);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        headEnd = __atomic_load_n(&(ring->head), __ATOMIC_RELAXED);
+        
+        /* Oldest span neither overwritten before nor during the copy (the slot of headEnd may be in progress) */
+        first = (headBegin > TRACE_RING_SIZE) ? (headBegin - TRACE_RING_SIZE) : 0;
+        if(headEnd + 1 > first + TRACE_RING_SIZE) {
+            
+            first = headEnd + 1 - TRACE_RING_SIZE;
+        }
+        
+        for(i = first; i < headBegin; i++) {
+            
+            if(copy[i & (TRACE_RING_SIZE - 1)].span < TRACE_SPAN_COUNT) {
+                
+                appendTraceSpan(text, &(copy[i & (TRACE_RING_SIZE - 1)]), (int)iRing + 1, &firstEvent);
+            }
+        }
+    }
+    
+    appendExportText(text, "\n]}\n");
+    
+    free(copy);
+    
+    error = text->error;
+    return error;
+}
+
+/*
+ * Function 'dumpTraceFile': writes the Chrome trace-event JSON of the recorded spans to a file.
+ * 
+ * Note:    Called by the main thread on TRACE_DUMP_SIGNAL. The trace is written to a new
+ *          file (never through a link planted in its place) and renamed over the path.
+ */
+int dumpTraceFile(const char *path) {
+    
+    struct ExportText text;
+    char tmpPath[PATH_MAX];
+    ssize_t len;
+    size_t written = 0;
+    int fd;
+    int error = 0;
+    
+    if(snprintf(tmpPath, sizeof(tmpPath), "%s%s", path, TRACE_DUMP_TMP_SUFFIX) >= (int)sizeof(tmpPath)) {
+        
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_TRACE_DUMP_FAIL, path);
+        
+        error = -1;
+        return error;
+    }
+    
+    memset(&text, 0, sizeof(text));
+    text.size = TRACE_TEXT_INIT_LEN;
+    text.data = (char*)malloc(text.size);
+    if((NULL == text.data) || (0 != buildTraceJson(&text))) {
+        
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_TRACE_DUMP_FAIL, path);
+        free(text.data);
+        
+        error = -1;
+        return error;
+    }
+    
+    /* Left over by a failed dump */
+    unlink(tmpPath);
+    
+    fd = open(tmpPath, O_CREAT | O_EXCL | O_NOFOLLOW | O_WRONLY | O_CLOEXEC, 0644);
+    if(fd < 0) {
+
+#ifdef SERVER_DEBUG
+        perror("open");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_TRACE_DUMP_FAIL, path);
+        free(text.data);
+        
+        error = -1;
+        return error;
+    }
+    
+    while(written < text.len) {
+        
+        len = write(fd, text.data + written, text.len - written);
+        if(len <= 0) {
+
+#ifdef SERVER_DEBUG
+            perror("write");
+            fflush(stderr);
+#endif
+            logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_TRACE_DUMP_FAIL, path);
+            error = -1;
+            break;
+        }
+        
+        written += (size_t)len;
+    }
+    
+    close(fd);
+    free(text.data);
+    
+    if((0 == error) && (rename(tmpPath, path) < 0)) {
+
+#ifdef SERVER_DEBUG
+        perror("rename");
+        fflush(stderr);
+#endif
+        logEvent(LOG_ERR, LOG_SYS_ERR_SERVER_TRACE_DUMP_FAIL, path);
+        error = -1;
+    }
+    
+    if(0 != error) {
+        
+        unlink(tmpPath);
+        return error;
+    }
+    
+    logEvent(LOG_INFO, LOG_SYS_INFO_SERVER_TRACE_DUMP, path);
+    
+    return error;
+}